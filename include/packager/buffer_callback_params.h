@@ -9,9 +9,34 @@
 
 #include <cstdint>
 #include <functional>
+#include <string>
 
 namespace shaka {
 
+/// Describes an output delivered to BufferCallbackParams::output_func.
+struct OutputInfo {
+  /// Name of the output, i.e. the label it would be written to with
+  /// @a BufferCallbackParams.write_func.
+  std::string name;
+  /// Label of the stream the output belongs to, i.e. @a
+  /// StreamDescriptor.segment_template, or @a StreamDescriptor.output if
+  /// there is no segment template.  Empty for manifests and playlists.
+  std::string stream;
+  /// True if the output is a media segment or a chunk of one, in which case
+  /// the fields below are set.
+  bool is_segment = false;
+  /// True if the output is a chunk of a low latency segment.  The chunks of a
+  /// segment are delivered in order, with the same segment number.
+  bool is_chunk = false;
+  /// Segment number, as used in $Number$ in segment templates.
+  int64_t segment_number = 0;
+  /// Start time and duration of the segment, in @a timescale units.  For a
+  /// chunk, the duration of the segment so far.
+  int64_t start_time = 0;
+  int64_t duration = 0;
+  int32_t timescale = 0;
+};
+
 /// Buffer callback params.
 struct BufferCallbackParams {
   /// If this function is specified, packager treats @a StreamDescriptor.input
@@ -29,6 +54,16 @@ struct BufferCallbackParams {
   std::function<
       int64_t(const std::string& name, const void* buffer, uint64_t size)>
       write_func;
+  /// If this function is specified, it is used instead of @a write_func, and
+  /// each output is delivered as one contiguous buffer once it is complete:
+  /// each segment, or each chunk of a low latency segment, each init segment
+  /// and each version of a manifest.  This avoids reassembling outputs from
+  /// many small writes.  The output is described by @a info.
+  /// The function should return true if the output was consumed, or false to
+  /// fail packaging.
+  std::function<
+      bool(const OutputInfo& info, const void* buffer, uint64_t size)>
+      output_func;
 };
 
 }  // namespace shaka
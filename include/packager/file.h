@@ -22,6 +22,7 @@ extern const char* kLocalFilePrefix;
 extern const char* kMemoryFilePrefix;
 extern const char* kUdpFilePrefix;
 extern const char* kHttpFilePrefix;
+extern const char* kOriginFilePrefix;
 const int64_t kWholeFile = -1;
 
 /// Define an abstract file interface.
@@ -69,6 +70,21 @@ class SHAKA_EXPORT File {
   /// @return Number of bytes written, or a value < 0 on error.
   virtual int64_t Write(const void* buffer, uint64_t length) = 0;
 
+  /// A block of data to be written by WriteV.
+  struct WriteBuffer {
+    const void* data;
+    uint64_t length;
+  };
+
+  /// Write several blocks of data, in order, as if they were one contiguous
+  /// block, without gathering them into a single buffer first.  The default
+  /// implementation calls Write for each block.
+  /// @param buffers points to an array of @a num_buffers blocks.
+  /// @param num_buffers indicates the number of blocks to write.
+  /// @return Number of bytes written, or a value < 0 on error.  Fewer bytes
+  ///         than requested may be written, as with Write.
+  virtual int64_t WriteV(const WriteBuffer* buffers, size_t num_buffers);
+
   /// Close the file for writing.  This signals that no more data will be
   /// written.  Future writes are invalid and their behavior is undefined!
   /// Data may still be read from the file after calling this method.
@@ -97,6 +113,24 @@ class SHAKA_EXPORT File {
   /// @return true on succcess, false otherwise.
   virtual bool Tell(uint64_t* position) = 0;
 
+  /// @return true if Read would return without waiting for data to arrive,
+  ///         i.e. if data, end of file or an error is available.  This lets
+  ///         a few threads take turns reading many live inputs.  Files which
+  ///         never wait for data, e.g. local files, always return true.
+  virtual bool IsReadReady() { return true; }
+
+  /// @return A file descriptor which polls readable when IsReadReady may have
+  ///         become true, or -1 if there is none and readiness has to be
+  ///         checked periodically.  IsReadReady must be called again after
+  ///         the descriptor polls readable.
+  virtual int GetReadinessFd() { return -1; }
+
+  /// @return How long Read waits for data before it fails, in microseconds,
+  ///         or 0 if it waits indefinitely.  IsReadReady returns true once
+  ///         no data arrived for that long, so that Read fails as it would
+  ///         have after waiting.
+  virtual int64_t GetReadTimeoutUs() { return 0; }
+
   /// @return The file name. Note that the file type prefix has been stripped
   ///         off.
   const std::string& file_name() const { return file_name_; }
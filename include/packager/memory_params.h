@@ -0,0 +1,36 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_PUBLIC_MEMORY_PARAMS_H_
+#define PACKAGER_PUBLIC_MEMORY_PARAMS_H_
+
+#include <cstdint>
+
+namespace shaka {
+
+/// Memory budget parameters. The memory held by input buffers, queued samples,
+/// samples waiting to be muxed and output caches is accounted for, and inputs
+/// are throttled once it goes over the budget.
+struct MemoryParams {
+  /// What to do with an input while the budget is exhausted.
+  enum class OverflowAction {
+    /// Stop reading the input until memory is released. Live inputs which
+    /// cannot be paused, e.g. UDP, may then lose data before it is read.
+    kBlock,
+    /// Keep reading the input but drop its samples, up to the next key frame
+    /// once memory is released. Dropped samples are counted in MemoryStats.
+    kDrop,
+  };
+
+  /// Maximum memory in bytes, 0 for unlimited. This is a soft limit: inputs
+  /// are throttled once it is reached.
+  uint64_t max_memory_bytes = 0;
+  OverflowAction overflow_action = OverflowAction::kBlock;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_PUBLIC_MEMORY_PARAMS_H_
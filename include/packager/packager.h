@@ -8,6 +8,7 @@
 #define PACKAGER_PUBLIC_PACKAGER_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -21,12 +22,21 @@
 #include <packager/export.h>
 #include <packager/file.h>
 #include <packager/hls_params.h>
+#include <packager/memory_params.h>
 #include <packager/mp4_output_params.h>
 #include <packager/mpd_params.h>
+#include <packager/packager_stats.h>
 #include <packager/status.h>
 
 namespace shaka {
 
+namespace media {
+class JobPool;
+class KeySourceCache;
+}  // namespace media
+
+class MemoryBudget;
+
 /// Parameters used for testing.
 struct TestParams {
   /// Whether to dump input stream info.
@@ -65,6 +75,17 @@ struct PackagingParams {
   /// Only use a single thread to generate output.  This is useful in tests to
   /// avoid non-deterministic outputs.
   bool single_threaded = false;
+  /// When non-zero, every output runs on a thread of its own, decoupled from
+  /// the input it is generated from by a queue of at most this many stream
+  /// data items, i.e. media samples, stream info, segment info and cue events.
+  /// This lets outputs sharing an input be muxed and written in parallel.
+  /// Ignored if `single_threaded` is set.
+  size_t output_queue_size = 0;
+  /// When non-zero, inputs are read and processed by a pool of this many
+  /// threads taking turns, instead of a thread each, so that many live inputs
+  /// can share a few cores.  Ignored if `single_threaded` is set or ad cues
+  /// are inserted.
+  size_t job_pool_size = 0;
 
   /// DASH MPD related parameters.
   MpdParams mpd_params;
@@ -81,6 +102,12 @@ struct PackagingParams {
   /// CEA-608 / CEA-708 captions.
   std::vector<CeaCaption> closed_captions;
 
+  /// Pipeline statistics dumping parameters.
+  StatsParams stats_params;
+
+  /// Memory budget of the pipeline.
+  MemoryParams memory_params;
+
   // Parameters for testing. Do not use in production.
   TestParams test_params;
 };
@@ -188,6 +215,12 @@ class SHAKA_EXPORT Packager {
   /// Cancel packaging. Note that it has to be called from another thread.
   void Cancel();
 
+  /// Get a snapshot of the statistics of the pipeline, i.e. where the time
+  /// goes and how much data flows through each stage. Can be called from
+  /// another thread while packaging.
+  /// @return the statistics, which are empty if not yet initialized.
+  PackagerStats GetStats() const;
+
   /// @return The version of the library.
   static std::string GetLibraryVersion();
 
@@ -220,6 +253,25 @@ class SHAKA_EXPORT Packager {
   Packager(const Packager&) = delete;
   Packager& operator=(const Packager&) = delete;
 
+  friend class PackagerHost;
+
+  // Same as the public Initialize, but uses resources shared with other
+  // packagers. Jobs run on @a job_pool when possible, and key sources come
+  // from @a key_sources, and the memory used is also accounted for in
+  // @a parent_memory_budget.
+  Status Initialize(const PackagingParams& packaging_params,
+                    const std::vector<StreamDescriptor>& stream_descriptors,
+                    std::shared_ptr<media::JobPool> job_pool,
+                    media::KeySourceCache* key_sources,
+                    std::shared_ptr<MemoryBudget> parent_memory_budget);
+
+  // Start the pipeline on the shared job pool without blocking. Once it
+  // completes, @a on_complete is called from a pool thread with the status
+  // Run() would return; it must not destroy the packager. Returns false if the
+  // pipeline cannot run on the pool, e.g. with ad cues, in which case Run()
+  // has to be used.
+  bool Start(std::function<void(const Status&)> on_complete);
+
   struct PackagerInternal;
   std::unique_ptr<PackagerInternal> internal_;
 };
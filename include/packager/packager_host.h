@@ -0,0 +1,103 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_PUBLIC_PACKAGER_HOST_H_
+#define PACKAGER_PUBLIC_PACKAGER_HOST_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <packager/export.h>
+#include <packager/packager.h>
+#include <packager/status.h>
+
+namespace shaka {
+
+/// PackagerHost parameters.
+struct PackagerHostParams {
+  /// Number of worker threads running the inputs of all channels. 0 means one
+  /// per CPU core.
+  uint32_t num_worker_threads = 0;
+  /// Limit of the memory buffered by all channels together, in bytes, on top
+  /// of the limit of each channel, see MemoryParams. 0 means unlimited.
+  uint64_t max_memory_bytes = 0;
+};
+
+/// Runs many packaging pipelines, called channels, in one process. Channels
+/// share the resources of the host instead of each creating their own:
+///  - Inputs of all channels run on one pool of worker threads, so that the
+///    number of threads does not grow with the number of channels. Channels
+///    with ad cues or `single_threaded` set still use their own threads.
+///  - Channels with the same encryption key parameters share one key source,
+///    so that keys are fetched once. Key sources with key rotation are not
+///    shared.
+///  - The memory buffered by channels is accounted for in one budget, which
+///    applies backpressure to the inputs of all channels once full.
+///  - HTTP connections are reused across channels, through the process-wide
+///    HTTP connection pool.
+/// Channels can be added and removed at any time. All methods are thread safe.
+class SHAKA_EXPORT PackagerHost {
+ public:
+  PackagerHost();
+  /// Cancels the channels which are still running and waits for them.
+  ~PackagerHost();
+
+  /// Initialize the shared resources.
+  /// @param params contains the host parameters.
+  /// @return OK on success, an appropriate error code on failure.
+  Status Initialize(const PackagerHostParams& params);
+
+  /// Add a channel and start packaging it. Does not block until the channel
+  /// completes, see WaitForChannel.
+  /// @param channel_id uniquely identifies the channel in the host.
+  /// @param packaging_params contains the packaging parameters of the channel.
+  /// @param stream_descriptors a list of stream descriptors of the channel.
+  /// @return OK on success, an appropriate error code if the channel could
+  ///         not be initialized.
+  Status AddChannel(const std::string& channel_id,
+                    const PackagingParams& packaging_params,
+                    const std::vector<StreamDescriptor>& stream_descriptors);
+
+  /// Wait for a channel to complete and remove it from the host.
+  /// @return The status of the channel, like Packager::Run(), or NOT_FOUND if
+  ///         there is no such channel.
+  Status WaitForChannel(const std::string& channel_id);
+
+  /// Cancel a channel, wait for it to stop and remove it from the host.
+  /// @return The status of the channel, like Packager::Run(), or NOT_FOUND if
+  ///         there is no such channel.
+  Status RemoveChannel(const std::string& channel_id);
+
+  /// @return The ids of the channels in the host.
+  std::vector<std::string> GetChannelIds() const;
+
+  /// Get a snapshot of the statistics of a channel, see Packager::GetStats().
+  /// @return OK on success, NOT_FOUND if there is no such channel or if it is
+  ///         still being added.
+  Status GetChannelStats(const std::string& channel_id,
+                         PackagerStats* stats) const;
+
+  /// @return The memory used by all the channels of the host.
+  MemoryStats GetMemoryStats() const;
+
+ private:
+  PackagerHost(const PackagerHost&) = delete;
+  PackagerHost& operator=(const PackagerHost&) = delete;
+
+  struct Channel;
+  struct PackagerHostInternal;
+
+  Status WaitAndRemoveChannel(const std::string& channel_id,
+                              std::shared_ptr<Channel> channel);
+
+  std::unique_ptr<PackagerHostInternal> internal_;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_PUBLIC_PACKAGER_HOST_H_
@@ -0,0 +1,95 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_PUBLIC_PACKAGER_STATS_H_
+#define PACKAGER_PUBLIC_PACKAGER_STATS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shaka {
+
+/// Statistics of one stage of the packaging pipeline, e.g. the demuxer of an
+/// input, the chunking handler of a stream, or the muxer of an output and its
+/// listener.
+struct HandlerStats {
+  /// Type of the stage followed by the input, stream or output it belongs to,
+  /// e.g. `ChunkingHandler[input.mp4:video]`.
+  std::string name;
+  /// Number of calls into the stage: stream data or batches of stream data
+  /// processed, flush requests, reads parsed by demuxers and events received
+  /// by listeners.
+  uint64_t num_calls = 0;
+  /// Number of stream data processed. For demuxers, the number of samples
+  /// produced.
+  uint64_t num_stream_data = 0;
+  /// Number of media and text samples processed.
+  uint64_t num_samples = 0;
+  /// Size of the media samples processed, in bytes.
+  uint64_t num_bytes = 0;
+  /// Time spent in the stage, excluding the time spent in the stages it
+  /// dispatches to, in microseconds.
+  uint64_t processing_time_us = 0;
+  /// Histogram of the time spent per call, as above. Bucket 0 counts calls
+  /// taking less than 1 microsecond, bucket `i` calls taking less than `2^i`
+  /// microseconds but at least `2^(i-1)`. The last bucket also counts all
+  /// longer calls.
+  std::vector<uint64_t> processing_time_histogram;
+  /// For muxers, the number of segments, subsegments and low latency chunks
+  /// written whose samples have a known ingest time.
+  uint64_t num_segments = 0;
+  /// Total and maximum time from the ingestion of the first sample of these
+  /// segments to the segment being written, in microseconds.
+  uint64_t first_sample_latency_us = 0;
+  uint64_t max_first_sample_latency_us = 0;
+  /// Same, from the ingestion of the last sample of the segments.
+  uint64_t last_sample_latency_us = 0;
+  uint64_t max_last_sample_latency_us = 0;
+  /// Number of stream data queued, for stages with a queue.
+  uint64_t queue_depth = 0;
+  uint64_t max_queue_depth = 0;
+};
+
+/// Memory accounted for in a budget, see MemoryParams.
+struct MemoryStats {
+  std::string name;
+  /// Memory in use, in bytes.
+  uint64_t usage_bytes = 0;
+  uint64_t max_usage_bytes = 0;
+  /// Limit of the budget in bytes, 0 if unlimited.
+  uint64_t limit_bytes = 0;
+  /// Number of times an input waited for memory to be released.
+  uint64_t num_backpressure_waits = 0;
+  /// Number of samples dropped to stay within the budget.
+  uint64_t num_dropped_samples = 0;
+};
+
+/// A snapshot of the statistics of a packaging pipeline.
+struct PackagerStats {
+  std::vector<HandlerStats> handlers;
+  /// Memory used by the pipeline.
+  MemoryStats memory;
+};
+
+/// Parameters for dumping PackagerStats periodically.
+struct StatsParams {
+  enum class Format {
+    kJson,
+    /// Prometheus text exposition format.
+    kPrometheus,
+  };
+
+  /// If not empty, a snapshot of the statistics is written to this file every
+  /// `dump_interval_in_seconds` while packaging, and once it completes.
+  std::string stats_output;
+  double dump_interval_in_seconds = 10;
+  Format format = Format::kJson;
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_PUBLIC_PACKAGER_STATS_H_
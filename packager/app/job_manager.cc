@@ -10,8 +10,8 @@
 
 #include <absl/log/check.h>
 
+#include <packager/media/async_queue/async_queue_handler.h>
 #include <packager/media/chunking/sync_point_queue.h>
-#include <packager/media/origin/origin_handler.h>
 
 namespace shaka {
 namespace media {
@@ -48,6 +48,29 @@ const Status& Job::Run() {
   return status_;
 }
 
+OriginHandler::StepResult Job::RunStep() {
+  OriginHandler::StepResult result = OriginHandler::StepResult::kDone;
+  if (status_.ok()) {  // initialized correctly
+    Status status;
+    result = work_->RunStep(&status);
+    if (result == OriginHandler::StepResult::kDone)
+      status_ = status;
+  }
+
+  if (result == OriginHandler::StepResult::kDone)
+    on_complete_(this);
+
+  return result;
+}
+
+int Job::GetInputReadinessFd() {
+  return work_->GetInputReadinessFd();
+}
+
+absl::Duration Job::GetInputTimeout() {
+  return work_->GetInputTimeout();
+}
+
 void Job::Join() {
   if (thread_) {
     thread_->join();
@@ -65,6 +88,11 @@ void JobManager::Add(const std::string& name,
       std::bind(&JobManager::OnJobComplete, this, std::placeholders::_1)));
 }
 
+void JobManager::AddAsyncQueue(
+    std::shared_ptr<AsyncQueueHandler> async_queue) {
+  async_queues_.push_back(std::move(async_queue));
+}
+
 Status JobManager::InitializeJobs() {
   Status status;
   for (auto& job : jobs_)
@@ -109,6 +137,9 @@ Status JobManager::RunJobs() {
   if (sync_points_)
     sync_points_->Cancel();
 
+  for (auto& async_queue : async_queues_)
+    async_queue->Cancel();
+
   for (auto& job : active_jobs)
     job->Cancel();
 
@@ -129,6 +160,9 @@ void JobManager::CancelJobs() {
   if (sync_points_)
     sync_points_->Cancel();
 
+  for (auto& async_queue : async_queues_)
+    async_queue->Cancel();
+
   for (auto& job : jobs_)
     job->Cancel();
 }
@@ -15,12 +15,13 @@
 
 #include <absl/synchronization/mutex.h>
 
+#include <packager/media/origin/origin_handler.h>
 #include <packager/status.h>
 
 namespace shaka {
 namespace media {
 
-class OriginHandler;
+class AsyncQueueHandler;
 class SyncPointQueue;
 
 // A job is a single line of work that is expected to run in parallel with
@@ -49,6 +50,19 @@ class Job {
   // operation.  DO NOT USE BOTH!
   const Status& Run();
 
+  // Run a bounded amount of the job's work without waiting for input. Updates
+  // status() when the job is done.
+  // Use either RunStep() or Start() / Run(). DO NOT USE BOTH!
+  OriginHandler::StepResult RunStep();
+
+  // Returns a file descriptor which polls readable when the job may make
+  // progress again after RunStep() returned kWaitForInput, or -1.
+  int GetInputReadinessFd();
+
+  // Returns how long the job may wait for input before it should be stepped
+  // again anyway, so that it can fail with a timeout.
+  absl::Duration GetInputTimeout();
+
   // Request that the job stops executing. This is only a request and will not
   // block. If you want to wait for the job to complete, use |complete|.
   void Cancel();
@@ -103,7 +117,12 @@ class JobManager {
 
   // Ask all jobs to stop running. This call is non-blocking and can be used to
   // unblock a call to |RunJobs|.
-  void CancelJobs();
+  virtual void CancelJobs();
+
+  // Register an AsyncQueueHandler used by the jobs. JobManager cancels
+  // @a async_queue when any job fails or is cancelled, so that no job stays
+  // blocked on a full or flushing queue.
+  void AddAsyncQueue(std::shared_ptr<AsyncQueueHandler> async_queue);
 
   SyncPointQueue* sync_points() { return sync_points_.get(); }
 
@@ -111,12 +130,14 @@ class JobManager {
   JobManager(const JobManager&) = delete;
   JobManager& operator=(const JobManager&) = delete;
 
-  void OnJobComplete(Job* job);
+  virtual void OnJobComplete(Job* job);
 
   // Stored in JobManager so JobManager can cancel |sync_points| when any job
   // fails or is cancelled.
   std::unique_ptr<SyncPointQueue> sync_points_;
 
+  std::vector<std::shared_ptr<AsyncQueueHandler>> async_queues_;
+
   std::vector<std::unique_ptr<Job>> jobs_;
 
   absl::Mutex mutex_;
@@ -0,0 +1,300 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/app/job_pool.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif  // defined(__linux__)
+
+#include <algorithm>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+
+#include <packager/macros/compiler.h>
+
+namespace shaka {
+namespace media {
+
+namespace {
+
+// How long to wait before stepping a job again if its input cannot be polled.
+const absl::Duration kRetryInterval = absl::Milliseconds(5);
+// Upper bound of a poll, so that the poller notices when it is stopped.
+const absl::Duration kMaxPollInterval = absl::Milliseconds(100);
+#if defined(__linux__)
+const int kMaxEvents = 64;
+#endif  // defined(__linux__)
+
+}  // namespace
+
+JobPool::JobPool(size_t num_threads) {
+  DCHECK_GT(num_threads, 0u);
+
+#if defined(__linux__)
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  interrupt_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.ptr = nullptr;
+  if (epoll_fd_ < 0 || interrupt_fd_ < 0 ||
+      epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, interrupt_fd_, &event) != 0) {
+    LOG(WARNING) << "Cannot set up epoll. Inputs will be polled periodically.";
+    if (epoll_fd_ >= 0)
+      close(epoll_fd_);
+    if (interrupt_fd_ >= 0)
+      close(interrupt_fd_);
+    epoll_fd_ = -1;
+    interrupt_fd_ = -1;
+  }
+#endif  // defined(__linux__)
+
+  for (size_t i = 0; i < num_threads; ++i)
+    workers_.emplace_back(new Worker);
+  for (size_t i = 0; i < num_threads; ++i)
+    workers_[i]->thread = std::thread(&JobPool::WorkerMain, this, i);
+  poller_thread_ = std::thread(&JobPool::PollerMain, this);
+}
+
+JobPool::~JobPool() {
+  {
+    absl::MutexLock lock(scheduler_mutex_);
+    DCHECK_EQ(num_queued_jobs_, 0u);
+    DCHECK(running_jobs_.empty());
+    stopping_ = true;
+    job_available_.SignalAll();
+  }
+  for (auto& worker : workers_)
+    worker->thread.join();
+  {
+    absl::MutexLock lock(waiting_mutex_);
+    DCHECK(waiting_jobs_.empty());
+    poller_stopping_ = true;
+    InterruptPoller();
+  }
+  poller_thread_.join();
+
+#if defined(__linux__)
+  if (epoll_fd_ >= 0)
+    close(epoll_fd_);
+  if (interrupt_fd_ >= 0)
+    close(interrupt_fd_);
+#endif  // defined(__linux__)
+}
+
+void JobPool::Add(const std::vector<Job*>& jobs) {
+  for (Job* job : jobs)
+    Schedule(job, next_worker_index_++ % workers_.size());
+}
+
+void JobPool::Cancel(const std::vector<Job*>& jobs) {
+  absl::MutexLock lock(waiting_mutex_);
+  for (Job* job : jobs) {
+    cancelled_jobs_.insert(job);
+    auto iter = waiting_jobs_.find(job);
+    if (iter == waiting_jobs_.end())
+      continue;
+    Schedule(job, iter->second.worker_index);
+    waiting_jobs_.erase(iter);
+  }
+}
+
+void JobPool::Release(const std::vector<Job*>& jobs) {
+  {
+    absl::MutexLock lock(scheduler_mutex_);
+    for (Job* job : jobs) {
+      while (running_jobs_.count(job) > 0)
+        job_stepped_.Wait(&scheduler_mutex_);
+    }
+  }
+  absl::MutexLock lock(waiting_mutex_);
+  for (Job* job : jobs) {
+    DCHECK_EQ(waiting_jobs_.count(job), 0u);
+    cancelled_jobs_.erase(job);
+  }
+}
+
+void JobPool::Schedule(Job* job, size_t worker_index) {
+  absl::MutexLock lock(scheduler_mutex_);
+  {
+    Worker* worker = workers_[worker_index].get();
+    absl::MutexLock worker_lock(worker->mutex);
+    worker->jobs.push_back(job);
+  }
+  ++num_queued_jobs_;
+  job_available_.Signal();
+}
+
+Job* JobPool::TakeJob(size_t worker_index) {
+  Job* job = nullptr;
+  for (size_t i = 0; i < workers_.size() && !job; ++i) {
+    Worker* worker = workers_[(worker_index + i) % workers_.size()].get();
+    absl::MutexLock worker_lock(worker->mutex);
+    if (worker->jobs.empty())
+      continue;
+    if (i == 0) {
+      job = worker->jobs.front();
+      worker->jobs.pop_front();
+    } else {
+      job = worker->jobs.back();
+      worker->jobs.pop_back();
+    }
+  }
+  if (job) {
+    // Jobs are counted before being queued, see Schedule.
+    absl::MutexLock lock(scheduler_mutex_);
+    --num_queued_jobs_;
+    running_jobs_.insert(job);
+  }
+  return job;
+}
+
+void JobPool::WorkerMain(size_t worker_index) {
+  while (true) {
+    Job* job = TakeJob(worker_index);
+    if (!job) {
+      absl::MutexLock lock(scheduler_mutex_);
+      while (num_queued_jobs_ == 0 && !stopping_)
+        job_available_.Wait(&scheduler_mutex_);
+      if (num_queued_jobs_ == 0 && stopping_)
+        return;
+      continue;
+    }
+
+    const OriginHandler::StepResult result = job->RunStep();
+    {
+      // Completed jobs may be destroyed once released, so |job| is only
+      // touched after this if it is not done.
+      absl::MutexLock lock(scheduler_mutex_);
+      running_jobs_.erase(job);
+      job_stepped_.SignalAll();
+    }
+
+    switch (result) {
+      case OriginHandler::StepResult::kContinue:
+        Schedule(job, worker_index);
+        break;
+      case OriginHandler::StepResult::kWaitForInput:
+        WaitForInput(job, worker_index);
+        break;
+      case OriginHandler::StepResult::kDone:
+        break;
+    }
+  }
+}
+
+void JobPool::WaitForInput(Job* job, size_t worker_index) {
+  const int fd = job->GetInputReadinessFd();
+  const absl::Duration timeout = job->GetInputTimeout();
+
+  absl::MutexLock lock(waiting_mutex_);
+  if (cancelled_jobs_.count(job) > 0) {
+    // Cancelled while stepping, so let the job finish.
+    Schedule(job, worker_index);
+    return;
+  }
+
+  // The job has to be registered before its descriptor is armed, since the
+  // poller may see the descriptor ready right away.
+  WaitingJob& waiting_job = waiting_jobs_[job];
+  waiting_job.worker_index = worker_index;
+  waiting_job.deadline = absl::Now() + timeout;
+
+  bool polled = false;
+#if defined(__linux__)
+  if (fd >= 0 && epoll_fd_ >= 0) {
+    struct epoll_event event = {};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.ptr = job;
+    polled = epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) == 0 ||
+             (errno == ENOENT &&
+              epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == 0);
+    if (!polled)
+      LOG(WARNING) << "Cannot poll input of job " << job->name();
+  }
+#else
+  UNUSED(fd);
+#endif  // defined(__linux__)
+  if (!polled) {
+    waiting_job.deadline =
+        std::min(waiting_job.deadline, absl::Now() + kRetryInterval);
+  }
+  if (waiting_job.deadline != absl::InfiniteFuture())
+    InterruptPoller();
+}
+
+void JobPool::PollerMain() {
+  while (true) {
+    absl::Duration timeout = kMaxPollInterval;
+    {
+      absl::MutexLock lock(waiting_mutex_);
+      if (poller_stopping_)
+        return;
+
+      // Schedule the jobs which are due, and wait for the next one.
+      const absl::Time now = absl::Now();
+      for (auto iter = waiting_jobs_.begin(); iter != waiting_jobs_.end();) {
+        if (iter->second.deadline <= now) {
+          Schedule(iter->first, iter->second.worker_index);
+          iter = waiting_jobs_.erase(iter);
+        } else {
+          timeout = std::min(timeout, iter->second.deadline - now);
+          ++iter;
+        }
+      }
+
+      if (epoll_fd_ < 0) {
+        poller_interrupted_.WaitWithTimeout(&waiting_mutex_, timeout);
+        continue;
+      }
+    }
+
+#if defined(__linux__)
+    struct epoll_event events[kMaxEvents];
+    const int64_t timeout_ms =
+        absl::ToInt64Milliseconds(absl::Ceil(timeout, absl::Milliseconds(1)));
+    const int num_events =
+        epoll_wait(epoll_fd_, events, kMaxEvents, static_cast<int>(timeout_ms));
+
+    absl::MutexLock lock(waiting_mutex_);
+    for (int i = 0; i < num_events; ++i) {
+      Job* job = static_cast<Job*>(events[i].data.ptr);
+      if (!job) {
+        uint64_t count;
+        if (read(interrupt_fd_, &count, sizeof(count)) < 0) {
+          // Already consumed.
+        }
+        continue;
+      }
+      // The job may have been woken up already, or even released.
+      auto iter = waiting_jobs_.find(job);
+      if (iter == waiting_jobs_.end())
+        continue;
+      Schedule(job, iter->second.worker_index);
+      waiting_jobs_.erase(iter);
+    }
+#endif  // defined(__linux__)
+  }
+}
+
+void JobPool::InterruptPoller() {
+#if defined(__linux__)
+  if (interrupt_fd_ >= 0) {
+    const uint64_t kOne = 1;
+    if (write(interrupt_fd_, &kOne, sizeof(kOne)) < 0)
+      LOG(WARNING) << "Failed to interrupt the poller.";
+    return;
+  }
+#endif  // defined(__linux__)
+  poller_interrupted_.Signal();
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,118 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_APP_JOB_POOL_H_
+#define PACKAGER_APP_JOB_POOL_H_
+
+#include <atomic>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
+
+#include <packager/app/job_manager.h>
+
+namespace shaka {
+namespace media {
+
+// Steps jobs cooperatively on a fixed number of threads instead of a thread
+// per job, so that the number of threads scales with cores rather than with
+// inputs. Jobs are run a step at a time (see OriginHandler::RunStep). Every
+// worker thread has a queue of jobs to step; an idle worker steals jobs from
+// the others. A job waiting for input is parked until its input is ready,
+// using epoll where the input provides a file descriptor, and is retried
+// after a short delay otherwise. It is also stepped again once its input
+// timeout passes, so that it can fail.
+//
+// A pool can be shared by the jobs of several JobManagers, e.g. by all the
+// channels of a PackagerHost. Jobs must not block on each other, e.g. through
+// cue alignment, unless there are at least as many threads as jobs.
+class JobPool {
+ public:
+  // @param num_threads is the number of worker threads.
+  explicit JobPool(size_t num_threads);
+  // All jobs must have been released.
+  ~JobPool();
+
+  // Step @a jobs until they are done. Job::RunStep() calls the completion
+  // callback of each job from a worker thread.
+  void Add(const std::vector<Job*>& jobs);
+
+  // Wake up @a jobs if they are waiting for input, and keep them from waiting
+  // again, so that cancelled jobs can exit.
+  void Cancel(const std::vector<Job*>& jobs);
+
+  // Wait until no worker is stepping @a jobs anymore, and forget about them.
+  // The jobs must have completed, and can be destroyed afterwards. Must not be
+  // called from a worker thread.
+  void Release(const std::vector<Job*>& jobs);
+
+  size_t num_threads() const { return workers_.size(); }
+
+ private:
+  JobPool(const JobPool&) = delete;
+  JobPool& operator=(const JobPool&) = delete;
+
+  struct Worker {
+    absl::Mutex mutex;
+    // The owner takes jobs from the front, so that its jobs take turns;
+    // thieves take them from the back.
+    std::deque<Job*> jobs ABSL_GUARDED_BY(mutex);
+    std::thread thread;
+  };
+
+  // Queue |job| to be stepped, preferably by the worker at |worker_index|.
+  void Schedule(Job* job, size_t worker_index);
+  // Take the next job for the worker at |worker_index|, stealing it from
+  // another worker if needed. Returns nullptr if there is none.
+  Job* TakeJob(size_t worker_index);
+  void WorkerMain(size_t worker_index);
+
+  // Park |job| until its input may be ready.
+  void WaitForInput(Job* job, size_t worker_index);
+  void PollerMain();
+  // Interrupt the poller, e.g. to pick up a new deadline.
+  void InterruptPoller();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // Spreads added jobs over the workers.
+  std::atomic<size_t> next_worker_index_{0};
+
+  absl::Mutex scheduler_mutex_;
+  absl::CondVar job_available_ ABSL_GUARDED_BY(scheduler_mutex_);
+  size_t num_queued_jobs_ ABSL_GUARDED_BY(scheduler_mutex_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(scheduler_mutex_) = false;
+  // The jobs being stepped, see Release.
+  std::set<Job*> running_jobs_ ABSL_GUARDED_BY(scheduler_mutex_);
+  absl::CondVar job_stepped_ ABSL_GUARDED_BY(scheduler_mutex_);
+
+  struct WaitingJob {
+    size_t worker_index;
+    // When to step the job again if its input is not ready by then: after
+    // the input timeout, or shortly if the input cannot be polled.
+    absl::Time deadline;
+  };
+  absl::Mutex waiting_mutex_;
+  std::map<Job*, WaitingJob> waiting_jobs_ ABSL_GUARDED_BY(waiting_mutex_);
+  // Jobs which are not parked anymore since they are cancelled.
+  std::set<Job*> cancelled_jobs_ ABSL_GUARDED_BY(waiting_mutex_);
+  bool poller_stopping_ ABSL_GUARDED_BY(waiting_mutex_) = false;
+  // Used without epoll, to wake up the poller.
+  absl::CondVar poller_interrupted_ ABSL_GUARDED_BY(waiting_mutex_);
+  int epoll_fd_ = -1;
+  int interrupt_fd_ = -1;
+  std::thread poller_thread_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_APP_JOB_POOL_H_
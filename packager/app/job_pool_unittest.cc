@@ -0,0 +1,223 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/app/job_pool.h>
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include <absl/synchronization/blocking_counter.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
+#include <absl/time/clock.h>
+#include <gtest/gtest.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+typedef OriginHandler::StepResult StepResult;
+
+// Steps with |step| and waits for input on |fd|, if any.
+class FakeHandler : public OriginHandler {
+ public:
+  FakeHandler(std::function<StepResult()> step,
+              int fd,
+              absl::Duration timeout)
+      : step_(std::move(step)), fd_(fd), timeout_(timeout) {}
+
+  Status Run() override { return Status::OK; }
+  void Cancel() override { cancelled_ = true; }
+  StepResult RunStep(Status* status) override {
+    *status = Status::OK;
+    num_steps_++;
+    return cancelled_ ? StepResult::kDone : step_();
+  }
+  int GetInputReadinessFd() override { return fd_; }
+  absl::Duration GetInputTimeout() override { return timeout_; }
+
+  int num_steps() const { return num_steps_; }
+
+ protected:
+  Status InitializeInternal() override { return Status::OK; }
+
+ private:
+  std::function<StepResult()> step_;
+  const int fd_;
+  const absl::Duration timeout_;
+  std::atomic<bool> cancelled_{false};
+  std::atomic<int> num_steps_{0};
+};
+
+class JobPoolTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    ASSERT_GE(fd_, 0);
+  }
+
+  void TearDown() override {
+    pool_->Release(GetJobs());
+    pool_.reset();
+    close(fd_);
+  }
+
+  std::vector<Job*> GetJobs() {
+    std::vector<Job*> jobs;
+    for (const auto& job : jobs_)
+      jobs.push_back(job.get());
+    return jobs;
+  }
+
+  // Adds a job stepped with |step| to |jobs_|. Its completion is counted in
+  // |num_completed_jobs_|.
+  FakeHandler* AddJob(std::function<StepResult()> step,
+                      int fd = -1,
+                      absl::Duration timeout = absl::InfiniteDuration()) {
+    auto handler = std::make_shared<FakeHandler>(std::move(step), fd, timeout);
+    jobs_.emplace_back(new Job("job", handler, [this](Job*) {
+      absl::MutexLock lock(mutex_);
+      num_completed_jobs_++;
+    }));
+    EXPECT_TRUE(jobs_.back()->Initialize().ok());
+    return handler.get();
+  }
+
+  void WaitForCompletedJobs(int num_jobs) {
+    absl::MutexLock lock(mutex_);
+    auto done = [this, num_jobs]() { return num_completed_jobs_ == num_jobs; };
+    mutex_.Await(absl::Condition(&done));
+  }
+
+  // Makes |fd_| poll readable.
+  void SignalInput() {
+    const uint64_t kOne = 1;
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(kOne)),
+              write(fd_, &kOne, sizeof(kOne)));
+  }
+
+  // Consumes the input signaled on |fd_|, if any.
+  bool ConsumeInput() {
+    uint64_t count = 0;
+    return read(fd_, &count, sizeof(count)) == sizeof(count);
+  }
+
+  std::unique_ptr<JobPool> pool_;
+  std::vector<std::unique_ptr<Job>> jobs_;
+  int fd_ = -1;
+  absl::Mutex mutex_;
+  int num_completed_jobs_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace
+
+TEST_F(JobPoolTest, IdleWorkerStealsJobs) {
+  pool_.reset(new JobPool(2));
+  absl::Notification unblock;
+  absl::BlockingCounter quick_jobs_done(3);
+  AddJob([&unblock]() {
+    unblock.WaitForNotification();
+    return StepResult::kDone;
+  });
+  // Added to the workers in turn, so that one of them is queued behind the
+  // blocked job whichever worker runs it.
+  for (int i = 0; i < 3; ++i) {
+    AddJob([&quick_jobs_done]() {
+      quick_jobs_done.DecrementCount();
+      return StepResult::kDone;
+    });
+  }
+
+  pool_->Add(GetJobs());
+  quick_jobs_done.Wait();
+  unblock.Notify();
+  WaitForCompletedJobs(4);
+}
+
+TEST_F(JobPoolTest, CancelWakesParkedJob) {
+  pool_.reset(new JobPool(1));
+  FakeHandler* handler =
+      AddJob([]() { return StepResult::kWaitForInput; }, fd_);
+  pool_->Add(GetJobs());
+
+  // Parked until its input is ready, which never happens.
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(1, handler->num_steps());
+
+  jobs_[0]->Cancel();
+  pool_->Cancel(GetJobs());
+  WaitForCompletedJobs(1);
+  EXPECT_EQ(2, handler->num_steps());
+}
+
+TEST_F(JobPoolTest, ParkedJobRearmedForEachInput) {
+  pool_.reset(new JobPool(1));
+  absl::Mutex inputs_mutex;
+  int num_inputs = 0;
+  AddJob(
+      [this, &inputs_mutex, &num_inputs]() {
+        if (!ConsumeInput())
+          return StepResult::kWaitForInput;
+        absl::MutexLock lock(inputs_mutex);
+        return ++num_inputs == 3 ? StepResult::kDone
+                                 : StepResult::kWaitForInput;
+      },
+      fd_);
+  pool_->Add(GetJobs());
+
+  // The descriptor is polled with EPOLLONESHOT, so the job is only woken up
+  // again if it is re-armed every time it is parked.
+  for (int i = 1; i <= 3; ++i) {
+    SignalInput();
+    absl::MutexLock lock(inputs_mutex);
+    auto consumed = [&num_inputs, i]() { return num_inputs == i; };
+    inputs_mutex.Await(absl::Condition(&consumed));
+  }
+  WaitForCompletedJobs(1);
+}
+
+TEST_F(JobPoolTest, JobWithoutReadinessFdRetried) {
+  pool_.reset(new JobPool(1));
+  int num_waits = 0;
+  FakeHandler* handler = AddJob([&num_waits]() {
+    return ++num_waits <= 3 ? StepResult::kWaitForInput : StepResult::kDone;
+  });
+
+  const absl::Time start = absl::Now();
+  pool_->Add(GetJobs());
+  WaitForCompletedJobs(1);
+  // Retried after 5ms every time.
+  EXPECT_GE(absl::Now() - start, absl::Milliseconds(15));
+  EXPECT_EQ(4, handler->num_steps());
+}
+
+TEST_F(JobPoolTest, ParkedJobSteppedAfterInputTimeout) {
+  pool_.reset(new JobPool(1));
+  bool waited = false;
+  FakeHandler* handler = AddJob(
+      [&waited]() {
+        if (waited)
+          return StepResult::kDone;
+        waited = true;
+        return StepResult::kWaitForInput;
+      },
+      fd_, absl::Milliseconds(50));
+
+  const absl::Time start = absl::Now();
+  pool_->Add(GetJobs());
+  WaitForCompletedJobs(1);
+  EXPECT_GE(absl::Now() - start, absl::Milliseconds(50));
+  EXPECT_EQ(2, handler->num_steps());
+}
+
+}  // namespace media
+}  // namespace shaka
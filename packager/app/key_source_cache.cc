@@ -0,0 +1,111 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/app/key_source_cache.h>
+
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+
+#include <packager/app/packager_util.h>
+#include <packager/crypto_params.h>
+#include <packager/media/base/key_source.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// Length prefixed, so that different parameters never give the same key.
+void AppendField(const std::string& value, std::string* key) {
+  absl::StrAppend(key, value.size(), ":", value);
+}
+
+void AppendField(const std::vector<uint8_t>& value, std::string* key) {
+  AppendField(std::string(value.begin(), value.end()), key);
+}
+
+// Returns a key identifying the key source created from the parameters.
+std::string GetCacheKey(FourCC protection_scheme,
+                        const EncryptionParams& encryption_params) {
+  std::string key = absl::StrCat(
+      static_cast<uint32_t>(protection_scheme), ",",
+      static_cast<int>(encryption_params.key_provider), ",",
+      static_cast<int>(encryption_params.protection_systems), ",");
+  switch (encryption_params.key_provider) {
+    case KeyProvider::kWidevine: {
+      const WidevineEncryptionParams& widevine = encryption_params.widevine;
+      AppendField(widevine.key_server_url, &key);
+      AppendField(widevine.content_id, &key);
+      AppendField(widevine.policy, &key);
+      AppendField(widevine.group_id, &key);
+      absl::StrAppend(&key, widevine.enable_entitlement_license ? 1 : 0, ",");
+      const WidevineSigner& signer = widevine.signer;
+      AppendField(signer.signer_name, &key);
+      absl::StrAppend(&key, static_cast<int>(signer.signing_key_type), ",");
+      AppendField(signer.aes.key, &key);
+      AppendField(signer.aes.iv, &key);
+      AppendField(signer.rsa.key, &key);
+      break;
+    }
+    case KeyProvider::kRawKey: {
+      const RawKeyParams& raw_key = encryption_params.raw_key;
+      AppendField(raw_key.iv, &key);
+      AppendField(raw_key.pssh, &key);
+      for (const auto& entry : raw_key.key_map) {
+        AppendField(entry.first, &key);
+        AppendField(entry.second.key_id, &key);
+        AppendField(entry.second.key, &key);
+        AppendField(entry.second.iv, &key);
+      }
+      break;
+    }
+    case KeyProvider::kPlayReady: {
+      const PlayReadyEncryptionParams& playready = encryption_params.playready;
+      AppendField(playready.key_server_url, &key);
+      AppendField(playready.program_identifier, &key);
+      break;
+    }
+    default:
+      break;
+  }
+  return key;
+}
+
+}  // namespace
+
+std::shared_ptr<KeySource> KeySourceCache::GetEncryptionKeySource(
+    FourCC protection_scheme,
+    const EncryptionParams& encryption_params) {
+  if (encryption_params.crypto_period_duration_in_seconds > 0) {
+    return CreateEncryptionKeySource(protection_scheme, encryption_params);
+  }
+
+  const std::string cache_key =
+      GetCacheKey(protection_scheme, encryption_params);
+  absl::MutexLock lock(mutex_);
+  std::shared_ptr<KeySource> key_source = key_sources_[cache_key].lock();
+  if (key_source)
+    return key_source;
+
+  key_source = CreateEncryptionKeySource(protection_scheme, encryption_params);
+  if (key_source) {
+    key_sources_[cache_key] = key_source;
+  } else {
+    key_sources_.erase(cache_key);
+  }
+  // Forget about the key sources which are not used anymore.
+  for (auto iter = key_sources_.begin(); iter != key_sources_.end();) {
+    if (iter->second.expired()) {
+      iter = key_sources_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+  return key_source;
+}
+
+}  // namespace media
+}  // namespace shaka
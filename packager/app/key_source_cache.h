@@ -0,0 +1,58 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_APP_KEY_SOURCE_CACHE_H_
+#define PACKAGER_APP_KEY_SOURCE_CACHE_H_
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/media/base/fourccs.h>
+
+namespace shaka {
+
+struct EncryptionParams;
+
+namespace media {
+
+class KeySource;
+
+/// Shares encryption key sources between pipelines with the same key
+/// parameters, e.g. channels of a PackagerHost, so that keys are only fetched
+/// once. Key sources with key rotation are never shared, since they fetch keys
+/// as their pipeline progresses.
+class KeySourceCache {
+ public:
+  KeySourceCache() = default;
+
+  /// Same as CreateEncryptionKeySource, but returns the existing key source if
+  /// one with the same parameters is still in use. Thread safe.
+  /// @return A key source, or nullptr if it cannot be created or encryption is
+  ///         not required.
+  std::shared_ptr<KeySource> GetEncryptionKeySource(
+      FourCC protection_scheme,
+      const EncryptionParams& encryption_params);
+
+ private:
+  friend class KeySourceCacheTest;
+
+  KeySourceCache(const KeySourceCache&) = delete;
+  KeySourceCache& operator=(const KeySourceCache&) = delete;
+
+  // Creating a key source may fetch keys, which is done with |mutex_| held so
+  // that concurrent requests with the same parameters fetch keys once.
+  absl::Mutex mutex_;
+  std::map<std::string, std::weak_ptr<KeySource>> key_sources_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_APP_KEY_SOURCE_CACHE_H_
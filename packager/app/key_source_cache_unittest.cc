@@ -0,0 +1,113 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/app/key_source_cache.h>
+
+#include <gtest/gtest.h>
+
+#include <packager/crypto_params.h>
+#include <packager/media/base/key_source.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const uint8_t kKeyId[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08,
+                          0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10};
+const uint8_t kKey[] = {0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18,
+                        0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20};
+const uint8_t kOtherKey[] = {0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28,
+                             0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30};
+
+EncryptionParams GetRawKeyParams(const uint8_t* key, size_t key_size) {
+  EncryptionParams params;
+  params.key_provider = KeyProvider::kRawKey;
+  RawKeyParams::KeyInfo& key_info = params.raw_key.key_map[""];
+  key_info.key_id.assign(kKeyId, kKeyId + sizeof(kKeyId));
+  key_info.key.assign(key, key + key_size);
+  return params;
+}
+
+}  // namespace
+
+class KeySourceCacheTest : public testing::Test {
+ protected:
+  size_t NumCachedKeySources() {
+    absl::MutexLock lock(cache_.mutex_);
+    return cache_.key_sources_.size();
+  }
+
+  KeySourceCache cache_;
+};
+
+TEST_F(KeySourceCacheTest, SameParamsShareKeySource) {
+  const EncryptionParams params = GetRawKeyParams(kKey, sizeof(kKey));
+  std::shared_ptr<KeySource> key_source =
+      cache_.GetEncryptionKeySource(FOURCC_cenc, params);
+  ASSERT_TRUE(key_source);
+  EXPECT_EQ(key_source, cache_.GetEncryptionKeySource(FOURCC_cenc, params));
+  EXPECT_EQ(1u, NumCachedKeySources());
+}
+
+TEST_F(KeySourceCacheTest, DifferentKeysDoNotShareKeySource) {
+  std::shared_ptr<KeySource> key_source = cache_.GetEncryptionKeySource(
+      FOURCC_cenc, GetRawKeyParams(kKey, sizeof(kKey)));
+  std::shared_ptr<KeySource> other_key_source = cache_.GetEncryptionKeySource(
+      FOURCC_cenc, GetRawKeyParams(kOtherKey, sizeof(kOtherKey)));
+  ASSERT_TRUE(key_source);
+  ASSERT_TRUE(other_key_source);
+  EXPECT_NE(key_source, other_key_source);
+  EXPECT_EQ(2u, NumCachedKeySources());
+}
+
+TEST_F(KeySourceCacheTest, DifferentSchemesDoNotShareKeySource) {
+  const EncryptionParams params = GetRawKeyParams(kKey, sizeof(kKey));
+  std::shared_ptr<KeySource> key_source =
+      cache_.GetEncryptionKeySource(FOURCC_cenc, params);
+  std::shared_ptr<KeySource> other_key_source =
+      cache_.GetEncryptionKeySource(FOURCC_cbcs, params);
+  ASSERT_TRUE(key_source);
+  ASSERT_TRUE(other_key_source);
+  EXPECT_NE(key_source, other_key_source);
+}
+
+TEST_F(KeySourceCacheTest, KeyRotationDoesNotShareKeySource) {
+  EncryptionParams params = GetRawKeyParams(kKey, sizeof(kKey));
+  params.crypto_period_duration_in_seconds = 10;
+  std::shared_ptr<KeySource> key_source =
+      cache_.GetEncryptionKeySource(FOURCC_cenc, params);
+  std::shared_ptr<KeySource> other_key_source =
+      cache_.GetEncryptionKeySource(FOURCC_cenc, params);
+  ASSERT_TRUE(key_source);
+  ASSERT_TRUE(other_key_source);
+  EXPECT_NE(key_source, other_key_source);
+  EXPECT_EQ(0u, NumCachedKeySources());
+}
+
+TEST_F(KeySourceCacheTest, UnusedKeySourcesPruned) {
+  std::shared_ptr<KeySource> key_source = cache_.GetEncryptionKeySource(
+      FOURCC_cenc, GetRawKeyParams(kKey, sizeof(kKey)));
+  ASSERT_TRUE(key_source);
+  std::weak_ptr<KeySource> finished_key_source = key_source;
+  // The channel using it finishes.
+  key_source.reset();
+  EXPECT_TRUE(finished_key_source.expired());
+
+  std::shared_ptr<KeySource> other_key_source = cache_.GetEncryptionKeySource(
+      FOURCC_cenc, GetRawKeyParams(kOtherKey, sizeof(kOtherKey)));
+  ASSERT_TRUE(other_key_source);
+  EXPECT_EQ(1u, NumCachedKeySources());
+}
+
+TEST_F(KeySourceCacheTest, FailedKeySourceNotCached) {
+  // Keys must be 16 bytes.
+  EXPECT_FALSE(
+      cache_.GetEncryptionKeySource(FOURCC_cenc, GetRawKeyParams(kKey, 8)));
+  EXPECT_EQ(0u, NumCachedKeySources());
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -58,6 +58,49 @@ ABSL_FLAG(bool,
           single_threaded,
           false,
           "If enabled, only use one thread when generating content.");
+ABSL_FLAG(uint64_t,
+          output_queue_size,
+          0,
+          "If non-zero, every output runs on a thread of its own, fed through "
+          "a queue of at most this many stream data items, i.e. media "
+          "samples, stream info, segment info and cue events, so that outputs "
+          "from the same input are muxed and written in parallel. Ignored "
+          "with --single_threaded.");
+ABSL_FLAG(uint64_t,
+          job_pool_size,
+          0,
+          "If non-zero, inputs are processed by a pool of this many threads "
+          "instead of a thread per input, e.g. to package many live channels "
+          "on one machine. Ignored with --single_threaded or ad cues.");
+ABSL_FLAG(std::string,
+          stats_output,
+          "",
+          "If set, statistics of every stage of the pipeline, e.g. processing "
+          "time histograms and sample counts, are written to this file every "
+          "--stats_interval seconds and once packaging completes.");
+ABSL_FLAG(double,
+          stats_interval,
+          10,
+          "Interval between writes of --stats_output, in seconds. If zero, "
+          "the statistics are only written once packaging completes.");
+ABSL_FLAG(std::string,
+          stats_format,
+          "json",
+          "Format of --stats_output: 'json' or 'prometheus' (text exposition "
+          "format).");
+ABSL_FLAG(uint64_t,
+          max_memory_mb,
+          0,
+          "If non-zero, limit of the memory buffered by the pipeline, e.g. in "
+          "queues, muxers and I/O caches, in MiB. Once it is reached, inputs "
+          "are handled as set by --memory_overflow_action.");
+ABSL_FLAG(std::string,
+          memory_overflow_action,
+          "block",
+          "What to do once --max_memory_mb is reached: 'block' pauses reading "
+          "the inputs until memory is released, 'drop' drops input samples "
+          "until memory is released and resumes at the next key frame, e.g. "
+          "to keep up with live inputs.");
 
 // From absl/log:
 ABSL_DECLARE_FLAG(int, stderrthreshold);
@@ -375,6 +418,36 @@ std::optional<PackagingParams> GetPackagingParams() {
 
   packaging_params.temp_dir = absl::GetFlag(FLAGS_temp_dir);
   packaging_params.single_threaded = absl::GetFlag(FLAGS_single_threaded);
+  packaging_params.output_queue_size = absl::GetFlag(FLAGS_output_queue_size);
+  packaging_params.job_pool_size = absl::GetFlag(FLAGS_job_pool_size);
+
+  StatsParams& stats_params = packaging_params.stats_params;
+  stats_params.stats_output = absl::GetFlag(FLAGS_stats_output);
+  stats_params.dump_interval_in_seconds = absl::GetFlag(FLAGS_stats_interval);
+  const std::string stats_format = absl::GetFlag(FLAGS_stats_format);
+  if (stats_format == "json") {
+    stats_params.format = StatsParams::Format::kJson;
+  } else if (stats_format == "prometheus") {
+    stats_params.format = StatsParams::Format::kPrometheus;
+  } else {
+    LOG(ERROR) << "Unrecognized stats_format " << stats_format;
+    return std::nullopt;
+  }
+
+  MemoryParams& memory_params = packaging_params.memory_params;
+  memory_params.max_memory_bytes =
+      absl::GetFlag(FLAGS_max_memory_mb) * 1024 * 1024;
+  const std::string memory_overflow_action =
+      absl::GetFlag(FLAGS_memory_overflow_action);
+  if (memory_overflow_action == "block") {
+    memory_params.overflow_action = MemoryParams::OverflowAction::kBlock;
+  } else if (memory_overflow_action == "drop") {
+    memory_params.overflow_action = MemoryParams::OverflowAction::kDrop;
+  } else {
+    LOG(ERROR) << "Unrecognized memory_overflow_action "
+               << memory_overflow_action;
+    return std::nullopt;
+  }
 
   AdCueGeneratorParams& ad_cue_generator_params =
       packaging_params.ad_cue_generator_params;
@@ -0,0 +1,60 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/app/stats_dumper.h>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/time/time.h>
+
+#include <packager/file.h>
+#include <packager/media/base/handler_metrics.h>
+
+namespace shaka {
+namespace media {
+
+StatsDumper::StatsDumper(const StatsParams& params,
+                         const PipelineMetrics* metrics)
+    : params_(params), metrics_(metrics) {
+  DCHECK(metrics_);
+  DCHECK(!params_.stats_output.empty());
+  if (params_.dump_interval_in_seconds > 0)
+    thread_.reset(new std::thread(&StatsDumper::ThreadMain, this));
+}
+
+StatsDumper::~StatsDumper() {
+  Stop();
+}
+
+void StatsDumper::Stop() {
+  if (stopped_)
+    return;
+  stopped_ = true;
+  stop_.Notify();
+  if (thread_)
+    thread_->join();
+  Dump();
+}
+
+void StatsDumper::ThreadMain() {
+  const absl::Duration interval =
+      absl::Seconds(params_.dump_interval_in_seconds);
+  while (!stop_.WaitForNotificationWithTimeout(interval))
+    Dump();
+}
+
+void StatsDumper::Dump() {
+  const PackagerStats stats = metrics_->GetStats();
+  const std::string contents =
+      params_.format == StatsParams::Format::kPrometheus
+          ? PipelineMetrics::ToPrometheusText(stats)
+          : PipelineMetrics::ToJson(stats);
+  if (!File::WriteFileAtomically(params_.stats_output.c_str(), contents))
+    LOG(WARNING) << "Failed to write stats to " << params_.stats_output;
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,51 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_APP_STATS_DUMPER_H_
+#define PACKAGER_APP_STATS_DUMPER_H_
+
+#include <memory>
+#include <thread>
+
+#include <absl/synchronization/notification.h>
+
+#include <packager/packager_stats.h>
+
+namespace shaka {
+namespace media {
+
+class PipelineMetrics;
+
+/// Writes the statistics of a pipeline to a file periodically, on a thread of
+/// its own, see StatsParams.
+class StatsDumper {
+ public:
+  /// @param metrics must outlive the dumper.
+  StatsDumper(const StatsParams& params, const PipelineMetrics* metrics);
+  ~StatsDumper();
+
+  /// Stop dumping periodically and write the final statistics. Does nothing
+  /// after the first call.
+  void Stop();
+
+ private:
+  StatsDumper(const StatsDumper&) = delete;
+  StatsDumper& operator=(const StatsDumper&) = delete;
+
+  void ThreadMain();
+  void Dump();
+
+  const StatsParams params_;
+  const PipelineMetrics* const metrics_;
+  absl::Notification stop_;
+  std::unique_ptr<std::thread> thread_;
+  bool stopped_ = false;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_APP_STATS_DUMPER_H_
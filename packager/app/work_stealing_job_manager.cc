@@ -0,0 +1,90 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/app/work_stealing_job_manager.h>
+
+#include <absl/log/check.h>
+#include <absl/synchronization/notification.h>
+
+#include <packager/media/chunking/sync_point_queue.h>
+
+namespace shaka {
+namespace media {
+
+WorkStealingJobManager::WorkStealingJobManager(
+    std::unique_ptr<SyncPointQueue> sync_points,
+    std::shared_ptr<JobPool> job_pool)
+    : JobManager(std::move(sync_points)), job_pool_(std::move(job_pool)) {
+  DCHECK(job_pool_);
+}
+
+WorkStealingJobManager::~WorkStealingJobManager() {
+  if (started_)
+    job_pool_->Release(GetJobs());
+}
+
+Status WorkStealingJobManager::RunJobs() {
+  absl::Notification done;
+  Status status;
+  StartJobs([&done, &status](const Status& jobs_status) {
+    status = jobs_status;
+    done.Notify();
+  });
+  done.WaitForNotification();
+  return status;
+}
+
+void WorkStealingJobManager::StartJobs(OnJobsCompleteFunction on_complete) {
+  DCHECK(!started_);
+  started_ = true;
+  if (jobs_.empty()) {
+    on_complete(Status::OK);
+    return;
+  }
+  on_complete_ = std::move(on_complete);
+  job_pool_->Add(GetJobs());
+}
+
+void WorkStealingJobManager::CancelJobs() {
+  JobManager::CancelJobs();
+  job_pool_->Cancel(GetJobs());
+}
+
+void WorkStealingJobManager::OnJobComplete(Job* job) {
+  bool cancel = false;
+  bool all_complete = false;
+  Status status;
+  {
+    absl::MutexLock lock(mutex_);
+    complete_[job] = true;
+    any_job_complete_.Signal();
+
+    status_.Update(job->status());
+    if (!status_.ok() && !cancelled_) {
+      // If a job failed and there are still jobs running, they have to be
+      // cancelled.
+      cancelled_ = true;
+      cancel = true;
+    }
+    all_complete = ++num_complete_jobs_ == jobs_.size();
+    status = status_;
+  }
+
+  if (cancel)
+    CancelJobs();
+  if (all_complete)
+    on_complete_(status);
+}
+
+std::vector<Job*> WorkStealingJobManager::GetJobs() const {
+  std::vector<Job*> jobs;
+  for (const auto& job : jobs_)
+    jobs.push_back(job.get());
+  return jobs;
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,66 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_APP_WORK_STEALING_JOB_MANAGER_H_
+#define PACKAGER_APP_WORK_STEALING_JOB_MANAGER_H_
+
+#include <functional>
+#include <memory>
+
+#include <packager/app/job_manager.h>
+#include <packager/app/job_pool.h>
+
+namespace shaka {
+namespace media {
+
+// Runs jobs on a JobPool instead of a thread per job. The pool may be shared
+// with other job managers. See JobPool for the restrictions on jobs.
+class WorkStealingJobManager : public JobManager {
+ public:
+  typedef std::function<void(const Status&)> OnJobsCompleteFunction;
+
+  // @param sync_points is an optional SyncPointQueue used to synchronize and
+  //        align cue points. JobManager cancels @a sync_points when any job
+  //        fails or is cancelled. It can be NULL.
+  // @param job_pool is the pool to run the jobs on.
+  WorkStealingJobManager(std::unique_ptr<SyncPointQueue> sync_points,
+                         std::shared_ptr<JobPool> job_pool);
+  // Jobs must have completed if they were started.
+  ~WorkStealingJobManager() override;
+
+  // Run all registered jobs on the pool. Blocks until all jobs exit.
+  Status RunJobs() override;
+
+  // Run all registered jobs on the pool without blocking. Once all jobs exit,
+  // @a on_complete is called from a pool thread with the status RunJobs()
+  // would return. The first job to fail cancels the others. Use either
+  // StartJobs() or RunJobs(), only once.
+  void StartJobs(OnJobsCompleteFunction on_complete);
+
+  // Also wakes up jobs waiting for input, so that they can exit.
+  void CancelJobs() override;
+
+ protected:
+  void OnJobComplete(Job* job) override;
+
+ private:
+  WorkStealingJobManager(const WorkStealingJobManager&) = delete;
+  WorkStealingJobManager& operator=(const WorkStealingJobManager&) = delete;
+
+  std::vector<Job*> GetJobs() const;
+
+  std::shared_ptr<JobPool> job_pool_;
+  bool started_ = false;
+  OnJobsCompleteFunction on_complete_;
+  size_t num_complete_jobs_ ABSL_GUARDED_BY(mutex_) = 0;
+  Status status_ ABSL_GUARDED_BY(mutex_);
+  bool cancelled_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_APP_WORK_STEALING_JOB_MANAGER_H_
@@ -0,0 +1,228 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <packager/media/base/buffer_writer.h>
+#include <packager/media/codecs/h264_parser.h>
+#include <packager/media/codecs/h265_parser.h>
+#include <packager/media/codecs/h26x_byte_scanner.h>
+#include <packager/media/codecs/nal_unit_to_byte_stream_converter.h>
+#include <packager/media/codecs/nalu_reader.h>
+#include <packager/media/test/test_data_util.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+// 759 NAL units of H.264 Annex B byte stream.
+const char kH264File[] = "test-25fps.h264";
+// A VPS, SPS, PPS, SEI and six slices of H.265 Annex B byte stream.
+const char kH265File[] = "hevc-byte-stream-frame.h265";
+
+// Splits an Annex B byte stream into NAL units. The NAL units point into
+// |stream|, which must outlive them.
+std::vector<Nalu> ReadNalus(Nalu::CodecType type,
+                            const std::vector<uint8_t>& stream) {
+  std::vector<Nalu> nalus;
+  NaluReader reader(type, kIsAnnexbByteStream, stream.data(), stream.size());
+  Nalu nalu;
+  while (reader.Advance(&nalu) == NaluReader::kOk)
+    nalus.push_back(nalu);
+  return nalus;
+}
+
+// Returns |size| bytes of random data, like entropy coded slice data, which has
+// a 00 00 sequence every 64 KiB on average.
+std::vector<uint8_t> GetSliceData(size_t size) {
+  std::mt19937 generator;
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<uint8_t> data(size);
+  for (uint8_t& byte : data)
+    byte = static_cast<uint8_t>(distribution(generator));
+  return data;
+}
+
+// Searches state.range(0) bytes of slice data for the sequences which have to
+// be escaped, with |find| being the SIMD or scalar implementation.
+void BM_FindZeroZeroSequence(benchmark::State& state,
+                             uint64_t (*find)(const uint8_t*,
+                                              uint64_t,
+                                              uint8_t)) {
+  const std::vector<uint8_t> data = GetSliceData(state.range(0));
+  const uint8_t kMaxThirdByte = 0x03;
+  for (auto _ : state) {
+    for (uint64_t pos = 0; pos < data.size(); pos += 3) {
+      pos += find(data.data() + pos, data.size() - pos, kMaxThirdByte);
+      benchmark::DoNotOptimize(pos);
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK_CAPTURE(BM_FindZeroZeroSequence, Simd, FindZeroZeroSequence)
+    ->Arg(64 << 10)
+    ->Arg(1 << 20);
+BENCHMARK_CAPTURE(BM_FindZeroZeroSequence, Scalar, FindZeroZeroSequenceScalar)
+    ->Arg(64 << 10)
+    ->Arg(1 << 20);
+
+// Escapes state.range(0) bytes of slice data, as when writing MPEG-2 TS.
+void BM_EscapeNalByteSequence(benchmark::State& state) {
+  const std::vector<uint8_t> data = GetSliceData(state.range(0));
+  BufferWriter writer(data.size() + data.size() / 64);
+  for (auto _ : state) {
+    writer.Clear();
+    EscapeNalByteSequence(data.data(), data.size(), &writer);
+    benchmark::DoNotOptimize(writer.Buffer());
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_EscapeNalByteSequence)->Arg(64 << 10)->Arg(1 << 20);
+
+void BM_NaluReaderAnnexB(benchmark::State& state,
+                         Nalu::CodecType type,
+                         const char* file_name) {
+  const std::vector<uint8_t> stream = ReadTestDataFile(file_name);
+  if (stream.empty()) {
+    state.SkipWithError("Cannot read test data.");
+    return;
+  }
+
+  int64_t num_nalus = 0;
+  for (auto _ : state) {
+    NaluReader reader(type, kIsAnnexbByteStream, stream.data(), stream.size());
+    Nalu nalu;
+    while (reader.Advance(&nalu) == NaluReader::kOk) {
+      benchmark::DoNotOptimize(nalu);
+      ++num_nalus;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * stream.size());
+  state.SetItemsProcessed(num_nalus);
+}
+BENCHMARK_CAPTURE(BM_NaluReaderAnnexB, H264, Nalu::kH264, kH264File);
+BENCHMARK_CAPTURE(BM_NaluReaderAnnexB, H265, Nalu::kH265, kH265File);
+
+// Parses the slice headers of the stream, with |parse| being the full or the
+// partial parsing, which the MPEG-2 TS demuxer uses to find access units.
+void BM_H264ParserSliceHeader(benchmark::State& state,
+                              H264Parser::Result (H264Parser::*parse)(
+                                  const Nalu&,
+                                  H264SliceHeader*)) {
+  const std::vector<uint8_t> stream = ReadTestDataFile(kH264File);
+  if (stream.empty()) {
+    state.SkipWithError("Cannot read test data.");
+    return;
+  }
+
+  // Parameter sets are parsed once, as a demuxer would.
+  H264Parser parser;
+  std::vector<Nalu> slices;
+  for (const Nalu& nalu : ReadNalus(Nalu::kH264, stream)) {
+    int id;
+    if (nalu.type() == Nalu::H264_SPS) {
+      parser.ParseSps(nalu, &id);
+    } else if (nalu.type() == Nalu::H264_PPS) {
+      parser.ParsePps(nalu, &id);
+    } else if (nalu.is_video_slice()) {
+      slices.push_back(nalu);
+    }
+  }
+
+  for (auto _ : state) {
+    for (const Nalu& nalu : slices) {
+      H264SliceHeader slice_header;
+      if ((parser.*parse)(nalu, &slice_header) != H264Parser::kOk) {
+        state.SkipWithError("Cannot parse slice header.");
+        return;
+      }
+      benchmark::DoNotOptimize(slice_header);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * slices.size());
+}
+BENCHMARK_CAPTURE(BM_H264ParserSliceHeader,
+                  Full,
+                  &H264Parser::ParseSliceHeader);
+BENCHMARK_CAPTURE(BM_H264ParserSliceHeader,
+                  Partial,
+                  &H264Parser::ParsePartialSliceHeader);
+
+// Parses the SPSes and PPSes of the stream, which repeats them before every
+// IDR picture, again and again, as a demuxer does.
+void BM_H264ParserParameterSets(benchmark::State& state) {
+  const std::vector<uint8_t> stream = ReadTestDataFile(kH264File);
+  if (stream.empty()) {
+    state.SkipWithError("Cannot read test data.");
+    return;
+  }
+
+  std::vector<Nalu> parameter_sets;
+  for (const Nalu& nalu : ReadNalus(Nalu::kH264, stream)) {
+    if (nalu.type() == Nalu::H264_SPS || nalu.type() == Nalu::H264_PPS)
+      parameter_sets.push_back(nalu);
+  }
+
+  H264Parser parser;
+  for (auto _ : state) {
+    for (const Nalu& nalu : parameter_sets) {
+      int id;
+      const H264Parser::Result result = nalu.type() == Nalu::H264_SPS
+                                            ? parser.ParseSps(nalu, &id)
+                                            : parser.ParsePps(nalu, &id);
+      if (result != H264Parser::kOk) {
+        state.SkipWithError("Cannot parse parameter set.");
+        return;
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * parameter_sets.size());
+}
+BENCHMARK(BM_H264ParserParameterSets);
+
+void BM_H265ParserSliceHeader(benchmark::State& state) {
+  const std::vector<uint8_t> stream = ReadTestDataFile(kH265File);
+  if (stream.empty()) {
+    state.SkipWithError("Cannot read test data.");
+    return;
+  }
+
+  H265Parser parser;
+  std::vector<Nalu> slices;
+  for (const Nalu& nalu : ReadNalus(Nalu::kH265, stream)) {
+    int id;
+    if (nalu.type() == Nalu::H265_VPS) {
+      parser.ParseVps(nalu, &id);
+    } else if (nalu.type() == Nalu::H265_SPS) {
+      parser.ParseSps(nalu, &id);
+    } else if (nalu.type() == Nalu::H265_PPS) {
+      parser.ParsePps(nalu, &id);
+    } else if (nalu.is_video_slice()) {
+      slices.push_back(nalu);
+    }
+  }
+
+  for (auto _ : state) {
+    for (const Nalu& nalu : slices) {
+      H265SliceHeader slice_header;
+      if (parser.ParseSliceHeader(nalu, &slice_header) != H265Parser::kOk) {
+        state.SkipWithError("Cannot parse slice header.");
+        return;
+      }
+      benchmark::DoNotOptimize(slice_header);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * slices.size());
+}
+BENCHMARK(BM_H265ParserSliceHeader);
+
+}  // namespace
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,76 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <packager/media/base/aes_encryptor.h>
+#include <packager/media/base/aes_pattern_cryptor.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const std::vector<uint8_t> kKey(16, 0x01);
+const std::vector<uint8_t> kIv(16, 0x02);
+
+// Encrypts a sample of state.range(0) bytes per iteration, in place as the
+// EncryptionHandler does for samples it owns.
+void RunCryptor(benchmark::State& state, AesCryptor* cryptor) {
+  if (!cryptor->InitializeWithIv(kKey, kIv)) {
+    state.SkipWithError("Cannot initialize cryptor.");
+    return;
+  }
+  std::vector<uint8_t> sample(state.range(0), 0xAB);
+  for (auto _ : state) {
+    if (!cryptor->Crypt(sample.data(), sample.size(), sample.data())) {
+      state.SkipWithError("Cannot encrypt sample.");
+      return;
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * sample.size());
+}
+
+void BM_AesCtrEncryptor(benchmark::State& state) {
+  AesCtrEncryptor encryptor;
+  RunCryptor(state, &encryptor);
+}
+// Audio frame, video frame and large video key frame sizes.
+BENCHMARK(BM_AesCtrEncryptor)->Arg(1 << 10)->Arg(64 << 10)->Arg(1 << 20);
+
+// 'cbcs' with the 1:9 pattern used for video.
+void BM_AesPatternCryptorCbcs(benchmark::State& state) {
+  const uint8_t kCryptByteBlock = 1;
+  const uint8_t kSkipByteBlock = 9;
+  AesPatternCryptor cryptor(
+      kCryptByteBlock, kSkipByteBlock,
+      AesPatternCryptor::kEncryptIfCryptByteBlockRemaining,
+      AesCryptor::kUseConstantIv,
+      std::unique_ptr<AesCryptor>(new AesCbcEncryptor(kNoPadding)));
+  RunCryptor(state, &cryptor);
+}
+BENCHMARK(BM_AesPatternCryptorCbcs)->Arg(1 << 10)->Arg(64 << 10)->Arg(1 << 20);
+
+// 'cens' with the 1:9 pattern used for video.
+void BM_AesPatternCryptorCens(benchmark::State& state) {
+  const uint8_t kCryptByteBlock = 1;
+  const uint8_t kSkipByteBlock = 9;
+  AesPatternCryptor cryptor(
+      kCryptByteBlock, kSkipByteBlock,
+      AesPatternCryptor::kEncryptIfCryptByteBlockRemaining,
+      AesCryptor::kDontUseConstantIv,
+      std::unique_ptr<AesCryptor>(new AesCtrEncryptor));
+  RunCryptor(state, &cryptor);
+}
+BENCHMARK(BM_AesPatternCryptorCens)->Arg(1 << 10)->Arg(64 << 10)->Arg(1 << 20);
+
+}  // namespace
+}  // namespace media
+}  // namespace shaka
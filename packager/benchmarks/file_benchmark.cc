@@ -0,0 +1,54 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <packager/file/io_cache.h>
+
+namespace shaka {
+namespace {
+
+// The defaults of --io_cache_size and --io_block_size.
+const uint64_t kCacheSize = 32ULL << 20;
+const uint64_t kBlockSize = 1ULL << 16;
+const uint64_t kBytesPerIteration = 64ULL << 20;
+
+// Streams kBytesPerIteration bytes through an IoCache, from a producer thread
+// writing blocks of state.range(0) bytes to a consumer reading blocks of
+// kBlockSize bytes, as ThreadedIoFile does when writing.
+void BM_IoCacheThroughput(benchmark::State& state) {
+  const std::vector<uint8_t> write_buffer(state.range(0), 0xAB);
+  std::vector<uint8_t> read_buffer(kBlockSize);
+
+  IoCache cache(kCacheSize);
+  for (auto _ : state) {
+    std::thread producer([&cache, &write_buffer]() {
+      for (uint64_t bytes_written = 0; bytes_written < kBytesPerIteration;
+           bytes_written += write_buffer.size()) {
+        cache.Write(write_buffer.data(), write_buffer.size());
+      }
+      cache.Close();
+    });
+    while (cache.Read(read_buffer.data(), read_buffer.size()) > 0) {
+    }
+    producer.join();
+    cache.Reopen();
+  }
+  state.SetBytesProcessed(state.iterations() * kBytesPerIteration);
+}
+// Small writes, e.g. of TS packets, and block sized writes.
+BENCHMARK(BM_IoCacheThroughput)
+    ->Arg(188)
+    ->Arg(4 << 10)
+    ->Arg(kBlockSize)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace shaka
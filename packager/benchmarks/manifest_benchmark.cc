@@ -0,0 +1,123 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <cstdint>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+#include <packager/file/memory_file.h>
+#include <packager/hls/base/media_playlist.h>
+#include <packager/hls_params.h>
+#include <packager/mpd/base/adaptation_set.h>
+#include <packager/mpd/base/media_info.pb.h>
+#include <packager/mpd/base/mpd_builder.h>
+#include <packager/mpd/base/mpd_options.h>
+#include <packager/mpd/base/period.h>
+#include <packager/mpd/base/representation.h>
+
+namespace shaka {
+namespace {
+
+const uint32_t kTimeScale = 90000;
+const int64_t kSegmentDuration = 2 * kTimeScale;
+const uint64_t kSegmentSize = 500000;
+
+MediaInfo CreateVideoMediaInfo() {
+  MediaInfo media_info;
+  MediaInfo::VideoInfo* video_info = media_info.mutable_video_info();
+  video_info->set_codec("avc1.64001e");
+  video_info->set_time_scale(kTimeScale);
+  video_info->set_frame_duration(3600);
+  video_info->set_width(1280);
+  video_info->set_height(720);
+  video_info->set_pixel_width(1);
+  video_info->set_pixel_height(1);
+  media_info.set_reference_time_scale(kTimeScale);
+  media_info.set_container_type(MediaInfo::CONTAINER_MP4);
+  media_info.set_bandwidth(2000000);
+  media_info.set_init_segment_url("init.mp4");
+  media_info.set_segment_template_url("$Number$.m4s");
+  media_info.set_segment_template("$Number$.m4s");
+  return media_info;
+}
+
+// Segment durations alternate by one frame, so that every segment gets its own
+// entry instead of all of them being collapsed into a single repeated one.
+int64_t GetSegmentDuration(int64_t segment_index) {
+  return kSegmentDuration + (segment_index % 2) * 3600;
+}
+
+// Writes a VOD media playlist of state.range(0) segments.
+void BM_MediaPlaylistWriteToFile(benchmark::State& state) {
+  const char kPlaylistPath[] = "memory://benchmark/playlist.m3u8";
+  const int64_t num_segments = state.range(0);
+
+  HlsParams hls_params;
+  hls::MediaPlaylist playlist(hls_params, "playlist.m3u8", "name", "group");
+  if (!playlist.SetMediaInfo(CreateVideoMediaInfo())) {
+    state.SkipWithError("Cannot set MediaInfo.");
+    return;
+  }
+  int64_t start_time = 0;
+  for (int64_t i = 0; i < num_segments; ++i) {
+    const int64_t duration = GetSegmentDuration(i);
+    playlist.AddSegment(std::to_string(i + 1) + ".m4s", start_time, duration,
+                        0, kSegmentSize);
+    start_time += duration;
+  }
+
+  for (auto _ : state) {
+    if (!playlist.WriteToFile(kPlaylistPath, false, true)) {
+      state.SkipWithError("Cannot write playlist.");
+      break;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * num_segments);
+  MemoryFile::DeleteAll();
+}
+BENCHMARK(BM_MediaPlaylistWriteToFile)->Arg(30)->Arg(300)->Arg(3000);
+
+// Generates a live profile MPD with a SegmentTimeline of state.range(0)
+// segments.
+void BM_MpdBuilderToString(benchmark::State& state) {
+  const int64_t num_segments = state.range(0);
+
+  MpdOptions mpd_options;
+  mpd_options.dash_profile = DashProfile::kLive;
+  MpdBuilder mpd_builder(mpd_options);
+  const MediaInfo media_info = CreateVideoMediaInfo();
+  const bool kContentProtectionInAdaptationSet = true;
+  Representation* representation =
+      mpd_builder.GetOrCreatePeriod(0)
+          ->GetOrCreateAdaptationSet(media_info,
+                                     kContentProtectionInAdaptationSet)
+          ->AddRepresentation(media_info);
+  if (!representation) {
+    state.SkipWithError("Cannot add Representation.");
+    return;
+  }
+  int64_t start_time = 0;
+  for (int64_t i = 0; i < num_segments; ++i) {
+    const int64_t duration = GetSegmentDuration(i);
+    representation->AddNewSegment(start_time, duration, kSegmentSize, i + 1);
+    start_time += duration;
+  }
+
+  for (auto _ : state) {
+    std::string mpd;
+    if (!mpd_builder.ToString(&mpd)) {
+      state.SkipWithError("Cannot generate MPD.");
+      break;
+    }
+    benchmark::DoNotOptimize(mpd);
+  }
+  state.SetItemsProcessed(state.iterations() * num_segments);
+}
+BENCHMARK(BM_MpdBuilderToString)->Arg(30)->Arg(300)->Arg(3000);
+
+}  // namespace
+}  // namespace shaka
@@ -0,0 +1,108 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <packager/media/base/buffer_writer.h>
+#include <packager/media/base/media_sample.h>
+#include <packager/media/base/stream_info.h>
+#include <packager/media/base/text_sample.h>
+#include <packager/media/formats/mp2t/mp2t_media_parser.h>
+#include <packager/media/formats/mp2t/pes_packet.h>
+#include <packager/media/formats/mp2t/program_map_table_writer.h>
+#include <packager/media/formats/mp2t/ts_writer.h>
+#include <packager/media/test/test_data_util.h>
+
+namespace shaka {
+namespace media {
+namespace mp2t {
+namespace {
+
+// Parses bear-640x360.ts, an H.264 and AAC transport stream, fed in reads of
+// state.range(0) bytes.
+void BM_Mp2tMediaParserParse(benchmark::State& state) {
+  const std::vector<uint8_t> buffer = ReadTestDataFile("bear-640x360.ts");
+  if (buffer.empty()) {
+    state.SkipWithError("Cannot read test data.");
+    return;
+  }
+  const size_t read_size = state.range(0);
+
+  int64_t num_samples = 0;
+  for (auto _ : state) {
+    Mp2tMediaParser parser;
+    parser.Init(
+        [](const std::vector<std::shared_ptr<StreamInfo>>&) {},
+        [&num_samples](uint32_t, std::shared_ptr<MediaSample>) {
+          ++num_samples;
+          return true;
+        },
+        [](uint32_t, std::shared_ptr<TextSample>) { return true; }, nullptr);
+    for (size_t offset = 0; offset < buffer.size(); offset += read_size) {
+      const size_t size = std::min(read_size, buffer.size() - offset);
+      if (!parser.Parse(buffer.data() + offset, static_cast<int>(size))) {
+        state.SkipWithError("Cannot parse test data.");
+        return;
+      }
+    }
+    if (!parser.Flush()) {
+      state.SkipWithError("Cannot flush parser.");
+      return;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+  state.SetItemsProcessed(num_samples);
+}
+// A single TS packet, a UDP datagram of 7 TS packets, and a Demuxer read.
+BENCHMARK(BM_Mp2tMediaParserParse)->Arg(188)->Arg(1316)->Arg(2 << 20);
+
+// Writes a segment of 50 PES packets of state.range(0) bytes, i.e. two seconds
+// of 25 fps video.
+void BM_TsWriterAddPesPacket(benchmark::State& state) {
+  const int kNumPesPackets = 50;
+  const int64_t kFrameDuration = 3600;
+  const std::vector<uint8_t> payload(state.range(0), 0xAB);
+
+  TsWriter ts_writer(std::unique_ptr<ProgramMapTableWriter>(
+      new VideoProgramMapTableWriter(kCodecH264)));
+  BufferWriter buffer;
+  int64_t timestamp = 0;
+  for (auto _ : state) {
+    buffer.Clear();
+    if (!ts_writer.NewSegment(&buffer)) {
+      state.SkipWithError("Cannot start segment.");
+      return;
+    }
+    for (int i = 0; i < kNumPesPackets; ++i) {
+      std::unique_ptr<PesPacket> pes(new PesPacket());
+      pes->set_stream_id(0xE0);
+      pes->set_pts(timestamp);
+      pes->set_dts(timestamp);
+      pes->set_is_key_frame(i == 0);
+      *pes->mutable_data() = payload;
+      if (!ts_writer.AddPesPacket(std::move(pes), &buffer)) {
+        state.SkipWithError("Cannot add PES packet.");
+        return;
+      }
+      timestamp += kFrameDuration;
+    }
+    benchmark::DoNotOptimize(buffer.Buffer());
+  }
+  state.SetBytesProcessed(state.iterations() * kNumPesPackets *
+                          payload.size());
+  state.SetItemsProcessed(state.iterations() * kNumPesPackets);
+}
+BENCHMARK(BM_TsWriterAddPesPacket)->Arg(1 << 10)->Arg(16 << 10)->Arg(128 << 10);
+
+}  // namespace
+}  // namespace mp2t
+}  // namespace media
+}  // namespace shaka
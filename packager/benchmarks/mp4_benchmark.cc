@@ -0,0 +1,118 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include <packager/file/memory_file.h>
+#include <packager/media/base/media_handler.h>
+#include <packager/media/base/media_sample.h>
+#include <packager/media/base/muxer_options.h>
+#include <packager/media/base/video_stream_info.h>
+#include <packager/media/formats/mp4/box_definitions.h>
+#include <packager/media/formats/mp4/multi_segment_segmenter.h>
+
+namespace shaka {
+namespace media {
+namespace mp4 {
+namespace {
+
+const int32_t kTimeScale = 90000;
+// Two seconds of 25 fps video per segment.
+const int kSamplesPerSegment = 50;
+const int64_t kSampleDuration = 3600;
+const uint8_t kCodecConfig[] = {0x01, 0x64, 0x00, 0x1E, 0xFF, 0xE0, 0x00};
+
+std::shared_ptr<const StreamInfo> CreateVideoStreamInfo() {
+  const int kTrackId = 1;
+  const int64_t kDuration = 0;
+  const uint32_t kWidth = 1280;
+  const uint32_t kHeight = 720;
+  const uint32_t kPixelWidth = 1;
+  const uint32_t kPixelHeight = 1;
+  const uint8_t kColorPrimaries = 0;
+  const uint8_t kMatrixCoefficients = 0;
+  const uint8_t kTransferCharacteristics = 0;
+  const uint32_t kTrickPlayFactor = 0;
+  const uint8_t kNaluLengthSize = 4;
+  const bool kEncrypted = true;
+  return std::make_shared<VideoStreamInfo>(
+      kTrackId, kTimeScale, kDuration, kCodecH264,
+      H26xStreamFormat::kNalUnitStreamWithoutParameterSetNalus, "avc1.64001e",
+      kCodecConfig, sizeof(kCodecConfig), kWidth, kHeight, kPixelWidth,
+      kPixelHeight, kColorPrimaries, kMatrixCoefficients,
+      kTransferCharacteristics, kTrickPlayFactor, kNaluLengthSize, "und",
+      !kEncrypted);
+}
+
+// Fragments and writes segments of kSamplesPerSegment video samples of
+// state.range(0) bytes, the first of which is a key frame, as a live DASH or
+// HLS output does. Segments are written to a memory file, which leaves out
+// the cost of the file system but keeps the one of writing a File.
+void BM_MultiSegmentSegmenter(benchmark::State& state) {
+  MuxerOptions options;
+  options.output_file_name = "memory://benchmark/init.mp4";
+  options.segment_template = "memory://benchmark/segment.m4s";
+
+  std::unique_ptr<Movie> moov(new Movie());
+  moov->tracks.resize(1);
+  moov->tracks[0].media.header.timescale = kTimeScale;
+  moov->extends.tracks.resize(1);
+  MultiSegmentSegmenter segmenter(
+      options, std::unique_ptr<FileType>(new FileType()), std::move(moov));
+  Status status =
+      segmenter.Initialize({CreateVideoStreamInfo()}, nullptr, nullptr);
+  if (!status.ok()) {
+    state.SkipWithError(status.ToString().c_str());
+    return;
+  }
+
+  // The samples are created once, so that their allocation is left out.
+  const std::vector<uint8_t> data(state.range(0), 0xAB);
+  std::vector<std::shared_ptr<MediaSample>> samples;
+  for (int i = 0; i < kSamplesPerSegment; ++i)
+    samples.push_back(MediaSample::CopyFrom(data.data(), data.size(), i == 0));
+
+  int64_t timestamp = 0;
+  int64_t segment_number = 1;
+  for (auto _ : state) {
+    SegmentInfo segment_info;
+    segment_info.start_timestamp = timestamp;
+    segment_info.duration = kSamplesPerSegment * kSampleDuration;
+    segment_info.segment_number = segment_number++;
+    for (const std::shared_ptr<MediaSample>& sample : samples) {
+      sample->set_pts(timestamp);
+      sample->set_dts(timestamp);
+      sample->set_duration(kSampleDuration);
+      timestamp += kSampleDuration;
+      status = segmenter.AddSample(0, *sample);
+      if (!status.ok())
+        break;
+    }
+    if (status.ok())
+      status = segmenter.FinalizeSegment(0, segment_info);
+    if (!status.ok()) {
+      state.SkipWithError(status.ToString().c_str());
+      break;
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * kSamplesPerSegment *
+                          data.size());
+  state.SetItemsProcessed(state.iterations() * kSamplesPerSegment);
+  MemoryFile::DeleteAll();
+}
+BENCHMARK(BM_MultiSegmentSegmenter)
+    ->Arg(1 << 10)
+    ->Arg(16 << 10)
+    ->Arg(128 << 10);
+
+}  // namespace
+}  // namespace mp4
+}  // namespace media
+}  // namespace shaka
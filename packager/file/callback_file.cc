@@ -19,8 +19,15 @@ CallbackFile::CallbackFile(const char* file_name, const char* mode)
 CallbackFile::~CallbackFile() {}
 
 bool CallbackFile::Close() {
+  bool result = true;
+  // Chunked outputs have been delivered already, except for any trailing
+  // data.
+  if (callback_params_ && callback_params_->output_func && is_writing() &&
+      (!has_delivered_chunks_ || !output_buffer_.empty())) {
+    result = DeliverOutput();
+  }
   delete this;
-  return true;
+  return result;
 }
 
 int64_t CallbackFile::Read(void* buffer, uint64_t length) {
@@ -32,6 +39,11 @@ int64_t CallbackFile::Read(void* buffer, uint64_t length) {
 }
 
 int64_t CallbackFile::Write(const void* buffer, uint64_t length) {
+  if (callback_params_->output_func) {
+    const uint8_t* data = static_cast<const uint8_t*>(buffer);
+    output_buffer_.insert(output_buffer_.end(), data, data + length);
+    return length;
+  }
   if (!callback_params_->write_func) {
     LOG(ERROR) << "Write function not defined.";
     return -1;
@@ -65,11 +77,49 @@ bool CallbackFile::Tell(uint64_t* position) {
 
 bool CallbackFile::Open() {
   if (file_mode_ != "r" && file_mode_ != "w" && file_mode_ != "rb" &&
-      file_mode_ != "wb") {
+      file_mode_ != "wb" && file_mode_ != "a" && file_mode_ != "ab") {
     LOG(ERROR) << "CallbackFile does not support file mode " << file_mode_;
     return false;
   }
-  return ParseCallbackFileName(file_name(), &callback_params_, &name_);
+  if (!ParseCallbackFileName(file_name(), &callback_params_, &name_))
+    return false;
+  // Appending is only supported when delivering whole outputs, where each
+  // output is delivered on its own anyway.
+  if (file_mode_[0] == 'a' && !callback_params_->output_func) {
+    LOG(ERROR) << "CallbackFile does not support file mode " << file_mode_
+               << " without an output function.";
+    return false;
+  }
+  output_info_.name = name_;
+  return true;
+}
+
+bool CallbackFile::DeliverOutput() {
+  const bool result = callback_params_->output_func(
+      output_info_, output_buffer_.data(), output_buffer_.size());
+  if (!result)
+    LOG(ERROR) << "Failed to deliver output " << name_;
+  output_buffer_.clear();
+  return result;
+}
+
+// static
+void CallbackFile::SetOutputInfo(File* file, const OutputInfo& info) {
+  CallbackFile* callback_file = dynamic_cast<CallbackFile*>(file);
+  if (!callback_file || !callback_file->callback_params_->output_func)
+    return;
+  callback_file->output_info_ = info;
+  callback_file->output_info_.name = callback_file->name_;
+}
+
+// static
+bool CallbackFile::DeliverChunk(File* file, const OutputInfo& info) {
+  CallbackFile* callback_file = dynamic_cast<CallbackFile*>(file);
+  if (!callback_file || !callback_file->callback_params_->output_func)
+    return true;
+  SetOutputInfo(file, info);
+  callback_file->has_delivered_chunks_ = true;
+  return callback_file->DeliverOutput();
 }
 
 }  // namespace shaka
@@ -4,7 +4,11 @@
 // license that can be found in the LICENSE file or at
 // https://developers.google.com/open-source/licenses/bsd
 
+#ifndef PACKAGER_FILE_CALLBACK_FILE_H_
+#define PACKAGER_FILE_CALLBACK_FILE_H_
+
 #include <cstdint>
+#include <vector>
 
 #include <packager/file.h>
 
@@ -12,6 +16,9 @@ namespace shaka {
 
 /// Implements CallbackFile, which delegates read/write calls to the callback
 /// functions set through the file name.
+///
+/// If BufferCallbackParams::output_func is set, written data is buffered and
+/// delivered to it as a whole on Close, or in chunks with DeliverChunk().
 class CallbackFile : public File {
  public:
   /// @param file_name is the callback file name, which should have callback
@@ -33,6 +40,17 @@ class CallbackFile : public File {
   bool Tell(uint64_t* position) override;
   /// @}
 
+  /// Sets the description delivered with the output of @a file, if it is a
+  /// CallbackFile delivering whole outputs.  Does nothing otherwise.  The
+  /// name in @a info is ignored.
+  static void SetOutputInfo(File* file, const OutputInfo& info);
+
+  /// Delivers the data written to @a file so far as a chunk described by
+  /// @a info, if it is a CallbackFile delivering whole outputs.  Does nothing
+  /// otherwise.
+  /// @return false if the delivery failed, true otherwise.
+  static bool DeliverChunk(File* file, const OutputInfo& info);
+
  protected:
   ~CallbackFile() override;
 
@@ -42,9 +60,19 @@ class CallbackFile : public File {
   CallbackFile(const CallbackFile&) = delete;
   CallbackFile& operator=(const CallbackFile&) = delete;
 
+  bool is_writing() const { return file_mode_[0] != 'r'; }
+  // Delivers and clears |output_buffer_|.
+  bool DeliverOutput();
+
   const BufferCallbackParams* callback_params_ = nullptr;
   std::string name_;
   std::string file_mode_;
+  // Output being buffered for |callback_params_->output_func|.
+  std::vector<uint8_t> output_buffer_;
+  OutputInfo output_info_;
+  bool has_delivered_chunks_ = false;
 };
 
 }  // namespace shaka
+
+#endif  // PACKAGER_FILE_CALLBACK_FILE_H_
@@ -7,6 +7,7 @@
 #include <packager/file/callback_file.h>
 
 #include <memory>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -167,4 +168,106 @@ TEST(CallbackFileTest, WriteFunctionNotDefined) {
   ASSERT_EQ(-1, writer->Write(kBuffer, kBufferSize));
 }
 
+TEST(CallbackFileTest, OutputDeliveredWhole) {
+  std::vector<std::pair<OutputInfo, std::string>> outputs;
+  BufferCallbackParams callback_params;
+  callback_params.output_func = [&outputs](const OutputInfo& info,
+                                           const void* buffer, uint64_t size) {
+    outputs.emplace_back(
+        info, std::string(static_cast<const char*>(buffer), size));
+    return true;
+  };
+
+  std::string file_name =
+      File::MakeCallbackFileName(callback_params, kBufferLabel);
+  std::unique_ptr<File, FileCloser> writer(File::Open(file_name.c_str(), "w"));
+  ASSERT_TRUE(writer);
+
+  OutputInfo info;
+  info.stream = "stream";
+  info.is_segment = true;
+  info.segment_number = 3;
+  CallbackFile::SetOutputInfo(writer.get(), info);
+
+  ASSERT_EQ(static_cast<int64_t>(kBufferSize),
+            writer->Write(kBuffer, kBufferSize));
+  ASSERT_EQ(static_cast<int64_t>(kSizeLessThanBufferSize),
+            writer->Write(kBuffer, kSizeLessThanBufferSize));
+  EXPECT_TRUE(outputs.empty());
+  ASSERT_TRUE(writer.release()->Close());
+
+  ASSERT_EQ(1u, outputs.size());
+  EXPECT_EQ(kBufferLabel, outputs[0].first.name);
+  EXPECT_EQ("stream", outputs[0].first.stream);
+  EXPECT_TRUE(outputs[0].first.is_segment);
+  EXPECT_FALSE(outputs[0].first.is_chunk);
+  EXPECT_EQ(3, outputs[0].first.segment_number);
+  const std::string data(reinterpret_cast<const char*>(kBuffer), kBufferSize);
+  EXPECT_EQ(data + data.substr(0, kSizeLessThanBufferSize), outputs[0].second);
+}
+
+TEST(CallbackFileTest, OutputDeliveredInChunks) {
+  std::vector<std::pair<OutputInfo, std::string>> outputs;
+  BufferCallbackParams callback_params;
+  callback_params.output_func = [&outputs](const OutputInfo& info,
+                                           const void* buffer, uint64_t size) {
+    outputs.emplace_back(
+        info, std::string(static_cast<const char*>(buffer), size));
+    return true;
+  };
+
+  std::string file_name =
+      File::MakeCallbackFileName(callback_params, kBufferLabel);
+  std::unique_ptr<File, FileCloser> writer(File::Open(file_name.c_str(), "a"));
+  ASSERT_TRUE(writer);
+
+  OutputInfo info;
+  info.is_segment = true;
+  info.is_chunk = true;
+  ASSERT_EQ(static_cast<int64_t>(kBufferSize),
+            writer->Write(kBuffer, kBufferSize));
+  info.duration = 10;
+  ASSERT_TRUE(CallbackFile::DeliverChunk(writer.get(), info));
+  ASSERT_EQ(static_cast<int64_t>(kSizeLessThanBufferSize),
+            writer->Write(kBuffer, kSizeLessThanBufferSize));
+  info.duration = 20;
+  ASSERT_TRUE(CallbackFile::DeliverChunk(writer.get(), info));
+  // Nothing is left to be delivered on close.
+  ASSERT_TRUE(writer.release()->Close());
+
+  ASSERT_EQ(2u, outputs.size());
+  EXPECT_EQ(10, outputs[0].first.duration);
+  EXPECT_EQ(kBufferSize, outputs[0].second.size());
+  EXPECT_TRUE(outputs[1].first.is_chunk);
+  EXPECT_EQ(20, outputs[1].first.duration);
+  EXPECT_EQ(kSizeLessThanBufferSize, outputs[1].second.size());
+}
+
+TEST(CallbackFileTest, OutputDeliveryFailed) {
+  BufferCallbackParams callback_params;
+  callback_params.output_func = [](const OutputInfo&, const void*, uint64_t) {
+    return false;
+  };
+
+  std::string file_name =
+      File::MakeCallbackFileName(callback_params, kBufferLabel);
+  std::unique_ptr<File, FileCloser> writer(File::Open(file_name.c_str(), "w"));
+  ASSERT_TRUE(writer);
+  ASSERT_EQ(static_cast<int64_t>(kBufferSize),
+            writer->Write(kBuffer, kBufferSize));
+  EXPECT_FALSE(writer.release()->Close());
+}
+
+TEST(CallbackFileTest, AppendRequiresOutputFunction) {
+  MockFunction<int64_t(const std::string& name, const void* buffer,
+                       uint64_t length)>
+      mock_write_func;
+  BufferCallbackParams callback_params;
+  callback_params.write_func = mock_write_func.AsStdFunction();
+
+  std::string file_name =
+      File::MakeCallbackFileName(callback_params, kBufferLabel);
+  EXPECT_FALSE(File::Open(file_name.c_str(), "a"));
+}
+
 }  // namespace shaka
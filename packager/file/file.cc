@@ -22,8 +22,11 @@
 #include <packager/file/http_file.h>
 #include <packager/file/local_file.h>
 #include <packager/file/memory_file.h>
+#include <packager/file/origin_file.h>
+#include <packager/file/thread_pool.h>
 #include <packager/file/threaded_io_file.h>
 #include <packager/file/udp_file.h>
+#include <packager/file/uring_file.h>
 #include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
 
@@ -36,6 +39,12 @@ ABSL_FLAG(uint64_t,
           io_block_size,
           1ULL << 16,
           "Size of the block size used for threaded I/O, in bytes.");
+ABSL_FLAG(bool,
+          use_io_uring,
+          false,
+          "Write local files and manifests with io_uring, so that writes do "
+          "not block on writeback. Only supported on Linux; falls back to "
+          "regular file I/O if the kernel does not support io_uring.");
 
 namespace shaka {
 
@@ -45,6 +54,7 @@ const char* kMemoryFilePrefix = "memory://";
 const char* kUdpFilePrefix = "udp://";
 const char* kHttpFilePrefix = "http://";
 const char* kHttpsFilePrefix = "https://";
+const char* kOriginFilePrefix = "origin://";
 
 namespace {
 
@@ -64,7 +74,18 @@ File* CreateCallbackFile(const char* file_name, const char* mode) {
   return new CallbackFile(file_name, mode);
 }
 
+// io_uring is only used for writing.
+bool UseIoUring(const char* mode) {
+  return absl::GetFlag(FLAGS_use_io_uring) &&
+         (!strcmp(mode, "w") || !strcmp(mode, "a")) &&
+         UringFile::IsSupported();
+}
+
 File* CreateLocalFile(const char* file_name, const char* mode) {
+#if defined(__linux__)
+  if (UseIoUring(mode))
+    return new UringFile(file_name, mode);
+#endif  // defined(__linux__)
   return new LocalFile(file_name, mode);
 }
 
@@ -92,6 +113,10 @@ bool WriteLocalFileAtomically(const char* file_name,
   std::string temp_file_name;
   if (!TempFilePath(dir_path.string(), &temp_file_name))
     return false;
+  if (UseIoUring("w")) {
+    return UringFile::WriteAtomically(file_name, temp_file_name.c_str(),
+                                      contents);
+  }
   if (!File::WriteStringToFile(temp_file_name.c_str(), contents))
     return false;
 
@@ -146,6 +171,19 @@ bool DeleteMemoryFile(const char* file_name) {
   return true;
 }
 
+File* CreateOriginFile(const char* file_name, const char* mode) {
+  return new OriginFile(file_name, mode);
+}
+
+bool DeleteOriginFile(const char* file_name) {
+  return OriginFile::Delete(file_name);
+}
+
+bool WriteOriginFileAtomically(const char* file_name,
+                               const std::string& contents) {
+  return OriginFile::WriteAtomically(file_name, contents);
+}
+
 static const FileTypeInfo kFileTypeInfo[] = {
     {
         kLocalFilePrefix,
@@ -158,6 +196,12 @@ static const FileTypeInfo kFileTypeInfo[] = {
     {kCallbackFilePrefix, &CreateCallbackFile, nullptr, nullptr},
     {kHttpFilePrefix, &CreateHttpFile, &DeleteHttpFile, nullptr},
     {kHttpsFilePrefix, &CreateHttpsFile, &DeleteHttpsFile, nullptr},
+    {
+        kOriginFilePrefix,
+        &CreateOriginFile,
+        &DeleteOriginFile,
+        &WriteOriginFileAtomically,
+    },
 };
 
 std::string_view GetFileTypePrefix(std::string_view file_name) {
@@ -187,8 +231,9 @@ File* File::Create(const char* file_name, const char* mode) {
 
   std::string_view file_type_prefix = GetFileTypePrefix(file_name);
   if (file_type_prefix == kMemoryFilePrefix ||
-      file_type_prefix == kCallbackFilePrefix) {
-    // Disable caching for memory and callback files.
+      file_type_prefix == kCallbackFilePrefix ||
+      file_type_prefix == kOriginFilePrefix) {
+    // Disable caching for memory, callback and origin files.
     return internal_file.release();
   }
 
@@ -220,6 +265,24 @@ File* File::CreateInternalFile(const char* file_name, const char* mode) {
   return file_type->factory_function(real_file_name.data(), mode);
 }
 
+int64_t File::WriteV(const WriteBuffer* buffers, size_t num_buffers) {
+  DCHECK(buffers || num_buffers == 0);
+  int64_t total_bytes_written = 0;
+  for (size_t i = 0; i < num_buffers; ++i) {
+    const uint8_t* data = static_cast<const uint8_t*>(buffers[i].data);
+    uint64_t bytes_left = buffers[i].length;
+    while (bytes_left > 0) {
+      const int64_t bytes_written = Write(data, bytes_left);
+      if (bytes_written <= 0)
+        return total_bytes_written > 0 ? total_bytes_written : bytes_written;
+      data += bytes_written;
+      bytes_left -= bytes_written;
+      total_bytes_written += bytes_written;
+    }
+  }
+  return total_bytes_written;
+}
+
 File* File::Open(const char* file_name, const char* mode) {
   File* file = File::Create(file_name, mode);
   if (!file)
@@ -319,6 +382,9 @@ bool File::WriteStringToFile(const char* file_name,
 bool File::WriteFileAtomically(const char* file_name,
                                const std::string& contents) {
   VLOG(2) << "File::WriteFileAtomically: " << file_name;
+  // Manifests are written atomically.  Let their I/O tasks skip ahead of
+  // queued segment writes when the I/O thread pool is at its limit.
+  ThreadPool::ScopedPriority priority(ThreadPool::Priority::kHigh);
   std::string_view real_file_name;
   const FileTypeInfo* file_type = GetFileTypeInfo(file_name, &real_file_name);
   DCHECK(file_type);
@@ -14,6 +14,7 @@
 #include <gtest/gtest.h>
 
 #include <packager/file/file_test_util.h>
+#include <packager/file/local_file.h>
 #include <packager/flag_saver.h>
 
 ABSL_DECLARE_FLAG(uint64_t, io_cache_size);
@@ -246,6 +247,25 @@ TEST_F(LocalFileTest, WriteFlushCheckSize) {
   }
 }
 
+TEST_F(LocalFileTest, Map) {
+  WriteFile(local_file_name_no_prefix_, data_);
+
+  uint64_t size = 0;
+  std::shared_ptr<const uint8_t> mapped =
+      LocalFile::Map(local_file_name_no_prefix_.c_str(), &size);
+#if defined(OS_WIN)
+  EXPECT_FALSE(mapped);
+#else
+  ASSERT_TRUE(mapped);
+  ASSERT_EQ(static_cast<uint64_t>(kDataSize), size);
+  EXPECT_EQ(0, memcmp(data_.data(), mapped.get(), kDataSize));
+
+  // The mapping outlives the file.
+  DeleteFile(local_file_name_no_prefix_);
+  EXPECT_EQ(data_[kDataSize - 1], static_cast<char>(mapped.get()[size - 1]));
+#endif  // defined(OS_WIN)
+}
+
 TEST_F(LocalFileTest, IsLocalRegular) {
   WriteFile(local_file_name_no_prefix_, data_);
   ASSERT_TRUE(File::IsLocalRegularFile(local_file_name_.c_str()));
@@ -396,6 +416,42 @@ TEST_P(ParamLocalFileTest, SeekWriteAndSeekRead) {
 
   EXPECT_TRUE(file->Close());
 }
+TEST_P(ParamLocalFileTest, WriteVMixedWithWriteAndSeek) {
+  FlagSaver local_backup_io_cache_size(&FLAGS_io_cache_size);
+  absl::SetFlag(&FLAGS_io_cache_size, GetParam());
+
+  const std::string kData1(3, 'a');
+  const std::string kData2(50, 'b');
+  const std::string kData3(60, 'c');
+  const std::string kData4 = "dd";
+  const File::WriteBuffer buffers[] = {{kData2.data(), kData2.size()},
+                                       {kData3.data(), kData3.size()}};
+  const uint64_t kVectoredSize = kData2.size() + kData3.size();
+
+  File* file = File::Open(local_file_name_no_prefix_.c_str(), "w");
+  ASSERT_TRUE(file != nullptr);
+  ASSERT_EQ(static_cast<int64_t>(kData1.size()),
+            file->Write(kData1.data(), kData1.size()));
+  ASSERT_EQ(static_cast<int64_t>(kVectoredSize), file->WriteV(buffers, 2));
+  uint64_t position;
+  ASSERT_TRUE(file->Tell(&position));
+  EXPECT_EQ(kData1.size() + kVectoredSize, position);
+
+  ASSERT_EQ(static_cast<int64_t>(kData4.size()),
+            file->Write(kData4.data(), kData4.size()));
+  ASSERT_TRUE(file->Tell(&position));
+  EXPECT_EQ(kData1.size() + kVectoredSize + kData4.size(), position);
+
+  // Overwrite the first byte.
+  ASSERT_TRUE(file->Seek(0));
+  ASSERT_EQ(1, file->Write("e", 1));
+  ASSERT_TRUE(file->Close());
+
+  std::string data_read;
+  ASSERT_TRUE(File::ReadFileToString(local_file_name_.c_str(), &data_read));
+  EXPECT_EQ("e" + kData1.substr(1) + kData2 + kData3 + kData4, data_read);
+}
+
 INSTANTIATE_TEST_SUITE_P(TestSeekWithDifferentCacheSizes,
                          ParamLocalFileTest,
                          // 0 disables cache, 20 is small, 61 is prime, and 1000
@@ -0,0 +1,156 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/http_connection_pool.h>
+
+#include <absl/flags/flag.h>
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <curl/curl.h>
+
+ABSL_FLAG(uint32_t,
+          http_max_idle_connections_per_host,
+          16,
+          "Maximum number of idle HTTP connections kept alive per "
+          "scheme/host/port for reuse by later requests. Specify 0 to disable "
+          "connection pooling.");
+
+namespace shaka {
+
+namespace {
+
+void LockShare(CURL* /* handle */,
+               curl_lock_data data,
+               curl_lock_access /* access */,
+               void* user_data) {
+  absl::Mutex* mutexes = static_cast<absl::Mutex*>(user_data);
+  mutexes[data].lock();
+}
+
+void UnlockShare(CURL* /* handle */, curl_lock_data data, void* user_data) {
+  absl::Mutex* mutexes = static_cast<absl::Mutex*>(user_data);
+  mutexes[data].unlock();
+}
+
+}  // namespace
+
+// static
+HttpConnectionPool* HttpConnectionPool::GetInstance() {
+  static HttpConnectionPool instance;
+  return &instance;
+}
+
+HttpConnectionPool::HttpConnectionPool()
+    : share_(nullptr), share_mutexes_(new absl::Mutex[CURL_LOCK_DATA_LAST]) {
+  curl_global_init(CURL_GLOBAL_DEFAULT);
+
+  share_ = curl_share_init();
+  if (!share_) {
+    LOG(WARNING) << "curl_share_init() failed. DNS and TLS sessions will not "
+                    "be shared between HTTP requests.";
+    return;
+  }
+  curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, &LockShare);
+  curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, &UnlockShare);
+  curl_share_setopt(share_, CURLSHOPT_USERDATA, share_mutexes_.get());
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+}
+
+HttpConnectionPool::~HttpConnectionPool() {
+  {
+    absl::MutexLock lock(mutex_);
+    for (auto& entry : idle_handles_) {
+      for (CURL* curl : entry.second)
+        curl_easy_cleanup(curl);
+    }
+    idle_handles_.clear();
+  }
+
+  // This fails if a request is still in flight on a detached thread at exit.
+  // The share object is leaked in that case, which is harmless at exit.
+  if (share_ && curl_share_cleanup(share_) != CURLSHE_OK)
+    VLOG(1) << "HTTP share object still in use at exit.";
+  curl_global_cleanup();
+}
+
+CURL* HttpConnectionPool::Acquire(const std::string& url) {
+  CURL* curl = nullptr;
+  {
+    absl::MutexLock lock(mutex_);
+    auto iter = idle_handles_.find(GetPoolKey(url));
+    if (iter != idle_handles_.end() && !iter->second.empty()) {
+      curl = iter->second.back();
+      iter->second.pop_back();
+    }
+  }
+
+  if (curl) {
+    VLOG(2) << "Reusing pooled HTTP handle for " << url;
+    // Resets all options, but keeps the live connections and caches.
+    curl_easy_reset(curl);
+  } else {
+    curl = curl_easy_init();
+    if (!curl)
+      return nullptr;
+  }
+
+  if (share_)
+    curl_easy_setopt(curl, CURLOPT_SHARE, share_);
+  return curl;
+}
+
+void HttpConnectionPool::Release(const std::string& url, CURL* curl) {
+  if (!curl)
+    return;
+
+  const size_t max_idle_handles =
+      absl::GetFlag(FLAGS_http_max_idle_connections_per_host);
+  {
+    absl::MutexLock lock(mutex_);
+    std::vector<CURL*>& handles = idle_handles_[GetPoolKey(url)];
+    if (handles.size() < max_idle_handles) {
+      handles.push_back(curl);
+      return;
+    }
+  }
+  curl_easy_cleanup(curl);
+}
+
+size_t HttpConnectionPool::NumIdleHandles(const std::string& url) {
+  absl::MutexLock lock(mutex_);
+  auto iter = idle_handles_.find(GetPoolKey(url));
+  return iter == idle_handles_.end() ? 0 : iter->second.size();
+}
+
+// static
+std::string HttpConnectionPool::GetPoolKey(const std::string& url) {
+  std::string key = url;
+
+  CURLU* parsed_url = curl_url();
+  if (!parsed_url)
+    return key;
+
+  char* scheme = nullptr;
+  char* host = nullptr;
+  char* port = nullptr;
+  if (curl_url_set(parsed_url, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK &&
+      curl_url_get(parsed_url, CURLUPART_SCHEME, &scheme, 0) == CURLUE_OK &&
+      curl_url_get(parsed_url, CURLUPART_HOST, &host, 0) == CURLUE_OK &&
+      curl_url_get(parsed_url, CURLUPART_PORT, &port, CURLU_DEFAULT_PORT) ==
+          CURLUE_OK) {
+    key = std::string(scheme) + "://" + host + ":" + port;
+  }
+
+  curl_free(scheme);
+  curl_free(host);
+  curl_free(port);
+  curl_url_cleanup(parsed_url);
+  return key;
+}
+
+}  // namespace shaka
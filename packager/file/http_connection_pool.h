@@ -0,0 +1,76 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_HTTP_CONNECTION_POOL_H_
+#define PACKAGER_FILE_HTTP_CONNECTION_POOL_H_
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
+#include <packager/macros/classes.h>
+
+typedef void CURL;
+typedef void CURLSH;
+
+namespace shaka {
+
+/// A process-wide pool of libcurl easy handles, keyed by scheme, host and
+/// port.  Each easy handle keeps its own cache of live connections, so handing
+/// the same handle to the next request for the same origin lets the keep-alive
+/// connection be reused instead of paying a new TCP and TLS handshake.  All
+/// handles are also attached to a common share object, so the DNS cache, TLS
+/// session IDs and the connection cache survive even when a handle is evicted
+/// from the pool.
+class HttpConnectionPool {
+ public:
+  /// @return The process-wide pool.
+  static HttpConnectionPool* GetInstance();
+
+  /// Borrow an easy handle to be used for a request to @a url.  The handle has
+  /// been reset to default options, except that it is attached to the shared
+  /// DNS / TLS session / connection cache.
+  /// @return A handle owned by the caller until it is passed back to Release,
+  ///         or nullptr if libcurl could not create a handle.
+  CURL* Acquire(const std::string& url);
+
+  /// Return a handle previously borrowed through Acquire.  If the number of
+  /// idle handles for this origin is at the limit, the handle is destroyed.
+  /// @param url is the url that was passed to Acquire.
+  /// @param curl is the handle to return.  May be nullptr.
+  void Release(const std::string& url, CURL* curl);
+
+  /// @return The number of idle handles pooled for the origin of @a url.
+  size_t NumIdleHandles(const std::string& url);
+
+  /// @return The pool key for @a url, which is "scheme://host:port" with the
+  ///         default port filled in.  If @a url cannot be parsed, it is
+  ///         returned unchanged.
+  static std::string GetPoolKey(const std::string& url);
+
+ private:
+  HttpConnectionPool();
+  ~HttpConnectionPool();
+
+  CURLSH* share_;
+  // One mutex per curl_lock_data type, used by the share callbacks.
+  std::unique_ptr<absl::Mutex[]> share_mutexes_;
+
+  absl::Mutex mutex_;
+  std::map<std::string, std::vector<CURL*>> idle_handles_
+      ABSL_GUARDED_BY(mutex_);
+
+  DISALLOW_COPY_AND_ASSIGN(HttpConnectionPool);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_HTTP_CONNECTION_POOL_H_
@@ -0,0 +1,103 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/http_connection_pool.h>
+
+#include <algorithm>
+
+#include <absl/flags/declare.h>
+#include <absl/flags/flag.h>
+#include <gtest/gtest.h>
+
+#include <packager/file/file_closer.h>
+#include <packager/file/http_file.h>
+#include <packager/flag_saver.h>
+#include <packager/media/test/test_web_server.h>
+
+ABSL_DECLARE_FLAG(uint32_t, http_max_idle_connections_per_host);
+
+namespace shaka {
+
+namespace {
+
+const std::vector<std::string> kNoHeaders;
+const std::string kNoContentType;
+const int kDefaultTestTimeout = 10;  // For a local, embedded server
+
+using FilePtr = std::unique_ptr<HttpFile, FileCloser>;
+
+}  // namespace
+
+TEST(HttpConnectionPoolTest, GetPoolKey) {
+  EXPECT_EQ("http://example.com:80",
+            HttpConnectionPool::GetPoolKey("http://example.com/a/b.mp4"));
+  EXPECT_EQ("https://example.com:443",
+            HttpConnectionPool::GetPoolKey("https://example.com/a?b=c"));
+  EXPECT_EQ("http://127.0.0.1:8080",
+            HttpConnectionPool::GetPoolKey("http://127.0.0.1:8080/seg.m4s"));
+  EXPECT_EQ("not a url", HttpConnectionPool::GetPoolKey("not a url"));
+}
+
+TEST(HttpConnectionPoolTest, ReusesHandlePerOrigin) {
+  HttpConnectionPool* pool = HttpConnectionPool::GetInstance();
+  const std::string url1 = "http://pool-test-1.example.com/a";
+  const std::string url2 = "http://pool-test-1.example.com/b";
+  const std::string other_url = "http://pool-test-2.example.com/a";
+
+  CURL* curl = pool->Acquire(url1);
+  ASSERT_TRUE(curl);
+  EXPECT_EQ(0u, pool->NumIdleHandles(url1));
+  pool->Release(url1, curl);
+  EXPECT_EQ(1u, pool->NumIdleHandles(url2));
+  EXPECT_EQ(0u, pool->NumIdleHandles(other_url));
+
+  // A different origin gets a fresh handle.
+  CURL* other_curl = pool->Acquire(other_url);
+  EXPECT_NE(curl, other_curl);
+  pool->Release(other_url, other_curl);
+
+  // The same origin gets the pooled handle back.
+  EXPECT_EQ(curl, pool->Acquire(url2));
+  EXPECT_EQ(0u, pool->NumIdleHandles(url2));
+  pool->Release(url2, curl);
+}
+
+TEST(HttpConnectionPoolTest, RespectsIdleLimit) {
+  FlagSaver<uint32_t> saver(&FLAGS_http_max_idle_connections_per_host);
+  absl::SetFlag(&FLAGS_http_max_idle_connections_per_host, 1);
+
+  HttpConnectionPool* pool = HttpConnectionPool::GetInstance();
+  const std::string url = "http://pool-test-3.example.com/a";
+  CURL* curl1 = pool->Acquire(url);
+  CURL* curl2 = pool->Acquire(url);
+  pool->Release(url, curl1);
+  pool->Release(url, curl2);
+  EXPECT_EQ(1u, pool->NumIdleHandles(url));
+}
+
+TEST(HttpConnectionPoolTest, HttpFileReturnsHandleToPool) {
+  media::TestWebServer server;
+  ASSERT_TRUE(server.Start());
+
+  HttpConnectionPool* pool = HttpConnectionPool::GetInstance();
+  const size_t idle_handles = pool->NumIdleHandles(server.ReflectUrl());
+
+  for (int i = 0; i < 3; ++i) {
+    FilePtr file(new HttpFile(HttpMethod::kGet, server.ReflectUrl(),
+                              kNoContentType, kNoHeaders, kDefaultTestTimeout));
+    ASSERT_TRUE(file->Open());
+    uint8_t buffer[1024];
+    while (file->Read(buffer, sizeof(buffer)) > 0) {
+    }
+    ASSERT_TRUE(file.release()->Close());
+
+    // Sequential requests keep reusing a single pooled handle.
+    EXPECT_EQ(std::max<size_t>(idle_handles, 1),
+              pool->NumIdleHandles(server.ReflectUrl()));
+  }
+}
+
+}  // namespace shaka
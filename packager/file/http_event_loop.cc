@@ -0,0 +1,171 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/http_event_loop.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include <absl/flags/flag.h>
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <curl/curl.h>
+
+#include <packager/file/http_connection_pool.h>
+
+ABSL_FLAG(uint32_t,
+          http_event_loop_threads,
+          0,
+          "Number of event loop threads used to drive all HTTP uploads and "
+          "downloads. Specify 0 to use one blocking thread per open HTTP "
+          "file instead.");
+
+namespace shaka {
+
+namespace {
+
+// Upper bound on how long the loop sleeps without activity.  Transfers wake
+// the loop up explicitly, so this only bounds timer resolution.
+const int kMaxPollTimeoutMs = 1000;
+
+}  // namespace
+
+// static
+size_t HttpEventLoop::NumLoops() {
+  return absl::GetFlag(FLAGS_http_event_loop_threads);
+}
+
+// static
+HttpEventLoop* HttpEventLoop::GetInstance() {
+  // The loops are created on first use, and are torn down at exit before the
+  // connection pool they depend on, since the pool is constructed first.
+  static const std::vector<std::unique_ptr<HttpEventLoop>> loops = [] {
+    std::vector<std::unique_ptr<HttpEventLoop>> loops;
+    for (size_t i = 0; i < std::max<size_t>(NumLoops(), 1); ++i)
+      loops.emplace_back(new HttpEventLoop);
+    return loops;
+  }();
+  static std::atomic<size_t> next_loop(0);
+
+  return loops[next_loop.fetch_add(1) % loops.size()].get();
+}
+
+HttpEventLoop::HttpEventLoop() : next_transfer_id_(1), terminated_(false) {
+  // Make sure libcurl is initialized before creating the multi handle.
+  HttpConnectionPool::GetInstance();
+  multi_ = curl_multi_init();
+  CHECK(multi_) << "curl_multi_init() failed.";
+
+  thread_.reset(new std::thread(&HttpEventLoop::ThreadMain, this));
+}
+
+HttpEventLoop::~HttpEventLoop() {
+  {
+    absl::MutexLock lock(mutex_);
+    terminated_ = true;
+  }
+  curl_multi_wakeup(multi_);
+  thread_->join();
+
+  for (auto& entry : active_transfers_)
+    curl_multi_remove_handle(multi_, entry.first);
+  curl_multi_cleanup(multi_);
+}
+
+uint64_t HttpEventLoop::AddTransfer(CURL* curl, DoneCallback done_callback) {
+  DCHECK(curl);
+  uint64_t transfer_id;
+  {
+    absl::MutexLock lock(mutex_);
+    transfer_id = next_transfer_id_++;
+    pending_transfers_.push_back(
+        Transfer{transfer_id, curl, std::move(done_callback)});
+  }
+  curl_multi_wakeup(multi_);
+  return transfer_id;
+}
+
+void HttpEventLoop::Resume(uint64_t transfer_id) {
+  {
+    absl::MutexLock lock(mutex_);
+    pending_resumes_.push_back(transfer_id);
+  }
+  curl_multi_wakeup(multi_);
+}
+
+void HttpEventLoop::ThreadMain() {
+  int running_transfers = 0;
+  while (ProcessPendingOperations()) {
+    CURLMcode res = curl_multi_perform(multi_, &running_transfers);
+    if (res != CURLM_OK) {
+      LOG(ERROR) << "curl_multi_perform failed: " << curl_multi_strerror(res);
+    }
+    ProcessCompletedTransfers();
+
+    res = curl_multi_poll(multi_, nullptr, 0, kMaxPollTimeoutMs, nullptr);
+    if (res != CURLM_OK) {
+      LOG(ERROR) << "curl_multi_poll failed: " << curl_multi_strerror(res);
+    }
+  }
+}
+
+bool HttpEventLoop::ProcessPendingOperations() {
+  std::vector<Transfer> transfers;
+  std::vector<uint64_t> resumes;
+  {
+    absl::MutexLock lock(mutex_);
+    if (terminated_)
+      return false;
+    transfers.swap(pending_transfers_);
+    resumes.swap(pending_resumes_);
+  }
+
+  for (Transfer& transfer : transfers) {
+    CURLMcode res = curl_multi_add_handle(multi_, transfer.curl);
+    if (res != CURLM_OK) {
+      LOG(ERROR) << "curl_multi_add_handle failed: "
+                 << curl_multi_strerror(res);
+      transfer.done_callback(CURLE_FAILED_INIT);
+      continue;
+    }
+    active_transfer_handles_[transfer.id] = transfer.curl;
+    active_transfers_[transfer.curl] = std::move(transfer);
+  }
+
+  for (uint64_t transfer_id : resumes) {
+    // The transfer may have completed before the request was processed, in
+    // which case its handle may already drive another transfer.
+    auto iter = active_transfer_handles_.find(transfer_id);
+    if (iter != active_transfer_handles_.end())
+      curl_easy_pause(iter->second, CURLPAUSE_CONT);
+  }
+  return true;
+}
+
+void HttpEventLoop::ProcessCompletedTransfers() {
+  int messages_left = 0;
+  while (CURLMsg* message = curl_multi_info_read(multi_, &messages_left)) {
+    if (message->msg != CURLMSG_DONE)
+      continue;
+
+    CURL* curl = message->easy_handle;
+    const CURLcode result = message->data.result;
+    curl_multi_remove_handle(multi_, curl);
+
+    auto iter = active_transfers_.find(curl);
+    if (iter == active_transfers_.end()) {
+      LOG(ERROR) << "Completed transfer is not tracked by the event loop.";
+      continue;
+    }
+    DoneCallback done_callback = std::move(iter->second.done_callback);
+    active_transfer_handles_.erase(iter->second.id);
+    active_transfers_.erase(iter);
+    // This may destroy the owner of |curl|, so it is called last.
+    done_callback(result);
+  }
+}
+
+}  // namespace shaka
@@ -0,0 +1,103 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_HTTP_EVENT_LOOP_H_
+#define PACKAGER_FILE_HTTP_EVENT_LOOP_H_
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/synchronization/mutex.h>
+
+#include <packager/macros/classes.h>
+
+typedef void CURL;
+typedef void CURLM;
+
+namespace shaka {
+
+/// Drives many concurrent HTTP transfers from a single thread, using the
+/// libcurl multi interface.  This replaces the thread-per-transfer model of
+/// running curl_easy_perform on a ThreadPool thread.
+///
+/// Transfer callbacks run on the loop thread and must never block.  When a
+/// callback cannot make progress, it pauses its transfer, and the owner of the
+/// transfer calls Resume once progress is possible again.
+class HttpEventLoop {
+ public:
+  /// Called on the loop thread when a transfer completes.  The argument is the
+  /// CURLcode result of the transfer.
+  typedef std::function<void(int)> DoneCallback;
+
+  /// @return The number of event loops configured by the
+  ///         --http_event_loop_threads flag.  Zero means transfers are not
+  ///         driven by an event loop.
+  static size_t NumLoops();
+
+  /// @return One of the process-wide event loops.  Transfers are spread
+  ///         across the loops in a round-robin fashion.  The loops are created
+  ///         on the first call, using the value of NumLoops() at that time.
+  static HttpEventLoop* GetInstance();
+
+  /// Start driving @a curl, which must be fully configured.  This can be
+  /// called from any thread.
+  /// @param curl is the transfer to add.  It must stay valid until
+  ///        @a done_callback has been called.
+  /// @param done_callback is called on the loop thread once the transfer has
+  ///        completed, successfully or not.
+  /// @return The id of the transfer, to be passed to Resume.
+  uint64_t AddTransfer(CURL* curl, DoneCallback done_callback);
+
+  /// Unpause the transfer @a transfer_id, after one of its callbacks paused
+  /// it.  This can be called from any thread.  Resuming a transfer that is not
+  /// paused, or that has completed, is harmless.  Its handle may be driving
+  /// another transfer by then, which is not affected.
+  void Resume(uint64_t transfer_id);
+
+ private:
+  friend struct std::default_delete<HttpEventLoop>;
+
+  HttpEventLoop();
+  ~HttpEventLoop();
+
+  void ThreadMain();
+  // Adds queued transfers to the multi handle and unpauses queued transfers.
+  // Returns false once the loop is terminating.
+  bool ProcessPendingOperations();
+  void ProcessCompletedTransfers();
+
+  struct Transfer {
+    uint64_t id;
+    CURL* curl;
+    DoneCallback done_callback;
+  };
+
+  CURLM* multi_;
+
+  absl::Mutex mutex_;
+  std::vector<Transfer> pending_transfers_ ABSL_GUARDED_BY(mutex_);
+  std::vector<uint64_t> pending_resumes_ ABSL_GUARDED_BY(mutex_);
+  uint64_t next_transfer_id_ ABSL_GUARDED_BY(mutex_);
+  bool terminated_ ABSL_GUARDED_BY(mutex_);
+
+  // Only accessed on the loop thread.  Handles are reused once their transfer
+  // completes, so transfers are resumed by id rather than by handle.
+  std::map<CURL*, Transfer> active_transfers_;
+  std::map<uint64_t, CURL*> active_transfer_handles_;
+
+  std::unique_ptr<std::thread> thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(HttpEventLoop);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_HTTP_EVENT_LOOP_H_
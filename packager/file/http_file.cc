@@ -6,6 +6,8 @@
 
 #include <packager/file/http_file.h>
 
+#include <algorithm>
+
 #include <absl/flags/declare.h>
 #include <absl/flags/flag.h>
 #include <absl/log/check.h>
@@ -16,6 +18,8 @@
 #include <curl/curl.h>
 
 #include <packager/file/file_closer.h>
+#include <packager/file/http_connection_pool.h>
+#include <packager/file/http_event_loop.h>
 #include <packager/file/thread_pool.h>
 #include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
@@ -140,16 +144,6 @@ int CurlDebugCallback(CURL* /* handle */,
   return 0;
 }
 
-class LibCurlInitializer {
- public:
-  LibCurlInitializer() { curl_global_init(CURL_GLOBAL_DEFAULT); }
-
-  ~LibCurlInitializer() { curl_global_cleanup(); }
-
-  LibCurlInitializer(const LibCurlInitializer&) = delete;
-  LibCurlInitializer& operator=(const LibCurlInitializer&) = delete;
-};
-
 template <typename List>
 bool AppendHeader(const std::string& header, List* list) {
   auto* temp = curl_slist_append(list->get(), header.c_str());
@@ -180,7 +174,7 @@ HttpFile::HttpFile(HttpMethod method,
       isUpload_(method == HttpMethod::kPut || method == HttpMethod::kPost),
       download_cache_(absl::GetFlag(FLAGS_io_cache_size)),
       upload_cache_(absl::GetFlag(FLAGS_io_cache_size)),
-      curl_(curl_easy_init()),
+      curl_(HttpConnectionPool::GetInstance()->Acquire(url)),
       status_(Status::OK),
       user_agent_(absl::GetFlag(FLAGS_user_agent)),
       ca_file_(absl::GetFlag(FLAGS_ca_file)),
@@ -189,7 +183,6 @@ HttpFile::HttpFile(HttpMethod method,
           absl::GetFlag(FLAGS_client_cert_private_key_file)),
       client_cert_private_key_password_(
           absl::GetFlag(FLAGS_client_cert_private_key_password)) {
-  static LibCurlInitializer lib_curl_initializer;
   if (user_agent_.empty()) {
     user_agent_ += "ShakaPackager/" + GetPackagerVersion();
   }
@@ -216,7 +209,11 @@ HttpFile::HttpFile(HttpMethod method,
   request_headers_ = std::move(temp_headers);
 }
 
-HttpFile::~HttpFile() {}
+HttpFile::~HttpFile() {
+  // Hand the handle back so that its live connection can be reused by the next
+  // request to the same origin.
+  HttpConnectionPool::GetInstance()->Release(url_, curl_);
+}
 
 // static
 bool HttpFile::Delete(const std::string& url) {
@@ -240,7 +237,16 @@ bool HttpFile::Open() {
   // TODO: Implement retrying with exponential backoff, see
   // "widevine_key_source.cc"
 
-  ThreadPool::instance.PostTask(std::bind(&HttpFile::ThreadMain, this));
+  if (HttpEventLoop::NumLoops() > 0) {
+    event_loop_ = HttpEventLoop::GetInstance();
+    SetupRequest();
+    transfer_id_ = event_loop_->AddTransfer(
+        curl_, std::bind(&HttpFile::OnTransferDone, this,
+                         std::placeholders::_1));
+  } else if (!ThreadPool::instance.PostLongRunningTask(
+                 std::bind(&HttpFile::ThreadMain, this))) {
+    return false;
+  }
 
   return true;
 }
@@ -254,6 +260,7 @@ Status HttpFile::CloseWithStatus() {
   // code at minimum) can still be written after uploading is complete.
   // The task will close the download cache when it is complete.
   upload_cache_.Close();
+  ResumeIfPaused(&upload_paused_);
   task_exit_event_.WaitForNotification();
 
   const Status result = status_;
@@ -268,18 +275,35 @@ bool HttpFile::Close() {
 
 int64_t HttpFile::Read(void* buffer, uint64_t length) {
   VLOG(2) << "Reading from " << url_ << ", length=" << length;
-  return download_cache_.Read(buffer, length);
+  const int64_t result = download_cache_.Read(buffer, length);
+  ResumeIfPaused(&download_paused_);
+  return result;
 }
 
 int64_t HttpFile::Write(const void* buffer, uint64_t length) {
   DCHECK(!upload_cache_.closed());
   VLOG(2) << "Writing to " << url_ << ", length=" << length;
-  return upload_cache_.Write(buffer, length);
+  // An event loop pauses the upload while the cache is empty, until it is
+  // resumed after writing.  Writing at most a full cache at a time never waits
+  // for room that only the paused upload would make.
+  const uint64_t max_write_size =
+      event_loop_ ? upload_cache_.cache_size() : length;
+  const uint8_t* data = static_cast<const uint8_t*>(buffer);
+  uint64_t bytes_written = 0;
+  while (bytes_written < length) {
+    const uint64_t size = std::min(length - bytes_written, max_write_size);
+    if (upload_cache_.Write(data + bytes_written, size) == 0)
+      return 0;
+    bytes_written += size;
+    ResumeIfPaused(&upload_paused_);
+  }
+  return bytes_written;
 }
 
 void HttpFile::CloseForWriting() {
   VLOG(2) << "Closing further writes to " << url_;
   upload_cache_.Close();
+  ResumeIfPaused(&upload_paused_);
 }
 
 int64_t HttpFile::Size() {
@@ -305,16 +329,12 @@ bool HttpFile::Tell(uint64_t* position) {
   return false;
 }
 
-void HttpFile::CurlDelete::operator()(CURL* curl) {
-  curl_easy_cleanup(curl);
-}
-
 void HttpFile::CurlDelete::operator()(curl_slist* headers) {
   curl_slist_free_all(headers);
 }
 
 void HttpFile::SetupRequest() {
-  auto* curl = curl_.get();
+  auto* curl = curl_;
 
   switch (method_) {
     case HttpMethod::kGet:
@@ -336,11 +356,25 @@ void HttpFile::SetupRequest() {
   curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout_in_seconds_);
   curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
   curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &CurlWriteCallback);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &download_cache_);
-  if (isUpload_) {
-    curl_easy_setopt(curl, CURLOPT_READFUNCTION, &CurlReadCallback);
-    curl_easy_setopt(curl, CURLOPT_READDATA, &upload_cache_);
+  // Keep idle pooled connections alive between requests.
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  if (event_loop_) {
+    // Callbacks run on the event loop thread, so they must never block.
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION,
+                     &HttpFile::NonBlockingWriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, this);
+    if (isUpload_) {
+      curl_easy_setopt(curl, CURLOPT_READFUNCTION,
+                       &HttpFile::NonBlockingReadCallback);
+      curl_easy_setopt(curl, CURLOPT_READDATA, this);
+    }
+  } else {
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &CurlWriteCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &download_cache_);
+    if (isUpload_) {
+      curl_easy_setopt(curl, CURLOPT_READFUNCTION, &CurlReadCallback);
+      curl_easy_setopt(curl, CURLOPT_READDATA, &upload_cache_);
+    }
   }
 
   curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request_headers_.get());
@@ -373,13 +407,16 @@ void HttpFile::SetupRequest() {
 
 void HttpFile::ThreadMain() {
   SetupRequest();
+  OnTransferDone(curl_easy_perform(curl_));
+}
 
-  CURLcode res = curl_easy_perform(curl_.get());
+void HttpFile::OnTransferDone(int result) {
+  const CURLcode res = static_cast<CURLcode>(result);
   if (res != CURLE_OK) {
     std::string error_message = curl_easy_strerror(res);
     if (res == CURLE_HTTP_RETURNED_ERROR) {
       long response_code = 0;
-      curl_easy_getinfo(curl_.get(), CURLINFO_RESPONSE_CODE, &response_code);
+      curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &response_code);
       error_message += absl::StrFormat(", response code: %ld.", response_code);
     }
 
@@ -398,4 +435,75 @@ void HttpFile::ThreadMain() {
   task_exit_event_.Notify();
 }
 
+// static
+size_t HttpFile::NonBlockingWriteCallback(char* buffer,
+                                          size_t size,
+                                          size_t nmemb,
+                                          void* user) {
+  HttpFile* file = reinterpret_cast<HttpFile*>(user);
+  const size_t length = size * nmemb;
+  size_t offset = file->download_offset_;
+  DCHECK_LE(offset, length);
+
+  // A closed cache drops the data, as in the blocking mode.
+  while (offset < length && !file->download_cache_.closed()) {
+    const size_t bytes_free = file->download_cache_.BytesFree();
+    if (bytes_free == 0) {
+      // Pause the transfer until the reader makes room.  The flag is raised
+      // before checking again, so that a concurrent Read either sees it and
+      // resumes the transfer, or has already made room that the second check
+      // sees.
+      file->download_paused_ = true;
+      if (file->download_cache_.BytesFree() == 0 &&
+          !file->download_cache_.closed()) {
+        VLOG(3) << "Pausing download from " << file->url_;
+        file->download_offset_ = offset;
+        return CURL_WRITEFUNC_PAUSE;
+      }
+      file->download_paused_ = false;
+      continue;
+    }
+
+    // There is enough room, so this will not block.
+    const size_t bytes = std::min(length - offset, bytes_free);
+    file->download_cache_.Write(buffer + offset, bytes);
+    offset += bytes;
+  }
+  file->download_offset_ = 0;
+  return length;
+}
+
+// static
+size_t HttpFile::NonBlockingReadCallback(char* buffer,
+                                         size_t size,
+                                         size_t nitems,
+                                         void* user) {
+  HttpFile* file = reinterpret_cast<HttpFile*>(user);
+
+  // Pause the transfer until the writer provides more data, or closes the
+  // cache to signal the end of the upload.
+  if (file->upload_cache_.BytesCached() == 0 &&
+      !file->upload_cache_.closed()) {
+    file->upload_paused_ = true;
+    if (file->upload_cache_.BytesCached() == 0 &&
+        !file->upload_cache_.closed()) {
+      VLOG(3) << "Pausing upload to " << file->url_;
+      return CURL_READFUNC_PAUSE;
+    }
+    file->upload_paused_ = false;
+  }
+
+  // There is data in the cache, or the cache is closed, so this will not
+  // block.  A closed and empty cache returns 0, which signals the end of the
+  // upload.
+  const size_t length = file->upload_cache_.Read(buffer, size * nitems);
+  VLOG(3) << "CurlRead length=" << length;
+  return length;
+}
+
+void HttpFile::ResumeIfPaused(std::atomic<bool>* paused) {
+  if (event_loop_ && paused->exchange(false))
+    event_loop_->Resume(transfer_id_);
+}
+
 }  // namespace shaka
@@ -7,6 +7,7 @@
 #ifndef PACKAGER_FILE_HTTP_H_
 #define PACKAGER_FILE_HTTP_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -21,6 +22,8 @@ struct curl_slist;
 
 namespace shaka {
 
+class HttpEventLoop;
+
 enum class HttpMethod {
   kGet,
   kPost,
@@ -71,12 +74,27 @@ class HttpFile : public File {
 
  private:
   struct CurlDelete {
-    void operator()(CURL* curl);
     void operator()(curl_slist* headers);
   };
 
   void SetupRequest();
   void ThreadMain();
+  // Records the result of the transfer and unblocks Close.  |result| is the
+  // CURLcode of the transfer.
+  void OnTransferDone(int result);
+
+  // Non-blocking libcurl callbacks, used when the transfer is driven by an
+  // HttpEventLoop.  They pause the transfer instead of waiting on the caches.
+  static size_t NonBlockingWriteCallback(char* buffer,
+                                         size_t size,
+                                         size_t nmemb,
+                                         void* user);
+  static size_t NonBlockingReadCallback(char* buffer,
+                                        size_t size,
+                                        size_t nitems,
+                                        void* user);
+  // Asks the event loop to resume the transfer if |paused| was set.
+  void ResumeIfPaused(std::atomic<bool>* paused);
 
   const std::string url_;
   const std::string upload_content_type_;
@@ -85,7 +103,8 @@ class HttpFile : public File {
   const bool isUpload_;
   IoCache download_cache_;
   IoCache upload_cache_;
-  std::unique_ptr<CURL, CurlDelete> curl_;
+  // Borrowed from HttpConnectionPool, and returned to it on destruction.
+  CURL* curl_;
   // The headers need to remain alive for the duration of the request.
   std::unique_ptr<curl_slist, CurlDelete> request_headers_;
   Status status_;
@@ -95,6 +114,19 @@ class HttpFile : public File {
   std::string client_cert_private_key_file_;
   std::string client_cert_private_key_password_;
 
+  // Set when the transfer is driven by an event loop instead of a thread.
+  HttpEventLoop* event_loop_ = nullptr;
+  // Identifies the transfer in |event_loop_|.  Unlike |curl_|, it is never
+  // reused, so a late resume cannot reach the next transfer of the handle.
+  uint64_t transfer_id_ = 0;
+  // Set by the non-blocking callbacks when they pause the transfer.
+  std::atomic<bool> upload_paused_{false};
+  std::atomic<bool> download_paused_{false};
+  // Bytes of the data last passed to NonBlockingWriteCallback which are already
+  // in |download_cache_|.  libcurl passes the data again when the transfer is
+  // resumed, so that data larger than the cache is written in parts.
+  size_t download_offset_ = 0;
+
   // Signaled when the "curl easy perform" task completes.
   absl::Notification task_exit_event_;
 };
@@ -9,15 +9,21 @@
 #include <memory>
 #include <vector>
 
+#include <absl/flags/declare.h>
+#include <absl/flags/flag.h>
 #include <absl/strings/str_split.h>
 #include <gtest/gtest.h>
 #include <nlohmann/json.hpp>
 
 #include <packager/file.h>
 #include <packager/file/file_closer.h>
+#include <packager/flag_saver.h>
 #include <packager/macros/logging.h>
 #include <packager/media/test/test_web_server.h>
 
+ABSL_DECLARE_FLAG(uint32_t, http_event_loop_threads);
+ABSL_DECLARE_FLAG(uint64_t, io_cache_size);
+
 #define ASSERT_JSON_STRING(json, key, value) \
   ASSERT_EQ(GetJsonString((json), (key)), (value)) << "JSON is " << (json)
 
@@ -84,6 +90,17 @@ class HttpFileTest : public testing::Test {
   media::TestWebServer server_;
 };
 
+// Drives all transfers from event loop threads instead of one thread per file.
+class HttpFileEventLoopTest : public HttpFileTest {
+ protected:
+  void SetUp() override {
+    HttpFileTest::SetUp();
+    absl::SetFlag(&FLAGS_http_event_loop_threads, 2);
+  }
+
+  FlagSaver<uint32_t> saver_{&FLAGS_http_event_loop_threads};
+};
+
 }  // namespace
 
 TEST_F(HttpFileTest, BasicGet) {
@@ -328,4 +345,129 @@ TEST_F(HttpFileTest, TimeoutNotTriggered) {
   ASSERT_TRUE(file.release()->Close());
 }
 
+TEST_F(HttpFileEventLoopTest, BasicGet) {
+  FilePtr file(new HttpFile(HttpMethod::kGet, server_.ReflectUrl(),
+                            kNoContentType, kNoHeaders, kDefaultTestTimeout));
+  ASSERT_TRUE(file);
+  ASSERT_TRUE(file->Open());
+
+  auto json = HandleResponse(file);
+  ASSERT_TRUE(json.is_object());
+  ASSERT_TRUE(file.release()->Close());
+  ASSERT_JSON_STRING(json, "method", "GET");
+}
+
+TEST_F(HttpFileEventLoopTest, ResponseLargerThanCache) {
+  FlagSaver<uint64_t> saver(&FLAGS_io_cache_size);
+  // Much smaller than the response, so that the response has to be written to
+  // the cache in parts.
+  absl::SetFlag(&FLAGS_io_cache_size, 16);
+
+  FilePtr file(new HttpFile(HttpMethod::kGet, server_.ReflectUrl(),
+                            kNoContentType, kNoHeaders, kDefaultTestTimeout));
+  ASSERT_TRUE(file);
+  ASSERT_TRUE(file->Open());
+
+  auto json = HandleResponse(file);
+  ASSERT_TRUE(json.is_object());
+  ASSERT_TRUE(file.release()->Close());
+  ASSERT_JSON_STRING(json, "method", "GET");
+}
+
+TEST_F(HttpFileEventLoopTest, UploadAndResponseLargerThanCache) {
+  FlagSaver<uint64_t> saver(&FLAGS_io_cache_size);
+  // Both the upload and the reflected response are much larger than the
+  // caches, so the transfer is paused and resumed many times each way.
+  absl::SetFlag(&FLAGS_io_cache_size, 64);
+
+  FilePtr file(new HttpFile(HttpMethod::kPut, server_.ReflectUrl(),
+                            kBinaryContentType, kNoHeaders,
+                            kDefaultTestTimeout));
+  ASSERT_TRUE(file);
+  ASSERT_TRUE(file->Open());
+
+  std::string data(100000, 0);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = 'a' + i % 26;
+  // Each write is larger than the cache, so it waits for the upload to make
+  // room.
+  const size_t kWriteSize = 1000;
+  for (size_t offset = 0; offset < data.size(); offset += kWriteSize) {
+    ASSERT_EQ(file->Write(data.data() + offset, kWriteSize),
+              static_cast<int64_t>(kWriteSize));
+  }
+  file->CloseForWriting();
+
+  auto json = HandleResponse(file);
+  ASSERT_TRUE(json.is_object());
+  ASSERT_TRUE(file.release()->Close());
+  ASSERT_JSON_STRING(json, "body", data);
+}
+
+TEST_F(HttpFileEventLoopTest, MultipleChunks) {
+  FilePtr file(new HttpFile(HttpMethod::kPut, server_.ReflectUrl(),
+                            kBinaryContentType, kNoHeaders,
+                            kDefaultTestTimeout));
+  ASSERT_TRUE(file);
+  ASSERT_TRUE(file->Open());
+
+  const std::string data1 = "abcd";
+  const std::string data2 = "efgh";
+
+  ASSERT_EQ(file->Write(data1.data(), data1.size()),
+            static_cast<int64_t>(data1.size()));
+  ASSERT_TRUE(file->Flush());
+  ASSERT_EQ(file->Write(data2.data(), data2.size()),
+            static_cast<int64_t>(data2.size()));
+  ASSERT_TRUE(file->Flush());
+  file->CloseForWriting();
+
+  auto json = HandleResponse(file);
+  ASSERT_TRUE(json.is_object());
+  ASSERT_TRUE(file.release()->Close());
+
+  ASSERT_JSON_STRING(json, "method", "PUT");
+  ASSERT_JSON_STRING(json, "body", data1 + data2);
+  ASSERT_JSON_STRING(json, "headers.Transfer-Encoding", "chunked");
+}
+
+TEST_F(HttpFileEventLoopTest, ConcurrentUploads) {
+  const int kNumFiles = 16;
+  std::vector<FilePtr> files;
+  for (int i = 0; i < kNumFiles; ++i) {
+    files.emplace_back(new HttpFile(HttpMethod::kPut, server_.ReflectUrl(),
+                                    kBinaryContentType, kNoHeaders,
+                                    kDefaultTestTimeout));
+    ASSERT_TRUE(files.back()->Open());
+  }
+
+  // Interleave writes across all of the open files.
+  for (int i = 0; i < kNumFiles; ++i) {
+    const std::string data = "file" + std::to_string(i);
+    ASSERT_EQ(files[i]->Write(data.data(), data.size()),
+              static_cast<int64_t>(data.size()));
+  }
+  for (int i = 0; i < kNumFiles; ++i) {
+    files[i]->CloseForWriting();
+    auto json = HandleResponse(files[i]);
+    ASSERT_TRUE(json.is_object());
+    ASSERT_TRUE(files[i].release()->Close());
+    ASSERT_JSON_STRING(json, "body", "file" + std::to_string(i));
+  }
+}
+
+TEST_F(HttpFileEventLoopTest, Error404) {
+  FilePtr file(new HttpFile(HttpMethod::kGet, server_.StatusCodeUrl(404),
+                            kNoContentType, kNoHeaders, kDefaultTestTimeout));
+  ASSERT_TRUE(file);
+  ASSERT_TRUE(file->Open());
+
+  uint8_t buffer[1];
+  ASSERT_EQ(file->Read(buffer, sizeof(buffer)), 0);
+
+  auto status = file.release()->CloseWithStatus();
+  ASSERT_FALSE(status.ok());
+  ASSERT_EQ(status.error_code(), error::HTTP_FAILURE);
+}
+
 }  // namespace shaka
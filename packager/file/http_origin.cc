@@ -0,0 +1,295 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/http_origin.h>
+
+#include <string_view>
+#include <vector>
+
+#include <absl/flags/flag.h>
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/strings/match.h>
+#include <absl/strings/str_split.h>
+#include <mongoose.h>
+
+ABSL_FLAG(std::string,
+          origin_listen_address,
+          "http://127.0.0.1:8080",
+          "Address the embedded HTTP origin listens on, used when outputs are "
+          "written to origin:// paths. Use http://0.0.0.0:<port> to accept "
+          "connections from other hosts, e.g. a CDN.");
+
+namespace shaka {
+
+namespace {
+
+// How long the server thread waits for socket activity before checking for
+// termination.
+const int kPollIntervalMs = 100;
+
+std::string_view MongooseStringView(const mg_str& mg_string) {
+  return std::string_view(mg_string.ptr, mg_string.len);
+}
+
+const char* GetContentType(std::string_view path) {
+  static const struct {
+    const char* extension;
+    const char* content_type;
+  } kContentTypes[] = {
+      {".mpd", "application/dash+xml"},
+      {".m3u8", "application/vnd.apple.mpegurl"},
+      {".m4s", "video/iso.segment"},
+      {".mp4", "video/mp4"},
+      {".m4a", "audio/mp4"},
+      {".m4v", "video/mp4"},
+      {".ts", "video/mp2t"},
+      {".aac", "audio/aac"},
+      {".ac3", "audio/ac3"},
+      {".ec3", "audio/eac3"},
+      {".vtt", "text/vtt"},
+      {".ttml", "application/ttml+xml"},
+  };
+  for (const auto& entry : kContentTypes) {
+    if (absl::EndsWithIgnoreCase(path, entry.extension))
+      return entry.content_type;
+  }
+  return "application/octet-stream";
+}
+
+// Manifests are updated continuously in live streams, so they must not be
+// cached for long.  Segments do not change once published, but their names
+// repeat under $Number$ templates, e.g. when a channel restarts, so they are
+// not cached for long either.
+const char kManifestCacheControl[] = "max-age=1";
+const char kSegmentCacheControl[] = "max-age=60";
+
+bool IsManifest(std::string_view path) {
+  return absl::EndsWithIgnoreCase(path, ".mpd") ||
+         absl::EndsWithIgnoreCase(path, ".m3u8");
+}
+
+// Returns true if |path| is a name generated by |segment_template|, e.g.
+// "live/video_12.m4s" for "live/video_$Number$.m4s".  Each $Identifier$ of the
+// template matches any text, and "$$" matches "$".
+bool MatchesSegmentTemplate(std::string_view path,
+                            std::string_view segment_template) {
+  // The literal parts of the template, which are separated by identifiers.
+  std::vector<std::string> parts(1);
+  const std::vector<std::string_view> tokens =
+      absl::StrSplit(segment_template, '$');
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    if (i % 2 == 0) {
+      parts.back().append(tokens[i].data(), tokens[i].size());
+    } else if (tokens[i].empty()) {
+      parts.back().append("$");
+    } else {
+      parts.emplace_back();
+    }
+  }
+  // An unbalanced '$', i.e. not a template.
+  if (tokens.size() % 2 == 0 || parts.size() == 1)
+    return false;
+
+  if (!absl::StartsWith(path, parts.front()))
+    return false;
+  size_t position = parts.front().size();
+  for (size_t i = 1; i + 1 < parts.size(); ++i) {
+    position = path.find(parts[i], position);
+    if (position == std::string_view::npos)
+      return false;
+    position += parts[i].size();
+  }
+  return path.size() >= position + parts.back().size() &&
+         absl::EndsWith(path, parts.back());
+}
+
+}  // namespace
+
+// static
+HttpOrigin* HttpOrigin::GetInstance() {
+  static HttpOrigin instance;
+  return &instance;
+}
+
+HttpOrigin::HttpOrigin()
+    : next_retention_id_(0),
+      state_(kNew),
+      terminated_(false),
+      port_(0) {}
+
+HttpOrigin::~HttpOrigin() {
+  {
+    absl::MutexLock lock(mutex_);
+    terminated_ = true;
+  }
+  if (thread_)
+    thread_->join();
+}
+
+bool HttpOrigin::Start() {
+  absl::MutexLock lock(mutex_);
+  if (state_ == kNew && !thread_)
+    thread_.reset(new std::thread(&HttpOrigin::ThreadMain, this));
+  while (state_ == kNew)
+    state_changed_.Wait(&mutex_);
+  return state_ == kStarted;
+}
+
+void HttpOrigin::Publish(const std::string& path, Object contents) {
+  DCHECK(contents);
+  const absl::Time now = absl::Now();
+
+  absl::MutexLock lock(mutex_);
+  const absl::Time expiration_time = GetExpirationTime(path, now);
+  objects_[path] = Entry{std::move(contents), expiration_time};
+  if (expiration_time != absl::InfiniteFuture())
+    expirations_.emplace(expiration_time, path);
+  EvictExpiredObjects(now);
+}
+
+HttpOrigin::Object HttpOrigin::Get(const std::string& path) {
+  absl::MutexLock lock(mutex_);
+  auto iter = objects_.find(path);
+  return iter == objects_.end() ? nullptr : iter->second.contents;
+}
+
+bool HttpOrigin::Remove(const std::string& path) {
+  absl::MutexLock lock(mutex_);
+  return objects_.erase(path) > 0;
+}
+
+void HttpOrigin::RemoveAll() {
+  absl::MutexLock lock(mutex_);
+  objects_.clear();
+  expirations_.clear();
+}
+
+int HttpOrigin::AddRetention(const std::vector<std::string>& segment_templates,
+                             absl::Duration retention) {
+  absl::MutexLock lock(mutex_);
+  const int id = next_retention_id_++;
+  retentions_[id] = Retention{segment_templates, retention};
+  return id;
+}
+
+void HttpOrigin::RemoveRetention(int id) {
+  absl::MutexLock lock(mutex_);
+  retentions_.erase(id);
+}
+
+int HttpOrigin::port() {
+  absl::MutexLock lock(mutex_);
+  return port_;
+}
+
+absl::Time HttpOrigin::GetExpirationTime(const std::string& path,
+                                         absl::Time now) {
+  for (const auto& entry : retentions_) {
+    const Retention& retention = entry.second;
+    for (const std::string& segment_template : retention.segment_templates) {
+      if (MatchesSegmentTemplate(path, segment_template))
+        return now + retention.retention;
+    }
+  }
+  return absl::InfiniteFuture();
+}
+
+void HttpOrigin::EvictExpiredObjects(absl::Time now) {
+  while (!expirations_.empty() && expirations_.begin()->first <= now) {
+    auto iter = objects_.find(expirations_.begin()->second);
+    // Skip objects which have been republished since, or removed.
+    if (iter != objects_.end() &&
+        iter->second.expiration_time == expirations_.begin()->first) {
+      VLOG(1) << "Evicting " << iter->first << " from the HTTP origin.";
+      objects_.erase(iter);
+    }
+    expirations_.erase(expirations_.begin());
+  }
+}
+
+void HttpOrigin::ThreadMain() {
+  std::unique_ptr<struct mg_mgr, decltype(&mg_mgr_free)> manager(
+      new struct mg_mgr, mg_mgr_free);
+  mg_mgr_init(manager.get());
+
+  const std::string address = absl::GetFlag(FLAGS_origin_listen_address);
+  struct mg_connection* listener = mg_http_listen(
+      manager.get(), address.c_str(), &HttpOrigin::HandleEvent, this);
+
+  {
+    absl::MutexLock lock(mutex_);
+    if (!listener) {
+      LOG(ERROR) << "HTTP origin failed to listen on " << address;
+      state_ = kFailed;
+      state_changed_.SignalAll();
+      return;
+    }
+    port_ = mg_ntohs(listener->loc.port);
+    state_ = kStarted;
+    state_changed_.SignalAll();
+  }
+  LOG(INFO) << "HTTP origin listening on " << address << " (port " << port()
+            << ").";
+
+  while (true) {
+    mg_mgr_poll(manager.get(), kPollIntervalMs);
+
+    absl::MutexLock lock(mutex_);
+    if (terminated_)
+      break;
+  }
+}
+
+// static
+void HttpOrigin::HandleEvent(struct mg_connection* connection,
+                             int event,
+                             void* event_data,
+                             void* callback_data) {
+  if (event != MG_EV_HTTP_MSG)
+    return;
+  static_cast<HttpOrigin*>(callback_data)
+      ->HandleRequest(static_cast<struct mg_http_message*>(event_data),
+                      connection);
+}
+
+void HttpOrigin::HandleRequest(struct mg_http_message* message,
+                               struct mg_connection* connection) {
+  const std::string_view method = MongooseStringView(message->method);
+  const bool is_head = method == "HEAD";
+  if (method != "GET" && !is_head) {
+    mg_http_reply(connection, 405 /* method not allowed */,
+                  "Allow: GET, HEAD\r\n", "");
+    return;
+  }
+
+  std::string_view path = MongooseStringView(message->uri);
+  if (absl::StartsWith(path, "/"))
+    path.remove_prefix(1);
+
+  // The reference keeps the object alive while it is copied to the
+  // connection, even if it is replaced or evicted meanwhile.
+  Object contents = Get(std::string(path));
+  if (!contents) {
+    mg_http_reply(connection, 404 /* not found */, "", "");
+    return;
+  }
+
+  mg_printf(connection,
+            "HTTP/1.1 200 OK\r\n"
+            "Content-Type: %s\r\n"
+            "Content-Length: %lu\r\n"
+            "Cache-Control: %s\r\n"
+            "Access-Control-Allow-Origin: *\r\n"
+            "\r\n",
+            GetContentType(path),
+            static_cast<unsigned long>(contents->size()),
+            IsManifest(path) ? kManifestCacheControl : kSegmentCacheControl);
+  if (!is_head)
+    mg_send(connection, contents->data(), contents->size());
+}
+
+}  // namespace shaka
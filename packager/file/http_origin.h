@@ -0,0 +1,131 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_HTTP_ORIGIN_H_
+#define PACKAGER_FILE_HTTP_ORIGIN_H_
+
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
+
+#include <packager/macros/classes.h>
+
+// Forward declare mongoose struct types, used as pointers below.
+struct mg_connection;
+struct mg_http_message;
+
+namespace shaka {
+
+/// An in-process HTTP origin which serves segments and manifests straight from
+/// memory, so that a CDN can pull them without a write-to-disk-then-serve hop.
+/// Objects are published under their path, e.g. "live/video_1.m4s" is served
+/// at "/live/video_1.m4s".  Published objects are immutable and replaced as a
+/// whole, so clients never see partially written objects.
+///
+/// The server listens on --origin_listen_address and is started the first
+/// time it is needed.
+class HttpOrigin {
+ public:
+  typedef std::shared_ptr<const std::string> Object;
+
+  /// @return The process-wide origin.
+  static HttpOrigin* GetInstance();
+
+  /// Starts the server if it is not running yet.
+  /// @return true if the server is running, false if it failed to start.
+  bool Start();
+
+  /// Publishes @a contents under @a path, replacing any previous object, and
+  /// evicts the segments which have expired.  Objects are kept until they are
+  /// replaced or removed, unless @a path matches a segment template of a
+  /// retention.
+  void Publish(const std::string& path, Object contents);
+
+  /// @return The object published under @a path, or nullptr if there is none.
+  Object Get(const std::string& path);
+
+  /// Removes the object published under @a path.
+  /// @return true if there was such an object.
+  bool Remove(const std::string& path);
+
+  /// Removes all published objects.
+  void RemoveAll();
+
+  /// Evicts the segments published under @a segment_templates, e.g.
+  /// "live/video_$Number$.m4s", once they were published @a retention ago.
+  /// Each channel adds its own retention, so that channels with different
+  /// live windows can share the origin.  Init segments and manifests do not
+  /// match segment templates, so they are kept.
+  /// @return The id of the retention, to be passed to RemoveRetention.
+  int AddRetention(const std::vector<std::string>& segment_templates,
+                   absl::Duration retention);
+
+  /// Stops applying the retention @a id to segments published from now on.
+  /// Segments published before are still evicted when they expire.
+  void RemoveRetention(int id);
+
+  /// @return The port the server listens on, or 0 if it is not running.
+  int port();
+
+ private:
+  struct Entry {
+    Object contents;
+    // absl::InfiniteFuture() if the object does not expire.
+    absl::Time expiration_time;
+  };
+
+  struct Retention {
+    std::vector<std::string> segment_templates;
+    absl::Duration retention;
+  };
+
+  HttpOrigin();
+  ~HttpOrigin();
+
+  void ThreadMain();
+  absl::Time GetExpirationTime(const std::string& path, absl::Time now)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void EvictExpiredObjects(absl::Time now)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  static void HandleEvent(struct mg_connection* connection,
+                          int event,
+                          void* event_data,
+                          void* callback_data);
+  void HandleRequest(struct mg_http_message* message,
+                     struct mg_connection* connection);
+
+  enum State {
+    kNew,
+    kFailed,
+    kStarted,
+  };
+
+  absl::Mutex mutex_;
+  std::map<std::string, Entry> objects_ ABSL_GUARDED_BY(mutex_);
+  // Paths of the objects which expire, by expiration time.  A path may be
+  // listed more than once if it was replaced.
+  std::multimap<absl::Time, std::string> expirations_ ABSL_GUARDED_BY(mutex_);
+  std::map<int, Retention> retentions_ ABSL_GUARDED_BY(mutex_);
+  int next_retention_id_ ABSL_GUARDED_BY(mutex_);
+
+  State state_ ABSL_GUARDED_BY(mutex_);
+  absl::CondVar state_changed_ ABSL_GUARDED_BY(mutex_);
+  bool terminated_ ABSL_GUARDED_BY(mutex_);
+  int port_ ABSL_GUARDED_BY(mutex_);
+  std::unique_ptr<std::thread> thread_;
+
+  DISALLOW_COPY_AND_ASSIGN(HttpOrigin);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_HTTP_ORIGIN_H_
@@ -18,13 +18,15 @@ namespace shaka {
 
 IoCache::IoCache(uint64_t cache_size)
     : cache_size_(cache_size),
-      // Make the buffer one byte larger than the cache so that when the
-      // condition r_ptr == w_ptr is unambiguous (buffer empty).
-      circular_buffer_(cache_size + 1),
-      end_ptr_(&circular_buffer_[0] + cache_size + 1),
-      r_ptr_(circular_buffer_.data()),
-      w_ptr_(circular_buffer_.data()),
-      closed_(false) {}
+      // Positions are absolute, so the buffer does not need a spare byte to
+      // tell a full buffer from an empty one.  Keep it non-empty anyway, so
+      // that offsets can always be computed.
+      circular_buffer_(std::max<uint64_t>(cache_size, 1)),
+      read_pos_(0),
+      write_pos_(0),
+      closed_(false),
+      reader_waiting_(false),
+      writer_waiting_(false) {}
 
 IoCache::~IoCache() {
   Close();
@@ -33,27 +35,28 @@ IoCache::~IoCache() {
 uint64_t IoCache::Read(void* buffer, uint64_t size) {
   DCHECK(buffer);
 
-  absl::MutexLock lock(mutex_);
-  while (!closed_ && (BytesCachedInternal() == 0)) {
-    write_event_.Wait(&mutex_);
+  const uint64_t read_pos = read_pos_.load(std::memory_order_relaxed);
+  uint64_t write_pos = write_pos_.load(std::memory_order_acquire);
+  if (write_pos == read_pos) {
+    WaitForData(read_pos);
+    write_pos = write_pos_.load(std::memory_order_acquire);
   }
 
-  size = std::min(size, BytesCachedInternal());
-  uint64_t first_chunk_size(
-      std::min(size, static_cast<uint64_t>(end_ptr_ - r_ptr_)));
-  memcpy(buffer, r_ptr_, first_chunk_size);
-  r_ptr_ += first_chunk_size;
-  DCHECK_GE(end_ptr_, r_ptr_);
-  if (r_ptr_ == end_ptr_)
-    r_ptr_ = &circular_buffer_[0];
-  uint64_t second_chunk_size(size - first_chunk_size);
+  size = std::min(size, write_pos - read_pos);
+  const uint64_t offset = read_pos % circular_buffer_.size();
+  const uint64_t first_chunk_size =
+      std::min(size, circular_buffer_.size() - offset);
+  memcpy(buffer, &circular_buffer_[offset], first_chunk_size);
+  const uint64_t second_chunk_size = size - first_chunk_size;
   if (second_chunk_size) {
-    memcpy(static_cast<uint8_t*>(buffer) + first_chunk_size, r_ptr_,
-           second_chunk_size);
-    r_ptr_ += second_chunk_size;
-    DCHECK_GT(end_ptr_, r_ptr_);
+    memcpy(static_cast<uint8_t*>(buffer) + first_chunk_size,
+           circular_buffer_.data(), second_chunk_size);
+  }
+
+  if (size) {
+    read_pos_.store(read_pos + size);
+    SignalDataRead();
   }
-  read_event_.Signal();
   return size;
 }
 
@@ -63,83 +66,107 @@ uint64_t IoCache::Write(const void* buffer, uint64_t size) {
   const uint8_t* r_ptr(static_cast<const uint8_t*>(buffer));
   uint64_t bytes_left(size);
   while (bytes_left) {
-    absl::MutexLock lock(mutex_);
-    while (!closed_ && (BytesFreeInternal() == 0)) {
+    const uint64_t write_pos = write_pos_.load(std::memory_order_relaxed);
+    uint64_t bytes_cached =
+        write_pos - read_pos_.load(std::memory_order_acquire);
+    if (bytes_cached >= cache_size_ && !closed_.load()) {
       VLOG(1) << "Circular buffer is full, which can happen if data arrives "
                  "faster than being consumed by packager. Ignore if it is not "
                  "live packaging. Otherwise, try increasing --io_cache_size.";
-      read_event_.Wait(&mutex_);
+      WaitForBytesCachedBelow(cache_size_);
+      bytes_cached = write_pos - read_pos_.load(std::memory_order_acquire);
     }
-    if (closed_)
+    if (closed_.load())
       return 0;
 
-    uint64_t write_size(std::min(bytes_left, BytesFreeInternal()));
-    uint64_t first_chunk_size(
-        std::min(write_size, static_cast<uint64_t>(end_ptr_ - w_ptr_)));
-    memcpy(w_ptr_, r_ptr, first_chunk_size);
-    w_ptr_ += first_chunk_size;
-    DCHECK_GE(end_ptr_, w_ptr_);
-    if (w_ptr_ == end_ptr_)
-      w_ptr_ = &circular_buffer_[0];
+    const uint64_t write_size = std::min(bytes_left, cache_size_ - bytes_cached);
+    const uint64_t offset = write_pos % circular_buffer_.size();
+    const uint64_t first_chunk_size =
+        std::min(write_size, circular_buffer_.size() - offset);
+    memcpy(&circular_buffer_[offset], r_ptr, first_chunk_size);
     r_ptr += first_chunk_size;
-    uint64_t second_chunk_size(write_size - first_chunk_size);
+    const uint64_t second_chunk_size = write_size - first_chunk_size;
     if (second_chunk_size) {
-      memcpy(w_ptr_, r_ptr, second_chunk_size);
-      w_ptr_ += second_chunk_size;
-      DCHECK_GT(end_ptr_, w_ptr_);
+      memcpy(circular_buffer_.data(), r_ptr, second_chunk_size);
       r_ptr += second_chunk_size;
     }
+
+    write_pos_.store(write_pos + write_size);
+    SignalDataWritten();
     bytes_left -= write_size;
-    write_event_.Signal();
   }
   return size;
 }
 
 void IoCache::Clear() {
-  absl::MutexLock lock(mutex_);
-  r_ptr_ = w_ptr_ = circular_buffer_.data();
+  read_pos_.store(write_pos_.load());
   // Let any writers know that there is room in the cache.
-  read_event_.Signal();
+  SignalDataRead();
 }
 
 void IoCache::Close() {
+  closed_.store(true);
   absl::MutexLock lock(mutex_);
-  closed_ = true;
-  read_event_.Signal();
-  write_event_.Signal();
+  read_event_.SignalAll();
+  write_event_.SignalAll();
 }
 
 void IoCache::Reopen() {
-  absl::MutexLock lock(mutex_);
-  CHECK(closed_);
-  r_ptr_ = w_ptr_ = circular_buffer_.data();
-  closed_ = false;
+  CHECK(closed_.load());
+  read_pos_.store(0);
+  write_pos_.store(0);
+  closed_.store(false);
 }
 
 uint64_t IoCache::BytesCached() {
-  absl::MutexLock lock(mutex_);
-  return BytesCachedInternal();
+  // Load the read position first.  Both positions only grow, so the
+  // difference can't be negative, but it can be stale and exceed the size.
+  const uint64_t read_pos = read_pos_.load();
+  const uint64_t write_pos = write_pos_.load();
+  return std::min(write_pos - read_pos, cache_size_);
 }
 
 uint64_t IoCache::BytesFree() {
-  absl::MutexLock lock(mutex_);
-  return BytesFreeInternal();
+  return cache_size_ - BytesCached();
 }
 
-uint64_t IoCache::BytesCachedInternal() {
-  return (r_ptr_ <= w_ptr_)
-             ? w_ptr_ - r_ptr_
-             : (end_ptr_ - r_ptr_) + (w_ptr_ - circular_buffer_.data());
+void IoCache::WaitUntilEmptyOrClosed() {
+  WaitForBytesCachedBelow(1);
 }
 
-uint64_t IoCache::BytesFreeInternal() {
-  return cache_size_ - BytesCachedInternal();
+// The waits below set a flag and then check the condition, while the other
+// side updates its position and then checks the flag.  With sequentially
+// consistent atomics, either the waiter sees the update, or the other side
+// sees the flag and takes the mutex to signal.  The waiter holds the mutex
+// from setting the flag until it blocks, so the signal can't be lost.
+
+void IoCache::WaitForData(uint64_t read_pos) {
+  absl::MutexLock lock(mutex_);
+  reader_waiting_.store(true);
+  while (!closed_.load() && write_pos_.load() == read_pos)
+    write_event_.Wait(&mutex_);
+  reader_waiting_.store(false);
 }
 
-void IoCache::WaitUntilEmptyOrClosed() {
+void IoCache::WaitForBytesCachedBelow(uint64_t bytes) {
   absl::MutexLock lock(mutex_);
-  while (!closed_ && BytesCachedInternal()) {
+  writer_waiting_.store(true);
+  while (!closed_.load() && write_pos_.load() - read_pos_.load() >= bytes)
     read_event_.Wait(&mutex_);
+  writer_waiting_.store(false);
+}
+
+void IoCache::SignalDataWritten() {
+  if (reader_waiting_.load()) {
+    absl::MutexLock lock(mutex_);
+    write_event_.Signal();
+  }
+}
+
+void IoCache::SignalDataRead() {
+  if (writer_waiting_.load()) {
+    absl::MutexLock lock(mutex_);
+    read_event_.Signal();
   }
 }
 
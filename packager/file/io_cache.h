@@ -7,6 +7,7 @@
 #ifndef PACKAGER_FILE_IO_CACHE_H_
 #define PACKAGER_FILE_IO_CACHE_H_
 
+#include <atomic>
 #include <cstdint>
 #include <vector>
 
@@ -17,6 +18,13 @@
 namespace shaka {
 
 /// Declaration of class which implements a thread-safe circular buffer.
+///
+/// The cache is lock-free for exactly one producer thread (calling Write and
+/// WaitUntilEmptyOrClosed) and one consumer thread (calling Read and Clear).
+/// The read and write positions live on separate cache lines, and a mutex is
+/// only taken to block when the cache is empty or full, and by the other side
+/// to wake up a blocked thread.  Close, closed, BytesCached and BytesFree may
+/// be called from any thread.
 class IoCache {
  public:
   explicit IoCache(uint64_t cache_size);
@@ -39,7 +47,7 @@ class IoCache {
   ///         closed.
   uint64_t Write(const void* buffer, uint64_t size);
 
-  /// Empties the cache.
+  /// Empties the cache.  Must be called by the consumer.
   void Clear();
 
   /// Close the cache. This will call any blocking calls to unblock, and the
@@ -47,9 +55,10 @@ class IoCache {
   void Close();
 
   /// @return true if the cache is closed, false otherwise.
-  bool closed() { return closed_; }
+  bool closed() { return closed_.load(); }
 
-  /// Reopens the cache. Any data still in the cache will be lost.
+  /// Reopens the cache. Any data still in the cache will be lost.  Neither the
+  /// producer nor the consumer may be using the cache during this call.
   void Reopen();
 
   /// Returns the number of bytes in the cache.
@@ -60,22 +69,44 @@ class IoCache {
   /// @return the number of free bytes in the cache.
   uint64_t BytesFree();
 
-  /// Waits until the cache is empty or has been closed.
+  /// @return the capacity of the cache.
+  uint64_t cache_size() const { return cache_size_; }
+
+  /// Waits until the cache is empty or has been closed.  Must be called by
+  /// the producer.
   void WaitUntilEmptyOrClosed();
 
  private:
-  uint64_t BytesCachedInternal();
-  uint64_t BytesFreeInternal();
+  // Keeps the positions, which are written by different threads, from sharing
+  // a cache line.
+  static constexpr size_t kCacheLineSize = 64;
+
+  // Blocks the consumer until there is data past |read_pos|, or the cache is
+  // closed.
+  void WaitForData(uint64_t read_pos);
+  // Blocks the producer until fewer than |bytes| bytes are cached, or the cache
+  // is closed.
+  void WaitForBytesCachedBelow(uint64_t bytes);
+  // Wake up the other side, if it is blocked.
+  void SignalDataWritten();
+  void SignalDataRead();
 
   const uint64_t cache_size_;
+  std::vector<uint8_t> circular_buffer_;
+
+  // Total number of bytes read and written since the cache was (re)opened.
+  // The offset in |circular_buffer_| is the position modulo its size.
+  alignas(kCacheLineSize) std::atomic<uint64_t> read_pos_;
+  alignas(kCacheLineSize) std::atomic<uint64_t> write_pos_;
+  alignas(kCacheLineSize) std::atomic<bool> closed_;
+  // Set while the consumer or the producer is blocked.
+  std::atomic<bool> reader_waiting_;
+  std::atomic<bool> writer_waiting_;
+
+  // Only used to block and wake up the consumer or the producer.
   absl::Mutex mutex_;
-  absl::CondVar read_event_ ABSL_GUARDED_BY(mutex_);
-  absl::CondVar write_event_ ABSL_GUARDED_BY(mutex_);
-  std::vector<uint8_t> circular_buffer_ ABSL_GUARDED_BY(mutex_);
-  const uint8_t* end_ptr_ ABSL_GUARDED_BY(mutex_);
-  uint8_t* r_ptr_ ABSL_GUARDED_BY(mutex_);
-  uint8_t* w_ptr_ ABSL_GUARDED_BY(mutex_);
-  bool closed_ ABSL_GUARDED_BY(mutex_);
+  absl::CondVar read_event_;
+  absl::CondVar write_event_;
 
   DISALLOW_COPY_AND_ASSIGN(IoCache);
 };
@@ -253,4 +253,49 @@ TEST_F(IoCacheTest, LargeRead) {
   cache_->Close();
 }
 
+TEST_F(IoCacheTest, StressRandomSizes) {
+  // Pushes a long, position-dependent byte sequence through the cache with
+  // write and read sizes that don't line up with each other or the cache size,
+  // so that both sides keep wrapping around and blocking on each other.
+  const uint64_t kTotalBytes = kCacheSize * 5000;
+  std::thread writer([this, kTotalBytes]() {
+    std::vector<uint8_t> buffer(kCacheSize * 2);
+    uint64_t position = 0;
+    uint32_t seed = 1;
+    while (position < kTotalBytes) {
+      seed = seed * 1103515245 + 12345;
+      const uint64_t size =
+          std::min<uint64_t>(1 + (seed >> 16) % buffer.size(),
+                             kTotalBytes - position);
+      for (uint64_t i = 0; i < size; ++i)
+        buffer[i] = static_cast<uint8_t>((position + i) * 7);
+      const uint64_t bytes_written = cache_->Write(buffer.data(), size);
+      EXPECT_EQ(size, bytes_written);
+      if (bytes_written != size)
+        break;
+      position += size;
+    }
+    cache_->Close();
+  });
+
+  std::vector<uint8_t> buffer(kCacheSize * 2);
+  uint64_t position = 0;
+  uint32_t seed = 2;
+  while (true) {
+    seed = seed * 1103515245 + 12345;
+    const uint64_t size = 1 + (seed >> 16) % buffer.size();
+    const uint64_t bytes_read = cache_->Read(buffer.data(), size);
+    if (bytes_read == 0)
+      break;
+    ASSERT_LE(bytes_read, size);
+    for (uint64_t i = 0; i < bytes_read; ++i) {
+      ASSERT_EQ(static_cast<uint8_t>((position + i) * 7), buffer[i])
+          << "at position " << position + i;
+    }
+    position += bytes_read;
+  }
+  writer.join();
+  EXPECT_EQ(kTotalBytes, position);
+}
+
 }  // namespace shaka
@@ -9,15 +9,24 @@
 #if defined(OS_WIN)
 #include <windows.h>
 #else
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #endif  // defined(OS_WIN)
 
+#include <algorithm>
 #include <cstdio>
 #include <filesystem>
+#include <vector>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 
+#include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
 
 namespace shaka {
@@ -65,6 +74,41 @@ int64_t LocalFile::Write(const void* buffer, uint64_t length) {
   return bytes_written;
 }
 
+int64_t LocalFile::WriteV(const WriteBuffer* buffers, size_t num_buffers) {
+#if defined(OS_WIN)
+  return File::WriteV(buffers, num_buffers);
+#else
+  DCHECK(internal_file_ != NULL);
+  // Data buffered in |internal_file_| must be written before the data written
+  // through its file descriptor.
+  if (fflush(internal_file_) != 0)
+    return -1;
+
+  std::vector<struct iovec> iovecs(
+      std::min<size_t>(num_buffers, static_cast<size_t>(IOV_MAX)));
+  for (size_t i = 0; i < iovecs.size(); ++i) {
+    iovecs[i].iov_base = const_cast<void*>(buffers[i].data);
+    iovecs[i].iov_len = buffers[i].length;
+  }
+  ssize_t bytes_written;
+  do {
+    bytes_written = writev(fileno(internal_file_), iovecs.data(),
+                           static_cast<int>(iovecs.size()));
+  } while (bytes_written < 0 && errno == EINTR);
+  VLOG(2) << "WriteV " << num_buffers << " buffers return " << bytes_written;
+
+  if (bytes_written > 0) {
+    // |internal_file_| may cache the position of its file descriptor, which
+    // the data written through the descriptor has moved.  Seek to the new
+    // position, so that Tell, Seek and later writes are not off.
+    const off_t position = lseek(fileno(internal_file_), 0, SEEK_CUR);
+    if (position < 0 || fseeko(internal_file_, position, SEEK_SET) != 0)
+      return -1;
+  }
+  return bytes_written;
+#endif  // defined(OS_WIN)
+}
+
 void LocalFile::CloseForWriting() {}
 
 int64_t LocalFile::Size() {
@@ -145,4 +189,44 @@ bool LocalFile::Delete(const char* file_name) {
   return std::filesystem::remove(file_path, ec);
 }
 
+// static
+std::shared_ptr<const uint8_t> LocalFile::Map(const char* file_name,
+                                              uint64_t* size) {
+  DCHECK(size);
+#if defined(OS_WIN)
+  UNUSED(file_name);
+  UNUSED(size);
+  return nullptr;
+#else
+  auto file_path = std::filesystem::u8path(file_name);
+  const int fd = open(file_path.u8string().c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    LOG(ERROR) << "Cannot open file " << file_name << " for mapping.";
+    return nullptr;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+    close(fd);
+    return nullptr;
+  }
+  const size_t mapped_size = static_cast<size_t>(info.st_size);
+  void* data = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping does not need the file descriptor to stay open.
+  close(fd);
+  if (data == MAP_FAILED) {
+    LOG(ERROR) << "Cannot map file " << file_name << ", error: " << errno;
+    return nullptr;
+  }
+  // Inputs are parsed front to back.
+  madvise(data, mapped_size, MADV_SEQUENTIAL);
+
+  *size = mapped_size;
+  return std::shared_ptr<const uint8_t>(
+      static_cast<const uint8_t*>(data),
+      [mapped_size](const uint8_t* data) {
+        munmap(const_cast<uint8_t*>(data), mapped_size);
+      });
+#endif  // defined(OS_WIN)
+}
+
 }  // namespace shaka
@@ -8,6 +8,7 @@
 #define PACKAGER_FILE_LOCAL_FILE_H_
 
 #include <cstdint>
+#include <memory>
 #include <string>
 
 #include <packager/file.h>
@@ -28,6 +29,7 @@ class LocalFile : public File {
   bool Close() override;
   int64_t Read(void* buffer, uint64_t length) override;
   int64_t Write(const void* buffer, uint64_t length) override;
+  int64_t WriteV(const WriteBuffer* buffers, size_t num_buffers) override;
   void CloseForWriting() override;
   int64_t Size() override;
   bool Flush() override;
@@ -40,6 +42,16 @@ class LocalFile : public File {
   /// @return true if successful, or false otherwise.
   static bool Delete(const char* file_name);
 
+  /// Map a local file into memory, read-only.
+  /// @param file_name is the path of the file to be mapped.
+  /// @param[out] size is set to the size of the file.
+  /// @return The mapped contents, which stay mapped until the last copy of the
+  ///         returned pointer, or of a pointer sharing ownership with it, is
+  ///         released.  nullptr on failure, for empty files, or if mapping
+  ///         files is not supported on this platform.
+  static std::shared_ptr<const uint8_t> Map(const char* file_name,
+                                            uint64_t* size);
+
  protected:
   ~LocalFile() override;
 
@@ -0,0 +1,119 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/origin_file.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+
+#include <packager/file/http_origin.h>
+#include <packager/macros/logging.h>
+
+namespace shaka {
+
+OriginFile::OriginFile(const char* file_name, const char* mode)
+    : File(file_name), mode_(mode), position_(0) {}
+
+OriginFile::~OriginFile() {}
+
+bool OriginFile::Close() {
+  if (write_data_) {
+    HttpOrigin::GetInstance()->Publish(file_name(), std::move(write_data_));
+  }
+  delete this;
+  return true;
+}
+
+int64_t OriginFile::Read(void* buffer, uint64_t length) {
+  if (!read_data_) {
+    LOG(ERROR) << "Origin file " << file_name() << " is not open for reading.";
+    return -1;
+  }
+  if (position_ >= read_data_->size())
+    return 0;
+
+  const uint64_t bytes_to_read =
+      std::min<uint64_t>(length, read_data_->size() - position_);
+  memcpy(buffer, read_data_->data() + position_, bytes_to_read);
+  position_ += bytes_to_read;
+  return bytes_to_read;
+}
+
+int64_t OriginFile::Write(const void* buffer, uint64_t length) {
+  if (!write_data_) {
+    LOG(ERROR) << "Origin file " << file_name() << " is not open for writing.";
+    return -1;
+  }
+  if (write_data_->size() < position_ + length)
+    write_data_->resize(position_ + length);
+  memcpy(&(*write_data_)[position_], buffer, length);
+  position_ += length;
+  return length;
+}
+
+void OriginFile::CloseForWriting() {}
+
+int64_t OriginFile::Size() {
+  if (write_data_)
+    return write_data_->size();
+  DCHECK(read_data_);
+  return read_data_->size();
+}
+
+bool OriginFile::Flush() {
+  return true;
+}
+
+bool OriginFile::Seek(uint64_t position) {
+  if (Size() < static_cast<int64_t>(position))
+    return false;
+
+  position_ = position;
+  return true;
+}
+
+bool OriginFile::Tell(uint64_t* position) {
+  *position = position_;
+  return true;
+}
+
+bool OriginFile::Open() {
+  position_ = 0;
+  if (mode_ == "r") {
+    read_data_ = HttpOrigin::GetInstance()->Get(file_name());
+    return read_data_ != nullptr;
+  }
+  if (mode_ != "w") {
+    NOTIMPLEMENTED() << "File mode '" << mode_
+                     << "' not supported by OriginFile";
+    return false;
+  }
+  if (!HttpOrigin::GetInstance()->Start())
+    return false;
+  write_data_ = std::make_shared<std::string>();
+  return true;
+}
+
+// static
+bool OriginFile::Delete(const char* file_name) {
+  HttpOrigin::GetInstance()->Remove(file_name);
+  return true;
+}
+
+// static
+bool OriginFile::WriteAtomically(const char* file_name,
+                                 const std::string& contents) {
+  if (!HttpOrigin::GetInstance()->Start())
+    return false;
+  HttpOrigin::GetInstance()->Publish(
+      file_name, std::make_shared<const std::string>(contents));
+  return true;
+}
+
+}  // namespace shaka
@@ -0,0 +1,69 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_ORIGIN_FILE_H_
+#define PACKAGER_FILE_ORIGIN_FILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <packager/file.h>
+#include <packager/macros/classes.h>
+
+namespace shaka {
+
+/// Implements a File which is served by the embedded HTTP origin.  Written
+/// data is kept in memory and published to the origin as a whole on Close, so
+/// that clients only ever see complete segments and manifests.  Opening a file
+/// for writing starts the origin if it is not running yet.
+///
+/// In read mode, the file reads the object currently published by the origin.
+class OriginFile : public File {
+ public:
+  /// @param file_name C string containing the path to be served, without the
+  ///        origin:// prefix.
+  /// @param mode C string containing the file access mode, "r" or "w".
+  OriginFile(const char* file_name, const char* mode);
+
+  /// @name File implementation overrides.
+  /// @{
+  bool Close() override;
+  int64_t Read(void* buffer, uint64_t length) override;
+  int64_t Write(const void* buffer, uint64_t length) override;
+  void CloseForWriting() override;
+  int64_t Size() override;
+  bool Flush() override;
+  bool Seek(uint64_t position) override;
+  bool Tell(uint64_t* position) override;
+  /// @}
+
+  /// Removes the object published under @a file_name from the origin.
+  static bool Delete(const char* file_name);
+
+  /// Publishes @a contents under @a file_name at once.
+  static bool WriteAtomically(const char* file_name,
+                              const std::string& contents);
+
+ protected:
+  ~OriginFile() override;
+
+  bool Open() override;
+
+ private:
+  std::string mode_;
+  // Data written so far, in write mode.
+  std::shared_ptr<std::string> write_data_;
+  // Published data, in read mode.
+  std::shared_ptr<const std::string> read_data_;
+  uint64_t position_;
+
+  DISALLOW_COPY_AND_ASSIGN(OriginFile);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_ORIGIN_FILE_H_
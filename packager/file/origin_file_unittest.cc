@@ -0,0 +1,143 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/origin_file.h>
+
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include <absl/flags/declare.h>
+#include <absl/flags/flag.h>
+#include <absl/strings/str_format.h>
+#include <gtest/gtest.h>
+
+#include <packager/file.h>
+#include <packager/file/file_closer.h>
+#include <packager/file/http_origin.h>
+
+ABSL_DECLARE_FLAG(std::string, origin_listen_address);
+
+namespace shaka {
+namespace {
+
+const char kSegmentData[] = "segment\0data";
+const size_t kSegmentDataSize = sizeof(kSegmentData) - 1;
+
+}  // namespace
+
+class OriginFileTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    // Let the system pick a port.  The origin is only started once per
+    // process, so this only has an effect on the first test.
+    absl::SetFlag(&FLAGS_origin_listen_address, "http://127.0.0.1:0");
+  }
+
+  void TearDown() override { HttpOrigin::GetInstance()->RemoveAll(); }
+
+  std::string OriginUrl(const std::string& path) {
+    return absl::StrFormat("http://127.0.0.1:%d/%s",
+                           HttpOrigin::GetInstance()->port(), path);
+  }
+};
+
+TEST_F(OriginFileTest, PublishedOnClose) {
+  std::unique_ptr<File, FileCloser> writer(
+      File::Open("origin://live/video_1.m4s", "w"));
+  ASSERT_TRUE(writer);
+  ASSERT_EQ(static_cast<int64_t>(kSegmentDataSize),
+            writer->Write(kSegmentData, kSegmentDataSize));
+
+  // Incomplete files are not visible.
+  EXPECT_FALSE(HttpOrigin::GetInstance()->Get("live/video_1.m4s"));
+  ASSERT_TRUE(writer.release()->Close());
+
+  HttpOrigin::Object object =
+      HttpOrigin::GetInstance()->Get("live/video_1.m4s");
+  ASSERT_TRUE(object);
+  EXPECT_EQ(std::string(kSegmentData, kSegmentDataSize), *object);
+
+  std::string contents;
+  ASSERT_TRUE(
+      File::ReadFileToString("origin://live/video_1.m4s", &contents));
+  EXPECT_EQ(*object, contents);
+}
+
+TEST_F(OriginFileTest, ServedOverHttp) {
+  ASSERT_TRUE(File::WriteStringToFile(
+      "origin://live/video_2.m4s", std::string(kSegmentData, kSegmentDataSize)));
+  ASSERT_TRUE(File::WriteFileAtomically("origin://live/manifest.mpd", "<MPD/>"));
+  ASSERT_NE(0, HttpOrigin::GetInstance()->port());
+
+  std::string contents;
+  ASSERT_TRUE(File::ReadFileToString(OriginUrl("live/video_2.m4s").c_str(),
+                                     &contents));
+  EXPECT_EQ(std::string(kSegmentData, kSegmentDataSize), contents);
+
+  ASSERT_TRUE(File::ReadFileToString(OriginUrl("live/manifest.mpd").c_str(),
+                                     &contents));
+  EXPECT_EQ("<MPD/>", contents);
+}
+
+TEST_F(OriginFileTest, Delete) {
+  ASSERT_TRUE(File::WriteStringToFile("origin://video_3.m4s", "data"));
+  ASSERT_TRUE(HttpOrigin::GetInstance()->Get("video_3.m4s"));
+  EXPECT_TRUE(File::Delete("origin://video_3.m4s"));
+  EXPECT_FALSE(HttpOrigin::GetInstance()->Get("video_3.m4s"));
+  EXPECT_FALSE(File::Open("origin://video_3.m4s", "r"));
+}
+
+TEST_F(OriginFileTest, KeptUntilDeleted) {
+  // Init segments are published once, so they must stay available for players
+  // joining a live stream later.
+  ASSERT_TRUE(File::WriteStringToFile("origin://live/init.mp4", "init"));
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(File::WriteStringToFile(
+        absl::StrFormat("origin://live/segment_%d.m4s", i).c_str(), "data"));
+  }
+  ASSERT_TRUE(HttpOrigin::GetInstance()->Get("live/init.mp4"));
+
+  // Segments which have left the live window are deleted by the packager.
+  EXPECT_TRUE(File::Delete("origin://live/segment_0.m4s"));
+  EXPECT_FALSE(HttpOrigin::GetInstance()->Get("live/segment_0.m4s"));
+  EXPECT_TRUE(HttpOrigin::GetInstance()->Get("live/segment_1.m4s"));
+}
+
+TEST_F(OriginFileTest, SegmentsEvictedAfterRetention) {
+  HttpOrigin* origin = HttpOrigin::GetInstance();
+  const int retention_id = origin->AddRetention(
+      {"channel1/segment_$Number$.m4s"}, absl::Milliseconds(50));
+  ASSERT_TRUE(File::WriteStringToFile("origin://channel1/init.mp4", "init"));
+  ASSERT_TRUE(
+      File::WriteStringToFile("origin://channel1/segment_1.m4s", "data"));
+  // Not covered by the retention of the first channel.
+  ASSERT_TRUE(
+      File::WriteStringToFile("origin://channel2/segment_1.m4s", "data"));
+  ASSERT_TRUE(File::WriteFileAtomically("origin://channel1/manifest.mpd",
+                                        "<MPD/>"));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_TRUE(
+      File::WriteStringToFile("origin://channel1/segment_2.m4s", "data"));
+  EXPECT_FALSE(origin->Get("channel1/segment_1.m4s"));
+  EXPECT_TRUE(origin->Get("channel1/segment_2.m4s"));
+  EXPECT_TRUE(origin->Get("channel1/init.mp4"));
+  EXPECT_TRUE(origin->Get("channel1/manifest.mpd"));
+  EXPECT_TRUE(origin->Get("channel2/segment_1.m4s"));
+
+  // Segments published after the channel stopped are kept.
+  origin->RemoveRetention(retention_id);
+  ASSERT_TRUE(
+      File::WriteStringToFile("origin://channel1/segment_3.m4s", "data"));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_TRUE(
+      File::WriteStringToFile("origin://channel1/segment_4.m4s", "data"));
+  EXPECT_FALSE(origin->Get("channel1/segment_2.m4s"));
+  EXPECT_TRUE(origin->Get("channel1/segment_3.m4s"));
+}
+
+}  // namespace shaka
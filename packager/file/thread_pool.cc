@@ -6,91 +6,196 @@
 
 #include <packager/file/thread_pool.h>
 
+#include <algorithm>
 #include <thread>
 
+#include <absl/flags/flag.h>
 #include <absl/log/check.h>
 #include <absl/log/log.h>
-#include <absl/time/time.h>
+
+ABSL_FLAG(uint32_t,
+          io_thread_pool_max_threads,
+          0,
+          "Maximum number of threads used for threaded file I/O and HTTP "
+          "transfers. Each open file holds a thread for its lifetime, so "
+          "opening a file waits for another one to be closed once this many "
+          "files are open, with manifests opened first. A file which waits "
+          "for more than a second gets a thread beyond the limit. Specify 0 "
+          "for no limit.");
 
 namespace shaka {
 
 namespace {
 
 const absl::Duration kMaxThreadIdleTime = absl::Minutes(10);
+// How long a long-running task waits for a thread before one is started for
+// it beyond the thread limit.
+const absl::Duration kMaxWaitForThreadTime = absl::Seconds(1);
+
+thread_local ThreadPool::Priority current_priority =
+    ThreadPool::Priority::kNormal;
 
 }  // namespace
 
 // static
 ThreadPool ThreadPool::instance;
 
-ThreadPool::ThreadPool() : num_idle_threads_(0), terminated_(false) {}
+ThreadPool::ScopedPriority::ScopedPriority(Priority priority)
+    : previous_priority_(current_priority) {
+  current_priority = priority;
+}
+
+ThreadPool::ScopedPriority::~ScopedPriority() {
+  current_priority = previous_priority_;
+}
+
+ThreadPool::ThreadPool()
+    : num_threads_(0), num_idle_threads_(0), terminated_(false) {}
 
 ThreadPool::~ThreadPool() {
   Terminate();
 }
 
-void ThreadPool::PostTask(const std::function<void()>& task) {
+void ThreadPool::PostTask(const Task& task) {
+  PostTask(task, current_priority);
+}
+
+void ThreadPool::PostTask(const Task& task, Priority priority) {
+  absl::MutexLock lock(mutex_);
+  PostTaskLocked(task, priority, nullptr);
+}
+
+bool ThreadPool::PostLongRunningTask(const Task& task) {
   absl::MutexLock lock(mutex_);
+  // Otherwise, an idle or new thread picks up the task.
+  const size_t max_threads = absl::GetFlag(FLAGS_io_thread_pool_max_threads);
+  const bool must_wait = max_threads != 0 && num_threads_ >= max_threads &&
+                         num_idle_threads_ <= NumQueuedTasks();
+  bool started = false;
+  if (!PostTaskLocked(task, current_priority, must_wait ? &started : nullptr))
+    return false;
+  if (!must_wait)
+    return true;
+
+  absl::Time deadline = absl::Now() + kMaxWaitForThreadTime;
+  while (!started && !terminated_) {
+    if (task_started_.WaitWithDeadline(&mutex_, deadline) && !started &&
+        !terminated_) {
+      // Another task may take the new thread, in which case this one waits
+      // for another period.
+      LOG(WARNING) << "Thread pool is at its limit of " << num_threads_
+                   << " threads. Starting another thread. Increase "
+                      "--io_thread_pool_max_threads.";
+      StartThread();
+      deadline = absl::Now() + kMaxWaitForThreadTime;
+    }
+  }
+  // Terminate() drops the queued tasks.
+  return started;
+}
 
+bool ThreadPool::PostTaskLocked(const Task& task,
+                                Priority priority,
+                                bool* started) {
   DCHECK(!terminated_) << "Should not call PostTask after Terminate!";
 
   if (terminated_) {
-    return;
+    return false;
   }
 
   // An empty task is used internally to signal the thread to terminate.  This
   // should never be sent on input.
   if (!task) {
     DLOG(ERROR) << "Should not post an empty task!";
-    return;
+    return false;
   }
 
-  tasks_.push(std::move(task));
+  tasks_[static_cast<int>(priority)].push_back({task, absl::Now(), started});
+  const size_t num_queued_tasks = NumQueuedTasks();
+  stats_.peak_queue_depth =
+      std::max(stats_.peak_queue_depth, num_queued_tasks);
 
-  if (num_idle_threads_ >= tasks_.size()) {
+  const size_t max_threads = absl::GetFlag(FLAGS_io_thread_pool_max_threads);
+  if (num_idle_threads_ >= num_queued_tasks) {
     // We have enough threads available.
     tasks_available_.SignalAll();
-  } else {
+  } else if (max_threads == 0 || num_threads_ < max_threads) {
     // We need to start an additional thread.
-    std::thread thread(std::bind(&ThreadPool::ThreadMain, this));
-    thread.detach();
+    StartThread();
+  } else {
+    // Wake up whatever idle threads there are, and let the rest of the tasks
+    // wait for a busy thread to finish.
+    tasks_available_.SignalAll();
+    VLOG(1) << "Thread pool is at its limit of " << max_threads
+            << " threads. Queued tasks: " << num_queued_tasks;
   }
+  return true;
+}
+
+void ThreadPool::StartThread() {
+  num_threads_++;
+  stats_.peak_num_threads = std::max(stats_.peak_num_threads, num_threads_);
+  std::thread thread(std::bind(&ThreadPool::ThreadMain, this));
+  thread.detach();
+}
+
+ThreadPool::Stats ThreadPool::GetStats() {
+  absl::MutexLock lock(mutex_);
+  Stats stats = stats_;
+  stats.num_threads = num_threads_;
+  stats.num_idle_threads = num_idle_threads_;
+  stats.queue_depth = NumQueuedTasks();
+  return stats;
 }
 
 void ThreadPool::Terminate() {
   {
     absl::MutexLock lock(mutex_);
     terminated_ = true;
-    while (!tasks_.empty()) {
-      tasks_.pop();
-    }
+    for (auto& tasks : tasks_)
+      tasks.clear();
   }
   tasks_available_.SignalAll();
+  task_started_.SignalAll();
 }
 
 ThreadPool::Task ThreadPool::WaitForTask() {
   absl::MutexLock lock(mutex_);
   if (terminated_) {
     // The pool is terminated.  Terminate this thread.
+    num_threads_--;
     return Task();
   }
 
-  if (tasks_.empty()) {
+  if (NumQueuedTasks() == 0) {
     num_idle_threads_++;
     // Wait for a task, up to the maximum idle time.
     tasks_available_.WaitWithTimeout(&mutex_, kMaxThreadIdleTime);
     num_idle_threads_--;
 
-    if (tasks_.empty()) {
+    if (NumQueuedTasks() == 0) {
       // No work before the timeout.  Terminate this thread.
+      num_threads_--;
       return Task();
     }
   }
 
-  // Get the next task from the queue.
-  Task task = tasks_.front();
-  tasks_.pop();
-  return task;
+  // Get the next task from the highest priority queue.
+  auto& tasks = tasks_[static_cast<int>(Priority::kHigh)].empty()
+                    ? tasks_[static_cast<int>(Priority::kNormal)]
+                    : tasks_[static_cast<int>(Priority::kHigh)];
+  PendingTask pending_task = std::move(tasks.front());
+  tasks.pop_front();
+  if (pending_task.started) {
+    *pending_task.started = true;
+    task_started_.SignalAll();
+  }
+
+  const absl::Duration queue_latency = absl::Now() - pending_task.post_time;
+  stats_.num_tasks_started++;
+  stats_.total_queue_latency += queue_latency;
+  stats_.max_queue_latency = std::max(stats_.max_queue_latency, queue_latency);
+  return std::move(pending_task.task);
 }
 
 void ThreadPool::ThreadMain() {
@@ -106,4 +211,9 @@ void ThreadPool::ThreadMain() {
   }
 }
 
+size_t ThreadPool::NumQueuedTasks() const {
+  return tasks_[static_cast<int>(Priority::kNormal)].size() +
+         tasks_[static_cast<int>(Priority::kHigh)].size();
+}
+
 }  // namespace shaka
@@ -7,11 +7,13 @@
 #ifndef PACKAGER_FILE_THREAD_POOL_H_
 #define PACKAGER_FILE_THREAD_POOL_H_
 
+#include <cstdint>
+#include <deque>
 #include <functional>
-#include <queue>
 
 #include <absl/base/thread_annotations.h>
 #include <absl/synchronization/mutex.h>
+#include <absl/time/time.h>
 
 #include <packager/macros/classes.h>
 
@@ -21,17 +23,70 @@ namespace shaka {
 /// is no replacement in the C++ standard library nor in absl.
 /// (As of June 2022.)  The pool will grow when there are no threads available
 /// to handle a task, and it will shrink when a thread is idle for too long.
+/// The number of threads can be bounded with --io_thread_pool_max_threads, in
+/// which case tasks wait in a queue, by priority, for a thread to become
+/// available.
 class ThreadPool {
  public:
   typedef std::function<void()> Task;
 
+  /// Tasks of higher priority are handed to workers before any queued task of
+  /// lower priority.  This only matters when the pool is at its thread limit.
+  enum class Priority {
+    kNormal,
+    kHigh,
+  };
+
+  /// A snapshot of the pool's counters.
+  struct Stats {
+    size_t num_threads = 0;
+    size_t num_idle_threads = 0;
+    size_t peak_num_threads = 0;
+    size_t queue_depth = 0;
+    size_t peak_queue_depth = 0;
+    uint64_t num_tasks_started = 0;
+    /// Time spent by tasks in the queue before a worker picked them up.
+    absl::Duration total_queue_latency;
+    absl::Duration max_queue_latency;
+  };
+
+  /// Raises the priority of tasks posted by the current thread for the
+  /// lifetime of this object.  This is used to let manifest writes skip ahead
+  /// of queued segment writes.
+  class ScopedPriority {
+   public:
+    explicit ScopedPriority(Priority priority);
+    ~ScopedPriority();
+
+   private:
+    Priority previous_priority_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScopedPriority);
+  };
+
   ThreadPool();
   ~ThreadPool();
 
-  /// Find or spawn a worker thread to handle |task|.
+  /// Find or spawn a worker thread to handle |task|.  If the pool is at its
+  /// thread limit, the task is queued until a worker becomes available.
   /// @param task A potentially long-running task to be handled by the pool.
   void PostTask(const Task& task);
 
+  /// Same as above, with an explicit priority instead of the priority set for
+  /// the current thread by ScopedPriority.
+  void PostTask(const Task& task, Priority priority);
+
+  /// Same as PostTask, for a task which holds its thread for the lifetime of
+  /// a file.  If the pool is at its thread limit, waits until a worker has
+  /// picked up |task|.  The threads may all be held by files which are only
+  /// closed once this one is, so if |task| waits in the queue for too long, a
+  /// thread is started for it beyond the thread limit.
+  /// @return true if |task| was picked up, false if the pool is terminated.
+  bool PostLongRunningTask(const Task& task);
+
+  /// @return A snapshot of the pool's counters.
+  Stats GetStats();
+
   static ThreadPool instance;
 
  private:
@@ -39,14 +94,29 @@ class ThreadPool {
   /// exit.
   void Terminate();
 
+  struct PendingTask {
+    Task task;
+    absl::Time post_time;
+    // Set when a worker picks up the task, if not null.
+    bool* started;
+  };
+
+  bool PostTaskLocked(const Task& task, Priority priority, bool* started)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void StartThread() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   Task WaitForTask();
   void ThreadMain();
+  size_t NumQueuedTasks() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   absl::Mutex mutex_;
   absl::CondVar tasks_available_ ABSL_GUARDED_BY(mutex_);
-  std::queue<Task> tasks_ ABSL_GUARDED_BY(mutex_);
+  absl::CondVar task_started_ ABSL_GUARDED_BY(mutex_);
+  // Indexed by Priority.
+  std::deque<PendingTask> tasks_[2] ABSL_GUARDED_BY(mutex_);
+  size_t num_threads_ ABSL_GUARDED_BY(mutex_);
   size_t num_idle_threads_ ABSL_GUARDED_BY(mutex_);
   bool terminated_ ABSL_GUARDED_BY(mutex_);
+  Stats stats_ ABSL_GUARDED_BY(mutex_);
 
   DISALLOW_COPY_AND_ASSIGN(ThreadPool);
 };
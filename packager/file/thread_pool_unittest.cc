@@ -0,0 +1,212 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/thread_pool.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/flags/declare.h>
+#include <absl/flags/flag.h>
+#include <absl/synchronization/blocking_counter.h>
+#include <absl/synchronization/notification.h>
+#include <gtest/gtest.h>
+
+#include <packager/flag_saver.h>
+
+ABSL_DECLARE_FLAG(uint32_t, io_thread_pool_max_threads);
+
+namespace shaka {
+
+TEST(ThreadPoolTest, RunsTasksAndCountsThem) {
+  const uint64_t tasks_started =
+      ThreadPool::instance.GetStats().num_tasks_started;
+
+  const int kNumTasks = 4;
+  absl::BlockingCounter done(kNumTasks);
+  for (int i = 0; i < kNumTasks; ++i)
+    ThreadPool::instance.PostTask([&done]() { done.DecrementCount(); });
+  done.Wait();
+
+  const ThreadPool::Stats stats = ThreadPool::instance.GetStats();
+  EXPECT_EQ(tasks_started + kNumTasks, stats.num_tasks_started);
+  EXPECT_GE(stats.peak_num_threads, 1u);
+  EXPECT_LE(stats.num_idle_threads, stats.num_threads);
+}
+
+TEST(ThreadPoolTest, BoundedPoolRunsHighPriorityTasksFirst) {
+  FlagSaver<uint32_t> saver(&FLAGS_io_thread_pool_max_threads);
+
+  // Occupy one thread, so the pool has at least one thread, then cap the pool
+  // at its current size and occupy every thread.
+  std::vector<std::unique_ptr<absl::Notification>> release;
+  release.emplace_back(new absl::Notification);
+  absl::Notification* first_release = release.back().get();
+  absl::Notification first_started;
+  ThreadPool::instance.PostTask([&first_started, first_release]() {
+    first_started.Notify();
+    first_release->WaitForNotification();
+  });
+  first_started.WaitForNotification();
+
+  const size_t num_threads = ThreadPool::instance.GetStats().num_threads;
+  absl::SetFlag(&FLAGS_io_thread_pool_max_threads, num_threads);
+
+  absl::BlockingCounter others_started(num_threads - 1);
+  absl::BlockingCounter others_done(num_threads - 1);
+  for (size_t i = 1; i < num_threads; ++i) {
+    release.emplace_back(new absl::Notification);
+    absl::Notification* notification = release.back().get();
+    ThreadPool::instance.PostTask(
+        [&others_started, &others_done, notification]() {
+          others_started.DecrementCount();
+          notification->WaitForNotification();
+          others_done.DecrementCount();
+        });
+  }
+  others_started.Wait();
+
+  // Every thread is busy, so these are queued.
+  std::string order;
+  absl::BlockingCounter queued_done(2);
+  ThreadPool::instance.PostTask([&]() {
+    order += "normal";
+    queued_done.DecrementCount();
+  });
+  {
+    ThreadPool::ScopedPriority priority(ThreadPool::Priority::kHigh);
+    ThreadPool::instance.PostTask([&]() {
+      order += "high,";
+      queued_done.DecrementCount();
+    });
+  }
+
+  ThreadPool::Stats stats = ThreadPool::instance.GetStats();
+  EXPECT_EQ(num_threads, stats.num_threads);
+  EXPECT_EQ(2u, stats.queue_depth);
+  EXPECT_GE(stats.peak_queue_depth, 2u);
+
+  // Free up a single thread, which runs the queued tasks one at a time.
+  release[0]->Notify();
+  queued_done.Wait();
+  EXPECT_EQ("high,normal", order);
+
+  for (size_t i = 1; i < release.size(); ++i)
+    release[i]->Notify();
+  others_done.Wait();
+
+  stats = ThreadPool::instance.GetStats();
+  EXPECT_EQ(0u, stats.queue_depth);
+  EXPECT_LE(stats.num_threads, num_threads);
+}
+
+TEST(ThreadPoolTest, BoundedPoolRunsLongRunningTasksByPriority) {
+  FlagSaver<uint32_t> saver(&FLAGS_io_thread_pool_max_threads);
+
+  // Occupy one thread, then cap the pool at its current size and occupy every
+  // thread.
+  absl::Notification release_first;
+  absl::Notification release_others;
+  absl::Notification first_started;
+  ThreadPool::instance.PostTask([&first_started, &release_first]() {
+    first_started.Notify();
+    release_first.WaitForNotification();
+  });
+  first_started.WaitForNotification();
+
+  const size_t num_threads = ThreadPool::instance.GetStats().num_threads;
+  absl::SetFlag(&FLAGS_io_thread_pool_max_threads, num_threads);
+
+  absl::BlockingCounter others_started(num_threads - 1);
+  absl::BlockingCounter others_done(num_threads - 1);
+  for (size_t i = 1; i < num_threads; ++i) {
+    ThreadPool::instance.PostTask(
+        [&others_started, &others_done, &release_others]() {
+          others_started.DecrementCount();
+          release_others.WaitForNotification();
+          others_done.DecrementCount();
+        });
+  }
+  others_started.Wait();
+
+  // Every thread is busy, so these wait in the queue, e.g. a segment and a
+  // manifest being opened.
+  std::string order;
+  absl::BlockingCounter queued_done(2);
+  std::thread segment_thread([&]() {
+    EXPECT_TRUE(ThreadPool::instance.PostLongRunningTask([&]() {
+      order += "normal";
+      queued_done.DecrementCount();
+    }));
+  });
+  std::thread manifest_thread([&]() {
+    ThreadPool::ScopedPriority priority(ThreadPool::Priority::kHigh);
+    EXPECT_TRUE(ThreadPool::instance.PostLongRunningTask([&]() {
+      order += "high,";
+      queued_done.DecrementCount();
+    }));
+  });
+  while (ThreadPool::instance.GetStats().queue_depth < 2)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  // Free up a single thread, which runs the queued tasks one at a time.
+  release_first.Notify();
+  segment_thread.join();
+  manifest_thread.join();
+  queued_done.Wait();
+  EXPECT_EQ("high,normal", order);
+
+  release_others.Notify();
+  others_done.Wait();
+}
+
+TEST(ThreadPoolTest, BoundedPoolStartsThreadForLongWaitingTask) {
+  FlagSaver<uint32_t> saver(&FLAGS_io_thread_pool_max_threads);
+
+  // Occupy one thread, then cap the pool at its current size and occupy every
+  // thread.
+  absl::Notification release;
+  absl::Notification first_started;
+  ThreadPool::instance.PostTask([&first_started, &release]() {
+    first_started.Notify();
+    release.WaitForNotification();
+  });
+  first_started.WaitForNotification();
+
+  const size_t num_threads = ThreadPool::instance.GetStats().num_threads;
+  absl::SetFlag(&FLAGS_io_thread_pool_max_threads, num_threads);
+
+  absl::BlockingCounter others_started(num_threads - 1);
+  absl::BlockingCounter done(num_threads);
+  for (size_t i = 1; i < num_threads; ++i) {
+    ThreadPool::instance.PostTask([&others_started, &done, &release]() {
+      others_started.DecrementCount();
+      release.WaitForNotification();
+      done.DecrementCount();
+    });
+  }
+  others_started.Wait();
+
+  // The busy threads could be held by files which are only closed after this
+  // one is opened, so the task gets a thread of its own instead of waiting
+  // forever.
+  absl::Notification started;
+  ASSERT_TRUE(ThreadPool::instance.PostLongRunningTask([&]() {
+    started.Notify();
+    release.WaitForNotification();
+    done.DecrementCount();
+  }));
+  started.WaitForNotification();
+  EXPECT_EQ(num_threads + 1, ThreadPool::instance.GetStats().num_threads);
+
+  release.Notify();
+  done.Wait();
+}
+
+}  // namespace shaka
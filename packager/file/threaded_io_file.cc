@@ -6,7 +6,13 @@
 
 #include <packager/file/threaded_io_file.h>
 
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif  // defined(__linux__)
+
 #include <absl/log/check.h>
+#include <absl/log/log.h>
 
 #include <packager/file/thread_pool.h>
 
@@ -21,17 +27,26 @@ ThreadedIoFile::ThreadedIoFile(std::unique_ptr<File, FileCloser> internal_file,
       mode_(mode),
       cache_(io_cache_size),
       io_buffer_(io_block_size),
+      memory_reservation_(MemoryBudget::GetGlobal(),
+                          io_cache_size + io_block_size),
       position_(0),
       size_(0),
       eof_(false),
       internal_file_error_(0),
+      readiness_fd_(-1),
+      readiness_requested_(false),
       flushing_(false),
       flush_complete_(false),
       task_exited_(false) {
   DCHECK(internal_file_);
 }
 
-ThreadedIoFile::~ThreadedIoFile() {}
+ThreadedIoFile::~ThreadedIoFile() {
+#if defined(__linux__)
+  if (readiness_fd_ >= 0)
+    close(readiness_fd_);
+#endif  // defined(__linux__)
+}
 
 bool ThreadedIoFile::Open() {
   DCHECK(internal_file_);
@@ -42,8 +57,13 @@ bool ThreadedIoFile::Open() {
   position_ = 0;
   size_ = internal_file_->Size();
 
-  ThreadPool::instance.PostTask(std::bind(&ThreadedIoFile::TaskHandler, this));
-  return true;
+#if defined(__linux__)
+  if (mode_ == kInputMode)
+    readiness_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif  // defined(__linux__)
+
+  return ThreadPool::instance.PostLongRunningTask(
+      std::bind(&ThreadedIoFile::TaskHandler, this));
 }
 
 bool ThreadedIoFile::Close() {
@@ -158,6 +178,35 @@ bool ThreadedIoFile::Tell(uint64_t* position) {
   return true;
 }
 
+bool ThreadedIoFile::IsReadReady() {
+  if (mode_ != kInputMode)
+    return true;
+
+#if defined(__linux__)
+  if (readiness_fd_ >= 0) {
+    // Consume the previous notification, if any, before checking the cache, so
+    // that data arriving from now on is notified again.
+    uint64_t count;
+    if (read(readiness_fd_, &count, sizeof(count)) < 0) {
+      // Nothing to consume.
+    }
+  }
+#endif  // defined(__linux__)
+  readiness_requested_.store(true, std::memory_order_relaxed);
+  // Pairs with the fence in NotifyReadReady: either the writer sees the
+  // request, or the data is seen here.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  // The cache is closed at end of file or on error.
+  if (cache_.BytesCached() == 0 && !cache_.closed())
+    return false;
+  readiness_requested_.store(false, std::memory_order_relaxed);
+  return true;
+}
+
+int ThreadedIoFile::GetReadinessFd() {
+  return readiness_fd_;
+}
+
 void ThreadedIoFile::TaskHandler() {
   {
     absl::MutexLock lock(task_exited_mutex_);
@@ -186,12 +235,29 @@ void ThreadedIoFile::RunInInputMode() {
       eof_.store(read_result == 0, std::memory_order_relaxed);
       internal_file_error_.store(read_result, std::memory_order_relaxed);
       cache_.Close();
+      NotifyReadReady();
       return;
     }
     if (cache_.Write(&io_buffer_[0], read_result) == 0) {
       return;
     }
+    NotifyReadReady();
+  }
+}
+
+void ThreadedIoFile::NotifyReadReady() {
+  // Only pay for the system call if a reader found the cache empty.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!readiness_requested_.load(std::memory_order_relaxed) ||
+      !readiness_requested_.exchange(false))
+    return;
+#if defined(__linux__)
+  if (readiness_fd_ >= 0) {
+    const uint64_t kOne = 1;
+    if (write(readiness_fd_, &kOne, sizeof(kOne)) < 0)
+      LOG(WARNING) << "Failed to signal read readiness of " << file_name();
   }
+#endif  // defined(__linux__)
 }
 
 void ThreadedIoFile::RunInOutputMode() {
@@ -17,6 +17,7 @@
 #include <packager/file/file_closer.h>
 #include <packager/file/io_cache.h>
 #include <packager/macros/classes.h>
+#include <packager/utils/memory_budget.h>
 
 namespace shaka {
 
@@ -40,6 +41,8 @@ class ThreadedIoFile : public File {
   bool Flush() override;
   bool Seek(uint64_t position) override;
   bool Tell(uint64_t* position) override;
+  bool IsReadReady() override;
+  int GetReadinessFd() override;
   /// @}
 
  protected:
@@ -54,15 +57,24 @@ class ThreadedIoFile : public File {
   void RunInInputMode();
   void RunInOutputMode();
   void WaitForSignal(absl::Mutex* mutex, bool* condition);
+  // Wakes up a reader waiting on |readiness_fd_|, if any.
+  void NotifyReadReady();
 
   std::unique_ptr<File, FileCloser> internal_file_;
   const Mode mode_;
   IoCache cache_;
   std::vector<uint8_t> io_buffer_;
+  // The cache and buffer are accounted for in the process-wide budget, as
+  // files do not know which pipeline they belong to.
+  MemoryBudget::Reservation memory_reservation_;
   uint64_t position_;
   uint64_t size_;
   std::atomic<bool> eof_;
   std::atomic<int64_t> internal_file_error_;
+  // In input mode on Linux, an eventfd which is signaled when data arrives
+  // after IsReadReady returned false.
+  int readiness_fd_;
+  std::atomic<bool> readiness_requested_;
 
   absl::Mutex flush_mutex_;
   bool flushing_ ABSL_GUARDED_BY(flush_mutex_);
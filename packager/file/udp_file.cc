@@ -9,14 +9,17 @@
 #if defined(OS_WIN)
 #include <ws2tcpip.h>
 #define close closesocket
+#define poll WSAPoll
 #define EINTR_CODE WSAEINTR
 #else
 #include <arpa/inet.h>
 #include <errno.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <string.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 #define INVALID_SOCKET -1
 #define EINTR_CODE EINTR
@@ -27,10 +30,13 @@
 #endif
 #endif  // defined(OS_WIN)
 
+#include <algorithm>
 #include <limits>
+#include <vector>
 
 #include <absl/log/check.h>
 #include <absl/log/log.h>
+#include <absl/time/clock.h>
 
 #include <packager/file/udp_options.h>
 #include <packager/macros/classes.h>
@@ -55,12 +61,57 @@ int GetSocketErrorCode() {
 
 }  // anonymous namespace
 
+#if defined(__linux__)
+struct UdpFile::BatchReceiver {
+  BatchReceiver(size_t batch_size, size_t datagram_size, size_t control_size)
+      : buffer(batch_size * datagram_size),
+        control(batch_size * control_size),
+        control_size(control_size),
+        iovecs(batch_size),
+        messages(batch_size) {
+    for (size_t i = 0; i < batch_size; ++i) {
+      iovecs[i].iov_base = &buffer[i * datagram_size];
+      iovecs[i].iov_len = datagram_size;
+    }
+  }
+
+  // Resets the message headers, which the kernel updates on every call.
+  void PrepareMessages() {
+    for (size_t i = 0; i < messages.size(); ++i) {
+      struct msghdr& header = messages[i].msg_hdr;
+      memset(&header, 0, sizeof(header));
+      header.msg_iov = &iovecs[i];
+      header.msg_iovlen = 1;
+      if (control_size > 0) {
+        header.msg_control = &control[i * control_size];
+        header.msg_controllen = control_size;
+      }
+      messages[i].msg_len = 0;
+    }
+  }
+
+  std::vector<uint8_t> buffer;
+  std::vector<uint8_t> control;
+  const size_t control_size;
+  std::vector<struct iovec> iovecs;
+  std::vector<struct mmsghdr> messages;
+  // Datagrams in |messages| received but not yet returned from Read.
+  size_t next_message = 0;
+  size_t num_messages = 0;
+  // The last SO_RXQ_OVFL counter seen; it counts drops since socket creation.
+  uint32_t last_drop_counter = 0;
+};
+#else
+struct UdpFile::BatchReceiver {};
+#endif  // defined(__linux__)
+
 UdpFile::UdpFile(const char* file_name)
     : File(file_name), socket_(INVALID_SOCKET) {}
 
 UdpFile::~UdpFile() {}
 
 bool UdpFile::Close() {
+  LogStats();
   if (socket_ != INVALID_SOCKET) {
     close(socket_);
     socket_ = INVALID_SOCKET;
@@ -80,16 +131,173 @@ int64_t UdpFile::Read(void* buffer, uint64_t length) {
 
   if (socket_ == INVALID_SOCKET)
     return -1;
+  // Fail as a read on the socket would have after the timeout, instead of
+  // waiting for the timeout again.
+  if (read_timed_out_)
+    return -1;
+
+  if (batch_receiver_)
+    return ReadBatch(buffer, length);
 
   int64_t result;
   do {
     result = recvfrom(socket_, reinterpret_cast<char*>(buffer),
                       static_cast<int>(length), 0, NULL, 0);
+    num_receive_calls_++;
   } while (result == -1 && GetSocketErrorCode() == EINTR_CODE);
 
+  if (result > 0) {
+    num_datagrams_++;
+    num_bytes_ += result;
+  }
   return result;
 }
 
+bool UdpFile::IsReadReady() {
+  if (socket_ == INVALID_SOCKET || read_timed_out_)
+    return true;
+#if defined(__linux__)
+  if (batch_receiver_ &&
+      batch_receiver_->next_message < batch_receiver_->num_messages) {
+    return true;
+  }
+#endif  // defined(__linux__)
+
+  struct pollfd poll_fd = {};
+  poll_fd.fd = socket_;
+  poll_fd.events = POLLIN;
+  // Errors are reported by Read.
+  if (poll(&poll_fd, 1, 0) != 0) {
+    if (timeout_us_ != 0)
+      last_ready_time_ = absl::Now();
+    return true;
+  }
+  if (timeout_us_ != 0 &&
+      absl::Now() - last_ready_time_ >= absl::Microseconds(timeout_us_)) {
+    LOG(ERROR) << "Timed out waiting for data on " << file_name();
+    read_timed_out_ = true;
+    return true;
+  }
+  return false;
+}
+
+int UdpFile::GetReadinessFd() {
+#if defined(OS_WIN)
+  // Sockets cannot be polled together with other descriptors on Windows.
+  return -1;
+#else
+  return socket_;
+#endif  // defined(OS_WIN)
+}
+
+int64_t UdpFile::GetReadTimeoutUs() {
+  return timeout_us_;
+}
+
+int64_t UdpFile::ReadBatch(void* buffer, uint64_t length) {
+#if defined(__linux__)
+  BatchReceiver* receiver = batch_receiver_.get();
+  if (receiver->next_message == receiver->num_messages) {
+    receiver->PrepareMessages();
+    int result;
+    do {
+      // Block for the first datagram only, then take whatever else is queued.
+      result = recvmmsg(socket_, receiver->messages.data(),
+                        receiver->messages.size(), MSG_WAITFORONE, nullptr);
+      num_receive_calls_++;
+    } while (result == -1 && GetSocketErrorCode() == EINTR_CODE);
+    if (result <= 0)
+      return result;
+
+    receiver->next_message = 0;
+    receiver->num_messages = result;
+    for (int i = 0; i < result; ++i)
+      ProcessControlMessages(i);
+  }
+
+  // Return as many whole datagrams as fit.  The first one is always returned,
+  // truncated if needed, as recvfrom would.
+  uint8_t* output = static_cast<uint8_t*>(buffer);
+  uint64_t bytes_read = 0;
+  while (receiver->next_message < receiver->num_messages) {
+    const size_t index = receiver->next_message;
+    uint64_t size = receiver->messages[index].msg_len;
+    if (bytes_read + size > length) {
+      if (bytes_read > 0)
+        break;
+      size = length;
+    }
+    memcpy(output + bytes_read, receiver->iovecs[index].iov_base, size);
+    bytes_read += size;
+    receiver->next_message++;
+  }
+  num_bytes_ += bytes_read;
+  return bytes_read;
+#else
+  UNUSED(buffer);
+  UNUSED(length);
+  NOTIMPLEMENTED() << "Batched UDP receive is only supported on Linux.";
+  return -1;
+#endif  // defined(__linux__)
+}
+
+void UdpFile::ProcessControlMessages(size_t message_index) {
+#if defined(__linux__)
+  BatchReceiver* receiver = batch_receiver_.get();
+  struct msghdr* header = &receiver->messages[message_index].msg_hdr;
+  num_datagrams_++;
+
+  if (header->msg_flags & MSG_TRUNC) {
+    LOG(WARNING) << "UDP datagram truncated on " << file_name()
+                 << ". Consider increasing the datagram_size UDP option.";
+  }
+  if (header->msg_flags & MSG_CTRUNC)
+    VLOG(1) << "UDP control data truncated on " << file_name();
+
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(header); cmsg;
+       cmsg = CMSG_NXTHDR(header, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET)
+      continue;
+
+    if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+      uint32_t drop_counter;
+      memcpy(&drop_counter, CMSG_DATA(cmsg), sizeof(drop_counter));
+      const uint32_t new_drops = drop_counter - receiver->last_drop_counter;
+      if (new_drops > 0) {
+        LOG(WARNING) << "Kernel dropped " << new_drops
+                     << " UDP datagrams on " << file_name()
+                     << " because the socket buffer was full. Consider "
+                        "increasing the buffer_size UDP option.";
+        num_dropped_datagrams_ += new_drops;
+        receiver->last_drop_counter = drop_counter;
+      }
+    } else if (cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+      struct timespec receive_time;
+      memcpy(&receive_time, CMSG_DATA(cmsg), sizeof(receive_time));
+      struct timespec now;
+      clock_gettime(CLOCK_REALTIME, &now);
+      const int64_t delay_us =
+          (now.tv_sec - receive_time.tv_sec) * 1000000 +
+          (now.tv_nsec - receive_time.tv_nsec) / 1000;
+      max_socket_queue_delay_us_ =
+          std::max(max_socket_queue_delay_us_, delay_us);
+    }
+  }
+#else
+  UNUSED(message_index);
+#endif  // defined(__linux__)
+}
+
+void UdpFile::LogStats() {
+  if (num_receive_calls_ == 0)
+    return;
+  LOG(INFO) << "UDP receive stats for " << file_name()
+            << ": datagrams=" << num_datagrams_ << " bytes=" << num_bytes_
+            << " receive_calls=" << num_receive_calls_
+            << " kernel_drops=" << num_dropped_datagrams_
+            << " max_socket_queue_delay_us=" << max_socket_queue_delay_us_;
+}
+
 int64_t UdpFile::Write(const void* buffer, uint64_t length) {
   UNUSED(buffer);
   UNUSED(length);
@@ -300,6 +508,40 @@ bool UdpFile::Open() {
     }
   }
 
+  if (options->batch_size() > 1 || options->timestamps() ||
+      options->drop_stats()) {
+#if defined(__linux__)
+    size_t control_size = 0;
+    const int optval_one = 1;
+    if (options->timestamps()) {
+      if (setsockopt(new_socket.get(), SOL_SOCKET, SO_TIMESTAMPNS, &optval_one,
+                     sizeof(optval_one)) < 0) {
+        LOG(ERROR) << "Failed to enable SO_TIMESTAMPNS, error = "
+                   << GetSocketErrorCode();
+        return false;
+      }
+      control_size += CMSG_SPACE(sizeof(struct timespec));
+    }
+    if (options->drop_stats()) {
+      if (setsockopt(new_socket.get(), SOL_SOCKET, SO_RXQ_OVFL, &optval_one,
+                     sizeof(optval_one)) < 0) {
+        LOG(ERROR) << "Failed to enable SO_RXQ_OVFL, error = "
+                   << GetSocketErrorCode();
+        return false;
+      }
+      control_size += CMSG_SPACE(sizeof(uint32_t));
+    }
+    batch_receiver_.reset(
+        new BatchReceiver(options->batch_size(), options->datagram_size(),
+                          control_size));
+#else
+    LOG(WARNING) << "UDP options batch_size, timestamps and drop_stats are "
+                    "only supported on Linux. Ignoring them.";
+#endif  // defined(__linux__)
+  }
+
+  timeout_us_ = options->timeout_us();
+  last_ready_time_ = absl::Now();
   socket_ = new_socket.release();
   return true;
 }
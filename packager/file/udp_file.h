@@ -8,8 +8,11 @@
 #define MEDIA_FILE_UDP_FILE_H_
 
 #include <cstdint>
+#include <memory>
 #include <string>
 
+#include <absl/time/time.h>
+
 #if defined(OS_WIN)
 #include <windows.h>
 #include <winsock2.h>
@@ -23,6 +26,10 @@ typedef int SOCKET;
 namespace shaka {
 
 /// Implements UdpFile, which receives UDP unicast and multicast streams.
+///
+/// On Linux, datagrams can be received in batches with recvmmsg (see the
+/// batch_size UDP option), in which case a single Read may return several
+/// whole datagrams back to back.
 class UdpFile : public File {
  public:
   /// @param file_name C string containing the address of the stream to receive.
@@ -39,6 +46,9 @@ class UdpFile : public File {
   bool Flush() override;
   bool Seek(uint64_t position) override;
   bool Tell(uint64_t* position) override;
+  bool IsReadReady() override;
+  int GetReadinessFd() override;
+  int64_t GetReadTimeoutUs() override;
   /// @}
 
  protected:
@@ -47,7 +57,37 @@ class UdpFile : public File {
   bool Open() override;
 
  private:
+  friend class UdpFileTest;
+
+  // Receive state for the recvmmsg path.  Defined in the .cc file, since it
+  // depends on Linux-only socket structures.
+  struct BatchReceiver;
+
+  int64_t ReadBatch(void* buffer, uint64_t length);
+  // Parses the control messages of a datagram received with ReadBatch.
+  void ProcessControlMessages(size_t message_index);
+  void LogStats();
+
   SOCKET socket_;
+  std::unique_ptr<BatchReceiver> batch_receiver_;
+
+  // The timeout UDP option, in microseconds. 0 if there is none.
+  uint64_t timeout_us_ = 0;
+  // When IsReadReady last saw data, or the socket was opened.
+  absl::Time last_ready_time_;
+  // Set by IsReadReady when no data arrived within |timeout_us_|.
+  bool read_timed_out_ = false;
+
+  // Receive statistics, logged on Close.
+  uint64_t num_datagrams_ = 0;
+  uint64_t num_bytes_ = 0;
+  uint64_t num_receive_calls_ = 0;
+  // Datagrams the kernel dropped because the socket buffer was full, as
+  // reported through SO_RXQ_OVFL.
+  uint64_t num_dropped_datagrams_ = 0;
+  // The longest time a datagram sat in the socket buffer, as measured with
+  // SO_TIMESTAMPNS.
+  int64_t max_socket_queue_delay_us_ = 0;
 #if defined(OS_WIN)
   // For Winsock in Windows.
   bool wsa_started_ = false;
@@ -0,0 +1,153 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/udp_file.h>
+
+#if defined(__linux__)
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <absl/strings/str_format.h>
+#include <gtest/gtest.h>
+
+namespace shaka {
+
+namespace {
+
+const size_t kReadBufferSize = 65536;
+
+}  // namespace
+
+class UdpFileTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    sender_ = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(sender_, 0);
+
+    // Find a free port by binding to port 0, since the port has to be known
+    // to send to it.
+    int probe = socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(probe, 0);
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    ASSERT_EQ(0, bind(probe, reinterpret_cast<struct sockaddr*>(&address),
+                      sizeof(address)));
+    socklen_t address_size = sizeof(address);
+    ASSERT_EQ(0,
+              getsockname(probe, reinterpret_cast<struct sockaddr*>(&address),
+                          &address_size));
+    close(probe);
+    receiver_address_ = address;
+  }
+
+  void TearDown() override {
+    if (file_)
+      file_->Close();
+    close(sender_);
+  }
+
+  // Opens |file_| on the free port, with |options|.
+  void Open(const std::string& options) {
+    const std::string url = absl::StrFormat(
+        "udp://127.0.0.1:%d?%s", ntohs(receiver_address_.sin_port), options);
+    file_ = static_cast<UdpFile*>(File::OpenWithNoBuffering(url.c_str(), "r"));
+    ASSERT_TRUE(file_);
+  }
+
+  void Send(const std::string& datagram) {
+    ASSERT_EQ(static_cast<ssize_t>(datagram.size()),
+              sendto(sender_, datagram.data(), datagram.size(), 0,
+                     reinterpret_cast<struct sockaddr*>(&receiver_address_),
+                     sizeof(receiver_address_)));
+  }
+
+  // Reads whatever datagrams are queued, up to |length| bytes.
+  std::string Read(size_t length = kReadBufferSize) {
+    std::vector<char> buffer(kReadBufferSize);
+    const int64_t result = file_->Read(buffer.data(), length);
+    EXPECT_GT(result, 0);
+    return result > 0 ? std::string(buffer.data(), result) : "";
+  }
+
+  uint64_t num_datagrams() const { return file_->num_datagrams_; }
+  uint64_t num_receive_calls() const { return file_->num_receive_calls_; }
+  uint64_t num_dropped_datagrams() const {
+    return file_->num_dropped_datagrams_;
+  }
+  int64_t max_socket_queue_delay_us() const {
+    return file_->max_socket_queue_delay_us_;
+  }
+
+  int sender_ = -1;
+  struct sockaddr_in receiver_address_ = {};
+  UdpFile* file_ = nullptr;
+};
+
+TEST_F(UdpFileTest, ReadBatchReturnsQueuedDatagrams) {
+  Open("batch_size=8");
+  const std::vector<std::string> datagrams = {
+      std::string(100, 'a'), std::string(200, 'b'), std::string(300, 'c'),
+      std::string(400, 'd'), std::string(500, 'e')};
+  std::string sent;
+  for (const std::string& datagram : datagrams) {
+    Send(datagram);
+    sent += datagram;
+  }
+
+  // All the queued datagrams are received with a single recvmmsg.
+  EXPECT_EQ(sent, Read());
+  EXPECT_EQ(5u, num_datagrams());
+  EXPECT_EQ(1u, num_receive_calls());
+}
+
+TEST_F(UdpFileTest, ReadBatchReturnsWholeDatagrams) {
+  Open("batch_size=8");
+  Send(std::string(300, 'a'));
+  Send(std::string(300, 'b'));
+  Send(std::string(300, 'c'));
+
+  // Datagrams which do not fit are returned by the next reads, without
+  // receiving again.
+  EXPECT_EQ(std::string(300, 'a') + std::string(300, 'b'), Read(700));
+  EXPECT_EQ(std::string(300, 'c'), Read(700));
+  EXPECT_EQ(1u, num_receive_calls());
+}
+
+TEST_F(UdpFileTest, ReadBatchTruncatesToDatagramSize) {
+  Open("batch_size=2&datagram_size=100");
+  Send(std::string(300, 'a'));
+  EXPECT_EQ(std::string(100, 'a'), Read());
+}
+
+TEST_F(UdpFileTest, ReadBatchCountsDropsAndQueueDelay) {
+  // The smallest receive buffer only holds a few datagrams.
+  Open("batch_size=64&drop_stats=1&timestamps=1&buffer_size=1");
+  for (int i = 0; i < 100; ++i)
+    Send(std::string(1000, 'a'));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  while (file_->IsReadReady())
+    Read();
+  EXPECT_GE(max_socket_queue_delay_us(), 20000);
+
+  // The kernel reports the drops with the datagrams received after them.
+  Send("b");
+  EXPECT_EQ("b", Read());
+  EXPECT_GT(num_dropped_datagrams(), 0u);
+  EXPECT_EQ(100u + 1u, num_datagrams() + num_dropped_datagrams());
+}
+
+}  // namespace shaka
+
+#endif  // defined(__linux__)
@@ -28,11 +28,15 @@ namespace {
 
 enum FieldType {
   kUnknownField = 0,
+  kBatchSizeField,
   kBufferSizeField,
+  kDatagramSizeField,
+  kDropStatsField,
   kInterfaceAddressField,
   kMulticastSourceField,
   kReuseField,
   kTimeoutField,
+  kTimestampsField,
 };
 
 struct FieldNameToTypeMapping {
@@ -41,13 +45,23 @@ struct FieldNameToTypeMapping {
 };
 
 const FieldNameToTypeMapping kFieldNameTypeMappings[] = {
+    {"batch_size", kBatchSizeField},
     {"buffer_size", kBufferSizeField},
+    {"datagram_size", kDatagramSizeField},
+    {"drop_stats", kDropStatsField},
     {"interface", kInterfaceAddressField},
     {"reuse", kReuseField},
     {"source", kMulticastSourceField},
     {"timeout", kTimeoutField},
+    {"timestamps", kTimestampsField},
 };
 
+// The largest batch is bounded so a typo can't allocate gigabytes of receive
+// buffers.  Each datagram slot is up to 64KiB.
+const unsigned kMaxBatchSize = 1024;
+// Large enough for any UDP datagram over IPv4.
+const unsigned kMaxDatagramSize = 65536;
+
 FieldType GetFieldType(const std::string& field_name) {
   for (size_t idx = 0; idx < std::size(kFieldNameTypeMappings); ++idx) {
     if (field_name == kFieldNameTypeMappings[idx].field_name)
@@ -94,6 +108,15 @@ std::unique_ptr<UdpOptions> UdpOptions::ParseFromString(
 
     for (const auto& pair : kv_pairs) {
       switch (GetFieldType(pair.first)) {
+        case kBatchSizeField:
+          if (!absl::SimpleAtoi(pair.second, &options->batch_size_) ||
+              options->batch_size_ == 0 ||
+              options->batch_size_ > kMaxBatchSize) {
+            LOG(ERROR) << "Invalid udp option for batch_size field "
+                       << pair.second;
+            return nullptr;
+          }
+          break;
         case kBufferSizeField:
           if (!absl::SimpleAtoi(pair.second, &options->buffer_size_)) {
             LOG(ERROR) << "Invalid udp option for buffer_size field "
@@ -101,6 +124,25 @@ std::unique_ptr<UdpOptions> UdpOptions::ParseFromString(
             return nullptr;
           }
           break;
+        case kDatagramSizeField:
+          if (!absl::SimpleAtoi(pair.second, &options->datagram_size_) ||
+              options->datagram_size_ == 0 ||
+              options->datagram_size_ > kMaxDatagramSize) {
+            LOG(ERROR) << "Invalid udp option for datagram_size field "
+                       << pair.second;
+            return nullptr;
+          }
+          break;
+        case kDropStatsField: {
+          int drop_stats_value = 0;
+          if (!absl::SimpleAtoi(pair.second, &drop_stats_value)) {
+            LOG(ERROR) << "Invalid udp option for drop_stats field "
+                       << pair.second;
+            return nullptr;
+          }
+          options->drop_stats_ = drop_stats_value > 0;
+          break;
+        }
         case kInterfaceAddressField:
           options->interface_address_ = pair.second;
           break;
@@ -124,6 +166,16 @@ std::unique_ptr<UdpOptions> UdpOptions::ParseFromString(
             return nullptr;
           }
           break;
+        case kTimestampsField: {
+          int timestamps_value = 0;
+          if (!absl::SimpleAtoi(pair.second, &timestamps_value)) {
+            LOG(ERROR) << "Invalid udp option for timestamps field "
+                       << pair.second;
+            return nullptr;
+          }
+          options->timestamps_ = timestamps_value > 0;
+          break;
+        }
         default:
           LOG(ERROR) << "Unknown field in udp options (\"" << pair.first
                      << "\").";
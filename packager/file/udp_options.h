@@ -30,6 +30,10 @@ class UdpOptions {
     return is_source_specific_multicast_;
   }
   int buffer_size() const { return buffer_size_; }
+  unsigned batch_size() const { return batch_size_; }
+  unsigned datagram_size() const { return datagram_size_; }
+  bool timestamps() const { return timestamps_; }
+  bool drop_stats() const { return drop_stats_; }
 
  private:
   UdpOptions() = default;
@@ -51,6 +55,17 @@ class UdpOptions {
   // by the underlying operating system ('sysctl net.core.rmem_max' on Linux
   // returns the maximum receive memory size).
   int buffer_size_ = 0;
+  // Maximum number of datagrams received per system call.  Values above 1 use
+  // recvmmsg, which is only available on Linux.
+  unsigned batch_size_ = 1;
+  // Largest datagram received in a batch, in bytes; larger ones are
+  // truncated.  Defaults to the Ethernet MTU, which fits the usual 7 TS
+  // packets per datagram.
+  unsigned datagram_size_ = 1500;
+  // Capture kernel receive timestamps (SO_TIMESTAMPNS, Linux only).
+  bool timestamps_ = false;
+  // Track datagrams dropped by the kernel (SO_RXQ_OVFL, Linux only).
+  bool drop_stats_ = false;
 };
 
 }  // namespace shaka
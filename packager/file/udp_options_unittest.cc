@@ -130,4 +130,55 @@ TEST_F(UdpOptionsTest, BufferSize) {
   EXPECT_EQ(1234, options->buffer_size());
 }
 
+TEST_F(UdpOptionsTest, BatchSize) {
+  auto options = UdpOptions::ParseFromString("224.1.2.30:88");
+  ASSERT_TRUE(options);
+  EXPECT_EQ(1u, options->batch_size());
+
+  options = UdpOptions::ParseFromString("224.1.2.30:88?batch_size=64");
+  ASSERT_TRUE(options);
+  EXPECT_EQ(64u, options->batch_size());
+}
+
+TEST_F(UdpOptionsTest, InvalidBatchSize) {
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?batch_size=0"));
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?batch_size=abc"));
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?batch_size=100000"));
+}
+
+TEST_F(UdpOptionsTest, DatagramSize) {
+  auto options = UdpOptions::ParseFromString("224.1.2.30:88");
+  ASSERT_TRUE(options);
+  EXPECT_EQ(1500u, options->datagram_size());
+
+  options = UdpOptions::ParseFromString("224.1.2.30:88?datagram_size=9000");
+  ASSERT_TRUE(options);
+  EXPECT_EQ(9000u, options->datagram_size());
+}
+
+TEST_F(UdpOptionsTest, InvalidDatagramSize) {
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?datagram_size=0"));
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?datagram_size=x"));
+  ASSERT_FALSE(
+      UdpOptions::ParseFromString("224.1.2.30:88?datagram_size=100000"));
+}
+
+TEST_F(UdpOptionsTest, TimestampsAndDropStats) {
+  auto options = UdpOptions::ParseFromString("224.1.2.30:88");
+  ASSERT_TRUE(options);
+  EXPECT_FALSE(options->timestamps());
+  EXPECT_FALSE(options->drop_stats());
+
+  options = UdpOptions::ParseFromString(
+      "224.1.2.30:88?timestamps=1&drop_stats=1");
+  ASSERT_TRUE(options);
+  EXPECT_TRUE(options->timestamps());
+  EXPECT_TRUE(options->drop_stats());
+}
+
+TEST_F(UdpOptionsTest, InvalidTimestampsAndDropStats) {
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?timestamps=x"));
+  ASSERT_FALSE(UdpOptions::ParseFromString("224.1.2.30:88?drop_stats=x"));
+}
+
 }  // namespace shaka
@@ -0,0 +1,749 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/uring_file.h>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif  // defined(__linux__)
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+
+#include <absl/base/thread_annotations.h>
+#include <absl/flags/flag.h>
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+#include <absl/synchronization/mutex.h>
+
+#include <packager/macros/compiler.h>
+#include <packager/macros/logging.h>
+
+ABSL_FLAG(uint32_t,
+          io_uring_queue_depth,
+          16,
+          "Maximum number of writes in flight per file when writing local "
+          "files with io_uring.");
+
+namespace shaka {
+
+#if defined(__linux__)
+
+namespace {
+
+// The kernel limits the length of a single read or write, so larger writes
+// complete in several steps.
+const uint64_t kMaxWriteSize = 1ULL << 30;
+
+int IoUringSetup(unsigned entries, struct io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int IoUringEnter(int fd,
+                 unsigned to_submit,
+                 unsigned min_complete,
+                 unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit,
+                                  min_complete, flags, nullptr, 0));
+}
+
+int IoUringRegister(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+  return static_cast<int>(
+      syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+}  // namespace
+
+// A minimal io_uring submission and completion queue pair, using the raw
+// system calls.  A single ring is shared by all the files of the process, so
+// that opening a file or writing a manifest does not set up and tear down a
+// ring of its own.  Submissions and completions are serialized by a mutex.  A
+// thread waiting for an operation either reaps the completions of every
+// thread, or waits for the thread which does.
+class UringFile::Ring {
+ public:
+  // The result of an operation, set when it completes.  The user_data of each
+  // submitted entry points to one.
+  struct Completion {
+    std::atomic<bool> done{false};
+    int32_t result = 0;
+  };
+
+  Ring() = default;
+
+  ~Ring() {
+    if (sqes_ != MAP_FAILED)
+      munmap(sqes_, sqes_size_);
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_)
+      munmap(cq_ring_, cq_ring_size_);
+    if (sq_ring_ != MAP_FAILED)
+      munmap(sq_ring_, sq_ring_size_);
+    if (fd_ >= 0)
+      close(fd_);
+  }
+
+  // @return the ring shared by the process, or nullptr if it could not be set
+  //         up.
+  static Ring* GetInstance() {
+    // Never destroyed, as files may still be written during static
+    // destruction.
+    static Ring* const instance = [] {
+      Ring* ring = new Ring;
+      if (!ring->Initialize(kRingEntries)) {
+        delete ring;
+        return static_cast<Ring*>(nullptr);
+      }
+      return ring;
+    }();
+    return instance;
+  }
+
+  // Returns true if the kernel supports all of |opcodes|.
+  bool SupportsOperations(const std::vector<uint8_t>& opcodes) {
+    const size_t kMaxOperations = 256;
+    std::vector<uint8_t> storage(sizeof(struct io_uring_probe) +
+                                 kMaxOperations *
+                                     sizeof(struct io_uring_probe_op));
+    struct io_uring_probe* probe =
+        reinterpret_cast<struct io_uring_probe*>(storage.data());
+    if (IoUringRegister(fd_, IORING_REGISTER_PROBE, probe, kMaxOperations) <
+        0) {
+      VLOG(1) << "io_uring probe failed: " << strerror(errno);
+      return false;
+    }
+    for (uint8_t opcode : opcodes) {
+      if (opcode > probe->last_op ||
+          !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Submits |count| entries, consecutively so that they can be linked.  The
+  // user_data of each must point to a Completion, which is reset.  Waits for
+  // operations to complete first if the completion queue could overflow.
+  // @return the number of entries taken by the kernel, which are completed
+  //         whatever happens next.  The others are withdrawn.
+  unsigned Submit(const struct io_uring_sqe* entries, unsigned count) {
+    DCHECK_LE(count, sq_entries_);
+    for (unsigned i = 0; i < count; ++i) {
+      Completion* completion =
+          reinterpret_cast<Completion*>(entries[i].user_data);
+      completion->done.store(false, std::memory_order_relaxed);
+    }
+
+    absl::MutexLock lock(mutex_);
+    // Called with |mutex_| held.
+    const auto has_room = [this, count]() ABSL_NO_THREAD_SAFETY_ANALYSIS {
+      return in_flight_ + count <= cq_entries_;
+    };
+    if (!WaitUntilLocked(has_room))
+      return 0;
+
+    const unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    const unsigned tail = __atomic_load_n(sq_tail_, __ATOMIC_RELAXED);
+    // Entries the kernel does not take are withdrawn below, so the queue is
+    // empty between submissions.
+    DCHECK_EQ(head, tail);
+    for (unsigned i = 0; i < count; ++i) {
+      const unsigned index = (tail + i) & sq_mask_;
+      static_cast<struct io_uring_sqe*>(sqes_)[index] = entries[i];
+      sq_array_[index] = index;
+    }
+    __atomic_store_n(sq_tail_, tail + count, __ATOMIC_RELEASE);
+
+    int result;
+    do {
+      result = IoUringEnter(fd_, count, 0, 0);
+    } while (result < 0 && errno == EINTR);
+    if (result < 0)
+      LOG(ERROR) << "io_uring_enter failed: " << strerror(errno);
+
+    // The kernel only reads the submission queue in io_uring_enter, which is
+    // serialized by |mutex_|, so the entries it did not take can be withdrawn
+    // by moving the tail back.
+    const unsigned submitted =
+        __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) - tail;
+    DCHECK_LE(submitted, count);
+    __atomic_store_n(sq_tail_, tail + submitted, __ATOMIC_RELEASE);
+    in_flight_ += submitted;
+    if (submitted < count && result >= 0) {
+      LOG(ERROR) << "io_uring_enter submitted " << submitted << " of "
+                 << count << " entries.";
+    }
+    return submitted;
+  }
+
+  // Waits until |condition|, which is called with the completions reaped so
+  // far, returns true.  Returns false if completions can no longer be reaped,
+  // in which case the operations in flight may still run at any time.
+  bool WaitUntil(const std::function<bool()>& condition) {
+    absl::MutexLock lock(mutex_);
+    return WaitUntilLocked(condition);
+  }
+
+  // @return true if completions can no longer be reaped, after which nothing
+  //         is submitted.
+  bool broken() {
+    absl::MutexLock lock(mutex_);
+    return broken_;
+  }
+
+ private:
+  static const unsigned kRingEntries = 256;
+
+  bool Initialize(unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    fd_ = IoUringSetup(entries, &params);
+    if (fd_ < 0) {
+      VLOG(1) << "io_uring_setup failed: " << strerror(errno);
+      return false;
+    }
+
+    sq_ring_size_ =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap)
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED)
+      return false;
+    if (single_mmap) {
+      cq_ring_ = sq_ring_;
+    } else {
+      cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+      if (cq_ring_ == MAP_FAILED)
+        return false;
+    }
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED)
+      return false;
+
+    uint8_t* sq = static_cast<uint8_t*>(sq_ring_);
+    sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    uint8_t* cq = static_cast<uint8_t*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cq_entries_ = params.cq_entries;
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  bool WaitUntilLocked(const std::function<bool()>& condition)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    while (true) {
+      if (broken_)
+        return false;
+      // Completions are only reaped by the thread waiting in the kernel while
+      // there is one, so that it is not left waiting for a completion which
+      // another thread has taken.
+      if (!reaping_)
+        ReapCompletions();
+      if (condition())
+        return true;
+      if (reaping_) {
+        completions_reaped_.Wait(&mutex_);
+        continue;
+      }
+
+      reaping_ = true;
+      mutex_.unlock();
+      int result;
+      do {
+        result = IoUringEnter(fd_, 0, 1, IORING_ENTER_GETEVENTS);
+      } while (result < 0 && errno == EINTR);
+      mutex_.lock();
+      ReapCompletions();
+      reaping_ = false;
+      completions_reaped_.SignalAll();
+      if (result < 0) {
+        // Operations in flight can no longer be waited for, so their memory
+        // and files must be kept as they are.
+        LOG(ERROR) << "io_uring_enter failed: " << strerror(errno)
+                   << ". No longer using io_uring.";
+        broken_ = true;
+        return false;
+      }
+    }
+  }
+
+  void ReapCompletions() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    unsigned head = __atomic_load_n(cq_head_, __ATOMIC_RELAXED);
+    const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    for (; head != tail; ++head) {
+      const struct io_uring_cqe& cqe = cqes_[head & cq_mask_];
+      Completion* completion = reinterpret_cast<Completion*>(cqe.user_data);
+      completion->result = cqe.res;
+      completion->done.store(true, std::memory_order_release);
+      --in_flight_;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  }
+
+  int fd_ = -1;
+  void* sq_ring_ = MAP_FAILED;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = MAP_FAILED;
+  size_t cq_ring_size_ = 0;
+  void* sqes_ = MAP_FAILED;
+  size_t sqes_size_ = 0;
+
+  unsigned* sq_head_ = nullptr;
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned sq_entries_ = 0;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  unsigned cq_entries_ = 0;
+  struct io_uring_cqe* cqes_ = nullptr;
+
+  absl::Mutex mutex_;
+  absl::CondVar completions_reaped_;
+  // Set while a thread waits in the kernel for completions.
+  bool reaping_ ABSL_GUARDED_BY(mutex_) = false;
+  // Set when waiting for completions fails.
+  bool broken_ ABSL_GUARDED_BY(mutex_) = false;
+  // Operations submitted and not reaped yet, which are bounded by the size of
+  // the completion queue.
+  unsigned in_flight_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(Ring);
+};
+
+struct UringFile::WriteRequest {
+  std::vector<uint8_t> data;
+  uint64_t offset = 0;
+  uint64_t bytes_written = 0;
+  bool in_flight = false;
+  Ring::Completion completion;
+};
+
+UringFile::UringFile(const char* file_name, const char* mode)
+    : File(file_name),
+      file_mode_(mode),
+      fd_(-1),
+      position_(0),
+      failed_(false),
+      ring_(nullptr) {}
+
+UringFile::~UringFile() {}
+
+bool UringFile::Close() {
+  bool result = true;
+  if (fd_ >= 0) {
+    result = WaitForWrites(0);
+    if (free_requests_.size() < requests_.size()) {
+      // The ring failed with writes in flight, which the kernel may still
+      // run.  Their buffers and the file descriptor are leaked rather than
+      // released under it.
+      LOG(ERROR) << "Leaking " << requests_.size() - free_requests_.size()
+                 << " writes in flight to " << file_name() << ".";
+      for (std::unique_ptr<WriteRequest>& request : requests_) {
+        if (request->in_flight)
+          UNUSED(request.release());
+      }
+    } else {
+      result = close(fd_) == 0 && result;
+    }
+    fd_ = -1;
+  }
+  delete this;
+  return result;
+}
+
+int64_t UringFile::Read(void* buffer, uint64_t length) {
+  UNUSED(buffer);
+  UNUSED(length);
+  NOTIMPLEMENTED() << "UringFile is write-only.";
+  return -1;
+}
+
+int64_t UringFile::Write(const void* buffer, uint64_t length) {
+  DCHECK(buffer != NULL);
+  DCHECK_GE(fd_, 0);
+  if (!ring_)
+    return WriteDirectly(buffer, length);
+  const WriteBuffer write_buffer = {buffer, length};
+  return WriteV(&write_buffer, 1);
+}
+
+int64_t UringFile::WriteV(const WriteBuffer* buffers, size_t num_buffers) {
+  DCHECK(buffers || num_buffers == 0);
+  DCHECK_GE(fd_, 0);
+  if (!ring_)
+    return File::WriteV(buffers, num_buffers);
+  if (failed_)
+    return -1;
+
+  uint64_t length = 0;
+  for (size_t i = 0; i < num_buffers; ++i)
+    length += buffers[i].length;
+  if (length == 0)
+    return 0;
+
+  if (free_requests_.empty() && !WaitForWrites(requests_.size() - 1))
+    return -1;
+
+  // The buffers are gathered into a single write, as they are copied anyway.
+  WriteRequest* request = free_requests_.back();
+  free_requests_.pop_back();
+  request->data.clear();
+  for (size_t i = 0; i < num_buffers; ++i) {
+    const uint8_t* data = static_cast<const uint8_t*>(buffers[i].data);
+    request->data.insert(request->data.end(), data, data + buffers[i].length);
+  }
+  request->offset = position_;
+  request->bytes_written = 0;
+  request->in_flight = true;
+  if (!SubmitWrite(request))
+    return -1;
+
+  position_ += length;
+  VLOG(2) << "Queued write of " << length << " bytes at " << request->offset;
+  return length;
+}
+
+void UringFile::CloseForWriting() {}
+
+int64_t UringFile::Size() {
+  DCHECK_GE(fd_, 0);
+  if (!Flush()) {
+    LOG(ERROR) << "Cannot flush file.";
+    return -1;
+  }
+  struct stat info;
+  if (fstat(fd_, &info) != 0) {
+    LOG(ERROR) << "Cannot get file size, error: " << strerror(errno);
+    return -1;
+  }
+  return info.st_size;
+}
+
+bool UringFile::Flush() {
+  DCHECK_GE(fd_, 0);
+  return WaitForWrites(0);
+}
+
+bool UringFile::Seek(uint64_t position) {
+  // In-flight writes complete in any order, so they are completed before
+  // anything can be written over them.
+  if (!WaitForWrites(0))
+    return false;
+  position_ = position;
+  return true;
+}
+
+bool UringFile::Tell(uint64_t* position) {
+  *position = position_;
+  return true;
+}
+
+bool UringFile::Open() {
+  auto file_path = std::filesystem::u8path(file_name());
+
+  // Create upper level directories, as LocalFile does.
+  auto parent_path = file_path.parent_path();
+  std::error_code ec;
+  if (parent_path != "" && !std::filesystem::is_directory(parent_path, ec)) {
+    if (!std::filesystem::create_directories(parent_path, ec) && ec)
+      return false;
+  }
+
+  // Appends use explicit offsets too, since writes in flight may complete out
+  // of order.
+  const bool append = file_mode_.find('a') != std::string::npos;
+  const int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (append ? 0 : O_TRUNC);
+  fd_ = open(file_path.u8string().c_str(), flags, 0666);
+  if (fd_ < 0)
+    return false;
+  if (append) {
+    struct stat info;
+    if (fstat(fd_, &info) != 0)
+      return false;
+    position_ = info.st_size;
+  }
+
+  ring_ = Ring::GetInstance();
+  if (ring_ && ring_->broken())
+    ring_ = nullptr;
+  if (!ring_) {
+    // e.g. when the locked memory limit is reached on older kernels.
+    LOG(WARNING) << "Failed to set up io_uring for " << file_name()
+                 << ". Writing synchronously.";
+    return true;
+  }
+  const uint32_t queue_depth =
+      std::max<uint32_t>(absl::GetFlag(FLAGS_io_uring_queue_depth), 1);
+  for (uint32_t i = 0; i < queue_depth; ++i) {
+    requests_.emplace_back(new WriteRequest);
+    free_requests_.push_back(requests_.back().get());
+  }
+  return true;
+}
+
+// static
+bool UringFile::IsSupported() {
+  static const bool supported = [] {
+    Ring* ring = Ring::GetInstance();
+    const bool result =
+        ring &&
+        ring->SupportsOperations({IORING_OP_WRITE, IORING_OP_RENAMEAT});
+    if (!result)
+      LOG(WARNING) << "io_uring is not supported by this kernel.";
+    return result;
+  }();
+  return supported;
+}
+
+// static
+bool UringFile::WriteAtomically(const char* file_name,
+                                const char* temp_file_name,
+                                const std::string& contents) {
+  Ring* ring = Ring::GetInstance();
+  if (!ring || ring->broken()) {
+    if (!File::WriteStringToFile(temp_file_name, contents))
+      return false;
+    if (rename(temp_file_name, file_name) != 0) {
+      LOG(ERROR) << "Failed to replace file '" << file_name << "' with '"
+                 << temp_file_name << "', error: " << strerror(errno);
+      return false;
+    }
+    return true;
+  }
+
+  // Everything the kernel may access is owned by |operation|, which is leaked
+  // if the ring fails while it is in flight.
+  struct Operation {
+    std::string file_name;
+    std::string temp_file_name;
+    std::string contents;
+    int fd = -1;
+    Ring::Completion write_completion;
+    Ring::Completion rename_completion;
+  };
+  std::unique_ptr<Operation> operation(
+      new Operation{file_name, temp_file_name, contents});
+  operation->fd =
+      open(temp_file_name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+  if (operation->fd < 0) {
+    LOG(ERROR) << "Failed to open file " << temp_file_name
+               << ", error: " << strerror(errno);
+    return false;
+  }
+
+  // Link the rename to the write, so a single submission writes and replaces
+  // the file.  The rename is canceled if the write fails or is short, in
+  // which case the rest is submitted again.
+  uint64_t bytes_written = 0;
+  bool renamed = false;
+  while (!renamed) {
+    struct io_uring_sqe sqes[2];
+    memset(sqes, 0, sizeof(sqes));
+    sqes[0].opcode = IORING_OP_WRITE;
+    sqes[0].flags = IOSQE_IO_LINK;
+    sqes[0].fd = operation->fd;
+    sqes[0].addr =
+        reinterpret_cast<uint64_t>(operation->contents.data() + bytes_written);
+    sqes[0].len = static_cast<uint32_t>(std::min<uint64_t>(
+        operation->contents.size() - bytes_written, kMaxWriteSize));
+    sqes[0].off = bytes_written;
+    sqes[0].user_data =
+        reinterpret_cast<uint64_t>(&operation->write_completion);
+
+    sqes[1].opcode = IORING_OP_RENAMEAT;
+    sqes[1].fd = AT_FDCWD;
+    sqes[1].addr =
+        reinterpret_cast<uint64_t>(operation->temp_file_name.c_str());
+    sqes[1].len = AT_FDCWD;
+    sqes[1].addr2 = reinterpret_cast<uint64_t>(operation->file_name.c_str());
+    sqes[1].user_data =
+        reinterpret_cast<uint64_t>(&operation->rename_completion);
+
+    const unsigned submitted = ring->Submit(sqes, 2);
+    if (submitted == 0) {
+      close(operation->fd);
+      return false;
+    }
+    Operation* const op = operation.get();
+    if (!ring->WaitUntil([op, submitted]() {
+          return op->write_completion.done.load(std::memory_order_acquire) &&
+                 (submitted < 2 ||
+                  op->rename_completion.done.load(std::memory_order_acquire));
+        })) {
+      LOG(ERROR) << "Failed to wait for writing " << temp_file_name << ".";
+      UNUSED(operation.release());
+      return false;
+    }
+
+    const int32_t write_result = operation->write_completion.result;
+    if (write_result < 0 ||
+        (write_result == 0 && bytes_written < operation->contents.size())) {
+      LOG(ERROR) << "Failed to write to file " << temp_file_name << ", error: "
+                 << strerror(write_result < 0 ? -write_result : EIO);
+      close(operation->fd);
+      return false;
+    }
+    bytes_written += write_result;
+    if (submitted < 2)
+      continue;
+    const int32_t rename_result = operation->rename_completion.result;
+    if (rename_result == -ECANCELED &&
+        bytes_written < operation->contents.size()) {
+      continue;
+    }
+    if (rename_result < 0) {
+      LOG(ERROR) << "Failed to replace file '" << file_name << "' with '"
+                 << temp_file_name << "', error: " << strerror(-rename_result);
+      close(operation->fd);
+      return false;
+    }
+    renamed = true;
+  }
+
+  if (close(operation->fd) != 0) {
+    LOG(ERROR) << "Failed to close file " << file_name
+               << ", error: " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+bool UringFile::SubmitWrite(WriteRequest* request) {
+  const uint64_t remaining = request->data.size() - request->bytes_written;
+  struct io_uring_sqe sqe;
+  memset(&sqe, 0, sizeof(sqe));
+  sqe.opcode = IORING_OP_WRITE;
+  sqe.fd = fd_;
+  sqe.addr =
+      reinterpret_cast<uint64_t>(request->data.data() + request->bytes_written);
+  sqe.len = static_cast<uint32_t>(std::min(remaining, kMaxWriteSize));
+  sqe.off = request->offset + request->bytes_written;
+  sqe.user_data = reinterpret_cast<uint64_t>(&request->completion);
+  if (ring_->Submit(&sqe, 1) == 0) {
+    // Not taken by the kernel, so the request can be reused.
+    request->in_flight = false;
+    free_requests_.push_back(request);
+    failed_ = true;
+    return false;
+  }
+  return true;
+}
+
+int64_t UringFile::WriteDirectly(const void* buffer, uint64_t length) {
+  const uint8_t* data = static_cast<const uint8_t*>(buffer);
+  uint64_t bytes_written = 0;
+  while (bytes_written < length) {
+    const ssize_t result = pwrite(fd_, data + bytes_written,
+                                  length - bytes_written, position_);
+    if (result < 0 && errno == EINTR)
+      continue;
+    if (result < 0)
+      return bytes_written > 0 ? bytes_written : -1;
+    bytes_written += result;
+    position_ += result;
+  }
+  return bytes_written;
+}
+
+bool UringFile::HasCompletedWrite() const {
+  for (const std::unique_ptr<WriteRequest>& request : requests_) {
+    if (request->in_flight &&
+        request->completion.done.load(std::memory_order_acquire)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool UringFile::WaitForWrites(size_t max_in_flight) {
+  if (!ring_)
+    return true;
+
+  while (true) {
+    for (const std::unique_ptr<WriteRequest>& owned_request : requests_) {
+      WriteRequest* request = owned_request.get();
+      if (!request->in_flight ||
+          !request->completion.done.load(std::memory_order_acquire)) {
+        continue;
+      }
+
+      const int32_t result = request->completion.result;
+      if (result <= 0) {
+        LOG(ERROR) << "Failed to write to " << file_name() << " at offset "
+                   << request->offset + request->bytes_written
+                   << ", error: " << strerror(result < 0 ? -result : EIO);
+        failed_ = true;
+      } else {
+        request->bytes_written += result;
+        if (request->bytes_written < request->data.size()) {
+          // Short write.  Queue the rest.  The request is released if this
+          // fails.
+          SubmitWrite(request);
+          continue;
+        }
+      }
+      request->in_flight = false;
+      free_requests_.push_back(request);
+    }
+
+    if (requests_.size() - free_requests_.size() <= max_in_flight)
+      return !failed_;
+    if (!ring_->WaitUntil([this]() { return HasCompletedWrite(); })) {
+      // The writes in flight stay in flight, as the kernel may still run
+      // them.  Close() leaks them.
+      failed_ = true;
+      return false;
+    }
+  }
+}
+
+#else  // defined(__linux__)
+
+// static
+bool UringFile::IsSupported() {
+  return false;
+}
+
+// static
+bool UringFile::WriteAtomically(const char* file_name,
+                                const char* temp_file_name,
+                                const std::string& contents) {
+  UNUSED(file_name);
+  UNUSED(temp_file_name);
+  UNUSED(contents);
+  NOTIMPLEMENTED() << "io_uring is only supported on Linux.";
+  return false;
+}
+
+#endif  // defined(__linux__)
+
+}  // namespace shaka
@@ -0,0 +1,91 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_FILE_URING_FILE_H_
+#define PACKAGER_FILE_URING_FILE_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <packager/file.h>
+#include <packager/macros/classes.h>
+
+namespace shaka {
+
+/// Implements a write-only local file which submits its writes through
+/// io_uring, so that writing does not block on page cache or device writeback.
+/// Each write is copied and queued, with up to --io_uring_queue_depth writes
+/// in flight at once.  Flush, Seek, Size and Close wait for all in-flight
+/// writes to complete.  All the files share one ring.
+///
+/// Only available on Linux.  Check IsSupported() before creating one.
+class UringFile : public File {
+ public:
+  /// @param file_name C string containing the name of the file to be accessed.
+  /// @param mode C string containing the file access mode, "w" or "a".
+  UringFile(const char* file_name, const char* mode);
+
+  /// @name File implementation overrides.
+  /// @{
+  bool Close() override;
+  int64_t Read(void* buffer, uint64_t length) override;
+  int64_t Write(const void* buffer, uint64_t length) override;
+  int64_t WriteV(const WriteBuffer* buffers, size_t num_buffers) override;
+  void CloseForWriting() override;
+  int64_t Size() override;
+  bool Flush() override;
+  bool Seek(uint64_t position) override;
+  bool Tell(uint64_t* position) override;
+  /// @}
+
+  /// @return true if the running kernel supports the io_uring operations used
+  ///         by UringFile.  The result is computed once and cached.
+  static bool IsSupported();
+
+  /// Writes @a contents to @a temp_file_name and renames it to @a file_name,
+  /// submitting both operations to io_uring at once.
+  /// @return true if successful, or false otherwise.
+  static bool WriteAtomically(const char* file_name,
+                              const char* temp_file_name,
+                              const std::string& contents);
+
+ protected:
+  ~UringFile() override;
+
+  bool Open() override;
+
+ private:
+  class Ring;
+  struct WriteRequest;
+
+  // Queues the unwritten part of |request|.  Releases |request| if the kernel
+  // does not take it.
+  bool SubmitWrite(WriteRequest* request);
+  // Writes synchronously, if the ring could not be set up.
+  int64_t WriteDirectly(const void* buffer, uint64_t length);
+  // Returns true if a write in flight has completed, but is not handled yet.
+  bool HasCompletedWrite() const;
+  // Waits until at most |max_in_flight| writes are in flight.  If the ring
+  // fails, the writes in flight are left in flight.
+  bool WaitForWrites(size_t max_in_flight);
+
+  std::string file_mode_;
+  int fd_;
+  uint64_t position_;
+  bool failed_;
+  // Shared by all the files, or nullptr if it could not be set up.
+  Ring* ring_;
+  std::vector<std::unique_ptr<WriteRequest>> requests_;
+  std::vector<WriteRequest*> free_requests_;
+
+  DISALLOW_COPY_AND_ASSIGN(UringFile);
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_FILE_URING_FILE_H_
@@ -0,0 +1,214 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/file/uring_file.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+#include <absl/flags/declare.h>
+#include <absl/flags/flag.h>
+#include <gtest/gtest.h>
+
+#include <packager/file/file_closer.h>
+#include <packager/flag_saver.h>
+
+ABSL_DECLARE_FLAG(bool, use_io_uring);
+ABSL_DECLARE_FLAG(uint32_t, io_uring_queue_depth);
+
+namespace shaka {
+
+namespace {
+
+std::string MakeData(size_t size, int seed) {
+  std::string data(size, 0);
+  for (size_t i = 0; i < size; ++i)
+    data[i] = static_cast<char>((i * 31 + seed) & 0xff);
+  return data;
+}
+
+}  // namespace
+
+class UringFileTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    if (!UringFile::IsSupported())
+      GTEST_SKIP() << "io_uring is not supported.";
+
+    absl::SetFlag(&FLAGS_use_io_uring, true);
+    temp_dir_ = std::filesystem::temp_directory_path() /
+                ("uring_file_test_" + std::to_string(getpid()));
+    std::filesystem::create_directories(temp_dir_);
+    file_name_ = (temp_dir_ / "sub" / "file.bin").string();
+  }
+
+  void TearDown() override {
+    std::error_code ec;
+    std::filesystem::remove_all(temp_dir_, ec);
+  }
+
+  // Opens |file_name| without the threaded I/O cache, so that the returned
+  // file is a UringFile.
+  std::unique_ptr<File, FileCloser> OpenUringFile(const std::string& file_name,
+                                                  const char* mode) {
+    std::unique_ptr<File, FileCloser> file(
+        File::OpenWithNoBuffering(file_name.c_str(), mode));
+    EXPECT_TRUE(dynamic_cast<UringFile*>(file.get()));
+    return file;
+  }
+
+  std::string ReadFile(const std::string& file_name) {
+    std::string contents;
+    EXPECT_TRUE(File::ReadFileToString(file_name.c_str(), &contents));
+    return contents;
+  }
+
+  FlagSaver<bool> use_io_uring_saver_{&FLAGS_use_io_uring};
+  std::filesystem::path temp_dir_;
+  std::string file_name_;
+};
+
+TEST_F(UringFileTest, WriteMoreThanQueueDepth) {
+  FlagSaver<uint32_t> saver(&FLAGS_io_uring_queue_depth);
+  absl::SetFlag(&FLAGS_io_uring_queue_depth, 2);
+
+  auto uring_file = OpenUringFile(file_name_, "w");
+  ASSERT_TRUE(uring_file);
+
+  std::string expected;
+  for (int i = 0; i < 20; ++i) {
+    const std::string data = MakeData(1000 + i * 100, i);
+    ASSERT_EQ(static_cast<int64_t>(data.size()),
+              uring_file->Write(data.data(), data.size()));
+    expected += data;
+  }
+  EXPECT_EQ(static_cast<int64_t>(expected.size()), uring_file->Size());
+  ASSERT_TRUE(uring_file.release()->Close());
+
+  EXPECT_EQ(expected, ReadFile(file_name_));
+}
+
+TEST_F(UringFileTest, WriteV) {
+  auto file = OpenUringFile(file_name_, "w");
+  ASSERT_TRUE(file);
+
+  const std::string data1 = MakeData(1000, 1);
+  const std::string data2 = MakeData(3000, 2);
+  const File::WriteBuffer buffers[] = {{data1.data(), data1.size()},
+                                       {data2.data(), data2.size()}};
+  ASSERT_EQ(static_cast<int64_t>(data1.size() + data2.size()),
+            file->WriteV(buffers, 2));
+  ASSERT_EQ(3, file->Write("abc", 3));
+  ASSERT_TRUE(file.release()->Close());
+
+  EXPECT_EQ(data1 + data2 + "abc", ReadFile(file_name_));
+}
+
+TEST_F(UringFileTest, FilesWrittenConcurrently) {
+  FlagSaver<uint32_t> saver(&FLAGS_io_uring_queue_depth);
+  absl::SetFlag(&FLAGS_io_uring_queue_depth, 2);
+
+  // The files share a ring, so each thread also reaps the completions of the
+  // others.
+  const int kNumThreads = 8;
+  std::vector<std::string> file_names;
+  std::vector<std::string> expected(kNumThreads);
+  for (int i = 0; i < kNumThreads; ++i)
+    file_names.push_back((temp_dir_ / ("file" + std::to_string(i))).string());
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&, i]() {
+      std::unique_ptr<File, FileCloser> file(
+          File::OpenWithNoBuffering(file_names[i].c_str(), "w"));
+      ASSERT_TRUE(file);
+      for (int j = 0; j < 50; ++j) {
+        const std::string data = MakeData(1000 + j, i * 100 + j);
+        ASSERT_EQ(static_cast<int64_t>(data.size()),
+                  file->Write(data.data(), data.size()));
+        expected[i] += data;
+      }
+      ASSERT_TRUE(file.release()->Close());
+
+      const std::string manifest = file_names[i] + ".mpd";
+      ASSERT_TRUE(UringFile::WriteAtomically(
+          manifest.c_str(), (manifest + ".tmp").c_str(), expected[i]));
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (int i = 0; i < kNumThreads; ++i) {
+    EXPECT_EQ(expected[i], ReadFile(file_names[i]));
+    EXPECT_EQ(expected[i], ReadFile(file_names[i] + ".mpd"));
+  }
+}
+
+TEST_F(UringFileTest, SeekAndOverwrite) {
+  auto file = OpenUringFile(file_name_, "w");
+  ASSERT_TRUE(file);
+
+  const std::string data = MakeData(4096, 1);
+  ASSERT_EQ(4096, file->Write(data.data(), data.size()));
+  ASSERT_TRUE(file->Seek(100));
+  ASSERT_EQ(3, file->Write("abc", 3));
+  uint64_t position = 0;
+  ASSERT_TRUE(file->Tell(&position));
+  EXPECT_EQ(103u, position);
+  ASSERT_TRUE(file.release()->Close());
+
+  std::string expected = data;
+  expected.replace(100, 3, "abc");
+  EXPECT_EQ(expected, ReadFile(file_name_));
+}
+
+TEST_F(UringFileTest, Append) {
+  ASSERT_TRUE(File::WriteStringToFile(file_name_.c_str(), "0123"));
+  EXPECT_EQ("0123", ReadFile(file_name_));
+
+  auto file = OpenUringFile(file_name_, "a");
+  ASSERT_TRUE(file);
+  ASSERT_EQ(4, file->Write("4567", 4));
+  ASSERT_EQ(2, file->Write("89", 2));
+  ASSERT_TRUE(file.release()->Close());
+
+  EXPECT_EQ("0123456789", ReadFile(file_name_));
+}
+
+TEST_F(UringFileTest, WriteAtomically) {
+  const std::string temp_file_name = (temp_dir_ / "temp.bin").string();
+  const std::string target = (temp_dir_ / "manifest.mpd").string();
+  ASSERT_TRUE(File::WriteStringToFile(target.c_str(), "old contents"));
+
+  const std::string contents = MakeData(100000, 7);
+  ASSERT_TRUE(UringFile::WriteAtomically(target.c_str(),
+                                         temp_file_name.c_str(), contents));
+  EXPECT_EQ(contents, ReadFile(target));
+  EXPECT_FALSE(std::filesystem::exists(temp_file_name));
+}
+
+TEST_F(UringFileTest, NotUsedForReading) {
+  ASSERT_TRUE(File::WriteStringToFile(file_name_.c_str(), "data"));
+  std::unique_ptr<File, FileCloser> file(
+      File::OpenWithNoBuffering(file_name_.c_str(), "r"));
+  ASSERT_TRUE(file);
+  EXPECT_FALSE(dynamic_cast<UringFile*>(file.get()));
+}
+
+TEST_F(UringFileTest, UsedByFile) {
+  const std::string contents = MakeData(300000, 3);
+  ASSERT_TRUE(File::WriteStringToFile(file_name_.c_str(), contents));
+  EXPECT_EQ(contents, ReadFile(file_name_));
+
+  const std::string manifest = (temp_dir_ / "manifest.m3u8").string();
+  ASSERT_TRUE(File::WriteFileAtomically(manifest.c_str(), "#EXTM3U\n"));
+  EXPECT_EQ("#EXTM3U\n", ReadFile(manifest));
+}
+
+}  // namespace shaka
@@ -0,0 +1,172 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/async_queue/async_queue_handler.h>
+
+#include <absl/log/check.h>
+#include <absl/log/log.h>
+
+#include <packager/macros/status.h>
+
+namespace shaka {
+namespace media {
+
+AsyncQueueHandler::AsyncQueueHandler(size_t capacity) : capacity_(capacity) {
+  DCHECK_GT(capacity_, 0u);
+}
+
+AsyncQueueHandler::~AsyncQueueHandler() {
+  {
+    absl::MutexLock lock(mutex_);
+    // Anything still queued will never be flushed, so drop it.
+    cancelled_ = true;
+    terminated_ = true;
+    ClearQueue();
+    not_empty_.Signal();
+  }
+  if (thread_)
+    thread_->join();
+}
+
+void AsyncQueueHandler::Cancel() {
+  absl::MutexLock lock(mutex_);
+  cancelled_ = true;
+  ClearQueue();
+  not_full_.SignalAll();
+  flush_done_.SignalAll();
+}
+
+Status AsyncQueueHandler::InitializeInternal() {
+  thread_.reset(new std::thread(&AsyncQueueHandler::ThreadMain, this));
+  return Status::OK;
+}
+
+Status AsyncQueueHandler::Process(std::unique_ptr<StreamData> stream_data) {
+  absl::MutexLock lock(mutex_);
+  Item item;
+  item.stream_data = std::move(stream_data);
+  return Push(std::move(item));
+}
+
+Status AsyncQueueHandler::ProcessBatch(
+    absl::Span<std::unique_ptr<StreamData>> batch) {
+  absl::MutexLock lock(mutex_);
+  for (auto& stream_data : batch) {
+    Item item;
+    item.stream_data = std::move(stream_data);
+    RETURN_IF_ERROR(Push(std::move(item)));
+  }
+  return Status::OK;
+}
+
+Status AsyncQueueHandler::OnFlushRequest(size_t input_stream_index) {
+  absl::MutexLock lock(mutex_);
+  Item item;
+  item.flush_stream_index = input_stream_index;
+  RETURN_IF_ERROR(Push(std::move(item)));
+
+  // Wait for the flush to propagate downstream.
+  const uint64_t flush_number = ++num_flushes_requested_;
+  while (num_flushes_done_ < flush_number && !cancelled_ &&
+         downstream_status_.ok()) {
+    flush_done_.Wait(&mutex_);
+  }
+  return GetError();
+}
+
+Status AsyncQueueHandler::Push(Item item) {
+  while (queue_.size() >= capacity_ && !cancelled_ && downstream_status_.ok())
+    not_full_.Wait(&mutex_);
+  RETURN_IF_ERROR(GetError());
+
+  if (memory_budget() && item.stream_data &&
+      item.stream_data->stream_data_type == StreamDataType::kMediaSample) {
+    item.reserved_bytes = item.stream_data->media_sample->data_size();
+    memory_budget()->Reserve(item.reserved_bytes);
+    queued_bytes_ += item.reserved_bytes;
+  }
+  queue_.push_back(std::move(item));
+  if (metrics())
+    metrics()->SetQueueDepth(queue_.size());
+  not_empty_.Signal();
+  return Status::OK;
+}
+
+void AsyncQueueHandler::ClearQueue() {
+  queue_.clear();
+  if (memory_budget())
+    memory_budget()->Release(queued_bytes_);
+  queued_bytes_ = 0;
+  if (metrics())
+    metrics()->SetQueueDepth(0);
+}
+
+Status AsyncQueueHandler::GetError() const {
+  if (cancelled_)
+    return Status(error::CANCELLED, "AsyncQueueHandler is cancelled.");
+  return downstream_status_;
+}
+
+void AsyncQueueHandler::ThreadMain() {
+  std::vector<std::unique_ptr<StreamData>> batch;
+  while (true) {
+    Item item;
+    {
+      absl::MutexLock lock(mutex_);
+      while (queue_.empty() && !terminated_)
+        not_empty_.Wait(&mutex_);
+      if (terminated_)
+        return;
+      item = std::move(queue_.front());
+      queue_.pop_front();
+      uint64_t released_bytes = item.reserved_bytes;
+      // Take the stream data queued up to the next flush request along.
+      if (item.stream_data) {
+        batch.push_back(std::move(item.stream_data));
+        while (!queue_.empty() && queue_.front().stream_data) {
+          released_bytes += queue_.front().reserved_bytes;
+          batch.push_back(std::move(queue_.front().stream_data));
+          queue_.pop_front();
+        }
+      }
+      // The memory is handed over to the downstream handlers, which account
+      // for it themselves if they buffer it.
+      if (released_bytes > 0) {
+        memory_budget()->Release(released_bytes);
+        queued_bytes_ -= released_bytes;
+      }
+      if (metrics())
+        metrics()->SetQueueDepth(queue_.size());
+      not_full_.SignalAll();
+    }
+
+    const bool is_flush = batch.empty();
+    Status status;
+    if (is_flush) {
+      status = FlushDownstream(item.flush_stream_index);
+    } else {
+      status = DispatchBatch(absl::MakeSpan(batch));
+      batch.clear();
+    }
+
+    absl::MutexLock lock(mutex_);
+    if (!status.ok() && downstream_status_.ok()) {
+      LOG(ERROR) << "Downstream of AsyncQueueHandler failed: " << status;
+      downstream_status_ = status;
+      // Nothing will be dispatched after an error, so unblock upstream.
+      ClearQueue();
+      not_full_.SignalAll();
+      flush_done_.SignalAll();
+    }
+    if (is_flush) {
+      ++num_flushes_done_;
+      flush_done_.SignalAll();
+    }
+  }
+}
+
+}  // namespace media
+}  // namespace shaka
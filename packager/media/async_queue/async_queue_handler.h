@@ -0,0 +1,95 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_ASYNC_QUEUE_ASYNC_QUEUE_HANDLER_H_
+#define PACKAGER_MEDIA_ASYNC_QUEUE_ASYNC_QUEUE_HANDLER_H_
+
+#include <deque>
+#include <memory>
+#include <thread>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/media/base/media_handler.h>
+
+namespace shaka {
+namespace media {
+
+/// AsyncQueueHandler decouples its downstream handlers from its upstream
+/// handlers: stream data is queued and dispatched downstream on a worker
+/// thread of its own, so that a slow downstream handler, e.g. a muxer writing
+/// to a slow server, does not stall its upstream handlers until the queue is
+/// full.  The output stream at a specific index comes from the input stream at
+/// the same index, in the same order.  Whatever is queued when the worker
+/// thread gets to it is dispatched as a batch.
+///
+/// A flush request is forwarded downstream once everything queued before it
+/// has been dispatched, and only returns after the downstream flush
+/// completed, so that the end of stream is observed as in a synchronous graph.
+/// Downstream errors are returned from the next Process or flush request.
+/// The samples queued are accounted for in the memory budget of the handler.
+class AsyncQueueHandler : public MediaHandler {
+ public:
+  /// @param capacity is the maximum number of stream data queued at once.
+  explicit AsyncQueueHandler(size_t capacity);
+  ~AsyncQueueHandler() override;
+
+  /// Drops all queued stream data and fails pending and future Process and
+  /// flush requests with CANCELLED.  Does not block.
+  void Cancel();
+
+ protected:
+  /// @name MediaHandler implementation overrides.
+  /// @{
+  Status InitializeInternal() override;
+  Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status ProcessBatch(absl::Span<std::unique_ptr<StreamData>> batch) override;
+  Status OnFlushRequest(size_t input_stream_index) override;
+  /// @}
+
+ private:
+  AsyncQueueHandler(const AsyncQueueHandler&) = delete;
+  AsyncQueueHandler& operator=(const AsyncQueueHandler&) = delete;
+
+  struct Item {
+    // Flush request if null.
+    std::unique_ptr<StreamData> stream_data;
+    size_t flush_stream_index = 0;
+    // Memory reserved for |stream_data| in the memory budget.
+    uint64_t reserved_bytes = 0;
+  };
+
+  // Queues |item|, blocking while the queue is full.
+  Status Push(Item item) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Drops all queued stream data.
+  void ClearQueue() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Returns the error to report to upstream, if any.
+  Status GetError() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void ThreadMain();
+
+  const size_t capacity_;
+
+  absl::Mutex mutex_;
+  std::deque<Item> queue_ ABSL_GUARDED_BY(mutex_);
+  // Memory reserved for the queued stream data.
+  uint64_t queued_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::CondVar not_empty_ ABSL_GUARDED_BY(mutex_);
+  absl::CondVar not_full_ ABSL_GUARDED_BY(mutex_);
+  absl::CondVar flush_done_ ABSL_GUARDED_BY(mutex_);
+  // The first error returned by a downstream handler.
+  Status downstream_status_ ABSL_GUARDED_BY(mutex_);
+  uint64_t num_flushes_requested_ ABSL_GUARDED_BY(mutex_) = 0;
+  uint64_t num_flushes_done_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool cancelled_ ABSL_GUARDED_BY(mutex_) = false;
+  bool terminated_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::unique_ptr<std::thread> thread_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_ASYNC_QUEUE_ASYNC_QUEUE_HANDLER_H_
@@ -0,0 +1,199 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/async_queue/async_queue_handler.h>
+
+#include <thread>
+
+#include <absl/synchronization/notification.h>
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <packager/media/base/media_handler_test_base.h>
+#include <packager/status/status_test_util.h>
+
+using ::testing::_;
+using ::testing::InSequence;
+using ::testing::Invoke;
+
+namespace shaka {
+namespace media {
+namespace {
+
+const size_t kQueueCapacity = 2;
+const size_t kStreamIndex = 0;
+const int32_t kTimescale = 1000;
+const int64_t kDuration = 1000;
+const bool kKeyFrame = true;
+const bool kEncrypted = true;
+
+// A handler which fails every stream data and flush request.
+class FailingMediaHandler : public MediaHandler {
+ private:
+  Status InitializeInternal() override { return Status::OK; }
+  Status Process(std::unique_ptr<StreamData>) override {
+    return Status(error::MUXER_FAILURE, "Failed to process.");
+  }
+  Status OnFlushRequest(size_t) override {
+    return Status(error::MUXER_FAILURE, "Failed to flush.");
+  }
+};
+
+}  // namespace
+
+class AsyncQueueHandlerTest : public MediaHandlerTestBase {
+ protected:
+  void SetUpAndInitializeGraph(size_t num_streams) {
+    handler_ = std::make_shared<AsyncQueueHandler>(kQueueCapacity);
+    ASSERT_OK(MediaHandlerTestBase::SetUpAndInitializeGraph(
+        handler_, num_streams, num_streams));
+  }
+
+  Status DispatchSample(size_t input, int64_t timestamp) {
+    return Input(input)->Dispatch(StreamData::FromMediaSample(
+        kStreamIndex, GetMediaSample(timestamp, kDuration, kKeyFrame)));
+  }
+
+  std::shared_ptr<AsyncQueueHandler> handler_;
+};
+
+TEST_F(AsyncQueueHandlerTest, DispatchesInOrderBeforeFlush) {
+  SetUpAndInitializeGraph(1);
+
+  const std::thread::id test_thread = std::this_thread::get_id();
+  {
+    InSequence s;
+    EXPECT_CALL(*Output(0), OnProcess(IsStreamInfo(kStreamIndex, kTimescale,
+                                                   !kEncrypted, _)))
+        .WillOnce(Invoke([test_thread](const StreamData*) {
+          EXPECT_NE(test_thread, std::this_thread::get_id());
+        }));
+    for (int i = 0; i < 5; ++i) {
+      EXPECT_CALL(*Output(0), OnProcess(IsMediaSample(
+                                  kStreamIndex, i * kDuration, kDuration,
+                                  !kEncrypted, kKeyFrame)));
+    }
+    EXPECT_CALL(*Output(0), OnFlush(kStreamIndex));
+  }
+
+  ASSERT_OK(Input(0)->Dispatch(StreamData::FromStreamInfo(
+      kStreamIndex, GetVideoStreamInfo(kTimescale))));
+  for (int i = 0; i < 5; ++i)
+    ASSERT_OK(DispatchSample(0, i * kDuration));
+  // Flushing only returns once everything has reached the output.
+  ASSERT_OK(Input(0)->FlushAllDownstreams());
+  testing::Mock::VerifyAndClearExpectations(Output(0));
+}
+
+TEST_F(AsyncQueueHandlerTest, DispatchesBatchesInOrder) {
+  SetUpAndInitializeGraph(1);
+
+  const int kNumSamples = 5;
+  {
+    InSequence s;
+    for (int i = 0; i < kNumSamples; ++i) {
+      EXPECT_CALL(*Output(0), OnProcess(IsMediaSample(
+                                  kStreamIndex, i * kDuration, kDuration,
+                                  !kEncrypted, kKeyFrame)));
+    }
+    EXPECT_CALL(*Output(0), OnFlush(kStreamIndex));
+  }
+
+  // The batch is larger than the queue.
+  std::vector<std::unique_ptr<StreamData>> batch;
+  for (int i = 0; i < kNumSamples; ++i) {
+    batch.push_back(StreamData::FromMediaSample(
+        kStreamIndex, GetMediaSample(i * kDuration, kDuration, kKeyFrame)));
+  }
+  ASSERT_OK(Input(0)->DispatchBatch(absl::MakeSpan(batch)));
+  ASSERT_OK(Input(0)->FlushAllDownstreams());
+  testing::Mock::VerifyAndClearExpectations(Output(0));
+}
+
+TEST_F(AsyncQueueHandlerTest, KeepsStreamsApart) {
+  SetUpAndInitializeGraph(2);
+
+  EXPECT_CALL(*Output(0), OnProcess(IsMediaSample(kStreamIndex, 0, kDuration,
+                                                  !kEncrypted, kKeyFrame)));
+  EXPECT_CALL(*Output(1),
+              OnProcess(IsMediaSample(kStreamIndex, kDuration, kDuration,
+                                      !kEncrypted, kKeyFrame)));
+  EXPECT_CALL(*Output(0), OnFlush(kStreamIndex));
+  EXPECT_CALL(*Output(1), OnFlush(kStreamIndex));
+
+  ASSERT_OK(DispatchSample(0, 0));
+  ASSERT_OK(DispatchSample(1, kDuration));
+  ASSERT_OK(Input(0)->FlushAllDownstreams());
+  ASSERT_OK(Input(1)->FlushAllDownstreams());
+  testing::Mock::VerifyAndClearExpectations(Output(0));
+  testing::Mock::VerifyAndClearExpectations(Output(1));
+}
+
+TEST_F(AsyncQueueHandlerTest, DoesNotWaitForSlowDownstream) {
+  SetUpAndInitializeGraph(1);
+
+  absl::Notification unblock;
+  EXPECT_CALL(*Output(0), OnProcess(_))
+      .WillOnce(Invoke([&unblock](const StreamData*) {
+        unblock.WaitForNotification();
+      }))
+      .WillRepeatedly(Invoke([](const StreamData*) {}));
+
+  // The first sample blocks the downstream, the others fill up the queue.
+  for (size_t i = 0; i <= kQueueCapacity; ++i)
+    ASSERT_OK(DispatchSample(0, i * kDuration));
+
+  unblock.Notify();
+  ASSERT_OK(Input(0)->FlushAllDownstreams());
+}
+
+TEST_F(AsyncQueueHandlerTest, ReturnsDownstreamError) {
+  auto input = std::make_shared<FakeInputMediaHandler>();
+  auto handler = std::make_shared<AsyncQueueHandler>(kQueueCapacity);
+  ASSERT_OK(input->AddHandler(handler));
+  ASSERT_OK(handler->AddHandler(std::make_shared<FailingMediaHandler>()));
+  ASSERT_OK(input->Initialize());
+
+  // The error may or may not have been reported by the time the sample is
+  // queued, but it is reported by the flush at the latest.
+  Status status = input->Dispatch(StreamData::FromMediaSample(
+      kStreamIndex, GetMediaSample(0, kDuration, kKeyFrame)));
+  if (status.ok())
+    status = input->FlushAllDownstreams();
+  EXPECT_EQ(error::MUXER_FAILURE, status.error_code());
+
+  // Later requests keep failing.
+  status = input->Dispatch(StreamData::FromMediaSample(
+      kStreamIndex, GetMediaSample(kDuration, kDuration, kKeyFrame)));
+  EXPECT_EQ(error::MUXER_FAILURE, status.error_code());
+}
+
+TEST_F(AsyncQueueHandlerTest, CancelUnblocksUpstream) {
+  SetUpAndInitializeGraph(1);
+
+  absl::Notification unblock;
+  ON_CALL(*Output(0), OnProcess(_))
+      .WillByDefault(Invoke([&unblock](const StreamData*) {
+        unblock.WaitForNotification();
+      }));
+
+  // Keeps dispatching until the queue is full, then blocks until cancelled.
+  Status status;
+  std::thread upstream([this, &status]() {
+    for (int i = 0; status.ok() && i < 100; ++i)
+      status = DispatchSample(0, i * kDuration);
+  });
+
+  handler_->Cancel();
+  upstream.join();
+  EXPECT_EQ(error::CANCELLED, status.error_code());
+  EXPECT_EQ(error::CANCELLED, Input(0)->FlushAllDownstreams().error_code());
+
+  unblock.Notify();
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,160 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/buffer_pool.h>
+
+#include <new>
+
+#include <absl/flags/flag.h>
+#include <absl/log/check.h>
+#include <absl/numeric/bits.h>
+
+ABSL_FLAG(uint64_t,
+          buffer_pool_cache_bytes,
+          64 << 20,
+          "Maximum number of bytes of freed sample buffers kept for reuse by "
+          "later samples. Specify 0 to free sample buffers right away.");
+
+namespace shaka {
+namespace media {
+namespace {
+
+// Size classes are kMinSizeClass, then four per power of two up to
+// kMaxSizeClass.
+const size_t kMinSizeClassLog2 = 5;
+const size_t kMaxSizeClassLog2 = 23;
+const size_t kMinSizeClass = 1 << kMinSizeClassLog2;
+const size_t kMaxSizeClass = 1 << kMaxSizeClassLog2;
+const size_t kSizeClassesPerPowerOfTwo = 4;
+const size_t kNumSizeClasses =
+    1 + (kMaxSizeClassLog2 - kMinSizeClassLog2) * kSizeClassesPerPowerOfTwo;
+
+size_t GetSizeClassSize(size_t index) {
+  if (index == 0)
+    return kMinSizeClass;
+  const size_t base = size_t{1}
+                      << (kMinSizeClassLog2 +
+                          (index - 1) / kSizeClassesPerPowerOfTwo);
+  const size_t step = base / kSizeClassesPerPowerOfTwo;
+  return base + ((index - 1) % kSizeClassesPerPowerOfTwo + 1) * step;
+}
+
+void UpdatePeak(uint64_t value, std::atomic<uint64_t>* peak) {
+  uint64_t current = peak->load(std::memory_order_relaxed);
+  while (value > current &&
+         !peak->compare_exchange_weak(current, value,
+                                      std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+BufferPool* BufferPool::GetInstance() {
+  // Never destroyed, since samples may outlive static destruction.
+  static BufferPool* instance = new BufferPool;
+  return instance;
+}
+
+BufferPool::BufferPool()
+    : max_bytes_cached_(absl::GetFlag(FLAGS_buffer_pool_cache_bytes)) {
+  for (size_t i = 0; i < kNumSizeClasses; ++i)
+    size_classes_.emplace_back(new SizeClass);
+}
+
+void* BufferPool::Allocate(size_t size) {
+  ++num_allocations_;
+  const size_t allocation_size = GetAllocationSize(size);
+  UpdatePeak(bytes_in_use_ += allocation_size, &peak_bytes_in_use_);
+  if (!IsPooled(size))
+    return ::operator new(allocation_size);
+
+  SizeClass* size_class = size_classes_[GetSizeClassIndex(size)].get();
+  {
+    absl::MutexLock lock(size_class->mutex);
+    if (!size_class->free_blocks.empty()) {
+      void* block = size_class->free_blocks.back();
+      size_class->free_blocks.pop_back();
+      bytes_cached_ -= allocation_size;
+      ++num_reused_;
+      return block;
+    }
+  }
+  return ::operator new(allocation_size);
+}
+
+void BufferPool::Free(void* block, size_t size) {
+  if (!block)
+    return;
+  const size_t allocation_size = GetAllocationSize(size);
+  bytes_in_use_ -= allocation_size;
+  // The limit may be exceeded slightly when blocks are freed concurrently.
+  if (IsPooled(size) &&
+      bytes_cached_.load(std::memory_order_relaxed) + allocation_size <=
+          max_bytes_cached_) {
+    SizeClass* size_class = size_classes_[GetSizeClassIndex(size)].get();
+    absl::MutexLock lock(size_class->mutex);
+    size_class->free_blocks.push_back(block);
+    bytes_cached_ += allocation_size;
+    return;
+  }
+  ::operator delete(block);
+}
+
+std::shared_ptr<uint8_t> BufferPool::AllocateShared(size_t size) {
+  return std::shared_ptr<uint8_t>(
+      static_cast<uint8_t*>(Allocate(size)),
+      [this, size](uint8_t* buffer) { Free(buffer, size); },
+      PoolAllocator<uint8_t>());
+}
+
+BufferPool::Stats BufferPool::GetStats() const {
+  Stats stats;
+  stats.num_allocations = num_allocations_;
+  stats.num_reused = num_reused_;
+  stats.bytes_in_use = bytes_in_use_;
+  stats.peak_bytes_in_use = peak_bytes_in_use_;
+  stats.bytes_cached = bytes_cached_;
+  return stats;
+}
+
+void BufferPool::Trim() {
+  for (size_t i = 0; i < kNumSizeClasses; ++i) {
+    std::vector<void*> free_blocks;
+    {
+      absl::MutexLock lock(size_classes_[i]->mutex);
+      free_blocks.swap(size_classes_[i]->free_blocks);
+      bytes_cached_ -= free_blocks.size() * GetSizeClassSize(i);
+    }
+    for (void* block : free_blocks)
+      ::operator delete(block);
+  }
+}
+
+// static
+size_t BufferPool::GetAllocationSize(size_t size) {
+  return IsPooled(size) ? GetSizeClassSize(GetSizeClassIndex(size)) : size;
+}
+
+// static
+bool BufferPool::IsPooled(size_t size) {
+  return size <= kMaxSizeClass;
+}
+
+// static
+size_t BufferPool::GetSizeClassIndex(size_t size) {
+  DCHECK(IsPooled(size));
+  if (size <= kMinSizeClass)
+    return 0;
+  // |size| is in (base, 2 * base], which is split into steps of base / 4.
+  const size_t log2 = absl::bit_width(size - 1) - 1;
+  const size_t base = size_t{1} << log2;
+  const size_t step = base / kSizeClassesPerPowerOfTwo;
+  return 1 + (log2 - kMinSizeClassLog2) * kSizeClassesPerPowerOfTwo +
+         (size - 1 - base) / step;
+}
+
+}  // namespace media
+}  // namespace shaka
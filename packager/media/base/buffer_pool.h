@@ -0,0 +1,118 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_BUFFER_POOL_H_
+#define PACKAGER_MEDIA_BASE_BUFFER_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/macros/classes.h>
+
+namespace shaka {
+namespace media {
+
+/// Recycles the memory of the objects allocated for every sample, i.e.
+/// StreamData, MediaSample and sample payloads, which are freed shortly after
+/// being allocated. Sizes are rounded up to size classes, four per power of
+/// two, and freed blocks are kept per size class for reuse, up to a bounded
+/// number of bytes. Blocks larger than the largest size class are not pooled.
+/// Thread safe.
+class BufferPool {
+ public:
+  struct Stats {
+    /// Number of blocks allocated.
+    uint64_t num_allocations = 0;
+    /// Number of blocks allocated from the blocks kept for reuse.
+    uint64_t num_reused = 0;
+    /// Size of the blocks allocated and not freed yet.
+    uint64_t bytes_in_use = 0;
+    /// High watermark of `bytes_in_use`.
+    uint64_t peak_bytes_in_use = 0;
+    /// Size of the blocks kept for reuse.
+    uint64_t bytes_cached = 0;
+  };
+
+  static BufferPool* GetInstance();
+
+  /// Allocate a block of at least @a size bytes.
+  void* Allocate(size_t size);
+  /// Free a block returned by Allocate().
+  /// @param size is the size passed to Allocate().
+  void Free(void* block, size_t size);
+
+  /// Allocate a buffer of @a size bytes, which returns to the pool with its
+  /// last reference.
+  std::shared_ptr<uint8_t> AllocateShared(size_t size);
+
+  Stats GetStats() const;
+
+  /// Release the blocks kept for reuse to the system.
+  void Trim();
+
+  /// @return The size class of @a size, i.e. the actual size allocated.
+  static size_t GetAllocationSize(size_t size);
+
+ private:
+  BufferPool();
+  ~BufferPool() = delete;
+
+  struct SizeClass {
+    absl::Mutex mutex;
+    std::vector<void*> free_blocks ABSL_GUARDED_BY(mutex);
+  };
+
+  static bool IsPooled(size_t size);
+  static size_t GetSizeClassIndex(size_t size);
+
+  std::vector<std::unique_ptr<SizeClass>> size_classes_;
+  const uint64_t max_bytes_cached_;
+
+  std::atomic<uint64_t> num_allocations_{0};
+  std::atomic<uint64_t> num_reused_{0};
+  std::atomic<uint64_t> bytes_in_use_{0};
+  std::atomic<uint64_t> peak_bytes_in_use_{0};
+  std::atomic<uint64_t> bytes_cached_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(BufferPool);
+};
+
+/// A standard allocator backed by BufferPool, e.g. for std::allocate_shared,
+/// so that the object and its reference count come from the pool.
+template <typename T>
+class PoolAllocator {
+ public:
+  typedef T value_type;
+
+  PoolAllocator() = default;
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>&) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(BufferPool::GetInstance()->Allocate(n * sizeof(T)));
+  }
+  void deallocate(T* p, size_t n) {
+    BufferPool::GetInstance()->Free(p, n * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const PoolAllocator<U>&) const {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const PoolAllocator<U>&) const {
+    return false;
+  }
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_BUFFER_POOL_H_
@@ -0,0 +1,107 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/buffer_pool.h>
+
+#include <gtest/gtest.h>
+
+#include <packager/media/base/media_handler.h>
+#include <packager/media/base/media_sample.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const size_t kLargestPooledSize = 8 << 20;
+const uint8_t kData[] = {1, 2, 3, 4};
+
+}  // namespace
+
+class BufferPoolTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    pool_ = BufferPool::GetInstance();
+    pool_->Trim();
+  }
+
+  BufferPool* pool_ = nullptr;
+};
+
+TEST_F(BufferPoolTest, GetAllocationSize) {
+  EXPECT_EQ(32u, BufferPool::GetAllocationSize(0));
+  EXPECT_EQ(32u, BufferPool::GetAllocationSize(32));
+  EXPECT_EQ(40u, BufferPool::GetAllocationSize(33));
+  EXPECT_EQ(64u, BufferPool::GetAllocationSize(64));
+  EXPECT_EQ(80u, BufferPool::GetAllocationSize(65));
+  EXPECT_EQ(1280u, BufferPool::GetAllocationSize(1025));
+  EXPECT_EQ(kLargestPooledSize,
+            BufferPool::GetAllocationSize(kLargestPooledSize - 1));
+  // Larger blocks are not rounded up.
+  EXPECT_EQ(kLargestPooledSize + 1,
+            BufferPool::GetAllocationSize(kLargestPooledSize + 1));
+}
+
+TEST_F(BufferPoolTest, ReusesFreedBlocks) {
+  const BufferPool::Stats initial_stats = pool_->GetStats();
+
+  void* block = pool_->Allocate(1000);
+  pool_->Free(block, 1000);
+  EXPECT_EQ(1024u, pool_->GetStats().bytes_cached);
+  // Any size in the same size class gets the block back.
+  EXPECT_EQ(block, pool_->Allocate(1020));
+  pool_->Free(block, 1020);
+
+  const BufferPool::Stats stats = pool_->GetStats();
+  EXPECT_EQ(initial_stats.num_allocations + 2, stats.num_allocations);
+  EXPECT_EQ(initial_stats.num_reused + 1, stats.num_reused);
+}
+
+TEST_F(BufferPoolTest, TracksBytesInUse) {
+  const BufferPool::Stats initial_stats = pool_->GetStats();
+
+  void* block1 = pool_->Allocate(4096);
+  void* block2 = pool_->Allocate(kLargestPooledSize + 1);
+  BufferPool::Stats stats = pool_->GetStats();
+  EXPECT_EQ(initial_stats.bytes_in_use + 4096 + kLargestPooledSize + 1,
+            stats.bytes_in_use);
+  EXPECT_GE(stats.peak_bytes_in_use, stats.bytes_in_use);
+
+  pool_->Free(block1, 4096);
+  pool_->Free(block2, kLargestPooledSize + 1);
+  stats = pool_->GetStats();
+  EXPECT_EQ(initial_stats.bytes_in_use, stats.bytes_in_use);
+  EXPECT_GE(stats.peak_bytes_in_use,
+            initial_stats.bytes_in_use + 4096 + kLargestPooledSize + 1);
+  // Only the pooled block is kept.
+  EXPECT_EQ(4096u, stats.bytes_cached);
+}
+
+TEST_F(BufferPoolTest, SharedBufferReturnsToPool) {
+  const uint64_t initial_bytes_in_use = pool_->GetStats().bytes_in_use;
+  {
+    std::shared_ptr<uint8_t> buffer = pool_->AllocateShared(100000);
+    ASSERT_TRUE(buffer);
+    EXPECT_LT(initial_bytes_in_use, pool_->GetStats().bytes_in_use);
+  }
+  EXPECT_EQ(initial_bytes_in_use, pool_->GetStats().bytes_in_use);
+}
+
+TEST_F(BufferPoolTest, SamplesComeFromPool) {
+  const uint64_t initial_allocations = pool_->GetStats().num_allocations;
+  {
+    std::unique_ptr<StreamData> stream_data = StreamData::FromMediaSample(
+        0, MediaSample::CopyFrom(kData, sizeof(kData), true));
+    EXPECT_EQ(0, memcmp(kData, stream_data->media_sample->data(),
+                        sizeof(kData)));
+    // The stream data, the sample with its reference count, the payload with
+    // its reference count.
+    EXPECT_EQ(initial_allocations + 4, pool_->GetStats().num_allocations);
+  }
+  EXPECT_LT(0u, pool_->GetStats().bytes_cached);
+}
+
+}  // namespace media
+}  // namespace shaka
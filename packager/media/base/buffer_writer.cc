@@ -66,12 +66,56 @@ void BufferWriter::AppendArray(const uint8_t* buf, size_t size) {
 }
 
 void BufferWriter::AppendBuffer(const BufferWriter& buffer) {
+  for (const std::vector<uint8_t>& chunk : buffer.chunks_)
+    buf_.insert(buf_.end(), chunk.begin(), chunk.end());
   buf_.insert(buf_.end(), buffer.buf_.begin(), buffer.buf_.end());
 }
 
+void BufferWriter::AppendBufferWithoutCopy(BufferWriter* buffer) {
+  DCHECK(buffer);
+  DCHECK_NE(buffer, this);
+
+  // Keep the data appended so far ahead of the new chunks.
+  if (!buf_.empty()) {
+    chunks_size_ += buf_.size();
+    chunks_.push_back(std::move(buf_));
+    buf_.clear();
+    TakeSpareChunk(&buf_);
+  }
+  for (std::vector<uint8_t>& chunk : buffer->chunks_) {
+    chunks_size_ += chunk.size();
+    chunks_.push_back(std::move(chunk));
+  }
+  if (!buffer->buf_.empty()) {
+    chunks_size_ += buffer->buf_.size();
+    chunks_.push_back(std::move(buffer->buf_));
+  }
+  buffer->Clear();
+  TakeSpareChunk(&buffer->buf_);
+}
+
+void BufferWriter::Clear() {
+  buf_.clear();
+  // Keep no more spare memory than the chunks being cleared held.
+  const size_t num_chunks = chunks_.size();
+  for (std::vector<uint8_t>& chunk : chunks_) {
+    chunk.clear();
+    spare_chunks_.push_back(std::move(chunk));
+  }
+  if (spare_chunks_.size() > num_chunks) {
+    spare_chunks_.erase(spare_chunks_.begin(),
+                        spare_chunks_.end() - num_chunks);
+  }
+  chunks_.clear();
+  chunks_size_ = 0;
+}
+
 Status BufferWriter::WriteToFile(File* file) {
   DCHECK(file);
-  DCHECK(!buf_.empty());
+  DCHECK_GT(Size(), 0u);
+
+  if (!chunks_.empty())
+    return WriteChunksToFile(file);
 
   size_t remaining_size = buf_.size();
   const uint8_t* buf = &buf_[0];
@@ -88,6 +132,47 @@ Status BufferWriter::WriteToFile(File* file) {
   return Status::OK;
 }
 
+Status BufferWriter::WriteChunksToFile(File* file) {
+  std::vector<File::WriteBuffer> buffers;
+  buffers.reserve(chunks_.size() + 1);
+  for (const std::vector<uint8_t>& chunk : chunks_)
+    buffers.push_back({chunk.data(), chunk.size()});
+  if (!buf_.empty())
+    buffers.push_back({buf_.data(), buf_.size()});
+
+  size_t next_buffer = 0;
+  while (next_buffer < buffers.size()) {
+    int64_t size_written =
+        file->WriteV(&buffers[next_buffer], buffers.size() - next_buffer);
+    if (size_written <= 0) {
+      return Status(error::FILE_FAILURE,
+                    "Fail to write to file in BufferWriter");
+    }
+    // Skip the buffers fully written, and the written part of the next one.
+    while (next_buffer < buffers.size() &&
+           static_cast<uint64_t>(size_written) >=
+               buffers[next_buffer].length) {
+      size_written -= buffers[next_buffer].length;
+      ++next_buffer;
+    }
+    if (size_written > 0) {
+      File::WriteBuffer& buffer = buffers[next_buffer];
+      buffer.data = static_cast<const uint8_t*>(buffer.data) + size_written;
+      buffer.length -= size_written;
+    }
+  }
+  Clear();
+  return Status::OK;
+}
+
+void BufferWriter::TakeSpareChunk(std::vector<uint8_t>* buffer) {
+  DCHECK(buffer->empty());
+  if (spare_chunks_.empty())
+    return;
+  buffer->swap(spare_chunks_.back());
+  spare_chunks_.pop_back();
+}
+
 template <typename T>
 void BufferWriter::AppendInternal(T v) {
   AppendArray(reinterpret_cast<uint8_t*>(&v), sizeof(T));
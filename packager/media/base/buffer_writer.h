@@ -8,6 +8,7 @@
 #define PACKAGER_MEDIA_BASE_BUFFER_WRITER_H_
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 #include <packager/macros/classes.h>
@@ -53,12 +54,27 @@ class BufferWriter {
   void AppendArray(const uint8_t* buf, size_t size);
   void AppendBuffer(const BufferWriter& buffer);
 
-  void Swap(BufferWriter* buffer) { buf_.swap(buffer->buf_); }
+  /// Append the contents of @a buffer by taking ownership of its memory
+  /// instead of copying it.  @a buffer is cleared, and is given memory from
+  /// parts written or cleared earlier, so that a buffer refilled for every
+  /// append keeps its capacity.  The buffer is no longer contiguous after this
+  /// call: Buffer() and SwapBuffer() must not be used until it is cleared, but
+  /// WriteToFile writes all the parts at once.
+  /// @param buffer should not be NULL.
+  void AppendBufferWithoutCopy(BufferWriter* buffer);
+
+  void Swap(BufferWriter* buffer) {
+    buf_.swap(buffer->buf_);
+    chunks_.swap(buffer->chunks_);
+    std::swap(chunks_size_, buffer->chunks_size_);
+  }
   void SwapBuffer(std::vector<uint8_t>* buffer) { buf_.swap(*buffer); }
 
-  void Clear() { buf_.clear(); }
-  size_t Size() const { return buf_.size(); }
-  /// @return Underlying buffer. Behavior is undefined if the buffer size is 0.
+  void Clear();
+  size_t Size() const { return chunks_size_ + buf_.size(); }
+  /// @return Underlying buffer. Behavior is undefined if the buffer size is 0,
+  ///         or if AppendBufferWithoutCopy has been called since the last
+  ///         Clear().
   const uint8_t* Buffer() const { return buf_.data(); }
 
   /// Write the buffer to file. The internal buffer will be cleared after
@@ -71,7 +87,17 @@ class BufferWriter {
   // Internal implementation of multi-byte write.
   template <typename T>
   void AppendInternal(T v);
+  // Implementation of WriteToFile after AppendBufferWithoutCopy.
+  Status WriteChunksToFile(File* file);
 
+  // Gives |buffer|, which must be empty, the memory of a spare chunk if any.
+  void TakeSpareChunk(std::vector<uint8_t>* buffer);
+
+  // Data appended with AppendBufferWithoutCopy, which precedes |buf_|.
+  std::vector<std::vector<uint8_t>> chunks_;
+  size_t chunks_size_ = 0;
+  // Empty chunks which have been written or cleared, kept for their memory.
+  std::vector<std::vector<uint8_t>> spare_chunks_;
   std::vector<uint8_t> buf_;
 
   DISALLOW_COPY_AND_ASSIGN(BufferWriter);
@@ -212,5 +212,83 @@ TEST_F(BufferWriterTest, WriteToFile) {
     EXPECT_EQ(kuint8Array[i], data_read[i]);
 }
 
+TEST_F(BufferWriterTest, AppendBufferWithoutCopy) {
+  const char kFileName[] = "memory://buffer_writer_test";
+
+  writer_->AppendArray(kuint8Array, sizeof(kuint8Array));
+  BufferWriter other;
+  other.AppendInt(kuint32);
+  writer_->AppendBufferWithoutCopy(&other);
+  EXPECT_EQ(0u, other.Size());
+  writer_->AppendInt(kuint16);
+  ASSERT_EQ(sizeof(kuint8Array) + sizeof(kuint32) + sizeof(kuint16),
+            writer_->Size());
+
+  // A copy of a chunked buffer is contiguous.
+  BufferWriter copy;
+  copy.AppendBuffer(*writer_);
+  ASSERT_EQ(writer_->Size(), copy.Size());
+  std::vector<uint8_t> expected(copy.Buffer(), copy.Buffer() + copy.Size());
+
+  File* const output_file = File::Open(kFileName, "w");
+  ASSERT_TRUE(output_file);
+  ASSERT_OK(writer_->WriteToFile(output_file));
+  ASSERT_EQ(0u, writer_->Size());
+  ASSERT_TRUE(output_file->Close());
+
+  std::string data_read;
+  ASSERT_TRUE(File::ReadFileToString(kFileName, &data_read));
+  EXPECT_EQ(std::string(expected.begin(), expected.end()), data_read);
+
+  reader_.reset(new BufferReader(expected.data(), expected.size()));
+  for (size_t i = 0; i < sizeof(kuint8Array); ++i)
+    ReadAndExpect(kuint8Array[i]);
+  ReadAndExpect(kuint32);
+  ReadAndExpect(kuint16);
+}
+
+TEST_F(BufferWriterTest, AppendBufferWithoutCopyReusesMemory) {
+  BufferWriter fragment;
+  fragment.AppendInt(kuint32);
+  const uint8_t* const fragment_data = fragment.Buffer();
+  writer_->AppendBufferWithoutCopy(&fragment);
+  writer_->Clear();
+
+  // The memory taken from |fragment| is handed back to the next buffer
+  // appended after the writer is cleared.
+  fragment.AppendInt(kuint32);
+  writer_->AppendBufferWithoutCopy(&fragment);
+  fragment.AppendInt(kuint32);
+  EXPECT_EQ(fragment_data, fragment.Buffer());
+}
+
+TEST_F(BufferWriterTest, WriteChunksToLocalFile) {
+  TempFile temp_file;
+
+  for (int i = 0; i < 100; ++i) {
+    BufferWriter chunk;
+    chunk.AppendInt(static_cast<uint32_t>(i));
+    writer_->AppendBufferWithoutCopy(&chunk);
+    writer_->AppendInt(static_cast<uint8_t>(i));
+  }
+  ASSERT_EQ(500u, writer_->Size());
+
+  // Without buffering, the chunks are written with a single writev.
+  File* const output_file =
+      File::OpenWithNoBuffering(temp_file.path().c_str(), "w");
+  ASSERT_TRUE(output_file);
+  ASSERT_OK(writer_->WriteToFile(output_file));
+  ASSERT_TRUE(output_file->Close());
+
+  std::string data_read;
+  ASSERT_TRUE(File::ReadFileToString(temp_file.path().c_str(), &data_read));
+  reader_.reset(new BufferReader(
+      reinterpret_cast<const uint8_t*>(data_read.data()), data_read.size()));
+  for (int i = 0; i < 100; ++i) {
+    ReadAndExpect(static_cast<uint32_t>(i));
+    ReadAndExpect(static_cast<uint8_t>(i));
+  }
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -30,9 +30,16 @@ void ByteQueue::Push(const uint8_t* data, int size) {
   DCHECK(data);
 
   size_t size_needed = used_ + size;
+  const bool out_of_space = offset_ + size_needed > size_;
+  // Moving the data in the queue to the front of the buffer is only done if
+  // the data is no larger than the space freed since it was last moved.
+  // Otherwise, e.g. when the queue holds nearly a full buffer of data, most
+  // Push() calls would move all of it. A bigger buffer is allocated instead.
+  const bool can_move =
+      size_needed <= size_ && static_cast<size_t>(used_) <= offset_;
 
   // Check to see if we need a bigger buffer.
-  if (size_needed > size_) {
+  if (out_of_space && !can_move) {
     size_t new_size = 2 * size_;
     while (size_needed > new_size && new_size > size_)
       new_size *= 2;
@@ -49,7 +56,7 @@ void ByteQueue::Push(const uint8_t* data, int size) {
     buffer_.reset(new_buffer.release());
     size_ = new_size;
     offset_ = 0;
-  } else if ((offset_ + used_ + size) > size_) {
+  } else if (out_of_space) {
     // The buffer is big enough, but we need to move the data in the queue.
     memmove(buffer_.get(), front(), used_);
     offset_ = 0;
@@ -72,11 +79,10 @@ void ByteQueue::Pop(int count) {
   offset_ += count;
   used_ -= count;
 
-  // Move the offset back to 0 if we have reached the end of the buffer.
-  if (offset_ == size_) {
-    DCHECK_EQ(used_, 0);
+  // Move the offset back to 0 once the queue is empty, which is free, instead
+  // of moving data in Push() later.
+  if (used_ == 0)
     offset_ = 0;
-  }
 }
 
 uint8_t* ByteQueue::front() const {
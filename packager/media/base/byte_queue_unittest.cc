@@ -0,0 +1,67 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/byte_queue.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace shaka {
+namespace media {
+
+TEST(ByteQueueTest, PushAndPop) {
+  ByteQueue queue;
+  const uint8_t kData[] = {1, 2, 3, 4, 5};
+  queue.Push(kData, sizeof(kData));
+  queue.Pop(2);
+  queue.Push(kData, sizeof(kData));
+
+  const uint8_t* data;
+  int size;
+  queue.Peek(&data, &size);
+  EXPECT_EQ(std::vector<uint8_t>({3, 4, 5, 1, 2, 3, 4, 5}),
+            std::vector<uint8_t>(data, data + size));
+
+  queue.Pop(size);
+  queue.Peek(&data, &size);
+  EXPECT_EQ(0, size);
+}
+
+TEST(ByteQueueTest, NearlyFullQueue) {
+  // Keep about a buffer worth of data in the queue while pushing and popping
+  // small amounts, which moves or reallocates the data.
+  const int kQueuedSize = 1000;
+  const int kPushSize = 7;
+  ByteQueue queue;
+  std::deque<uint8_t> expected;
+  uint8_t value = 0;
+  for (int i = 0; i < 1000; ++i) {
+    std::vector<uint8_t> push_data(kPushSize);
+    for (uint8_t& byte : push_data) {
+      byte = value++;
+      expected.push_back(byte);
+    }
+    queue.Push(push_data.data(), kPushSize);
+
+    const uint8_t* data;
+    int size;
+    queue.Peek(&data, &size);
+    ASSERT_EQ(expected.size(), static_cast<size_t>(size));
+    ASSERT_TRUE(std::equal(expected.begin(), expected.end(), data));
+
+    if (size > kQueuedSize) {
+      queue.Pop(kPushSize);
+      expected.erase(expected.begin(), expected.begin() + kPushSize);
+    }
+  }
+}
+
+}  // namespace media
+}  // namespace shaka
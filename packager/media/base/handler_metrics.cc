@@ -0,0 +1,366 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/handler_metrics.h>
+
+#include <algorithm>
+
+#include <absl/strings/str_format.h>
+
+#include <packager/media/base/media_handler.h>
+
+namespace shaka {
+namespace media {
+
+namespace {
+
+// Time spent in nested timers by the innermost timer of this thread.
+thread_local int64_t g_nested_time_ns = 0;
+
+void UpdateMax(std::atomic<uint64_t>* max_value, uint64_t value) {
+  uint64_t current = max_value->load(std::memory_order_relaxed);
+  while (current < value && !max_value->compare_exchange_weak(
+                                current, value, std::memory_order_relaxed)) {
+  }
+}
+
+size_t GetHistogramBucket(int64_t time_ns) {
+  uint64_t time_us = static_cast<uint64_t>(time_ns) / 1000;
+  size_t bucket = 0;
+  while (time_us > 0 && bucket < HandlerMetrics::kNumHistogramBuckets - 1) {
+    time_us >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+std::string EscapeJson(const std::string& value) {
+  std::string escaped;
+  for (const char c : value) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+          absl::StrAppendFormat(&escaped, "\\u%04x", static_cast<int>(c));
+        else
+          escaped += c;
+    }
+  }
+  return escaped;
+}
+
+std::string EscapePrometheusLabel(const std::string& value) {
+  std::string escaped;
+  for (const char c : value) {
+    switch (c) {
+      case '"':
+        escaped += "\\\"";
+        break;
+      case '\\':
+        escaped += "\\\\";
+        break;
+      case '\n':
+        escaped += "\\n";
+        break;
+      default:
+        escaped += c;
+    }
+  }
+  return escaped;
+}
+
+}  // namespace
+
+HandlerMetrics::HandlerMetrics(const std::string& name) : name_(name) {}
+
+HandlerMetrics::ScopedTimer::ScopedTimer(HandlerMetrics* metrics)
+    : metrics_(metrics) {
+  if (!metrics_)
+    return;
+  outer_nested_time_ns_ = g_nested_time_ns;
+  g_nested_time_ns = 0;
+  start_time_ = std::chrono::steady_clock::now();
+}
+
+HandlerMetrics::ScopedTimer::~ScopedTimer() {
+  if (!metrics_)
+    return;
+  const int64_t elapsed_ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - start_time_)
+          .count();
+  metrics_->AddCall(std::max<int64_t>(elapsed_ns - g_nested_time_ns, 0));
+  g_nested_time_ns = outer_nested_time_ns_ + elapsed_ns;
+}
+
+void HandlerMetrics::AddStreamData(const StreamData& stream_data) {
+  num_stream_data_.fetch_add(1, std::memory_order_relaxed);
+  if (stream_data.stream_data_type == StreamDataType::kMediaSample) {
+    num_samples_.fetch_add(1, std::memory_order_relaxed);
+    num_bytes_.fetch_add(stream_data.media_sample->data_size(),
+                         std::memory_order_relaxed);
+  } else if (stream_data.stream_data_type == StreamDataType::kTextSample) {
+    num_samples_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void HandlerMetrics::SetQueueDepth(size_t queue_depth) {
+  queue_depth_.store(queue_depth, std::memory_order_relaxed);
+  UpdateMax(&max_queue_depth_, queue_depth);
+}
+
+void HandlerMetrics::AddSegmentLatency(int64_t first_sample_latency_us,
+                                       int64_t last_sample_latency_us) {
+  const uint64_t first_latency =
+      static_cast<uint64_t>(std::max<int64_t>(first_sample_latency_us, 0));
+  const uint64_t last_latency =
+      static_cast<uint64_t>(std::max<int64_t>(last_sample_latency_us, 0));
+  num_segments_.fetch_add(1, std::memory_order_relaxed);
+  first_sample_latency_us_.fetch_add(first_latency, std::memory_order_relaxed);
+  UpdateMax(&max_first_sample_latency_us_, first_latency);
+  last_sample_latency_us_.fetch_add(last_latency, std::memory_order_relaxed);
+  UpdateMax(&max_last_sample_latency_us_, last_latency);
+}
+
+HandlerStats HandlerMetrics::GetStats() const {
+  HandlerStats stats;
+  stats.name = name_;
+  stats.num_calls = num_calls_.load(std::memory_order_relaxed);
+  stats.num_stream_data = num_stream_data_.load(std::memory_order_relaxed);
+  stats.num_samples = num_samples_.load(std::memory_order_relaxed);
+  stats.num_bytes = num_bytes_.load(std::memory_order_relaxed);
+  stats.processing_time_us =
+      processing_time_ns_.load(std::memory_order_relaxed) / 1000;
+  for (const auto& bucket : histogram_) {
+    stats.processing_time_histogram.push_back(
+        bucket.load(std::memory_order_relaxed));
+  }
+  stats.num_segments = num_segments_.load(std::memory_order_relaxed);
+  stats.first_sample_latency_us =
+      first_sample_latency_us_.load(std::memory_order_relaxed);
+  stats.max_first_sample_latency_us =
+      max_first_sample_latency_us_.load(std::memory_order_relaxed);
+  stats.last_sample_latency_us =
+      last_sample_latency_us_.load(std::memory_order_relaxed);
+  stats.max_last_sample_latency_us =
+      max_last_sample_latency_us_.load(std::memory_order_relaxed);
+  stats.queue_depth = queue_depth_.load(std::memory_order_relaxed);
+  stats.max_queue_depth = max_queue_depth_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void HandlerMetrics::AddCall(int64_t time_ns) {
+  num_calls_.fetch_add(1, std::memory_order_relaxed);
+  processing_time_ns_.fetch_add(time_ns, std::memory_order_relaxed);
+  histogram_[GetHistogramBucket(time_ns)].fetch_add(1,
+                                                    std::memory_order_relaxed);
+}
+
+std::shared_ptr<HandlerMetrics> PipelineMetrics::Create(
+    const std::string& name) {
+  auto metrics = std::make_shared<HandlerMetrics>(name);
+  absl::MutexLock lock(mutex_);
+  metrics_.push_back(metrics);
+  return metrics;
+}
+
+PackagerStats PipelineMetrics::GetStats() const {
+  PackagerStats stats;
+  if (memory_budget_)
+    stats.memory = memory_budget_->GetStats();
+  absl::MutexLock lock(mutex_);
+  for (const auto& metrics : metrics_)
+    stats.handlers.push_back(metrics->GetStats());
+  return stats;
+}
+
+std::string PipelineMetrics::ToJson(const PackagerStats& stats) {
+  std::string json = "{\"handlers\":[";
+  for (size_t i = 0; i < stats.handlers.size(); ++i) {
+    const HandlerStats& handler = stats.handlers[i];
+    if (i > 0)
+      json += ",";
+    absl::StrAppendFormat(
+        &json,
+        "{\"name\":\"%s\",\"num_calls\":%d,\"num_stream_data\":%d,"
+        "\"num_samples\":%d,\"num_bytes\":%d,\"processing_time_us\":%d,"
+        "\"processing_time_histogram\":[",
+        EscapeJson(handler.name), handler.num_calls, handler.num_stream_data,
+        handler.num_samples, handler.num_bytes, handler.processing_time_us);
+    for (size_t j = 0; j < handler.processing_time_histogram.size(); ++j) {
+      absl::StrAppendFormat(&json, "%s%d", j > 0 ? "," : "",
+                            handler.processing_time_histogram[j]);
+    }
+    absl::StrAppendFormat(
+        &json,
+        "],\"num_segments\":%d,\"first_sample_latency_us\":%d,"
+        "\"max_first_sample_latency_us\":%d,\"last_sample_latency_us\":%d,"
+        "\"max_last_sample_latency_us\":%d,\"queue_depth\":%d,"
+        "\"max_queue_depth\":%d}",
+        handler.num_segments, handler.first_sample_latency_us,
+        handler.max_first_sample_latency_us, handler.last_sample_latency_us,
+        handler.max_last_sample_latency_us, handler.queue_depth,
+        handler.max_queue_depth);
+  }
+  json += "]";
+  const MemoryStats& memory = stats.memory;
+  if (!memory.name.empty()) {
+    absl::StrAppendFormat(
+        &json,
+        ",\"memory\":{\"name\":\"%s\",\"usage_bytes\":%d,"
+        "\"max_usage_bytes\":%d,\"limit_bytes\":%d,"
+        "\"num_backpressure_waits\":%d,\"num_dropped_samples\":%d}",
+        EscapeJson(memory.name), memory.usage_bytes, memory.max_usage_bytes,
+        memory.limit_bytes, memory.num_backpressure_waits,
+        memory.num_dropped_samples);
+  }
+  json += "}\n";
+  return json;
+}
+
+std::string PipelineMetrics::ToPrometheusText(const PackagerStats& stats) {
+  struct Counter {
+    const char* name;
+    const char* type;
+    const char* help;
+    uint64_t HandlerStats::*value;
+  };
+  const Counter kCounters[] = {
+      {"shaka_packager_handler_calls_total", "counter",
+       "Calls into the pipeline stage.", &HandlerStats::num_calls},
+      {"shaka_packager_handler_stream_data_total", "counter",
+       "Stream data processed by the pipeline stage.",
+       &HandlerStats::num_stream_data},
+      {"shaka_packager_handler_samples_total", "counter",
+       "Samples processed by the pipeline stage.", &HandlerStats::num_samples},
+      {"shaka_packager_handler_bytes_total", "counter",
+       "Bytes of media samples processed by the pipeline stage.",
+       &HandlerStats::num_bytes},
+      {"shaka_packager_handler_segments_total", "counter",
+       "Segments written by the muxer with a known ingest time.",
+       &HandlerStats::num_segments},
+      {"shaka_packager_handler_queue_depth", "gauge",
+       "Stream data queued in the pipeline stage.", &HandlerStats::queue_depth},
+      {"shaka_packager_handler_max_queue_depth", "gauge",
+       "Maximum stream data queued in the pipeline stage.",
+       &HandlerStats::max_queue_depth},
+  };
+
+  std::string text;
+  for (const Counter& counter : kCounters) {
+    absl::StrAppendFormat(&text, "# HELP %s %s\n# TYPE %s %s\n", counter.name,
+                          counter.help, counter.name, counter.type);
+    for (const HandlerStats& handler : stats.handlers) {
+      absl::StrAppendFormat(&text, "%s{handler=\"%s\"} %d\n", counter.name,
+                            EscapePrometheusLabel(handler.name),
+                            handler.*counter.value);
+    }
+  }
+
+  // Latencies are exported in seconds, as usual for Prometheus.
+  const Counter kLatencies[] = {
+      {"shaka_packager_segment_first_sample_latency_seconds_total", "counter",
+       "Time from the ingestion of the first sample of the segments to the "
+       "segments being written.",
+       &HandlerStats::first_sample_latency_us},
+      {"shaka_packager_segment_max_first_sample_latency_seconds", "gauge",
+       "Maximum time from the ingestion of the first sample of a segment to "
+       "the segment being written.",
+       &HandlerStats::max_first_sample_latency_us},
+      {"shaka_packager_segment_last_sample_latency_seconds_total", "counter",
+       "Time from the ingestion of the last sample of the segments to the "
+       "segments being written.",
+       &HandlerStats::last_sample_latency_us},
+      {"shaka_packager_segment_max_last_sample_latency_seconds", "gauge",
+       "Maximum time from the ingestion of the last sample of a segment to "
+       "the segment being written.",
+       &HandlerStats::max_last_sample_latency_us},
+  };
+  for (const Counter& latency : kLatencies) {
+    absl::StrAppendFormat(&text, "# HELP %s %s\n# TYPE %s %s\n", latency.name,
+                          latency.help, latency.name, latency.type);
+    for (const HandlerStats& handler : stats.handlers) {
+      if (handler.num_segments == 0)
+        continue;
+      absl::StrAppendFormat(&text, "%s{handler=\"%s\"} %g\n", latency.name,
+                            EscapePrometheusLabel(handler.name),
+                            handler.*latency.value / 1e6);
+    }
+  }
+
+  const char kHistogram[] = "shaka_packager_handler_processing_seconds";
+  absl::StrAppendFormat(&text,
+                        "# HELP %s Time spent per call into the pipeline "
+                        "stage, excluding downstream stages.\n"
+                        "# TYPE %s histogram\n",
+                        kHistogram, kHistogram);
+  for (const HandlerStats& handler : stats.handlers) {
+    const std::string label = EscapePrometheusLabel(handler.name);
+    uint64_t cumulative_count = 0;
+    for (size_t i = 0; i < handler.processing_time_histogram.size(); ++i) {
+      cumulative_count += handler.processing_time_histogram[i];
+      if (i + 1 == handler.processing_time_histogram.size()) {
+        absl::StrAppendFormat(&text,
+                              "%s_bucket{handler=\"%s\",le=\"+Inf\"} %d\n",
+                              kHistogram, label, cumulative_count);
+      } else {
+        absl::StrAppendFormat(&text, "%s_bucket{handler=\"%s\",le=\"%g\"} %d\n",
+                              kHistogram, label,
+                              static_cast<double>(uint64_t{1} << i) / 1e6,
+                              cumulative_count);
+      }
+    }
+    absl::StrAppendFormat(&text, "%s_sum{handler=\"%s\"} %g\n", kHistogram,
+                          label, handler.processing_time_us / 1e6);
+    absl::StrAppendFormat(&text, "%s_count{handler=\"%s\"} %d\n", kHistogram,
+                          label, handler.num_calls);
+  }
+
+  const MemoryStats& memory = stats.memory;
+  if (memory.name.empty())
+    return text;
+  struct MemoryCounter {
+    const char* name;
+    const char* type;
+    const char* help;
+    uint64_t MemoryStats::*value;
+  };
+  const MemoryCounter kMemoryCounters[] = {
+      {"shaka_packager_memory_usage_bytes", "gauge",
+       "Memory used by the pipeline.", &MemoryStats::usage_bytes},
+      {"shaka_packager_memory_max_usage_bytes", "gauge",
+       "Maximum memory used by the pipeline.", &MemoryStats::max_usage_bytes},
+      {"shaka_packager_memory_limit_bytes", "gauge",
+       "Memory budget of the pipeline, 0 if unlimited.",
+       &MemoryStats::limit_bytes},
+      {"shaka_packager_memory_backpressure_waits_total", "counter",
+       "Times an input paused until memory was released.",
+       &MemoryStats::num_backpressure_waits},
+      {"shaka_packager_memory_dropped_samples_total", "counter",
+       "Samples dropped to stay within the memory budget.",
+       &MemoryStats::num_dropped_samples},
+  };
+  const std::string budget_label = EscapePrometheusLabel(memory.name);
+  for (const MemoryCounter& counter : kMemoryCounters) {
+    absl::StrAppendFormat(&text,
+                          "# HELP %s %s\n# TYPE %s %s\n%s{budget=\"%s\"} %d\n",
+                          counter.name, counter.help, counter.name,
+                          counter.type, counter.name, budget_label,
+                          memory.*counter.value);
+  }
+  return text;
+}
+
+}  // namespace media
+}  // namespace shaka
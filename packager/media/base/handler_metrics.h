@@ -0,0 +1,123 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_BASE_HANDLER_METRICS_H_
+#define PACKAGER_MEDIA_BASE_HANDLER_METRICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/synchronization/mutex.h>
+
+#include <packager/packager_stats.h>
+#include <packager/utils/memory_budget.h>
+
+namespace shaka {
+namespace media {
+
+struct StreamData;
+
+/// Collects the statistics of a stage of the pipeline, see HandlerStats. It is
+/// cheap enough to update on every call, and can be updated from several
+/// threads at once.
+class HandlerMetrics {
+ public:
+  static const size_t kNumHistogramBuckets = 20;
+
+  explicit HandlerMetrics(const std::string& name);
+
+  /// Times a call into the stage over its scope. The time spent in nested
+  /// timers on the same thread, i.e. in the stages called from this one, is
+  /// left out. Does nothing if @a metrics is null.
+  class ScopedTimer {
+   public:
+    explicit ScopedTimer(HandlerMetrics* metrics);
+    ~ScopedTimer();
+
+   private:
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    HandlerMetrics* const metrics_;
+    std::chrono::steady_clock::time_point start_time_;
+    int64_t outer_nested_time_ns_ = 0;
+  };
+
+  /// Count @a stream_data as processed.
+  void AddStreamData(const StreamData& stream_data);
+  /// Update the number of stream data queued.
+  void SetQueueDepth(size_t queue_depth);
+  /// Count a segment written @a first_sample_latency_us and
+  /// @a last_sample_latency_us after its first and last samples were ingested.
+  void AddSegmentLatency(int64_t first_sample_latency_us,
+                         int64_t last_sample_latency_us);
+
+  HandlerStats GetStats() const;
+
+  const std::string& name() const { return name_; }
+
+ private:
+  HandlerMetrics(const HandlerMetrics&) = delete;
+  HandlerMetrics& operator=(const HandlerMetrics&) = delete;
+
+  void AddCall(int64_t time_ns);
+
+  const std::string name_;
+  std::atomic<uint64_t> num_calls_{0};
+  std::atomic<uint64_t> num_stream_data_{0};
+  std::atomic<uint64_t> num_samples_{0};
+  std::atomic<uint64_t> num_bytes_{0};
+  std::atomic<uint64_t> processing_time_ns_{0};
+  std::atomic<uint64_t> histogram_[kNumHistogramBuckets] = {};
+  std::atomic<uint64_t> num_segments_{0};
+  std::atomic<uint64_t> first_sample_latency_us_{0};
+  std::atomic<uint64_t> max_first_sample_latency_us_{0};
+  std::atomic<uint64_t> last_sample_latency_us_{0};
+  std::atomic<uint64_t> max_last_sample_latency_us_{0};
+  std::atomic<uint64_t> queue_depth_{0};
+  std::atomic<uint64_t> max_queue_depth_{0};
+};
+
+/// The metrics of all the stages of a pipeline.
+class PipelineMetrics {
+ public:
+  PipelineMetrics() = default;
+
+  /// @return new metrics for a stage called @a name, to attach to the stage.
+  std::shared_ptr<HandlerMetrics> Create(const std::string& name);
+  /// Report the memory used by the pipeline from @a memory_budget. Must be set
+  /// before the stats are read.
+  void set_memory_budget(std::shared_ptr<const MemoryBudget> memory_budget) {
+    memory_budget_ = std::move(memory_budget);
+  }
+
+  /// @return a snapshot of the statistics of all stages, in creation order,
+  ///         and of the memory used.
+  PackagerStats GetStats() const;
+
+  /// Format @a stats as a JSON object.
+  static std::string ToJson(const PackagerStats& stats);
+  /// Format @a stats in the Prometheus text exposition format.
+  static std::string ToPrometheusText(const PackagerStats& stats);
+
+ private:
+  PipelineMetrics(const PipelineMetrics&) = delete;
+  PipelineMetrics& operator=(const PipelineMetrics&) = delete;
+
+  mutable absl::Mutex mutex_;
+  std::vector<std::shared_ptr<HandlerMetrics>> metrics_
+      ABSL_GUARDED_BY(mutex_);
+  std::shared_ptr<const MemoryBudget> memory_budget_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_BASE_HANDLER_METRICS_H_
@@ -0,0 +1,181 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/base/handler_metrics.h>
+
+#include <thread>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <packager/media/base/media_handler_test_base.h>
+#include <packager/status/status_test_util.h>
+
+using ::testing::HasSubstr;
+
+namespace shaka {
+namespace media {
+namespace {
+
+const size_t kStreamIndex = 0;
+const int64_t kDuration = 1000;
+const bool kKeyFrame = true;
+const std::chrono::milliseconds kSleepTime(100);
+const uint8_t kSampleData[] = {1, 2, 3, 4};
+
+// Sleeps in Process() before dispatching downstream.
+class SleepingMediaHandler : public MediaHandler {
+ public:
+  explicit SleepingMediaHandler(std::chrono::milliseconds sleep_time)
+      : sleep_time_(sleep_time) {}
+
+ private:
+  Status InitializeInternal() override { return Status::OK; }
+  Status Process(std::unique_ptr<StreamData> stream_data) override {
+    std::this_thread::sleep_for(sleep_time_);
+    return Dispatch(std::move(stream_data));
+  }
+
+  const std::chrono::milliseconds sleep_time_;
+};
+
+uint64_t ToMicroseconds(std::chrono::milliseconds time) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+}
+
+}  // namespace
+
+class HandlerMetricsTest : public MediaHandlerTestBase {};
+
+TEST_F(HandlerMetricsTest, ExcludesDownstreamTime) {
+  PipelineMetrics pipeline_metrics;
+  auto upstream =
+      std::make_shared<SleepingMediaHandler>(std::chrono::milliseconds(0));
+  upstream->set_metrics(pipeline_metrics.Create("upstream"));
+  auto downstream = std::make_shared<SleepingMediaHandler>(kSleepTime);
+  downstream->set_metrics(pipeline_metrics.Create("downstream"));
+  ASSERT_OK(upstream->AddHandler(downstream));
+  ASSERT_OK(downstream->AddHandler(std::make_shared<CachingMediaHandler>()));
+  ASSERT_OK(SetUpAndInitializeGraph(upstream, 1, 0));
+
+  ASSERT_OK(Input(0)->Dispatch(StreamData::FromMediaSample(
+      kStreamIndex, GetMediaSample(0, kDuration, kKeyFrame, kSampleData,
+                                   sizeof(kSampleData)))));
+
+  const PackagerStats stats = pipeline_metrics.GetStats();
+  ASSERT_EQ(2u, stats.handlers.size());
+  for (const HandlerStats& handler : stats.handlers) {
+    EXPECT_EQ(1u, handler.num_calls);
+    EXPECT_EQ(1u, handler.num_stream_data);
+    EXPECT_EQ(1u, handler.num_samples);
+    EXPECT_EQ(sizeof(kSampleData), handler.num_bytes);
+  }
+  EXPECT_EQ("upstream", stats.handlers[0].name);
+  EXPECT_EQ("downstream", stats.handlers[1].name);
+  // The upstream handler waits for the downstream handler, which is left out.
+  EXPECT_LT(stats.handlers[0].processing_time_us, ToMicroseconds(kSleepTime));
+  EXPECT_GE(stats.handlers[1].processing_time_us, ToMicroseconds(kSleepTime));
+}
+
+TEST_F(HandlerMetricsTest, CountsBatches) {
+  PipelineMetrics pipeline_metrics;
+  auto handler = std::make_shared<CachingMediaHandler>();
+  handler->set_metrics(pipeline_metrics.Create("handler"));
+  ASSERT_OK(SetUpAndInitializeGraph(handler, 1, 0));
+
+  std::vector<std::unique_ptr<StreamData>> batch;
+  batch.push_back(StreamData::FromStreamInfo(kStreamIndex,
+                                             GetVideoStreamInfo(kDuration)));
+  for (int i = 0; i < 3; ++i) {
+    batch.push_back(StreamData::FromMediaSample(
+        kStreamIndex, GetMediaSample(i * kDuration, kDuration, kKeyFrame)));
+  }
+  ASSERT_OK(Input(0)->DispatchBatch(absl::MakeSpan(batch)));
+  ASSERT_OK(Input(0)->FlushAllDownstreams());
+
+  const HandlerStats stats = pipeline_metrics.GetStats().handlers[0];
+  // One call for the batch, one for the flush.
+  EXPECT_EQ(2u, stats.num_calls);
+  EXPECT_EQ(4u, stats.num_stream_data);
+  EXPECT_EQ(3u, stats.num_samples);
+  uint64_t num_histogram_calls = 0;
+  for (uint64_t count : stats.processing_time_histogram)
+    num_histogram_calls += count;
+  EXPECT_EQ(2u, num_histogram_calls);
+}
+
+TEST_F(HandlerMetricsTest, TracksQueueDepth) {
+  HandlerMetrics metrics("queue");
+  metrics.SetQueueDepth(3);
+  metrics.SetQueueDepth(1);
+  const HandlerStats stats = metrics.GetStats();
+  EXPECT_EQ(1u, stats.queue_depth);
+  EXPECT_EQ(3u, stats.max_queue_depth);
+}
+
+TEST_F(HandlerMetricsTest, TracksSegmentLatency) {
+  HandlerMetrics metrics("Muxer");
+  metrics.AddSegmentLatency(3000, 1000);
+  metrics.AddSegmentLatency(2000, 1500);
+  // Clock skew is not counted as negative latency.
+  metrics.AddSegmentLatency(-10, -20);
+
+  const HandlerStats stats = metrics.GetStats();
+  EXPECT_EQ(3u, stats.num_segments);
+  EXPECT_EQ(5000u, stats.first_sample_latency_us);
+  EXPECT_EQ(3000u, stats.max_first_sample_latency_us);
+  EXPECT_EQ(2500u, stats.last_sample_latency_us);
+  EXPECT_EQ(1500u, stats.max_last_sample_latency_us);
+}
+
+TEST_F(HandlerMetricsTest, Formats) {
+  PipelineMetrics pipeline_metrics;
+  {
+    HandlerMetrics::ScopedTimer timer(
+        pipeline_metrics.Create("Muxer[\"out\".mp4]").get());
+  }
+  const PackagerStats stats = pipeline_metrics.GetStats();
+
+  const std::string json = PipelineMetrics::ToJson(stats);
+  EXPECT_THAT(json, HasSubstr("{\"handlers\":[{\"name\":\"Muxer[\\\"out\\\"."
+                              "mp4]\",\"num_calls\":1,"));
+  EXPECT_THAT(json, HasSubstr("\"max_queue_depth\":0}]}"));
+
+  const std::string text = PipelineMetrics::ToPrometheusText(stats);
+  EXPECT_THAT(text, HasSubstr("# TYPE shaka_packager_handler_calls_total "
+                              "counter\n"
+                              "shaka_packager_handler_calls_total{handler="
+                              "\"Muxer[\\\"out\\\".mp4]\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("shaka_packager_handler_processing_seconds_"
+                              "bucket{handler=\"Muxer[\\\"out\\\".mp4]\","
+                              "le=\"+Inf\"} 1\n"));
+  EXPECT_THAT(text, HasSubstr("shaka_packager_handler_processing_seconds_"
+                              "count{handler=\"Muxer[\\\"out\\\".mp4]\"} 1\n"));
+}
+
+TEST_F(HandlerMetricsTest, FormatsMemoryStats) {
+  auto memory_budget = std::make_shared<MemoryBudget>("packager", 100, nullptr);
+  memory_budget->Reserve(40);
+  memory_budget->AddDroppedSamples(3);
+  PipelineMetrics pipeline_metrics;
+  pipeline_metrics.set_memory_budget(memory_budget);
+  const PackagerStats stats = pipeline_metrics.GetStats();
+  EXPECT_EQ(40u, stats.memory.usage_bytes);
+  EXPECT_EQ(100u, stats.memory.limit_bytes);
+
+  EXPECT_THAT(PipelineMetrics::ToJson(stats),
+              HasSubstr("\"memory\":{\"name\":\"packager\","
+                        "\"usage_bytes\":40,\"max_usage_bytes\":40,"
+                        "\"limit_bytes\":100,\"num_backpressure_waits\":0,"
+                        "\"num_dropped_samples\":3}"));
+  EXPECT_THAT(PipelineMetrics::ToPrometheusText(stats),
+              HasSubstr("shaka_packager_memory_usage_bytes{budget="
+                        "\"packager\"} 40\n"));
+  memory_budget->Release(40);
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -6,6 +6,8 @@
 
 #include <packager/media/base/media_handler.h>
 
+#include <absl/log/check.h>
+
 #include <packager/macros/status.h>
 
 namespace shaka {
@@ -91,7 +93,18 @@ bool MediaHandler::ValidateOutputStreamIndex(size_t stream_index) const {
   return stream_index < num_input_streams_;
 }
 
+Status MediaHandler::ProcessBatch(
+    absl::Span<std::unique_ptr<StreamData>> batch) {
+  for (auto& stream_data : batch)
+    RETURN_IF_ERROR(Process(std::move(stream_data)));
+  return Status::OK;
+}
+
 Status MediaHandler::Dispatch(std::unique_ptr<StreamData> stream_data) const {
+  if (collected_stream_data_) {
+    collected_stream_data_->push_back(std::move(stream_data));
+    return Status::OK;
+  }
   size_t output_stream_index = stream_data->stream_index;
   auto handler_it = output_handlers_.find(output_stream_index);
   if (handler_it == output_handlers_.end()) {
@@ -99,7 +112,61 @@ Status MediaHandler::Dispatch(std::unique_ptr<StreamData> stream_data) const {
                   "No output handler exist at the specified index.");
   }
   stream_data->stream_index = handler_it->second.second;
-  return handler_it->second.first->Process(std::move(stream_data));
+
+  MediaHandler* handler = handler_it->second.first.get();
+  HandlerMetrics::ScopedTimer timer(handler->metrics());
+  if (handler->metrics())
+    handler->metrics()->AddStreamData(*stream_data);
+  return handler->Process(std::move(stream_data));
+}
+
+Status MediaHandler::DispatchBatch(
+    absl::Span<std::unique_ptr<StreamData>> batch) const {
+  size_t begin = 0;
+  while (begin < batch.size()) {
+    const size_t output_stream_index = batch[begin]->stream_index;
+    size_t end = begin + 1;
+    while (end < batch.size() &&
+           batch[end]->stream_index == output_stream_index) {
+      ++end;
+    }
+
+    auto handler_it = output_handlers_.find(output_stream_index);
+    if (handler_it == output_handlers_.end()) {
+      return Status(error::NOT_FOUND,
+                    "No output handler exist at the specified index.");
+    }
+    MediaHandler* handler = handler_it->second.first.get();
+    for (size_t i = begin; i < end; ++i) {
+      batch[i]->stream_index = handler_it->second.second;
+      if (handler->metrics())
+        handler->metrics()->AddStreamData(*batch[i]);
+    }
+    HandlerMetrics::ScopedTimer timer(handler->metrics());
+    RETURN_IF_ERROR(handler->ProcessBatch(batch.subspan(begin, end - begin)));
+    begin = end;
+  }
+  return Status::OK;
+}
+
+Status MediaHandler::ProcessAndDispatchBatch(
+    absl::Span<std::unique_ptr<StreamData>> batch) {
+  DCHECK(!collected_stream_data_);
+  std::vector<std::unique_ptr<StreamData>> collected;
+  collected.reserve(batch.size());
+  collected_stream_data_ = &collected;
+  Status status;
+  for (auto& stream_data : batch) {
+    status = Process(std::move(stream_data));
+    if (!status.ok())
+      break;
+  }
+  collected_stream_data_ = nullptr;
+
+  // Whatever was produced before an error is still passed on, as it would
+  // have been without batching.
+  status.Update(DispatchBatch(absl::MakeSpan(collected)));
+  return status;
 }
 
 Status MediaHandler::FlushDownstream(size_t output_stream_index) {
@@ -108,12 +175,16 @@ Status MediaHandler::FlushDownstream(size_t output_stream_index) {
     return Status(error::NOT_FOUND,
                   "No output handler exist at the specified index.");
   }
-  return handler_it->second.first->OnFlushRequest(handler_it->second.second);
+  MediaHandler* handler = handler_it->second.first.get();
+  HandlerMetrics::ScopedTimer timer(handler->metrics());
+  return handler->OnFlushRequest(handler_it->second.second);
 }
 
 Status MediaHandler::FlushAllDownstreams() {
   for (const auto& pair : output_handlers_) {
-    Status status = pair.second.first->OnFlushRequest(pair.second.second);
+    MediaHandler* handler = pair.second.first.get();
+    HandlerMetrics::ScopedTimer timer(handler->metrics());
+    Status status = handler->OnFlushRequest(pair.second.second);
     if (!status.ok()) {
       return status;
     }
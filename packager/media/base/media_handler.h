@@ -10,10 +10,16 @@
 #include <map>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include <absl/types/span.h>
+
+#include <packager/media/base/buffer_pool.h>
+#include <packager/media/base/handler_metrics.h>
 #include <packager/media/base/media_sample.h>
 #include <packager/media/base/stream_info.h>
 #include <packager/media/base/text_sample.h>
+#include <packager/utils/memory_budget.h>
 #include <packager/status.h>
 
 namespace shaka {
@@ -60,6 +66,11 @@ struct SegmentInfo {
   int64_t start_timestamp = -1;
   int64_t duration = 0;
   int64_t segment_number = 1;
+  // Wall-clock ingest time of the first and last samples of the segment, in
+  // microseconds since the Unix epoch, or 0 if unknown. See
+  // MediaSample::arrival_time_us().
+  int64_t first_sample_arrival_time_us = 0;
+  int64_t last_sample_arrival_time_us = 0;
   // This is only available if key rotation is enabled. Note that we may have
   // a |key_rotation_encryption_config| even if the segment is not encrypted,
   // which is the case for clear lead.
@@ -78,6 +89,14 @@ struct StreamData {
   std::shared_ptr<const Scte35Event> scte35_event;
   std::shared_ptr<const CueEvent> cue_event;
 
+  // One StreamData is allocated for every sample, so they are recycled.
+  static void* operator new(size_t size) {
+    return BufferPool::GetInstance()->Allocate(size);
+  }
+  static void operator delete(void* block, size_t size) {
+    BufferPool::GetInstance()->Free(block, size);
+  }
+
   static std::unique_ptr<StreamData> FromStreamInfo(
       size_t stream_index,
       std::shared_ptr<const StreamInfo> stream_info) {
@@ -177,6 +196,20 @@ class MediaHandler {
 
   static Status Chain(const std::vector<std::shared_ptr<MediaHandler>>& list);
 
+  /// Collect the statistics of the handler into @a metrics: the calls into the
+  /// handler and the stream data it processes. Must be set before running the
+  /// graph.
+  void set_metrics(std::shared_ptr<HandlerMetrics> metrics) {
+    metrics_ = std::move(metrics);
+  }
+
+  /// Account for the memory buffered by the handler in @a memory_budget. Only
+  /// handlers which buffer stream data use it. Must be set before running the
+  /// graph.
+  void set_memory_budget(std::shared_ptr<MemoryBudget> memory_budget) {
+    memory_budget_ = std::move(memory_budget);
+  }
+
  protected:
   /// Internal implementation of initialize. Note that it should only initialize
   /// the MediaHandler itself. Downstream handlers are handled in Initialize().
@@ -188,6 +221,13 @@ class MediaHandler {
   /// handlers after finishing processing if needed.
   virtual Status Process(std::unique_ptr<StreamData> stream_data) = 0;
 
+  /// Process a batch of incoming stream data, in order, as if Process() was
+  /// called on each of them. The stream data is consumed. Handlers which can
+  /// amortize per call costs over the batch override this; the default
+  /// implementation calls Process() on each stream data and stops at the first
+  /// error.
+  virtual Status ProcessBatch(absl::Span<std::unique_ptr<StreamData>> batch);
+
   /// Event handler for flush request at the specific input stream index.
   virtual Status OnFlushRequest(size_t input_stream_index);
 
@@ -198,6 +238,20 @@ class MediaHandler {
   /// stream_data.stream_index should be the output stream index.
   Status Dispatch(std::unique_ptr<StreamData> stream_data) const;
 
+  /// Dispatch a batch of stream data to downstream handlers, in order. Note
+  /// that stream_data.stream_index should be the output stream index. Runs of
+  /// stream data going to the same output are passed to ProcessBatch() of the
+  /// downstream handler at once.
+  Status DispatchBatch(absl::Span<std::unique_ptr<StreamData>> batch) const;
+
+  /// Process @a batch with Process(), collecting everything dispatched
+  /// meanwhile, then dispatch the collected stream data with DispatchBatch().
+  /// Lets a handler which produces its outputs in Process() pass batches on to
+  /// its downstream handlers. Must not be used by handlers which dispatch from
+  /// more than one thread.
+  Status ProcessAndDispatchBatch(
+      absl::Span<std::unique_ptr<StreamData>> batch);
+
   /// Dispatch the stream info to downstream handlers.
   Status DispatchStreamInfo(
       size_t stream_index,
@@ -252,6 +306,14 @@ class MediaHandler {
   /// Flush all connected downstream handlers.
   Status FlushAllDownstreams();
 
+  /// @return the metrics of the handler, or null if not collected.
+  HandlerMetrics* metrics() const { return metrics_.get(); }
+
+  /// @return the memory budget of the handler, or null if not accounted for.
+  const std::shared_ptr<MemoryBudget>& memory_budget() const {
+    return memory_budget_;
+  }
+
   bool initialized() { return initialized_; }
   size_t num_input_streams() const { return num_input_streams_; }
   size_t next_output_stream_index() const { return next_output_stream_index_; }
@@ -273,6 +335,12 @@ class MediaHandler {
   // map.
   std::map<size_t, std::pair<std::shared_ptr<MediaHandler>, size_t>>
       output_handlers_;
+  std::shared_ptr<HandlerMetrics> metrics_;
+  std::shared_ptr<MemoryBudget> memory_budget_;
+  // Where Dispatch() collects the stream data during
+  // ProcessAndDispatchBatch(), null otherwise.
+  mutable std::vector<std::unique_ptr<StreamData>>* collected_stream_data_ =
+      nullptr;
 };
 
 }  // namespace media
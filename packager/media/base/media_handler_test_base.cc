@@ -170,6 +170,14 @@ Status CachingMediaHandler::Process(std::unique_ptr<StreamData> stream_data) {
   return Status::OK;
 }
 
+Status CachingMediaHandler::ProcessBatch(
+    absl::Span<std::unique_ptr<StreamData>> batch) {
+  ++num_batches_;
+  for (auto& stream_data : batch)
+    stream_data_vector_.push_back(std::move(stream_data));
+  return Status::OK;
+}
+
 Status CachingMediaHandler::OnFlushRequest(size_t input_stream_index) {
   UNUSED(input_stream_index);
   return Status::OK;
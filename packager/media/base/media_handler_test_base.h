@@ -250,6 +250,7 @@ MATCHER_P2(IsCueEvent, stream_index, time_in_seconds, "") {
 class FakeInputMediaHandler : public MediaHandler {
  public:
   using MediaHandler::Dispatch;
+  using MediaHandler::DispatchBatch;
   using MediaHandler::FlushAllDownstreams;
   using MediaHandler::FlushDownstream;
 
@@ -280,13 +281,18 @@ class CachingMediaHandler : public MediaHandler {
   //               of the test harder to understand.
   void Clear() { stream_data_vector_.clear(); }
 
+  /// @return the number of ProcessBatch() calls received.
+  size_t num_batches() const { return num_batches_; }
+
  private:
   Status InitializeInternal() override;
   Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status ProcessBatch(absl::Span<std::unique_ptr<StreamData>> batch) override;
   Status OnFlushRequest(size_t input_stream_index) override;
   bool ValidateOutputStreamIndex(size_t stream_index) const override;
 
   std::vector<std::unique_ptr<StreamData>> stream_data_vector_;
+  size_t num_batches_ = 0;
 };
 
 class MediaHandlerTestBase : public ::testing::Test {
@@ -78,6 +78,16 @@ class MediaParser {
   /// @return true if successful.
   [[nodiscard]] virtual bool Parse(const uint8_t* buf, int size) = 0;
 
+  /// Like Parse(), for data that stays valid and unchanged as long as a
+  /// reference to @a buf is held, e.g. a part of a mapped file.  Parsers may
+  /// then reference the data from the samples they emit instead of copying it.
+  /// The default implementation calls Parse().
+  /// @return true if successful.
+  [[nodiscard]] virtual bool ParseShared(std::shared_ptr<const uint8_t> buf,
+                                         int size) {
+    return Parse(buf.get(), size);
+  }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(MediaParser);
 };
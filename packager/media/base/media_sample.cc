@@ -12,8 +12,29 @@
 #include <absl/log/log.h>
 #include <absl/strings/str_format.h>
 
+#include <packager/media/base/buffer_pool.h>
+
 namespace shaka {
 namespace media {
+namespace {
+
+// Lets std::allocate_shared construct MediaSamples, whose constructors are
+// protected.
+class PooledMediaSample : public MediaSample {
+ public:
+  template <typename... Args>
+  explicit PooledMediaSample(Args&&... args)
+      : MediaSample(std::forward<Args>(args)...) {}
+};
+
+// Allocates the sample and its reference count in one block from the pool.
+template <typename... Args>
+std::shared_ptr<MediaSample> CreateMediaSample(Args&&... args) {
+  return std::allocate_shared<PooledMediaSample>(
+      PoolAllocator<PooledMediaSample>(), std::forward<Args>(args)...);
+}
+
+}  // namespace
 
 MediaSample::MediaSample(const uint8_t* data,
                          size_t data_size,
@@ -27,8 +48,8 @@ MediaSample::MediaSample(const uint8_t* data,
 
   SetData(data, data_size);
   if (side_data) {
-    std::shared_ptr<uint8_t> shared_side_data(new uint8_t[side_data_size],
-                                              std::default_delete<uint8_t[]>());
+    std::shared_ptr<uint8_t> shared_side_data =
+        BufferPool::GetInstance()->AllocateShared(side_data_size);
     memcpy(shared_side_data.get(), side_data, side_data_size);
     side_data_ = std::move(shared_side_data);
     side_data_size_ = side_data_size;
@@ -45,8 +66,7 @@ std::shared_ptr<MediaSample> MediaSample::CopyFrom(const uint8_t* data,
                                                    bool is_key_frame) {
   // If you hit this CHECK you likely have a bug in a demuxer. Go fix it.
   CHECK(data);
-  return std::shared_ptr<MediaSample>(
-      new MediaSample(data, data_size, nullptr, 0u, is_key_frame));
+  return CreateMediaSample(data, data_size, nullptr, 0u, is_key_frame);
 }
 
 // static
@@ -57,37 +77,37 @@ std::shared_ptr<MediaSample> MediaSample::CopyFrom(const uint8_t* data,
                                                    bool is_key_frame) {
   // If you hit this CHECK you likely have a bug in a demuxer. Go fix it.
   CHECK(data);
-  return std::shared_ptr<MediaSample>(new MediaSample(
-      data, data_size, side_data, side_data_size, is_key_frame));
+  return CreateMediaSample(data, data_size, side_data, side_data_size,
+                           is_key_frame);
 }
 
 // static
 std::shared_ptr<MediaSample> MediaSample::FromMetadata(const uint8_t* metadata,
                                                        size_t metadata_size) {
-  return std::shared_ptr<MediaSample>(
-      new MediaSample(nullptr, 0, metadata, metadata_size, false));
+  return CreateMediaSample(nullptr, 0u, metadata, metadata_size, false);
 }
 
 // static
 std::shared_ptr<MediaSample> MediaSample::CreateEmptyMediaSample() {
-  return std::shared_ptr<MediaSample>(new MediaSample);
+  return CreateMediaSample();
 }
 
 // static
 std::shared_ptr<MediaSample> MediaSample::CreateEOSBuffer() {
-  return std::shared_ptr<MediaSample>(
-      new MediaSample(nullptr, 0, nullptr, 0, false));
+  return CreateMediaSample(nullptr, 0u, nullptr, 0u, false);
 }
 
 std::shared_ptr<MediaSample> MediaSample::Clone() const {
-  std::shared_ptr<MediaSample> new_media_sample(new MediaSample);
+  std::shared_ptr<MediaSample> new_media_sample = CreateMediaSample();
   new_media_sample->dts_ = dts_;
   new_media_sample->pts_ = pts_;
   new_media_sample->duration_ = duration_;
+  new_media_sample->arrival_time_us_ = arrival_time_us_;
   new_media_sample->is_key_frame_ = is_key_frame_;
   new_media_sample->is_encrypted_ = is_encrypted_;
   new_media_sample->data_ = data_;
   new_media_sample->data_size_ = data_size_;
+  new_media_sample->data_is_writable_ = data_is_writable_;
   new_media_sample->side_data_ = side_data_;
   new_media_sample->side_data_size_ = side_data_size_;
   new_media_sample->config_id_ = config_id_;
@@ -101,17 +121,34 @@ std::shared_ptr<MediaSample> MediaSample::Clone() const {
   return new_media_sample;
 }
 
-void MediaSample::TransferData(std::shared_ptr<uint8_t> data,
+void MediaSample::TransferData(std::shared_ptr<const uint8_t> data,
                                size_t data_size) {
   data_ = std::move(data);
   data_size_ = data_size;
+  data_is_writable_ = false;
 }
 
 void MediaSample::SetData(const uint8_t* data, size_t data_size) {
-  std::shared_ptr<uint8_t> shared_data(new uint8_t[data_size],
-                                       std::default_delete<uint8_t[]>());
+  std::shared_ptr<uint8_t> shared_data =
+      BufferPool::GetInstance()->AllocateShared(data_size);
   memcpy(shared_data.get(), data, data_size);
   TransferData(std::move(shared_data), data_size);
+  data_is_writable_ = true;
+}
+
+uint8_t* MediaSample::AllocateData(size_t data_size) {
+  std::shared_ptr<uint8_t> shared_data =
+      BufferPool::GetInstance()->AllocateShared(data_size);
+  uint8_t* data = shared_data.get();
+  TransferData(std::move(shared_data), data_size);
+  data_is_writable_ = true;
+  return data;
+}
+
+uint8_t* MediaSample::GetExclusiveData() {
+  if (!data_is_writable_ || data_.use_count() != 1)
+    return nullptr;
+  return const_cast<uint8_t*>(data_.get());
 }
 
 std::string MediaSample::ToString() const {
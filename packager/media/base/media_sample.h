@@ -72,9 +72,10 @@ class MediaSample {
   std::shared_ptr<MediaSample> Clone() const;
 
   /// Transfer data to this media sample. No data copying is involved.
-  /// @param data points to the data to be transferred.
+  /// @param data points to the data to be transferred. It may share ownership
+  ///        of a larger buffer, such as a mapped input file.
   /// @param data_size is the size of the data to be transferred.
-  void TransferData(std::shared_ptr<uint8_t> data, size_t data_size);
+  void TransferData(std::shared_ptr<const uint8_t> data, size_t data_size);
 
   /// Set the data in this media sample. Note that this method involves data
   /// copying.
@@ -82,6 +83,12 @@ class MediaSample {
   /// @param data_size is the size of the data to be copied.
   void SetData(const uint8_t* data, size_t data_size);
 
+  /// Allocate the data of this media sample, to be written in place instead
+  /// of being copied by SetData().
+  /// @param data_size is the size of the data.
+  /// @return A writable pointer to the uninitialized sample data.
+  uint8_t* AllocateData(size_t data_size);
+
   /// @return a human-readable string describing |*this|.
   std::string ToString() const;
 
@@ -128,6 +135,12 @@ class MediaSample {
     return data_size_;
   }
 
+  /// @return A writable pointer to the sample data if the data was copied into
+  ///         this sample by SetData(), or allocated by AllocateData(), and no
+  ///         other sample shares it, e.g. to encrypt it in place; nullptr
+  ///         otherwise.
+  uint8_t* GetExclusiveData();
+
   const uint8_t* side_data() const { return side_data_.get(); }
 
   size_t side_data_size() const { return side_data_size_; }
@@ -148,6 +161,13 @@ class MediaSample {
   const std::string& config_id() const { return config_id_; }
   void set_config_id(const std::string& config_id) { config_id_ = config_id; }
 
+  /// @return the wall-clock time the sample was ingested, in microseconds since
+  ///         the Unix epoch, or 0 if unknown.
+  int64_t arrival_time_us() const { return arrival_time_us_; }
+  void set_arrival_time_us(int64_t arrival_time_us) {
+    arrival_time_us_ = arrival_time_us;
+  }
+
  protected:
   // Made it protected to disallow the constructor to be called directly.
   // Create a MediaSample. Buffer will be padded and aligned as necessary.
@@ -165,6 +185,8 @@ class MediaSample {
   // Presentation time stamp.
   int64_t pts_ = 0;
   int64_t duration_ = 0;
+  // Wall-clock ingest time, in microseconds since the Unix epoch.
+  int64_t arrival_time_us_ = 0;
   bool is_key_frame_ = false;
   // is sample encrypted ?
   bool is_encrypted_ = false;
@@ -172,6 +194,9 @@ class MediaSample {
   // Main buffer data.
   std::shared_ptr<const uint8_t> data_;
   size_t data_size_ = 0;
+  // Set if |data_| was allocated by SetData(), as opposed to transferred from
+  // a buffer which may be read-only, e.g. a mapped input file.
+  bool data_is_writable_ = false;
   // Contain additional buffers to complete the main one. Needed by WebM
   // http://www.matroska.org/technical/specs/index.html BlockAdditional[A5].
   // Not used by mp4 and other containers.
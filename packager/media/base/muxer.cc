@@ -30,7 +30,9 @@ Muxer::Muxer(const MuxerOptions& options)
     output_file_template_ = options_.output_file_name;
 }
 
-Muxer::~Muxer() {}
+Muxer::~Muxer() {
+  ReleaseBufferedMemory();
+}
 
 void Muxer::Cancel() {
   cancelled_ = true;
@@ -69,9 +71,19 @@ Status Muxer::Process(std::unique_ptr<StreamData> stream_data) {
           muxer_listener_->OnEncryptionStart();
         }
       }
-      return FinalizeSegment(stream_data->stream_index, segment_info);
+      RETURN_IF_ERROR(
+          FinalizeSegment(stream_data->stream_index, segment_info));
+      ReleaseBufferedMemory();
+      ReportSegmentLatency(segment_info);
+      return Status::OK;
     }
     case StreamDataType::kMediaSample:
+      // Samples are buffered until their segment is finalized.
+      if (memory_budget()) {
+        const uint64_t sample_size = stream_data->media_sample->data_size();
+        memory_budget()->Reserve(sample_size);
+        buffered_bytes_ += sample_size;
+      }
       return AddMediaSample(stream_data->stream_index,
                             *stream_data->media_sample);
     case StreamDataType::kTextSample:
@@ -103,9 +115,19 @@ Status Muxer::Process(std::unique_ptr<StreamData> stream_data) {
   return Status::OK;
 }
 
+Status Muxer::ProcessBatch(absl::Span<std::unique_ptr<StreamData>> batch) {
+  // Muxers are sinks, so there is nothing to pass on; this only saves the
+  // virtual calls.
+  for (auto& stream_data : batch)
+    RETURN_IF_ERROR(Muxer::Process(std::move(stream_data)));
+  return Status::OK;
+}
+
 Status Muxer::OnFlushRequest(size_t input_stream_index) {
   UNUSED(input_stream_index);
-  return Finalize();
+  const Status status = Finalize();
+  ReleaseBufferedMemory();
+  return status;
 }
 
 Status Muxer::AddMediaSample(size_t stream_id, const MediaSample& sample) {
@@ -120,6 +142,40 @@ Status Muxer::AddTextSample(size_t stream_id, const TextSample& sample) {
   return Status::OK;
 }
 
+void Muxer::ReleaseBufferedMemory() {
+  if (buffered_bytes_ == 0)
+    return;
+  memory_budget()->Release(buffered_bytes_);
+  buffered_bytes_ = 0;
+}
+
+void Muxer::ReportSegmentLatency(const SegmentInfo& segment_info) {
+  if (segment_info.first_sample_arrival_time_us <= 0)
+    return;
+  const int64_t now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                             clock_->now().time_since_epoch())
+                             .count();
+  MuxerListener::SegmentLatency latency;
+  latency.start_time = segment_info.start_timestamp;
+  latency.is_subsegment = segment_info.is_subsegment;
+  latency.is_chunk = segment_info.is_chunk;
+  latency.first_sample_latency_us =
+      std::max<int64_t>(now_us - segment_info.first_sample_arrival_time_us, 0);
+  latency.last_sample_latency_us =
+      std::max<int64_t>(now_us - segment_info.last_sample_arrival_time_us, 0);
+  VLOG(2) << "Segment " << latency.start_time << " written "
+          << latency.first_sample_latency_us << "us after its first sample "
+          << "and " << latency.last_sample_latency_us
+          << "us after its last sample were ingested.";
+
+  if (metrics()) {
+    metrics()->AddSegmentLatency(latency.first_sample_latency_us,
+                                 latency.last_sample_latency_us);
+  }
+  if (muxer_listener_)
+    muxer_listener_->OnSegmentLatency(latency);
+}
+
 Status Muxer::ReinitializeMuxer(int64_t timestamp) {
   if (muxer_listener_ && streams_.back()->is_encrypted()) {
     const EncryptionConfig& encryption_config =
@@ -62,6 +62,7 @@ class Muxer : public MediaHandler {
   /// @{
   Status InitializeInternal() override { return Status::OK; }
   Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status ProcessBatch(absl::Span<std::unique_ptr<StreamData>> batch) override;
   Status OnFlushRequest(size_t input_stream_index) override;
   /// @}
 
@@ -100,6 +101,14 @@ class Muxer : public MediaHandler {
   virtual Status FinalizeSegment(size_t stream_id,
                                  const SegmentInfo& segment_info) = 0;
 
+  // Release the memory accounted for the samples buffered since the last
+  // segment was finalized.
+  void ReleaseBufferedMemory();
+
+  // Report how long after the ingestion of its samples the segment described
+  // by |segment_info| was written, if known.
+  void ReportSegmentLatency(const SegmentInfo& segment_info);
+
   // Re-initialize Muxer. Could be called on StreamInfo or CueEvent.
   // |timestamp| may be used to set the output file name.
   Status ReinitializeMuxer(int64_t timestamp);
@@ -118,6 +127,10 @@ class Muxer : public MediaHandler {
   // be a template. In this case, there will be NumAdCues + 1 files generated.
   std::string output_file_template_;
   size_t output_file_index_ = 1;
+
+  // Size of the samples buffered since the last segment was finalized, which
+  // is accounted for in the memory budget.
+  uint64_t buffered_bytes_ = 0;
 };
 
 }  // namespace media
@@ -7,6 +7,7 @@
 #include <packager/media/base/muxer_util.h>
 
 #include <cinttypes>
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -16,6 +17,9 @@
 #include <absl/strings/str_format.h>
 #include <absl/strings/str_split.h>
 
+#include <packager/file.h>
+#include <packager/file/callback_file.h>
+#include <packager/media/base/muxer_options.h>
 #include <packager/media/base/video_stream_info.h>
 
 namespace shaka {
@@ -38,6 +42,26 @@ Status ValidateFormatTag(const std::string& format_tag) {
       error::INVALID_ARGUMENT,
       "Format tag should follow this prototype: %0[width]d if exist.");
 }
+
+// Returns the label of the stream written by a muxer with |options|, if its
+// outputs are callback files.
+std::string GetStreamLabel(const media::MuxerOptions& options) {
+  const std::string& file_name = options.segment_template.empty()
+                                     ? options.output_file_name
+                                     : options.segment_template;
+  const size_t prefix_size = strlen(kCallbackFilePrefix);
+  if (file_name.compare(0, prefix_size, kCallbackFilePrefix) != 0)
+    return "";
+
+  const BufferCallbackParams* callback_params = nullptr;
+  std::string label;
+  if (!File::ParseCallbackFileName(file_name.substr(prefix_size),
+                                   &callback_params, &label)) {
+    return "";
+  }
+  return label;
+}
+
 }  // namespace
 
 namespace media {
@@ -169,5 +193,22 @@ std::string GetSegmentName(const std::string& segment_template,
   return segment_name;
 }
 
+void SetOutputInfo(const MuxerOptions& options, OutputInfo info, File* file) {
+  info.stream = GetStreamLabel(options);
+  CallbackFile::SetOutputInfo(file, info);
+}
+
+Status DeliverOutputChunk(const MuxerOptions& options,
+                          OutputInfo info,
+                          File* file) {
+  info.stream = GetStreamLabel(options);
+  info.is_chunk = true;
+  if (!CallbackFile::DeliverChunk(file, info)) {
+    return Status(error::FILE_FAILURE,
+                  "Failed to deliver chunk of " + file->file_name());
+  }
+  return Status::OK;
+}
+
 }  // namespace media
 }  // namespace shaka
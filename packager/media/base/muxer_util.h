@@ -11,12 +11,17 @@
 
 #include <cstdint>
 
+#include <packager/buffer_callback_params.h>
 #include <packager/status.h>
 
 namespace shaka {
+
+class File;
+
 namespace media {
 
 class StreamInfo;
+struct MuxerOptions;
 
 /// Validates the segment template against segment URL construction rule
 /// specified in ISO/IEC 23009-1:2012 5.3.9.4.4.
@@ -37,6 +42,21 @@ std::string GetSegmentName(const std::string& segment_template,
                            uint32_t segment_number,
                            uint32_t bandwidth);
 
+/// Describes the output written to @a file, for delivery through
+/// BufferCallbackParams::output_func.  The stream label is derived from
+/// @a options.  Does nothing if @a file does not deliver whole outputs.
+/// @param options is the options of the muxer writing @a file.
+/// @param info describes the output.
+/// @param file is the file being written.
+void SetOutputInfo(const MuxerOptions& options, OutputInfo info, File* file);
+
+/// Like SetOutputInfo, but also delivers the data written to @a file so far as
+/// a chunk of a segment.
+/// @return OK on success, an error status if the delivery failed.
+Status DeliverOutputChunk(const MuxerOptions& options,
+                          OutputInfo info,
+                          File* file);
+
 }  // namespace media
 }  // namespace shaka
 
@@ -6,6 +6,7 @@
 
 #include <cstdint>
 
+#include <absl/log/check.h>
 #include <absl/log/log.h>
 
 #include <packager/macros/logging.h>
@@ -18,25 +19,55 @@ OffsetByteQueue::~OffsetByteQueue() {}
 
 void OffsetByteQueue::Reset() {
   queue_.Reset();
+  shared_buf_.reset();
   buf_ = NULL;
   size_ = 0;
   head_ = 0;
 }
 
 void OffsetByteQueue::Push(const uint8_t* buf, int size) {
+  if (shared_buf_)
+    StopSharing();
   queue_.Push(buf, size);
   Sync();
   DVLOG(4) << "Buffer pushed. head=" << head() << " tail=" << tail();
 }
 
+void OffsetByteQueue::PushShared(std::shared_ptr<const uint8_t> buf,
+                                 int size) {
+  if (size <= 0)
+    return;
+  if (size_ == 0 || (shared_buf_ && buf.get() == buf_ + size_)) {
+    if (size_ == 0)
+      buf_ = buf.get();
+    size_ += size;
+    shared_buf_ = std::move(buf);
+    DVLOG(4) << "Shared buffer pushed. head=" << head() << " tail=" << tail();
+    return;
+  }
+  Push(buf.get(), size);
+}
+
+std::shared_ptr<const uint8_t> OffsetByteQueue::GetSharedAt(
+    int64_t offset) const {
+  if (!shared_buf_ || offset < head_ || offset >= head_ + size_)
+    return nullptr;
+  return std::shared_ptr<const uint8_t>(shared_buf_, &buf_[offset - head_]);
+}
+
 void OffsetByteQueue::Peek(const uint8_t** buf, int* size) {
   *buf = size_ > 0 ? buf_ : NULL;
   *size = size_;
 }
 
 void OffsetByteQueue::Pop(int count) {
-  queue_.Pop(count);
   head_ += count;
+  if (shared_buf_) {
+    buf_ += count;
+    size_ -= count;
+    return;
+  }
+  queue_.Pop(count);
   Sync();
 }
 
@@ -65,5 +96,12 @@ void OffsetByteQueue::Sync() {
   queue_.Peek(&buf_, &size_);
 }
 
+void OffsetByteQueue::StopSharing() {
+  DCHECK(shared_buf_);
+  queue_.Push(buf_, size_);
+  shared_buf_.reset();
+  Sync();
+}
+
 }  // namespace media
 }  // namespace shaka
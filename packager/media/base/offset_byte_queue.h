@@ -6,6 +6,7 @@
 #define PACKAGER_MEDIA_BASE_OFFSET_BYTE_QUEUE_H_
 
 #include <cstdint>
+#include <memory>
 
 #include <packager/macros/classes.h>
 #include <packager/media/base/byte_queue.h>
@@ -30,6 +31,17 @@ class OffsetByteQueue {
   void Pop(int count);
   /// @}
 
+  /// Like Push(), but without copying when the queue is empty, or when @a buf
+  /// directly follows the data previously pushed with PushShared().  The
+  /// queue then references @a buf, which must stay valid and unchanged as long
+  /// as a reference to it is held.
+  void PushShared(std::shared_ptr<const uint8_t> buf, int size);
+
+  /// @return A reference to the buffered byte at @a offset, which shares
+  ///          ownership of the buffer given to PushShared(), or nullptr if
+  ///          that byte is not in a shared buffer.
+  std::shared_ptr<const uint8_t> GetSharedAt(int64_t offset) const;
+
   /// Set @a buf to point at the first buffered byte corresponding to @a offset,
   /// and @a size to the number of bytes available starting from that offset.
   ///
@@ -58,8 +70,13 @@ class OffsetByteQueue {
  private:
   // Synchronize |buf_| and |size_| with |queue_|.
   void Sync();
+  // Copies the referenced shared data to |queue_|.
+  void StopSharing();
 
   ByteQueue queue_;
+  // Holds the buffer referenced by |buf_| when it is shared, instead of being
+  // owned by |queue_|.
+  std::shared_ptr<const uint8_t> shared_buf_;
   const uint8_t* buf_;
   int size_;
   int64_t head_;
@@ -91,5 +91,71 @@ TEST_F(OffsetByteQueueTest, Trim) {
   EXPECT_TRUE(queue_->Trim(512));
 }
 
+TEST(OffsetByteQueueSharedTest, PushShared) {
+  std::shared_ptr<uint8_t> data(new uint8_t[256],
+                                std::default_delete<uint8_t[]>());
+  for (int i = 0; i < 256; i++)
+    data.get()[i] = i;
+
+  OffsetByteQueue queue;
+  queue.PushShared(std::shared_ptr<const uint8_t>(data, data.get()), 100);
+  queue.PushShared(std::shared_ptr<const uint8_t>(data, data.get() + 100), 156);
+  EXPECT_EQ(0, queue.head());
+  EXPECT_EQ(256, queue.tail());
+
+  // Contiguous shared pushes are referenced, not copied.
+  const uint8_t* buf;
+  int size;
+  queue.Peek(&buf, &size);
+  EXPECT_EQ(data.get(), buf);
+  EXPECT_EQ(256, size);
+
+  queue.Pop(10);
+  std::shared_ptr<const uint8_t> shared = queue.GetSharedAt(20);
+  ASSERT_TRUE(shared);
+  EXPECT_EQ(data.get() + 20, shared.get());
+  EXPECT_FALSE(queue.GetSharedAt(5));
+  EXPECT_FALSE(queue.GetSharedAt(256));
+
+  // The shared reference keeps the buffer alive.
+  EXPECT_EQ(3, data.use_count());
+  queue.Reset();
+  EXPECT_EQ(2, data.use_count());
+}
+
+TEST(OffsetByteQueueSharedTest, CopiesWhenNotContiguous) {
+  uint8_t buf[256];
+  for (int i = 0; i < 256; i++)
+    buf[i] = i;
+  std::shared_ptr<uint8_t> data(new uint8_t[256],
+                                std::default_delete<uint8_t[]>());
+  memcpy(data.get(), buf, sizeof(buf));
+
+  OffsetByteQueue queue;
+  queue.Push(buf, 100);
+  queue.PushShared(std::shared_ptr<const uint8_t>(data, data.get() + 100), 156);
+  EXPECT_FALSE(queue.GetSharedAt(150));
+
+  const uint8_t* peeked;
+  int size;
+  queue.Peek(&peeked, &size);
+  ASSERT_EQ(256, size);
+  EXPECT_EQ(0, memcmp(buf, peeked, size));
+  EXPECT_EQ(1, data.use_count());
+
+  // Once the queue is drained, shared buffers are referenced again.
+  queue.Pop(256);
+  queue.PushShared(std::shared_ptr<const uint8_t>(data, data.get()), 256);
+  EXPECT_TRUE(queue.GetSharedAt(256));
+
+  // Copying pushes copy the shared data first.
+  queue.Push(buf, 10);
+  EXPECT_FALSE(queue.GetSharedAt(256));
+  queue.PeekAt(500, &peeked, &size);
+  ASSERT_EQ(22, size);
+  EXPECT_EQ(244, peeked[0]);
+  EXPECT_EQ(9, peeked[21]);
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -63,6 +63,13 @@ Status ChunkingHandler::Process(std::unique_ptr<StreamData> stream_data) {
   }
 }
 
+Status ChunkingHandler::ProcessBatch(
+    absl::Span<std::unique_ptr<StreamData>> batch) {
+  // Segment infos are interleaved with the samples, so they go downstream in
+  // the same batch.
+  return ProcessAndDispatchBatch(batch);
+}
+
 Status ChunkingHandler::OnFlushRequest(size_t /*input_stream_index*/) {
   RETURN_IF_ERROR(EndSegmentIfStarted());
   return FlushDownstream(kStreamIndex);
@@ -113,6 +120,8 @@ Status ChunkingHandler::OnMediaSample(
       segment_start_time_ = timestamp;
       subsegment_start_time_ = timestamp;
       max_segment_time_ = timestamp + sample->duration();
+      segment_first_arrival_time_us_ = 0;
+      subsegment_first_arrival_time_us_ = 0;
       started_new_segment = true;
     }
   }
@@ -126,6 +135,7 @@ Status ChunkingHandler::OnMediaSample(
 
     RETURN_IF_ERROR(EndSubsegmentIfStarted());
     subsegment_start_time_ = timestamp;
+    subsegment_first_arrival_time_us_ = 0;
   }
 
   // Here, a subsegment refers to a fragment that is within a segment.
@@ -143,6 +153,7 @@ Status ChunkingHandler::OnMediaSample(
 
         RETURN_IF_ERROR(EndSubsegmentIfStarted());
         subsegment_start_time_ = timestamp;
+        subsegment_first_arrival_time_us_ = 0;
       }
     }
   }
@@ -161,6 +172,13 @@ Status ChunkingHandler::OnMediaSample(
   subsegment_start_time_ = std::min(subsegment_start_time_.value(), timestamp);
   max_segment_time_ =
       std::max(max_segment_time_, timestamp + sample->duration());
+  if (sample->arrival_time_us() > 0) {
+    if (segment_first_arrival_time_us_ == 0)
+      segment_first_arrival_time_us_ = sample->arrival_time_us();
+    if (subsegment_first_arrival_time_us_ == 0)
+      subsegment_first_arrival_time_us_ = sample->arrival_time_us();
+    last_arrival_time_us_ = sample->arrival_time_us();
+  }
   return DispatchMediaSample(kStreamIndex, std::move(sample));
 }
 
@@ -177,6 +195,10 @@ Status ChunkingHandler::EndSegmentIfStarted() {
   segment_info->start_timestamp = unwrapped_start;
   segment_info->duration = unwrapped_max - unwrapped_start;
   segment_info->segment_number = segment_number_++;
+  if (segment_first_arrival_time_us_ > 0) {
+    segment_info->first_sample_arrival_time_us = segment_first_arrival_time_us_;
+    segment_info->last_sample_arrival_time_us = last_arrival_time_us_;
+  }
 
   DVLOG(2) << "ChunkingHandler: Segment " << segment_info->segment_number
            << " start=" << unwrapped_start
@@ -201,6 +223,11 @@ Status ChunkingHandler::EndSubsegmentIfStarted() const {
   subsegment_info->duration =
       max_segment_time_ - subsegment_start_time_.value();
   subsegment_info->is_subsegment = true;
+  if (subsegment_first_arrival_time_us_ > 0) {
+    subsegment_info->first_sample_arrival_time_us =
+        subsegment_first_arrival_time_us_;
+    subsegment_info->last_sample_arrival_time_us = last_arrival_time_us_;
+  }
   if (chunking_params_.low_latency_dash_mode)
     subsegment_info->is_chunk = true;
   return DispatchSegmentInfo(kStreamIndex, std::move(subsegment_info));
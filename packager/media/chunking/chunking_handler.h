@@ -48,6 +48,7 @@ class ChunkingHandler : public MediaHandler {
   /// @{
   Status InitializeInternal() override;
   Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status ProcessBatch(absl::Span<std::unique_ptr<StreamData>> batch) override;
   Status OnFlushRequest(size_t input_stream_index) override;
   /// @}
 
@@ -90,6 +91,12 @@ class ChunkingHandler : public MediaHandler {
   int64_t max_segment_time_ = 0;
   int32_t time_scale_ = 0;
 
+  // Ingest times of the samples of the current segment and subsegment, see
+  // SegmentInfo::first_sample_arrival_time_us. 0 if unknown.
+  int64_t segment_first_arrival_time_us_ = 0;
+  int64_t subsegment_first_arrival_time_us_ = 0;
+  int64_t last_arrival_time_us_ = 0;
+
   // The offset is applied to sample timestamps so a full segment is generated
   // after cue points.
   int64_t cue_offset_ = 0;
@@ -42,6 +42,10 @@ class ChunkingHandlerTest : public MediaHandlerGraphTestBase {
     return chunking_handler_->Process(std::move(stream_data));
   }
 
+  Status ProcessBatch(std::vector<std::unique_ptr<StreamData>> batch) {
+    return chunking_handler_->ProcessBatch(absl::MakeSpan(batch));
+  }
+
   Status OnFlushRequest(int stream_index) {
     return chunking_handler_->OnFlushRequest(stream_index);
   }
@@ -250,5 +254,74 @@ TEST_F(ChunkingHandlerTest, LowLatencyDash) {
                         kChunkDurationInMs, !kEncrypted, _)));
 }
 
+TEST_F(ChunkingHandlerTest, BatchIsDispatchedAsBatch) {
+  ChunkingParams chunking_params;
+  chunking_params.segment_duration_in_seconds = 1;
+  SetUpChunkingHandler(1, chunking_params);
+
+  std::vector<std::unique_ptr<StreamData>> batch;
+  batch.push_back(StreamData::FromStreamInfo(kStreamIndex,
+                                             GetAudioStreamInfo(kTimeScale0)));
+  for (int i = 0; i < 5; ++i) {
+    batch.push_back(StreamData::FromMediaSample(
+        kStreamIndex, GetMediaSample(i * kDuration, kDuration, kKeyFrame)));
+  }
+  ASSERT_OK(ProcessBatch(std::move(batch)));
+
+  // Same output as processing one by one, with the segment info in between.
+  EXPECT_THAT(
+      GetOutputStreamDataVector(),
+      ElementsAre(
+          IsStreamInfo(kStreamIndex, kTimeScale0, !kEncrypted, _),
+          IsMediaSample(kStreamIndex, 0, kDuration, !kEncrypted, _),
+          IsMediaSample(kStreamIndex, kDuration, kDuration, !kEncrypted, _),
+          IsMediaSample(kStreamIndex, 2 * kDuration, kDuration, !kEncrypted,
+                        _),
+          IsSegmentInfo(kStreamIndex, 0, kDuration * 3, !kIsSubsegment,
+                        !kEncrypted),
+          IsMediaSample(kStreamIndex, 3 * kDuration, kDuration, !kEncrypted,
+                        _),
+          IsMediaSample(kStreamIndex, 4 * kDuration, kDuration, !kEncrypted,
+                        _)));
+  EXPECT_EQ(1u, next_handler()->num_batches());
+}
+
+TEST_F(ChunkingHandlerTest, SegmentInfoCarriesSampleArrivalTimes) {
+  const int64_t kArrivalTimeUs = 1000000;
+  ChunkingParams chunking_params;
+  chunking_params.segment_duration_in_seconds = 1;
+  chunking_params.subsegment_duration_in_seconds = 0.5;
+  SetUpChunkingHandler(1, chunking_params);
+
+  ASSERT_OK(Process(StreamData::FromStreamInfo(
+      kStreamIndex, GetAudioStreamInfo(kTimeScale0))));
+  for (int i = 0; i < 5; ++i) {
+    std::shared_ptr<MediaSample> sample =
+        GetMediaSample(i * kDuration, kDuration, kKeyFrame);
+    sample->set_arrival_time_us(kArrivalTimeUs + i);
+    ASSERT_OK(Process(StreamData::FromMediaSample(kStreamIndex, sample)));
+  }
+  ASSERT_OK(OnFlushRequest(kStreamIndex));
+
+  std::vector<const SegmentInfo*> segment_infos;
+  for (const auto& stream_data : GetOutputStreamDataVector()) {
+    if (stream_data->stream_data_type == StreamDataType::kSegmentInfo)
+      segment_infos.push_back(stream_data->segment_info.get());
+  }
+  ASSERT_EQ(3u, segment_infos.size());
+  // Subsegment with the first two samples.
+  EXPECT_TRUE(segment_infos[0]->is_subsegment);
+  EXPECT_EQ(kArrivalTimeUs, segment_infos[0]->first_sample_arrival_time_us);
+  EXPECT_EQ(kArrivalTimeUs + 1, segment_infos[0]->last_sample_arrival_time_us);
+  // Segment with the first three samples.
+  EXPECT_FALSE(segment_infos[1]->is_subsegment);
+  EXPECT_EQ(kArrivalTimeUs, segment_infos[1]->first_sample_arrival_time_us);
+  EXPECT_EQ(kArrivalTimeUs + 2, segment_infos[1]->last_sample_arrival_time_us);
+  // Segment with the last two samples.
+  EXPECT_FALSE(segment_infos[2]->is_subsegment);
+  EXPECT_EQ(kArrivalTimeUs + 3, segment_infos[2]->first_sample_arrival_time_us);
+  EXPECT_EQ(kArrivalTimeUs + 4, segment_infos[2]->last_sample_arrival_time_us);
+}
+
 }  // namespace media
 }  // namespace shaka
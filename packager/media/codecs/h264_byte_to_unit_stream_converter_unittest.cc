@@ -9,6 +9,7 @@
 #include <absl/strings/escaping.h>
 #include <gtest/gtest.h>
 
+#include <packager/media/base/media_sample.h>
 #include <packager/media/test/test_data_util.h>
 
 namespace {
@@ -63,6 +64,27 @@ TEST(H264ByteToUnitStreamConverter, KeepParameterSetsNalu) {
   EXPECT_EQ(expected_output_frame, output_frame);
 }
 
+TEST(H264ByteToUnitStreamConverter, ConvertToMediaSample) {
+  std::vector<uint8_t> input_frame =
+      ReadTestDataFile("avc-byte-stream-frame.h264");
+  ASSERT_FALSE(input_frame.empty());
+
+  std::vector<uint8_t> expected_output_frame =
+      ReadTestDataFile("avc1-unit-stream-frame.h264");
+  ASSERT_FALSE(expected_output_frame.empty());
+
+  H264ByteToUnitStreamConverter converter(
+      H26xStreamFormat::kNalUnitStreamWithoutParameterSetNalus);
+  std::shared_ptr<MediaSample> sample = MediaSample::CreateEmptyMediaSample();
+  ASSERT_TRUE(converter.ConvertByteStreamToNalUnitStream(
+      input_frame.data(), input_frame.size(), sample.get()));
+  EXPECT_EQ(expected_output_frame,
+            std::vector<uint8_t>(sample->data(),
+                                 sample->data() + sample->data_size()));
+  // The sample owns the converted frame, so it can be modified in place.
+  EXPECT_EQ(sample->data(), sample->GetExclusiveData());
+}
+
 TEST(H264ByteToUnitStreamConverter, ConversionFailure) {
   std::vector<uint8_t> input_frame(100, 0);
 
@@ -197,6 +197,18 @@ const H264Sps* H264Parser::GetSps(int sps_id) {
   return active_SPSes_[sps_id].get();
 }
 
+bool H264Parser::IsParameterSetUnchanged(const Nalu& nalu) const {
+  int id;
+  switch (nalu.type()) {
+    case Nalu::H264_SPS:
+      return sps_cache_.Find(nalu, &id);
+    case Nalu::H264_PPS:
+      return pps_cache_.Find(nalu, &id);
+    default:
+      return false;
+  }
+}
+
 // Default scaling lists (per spec).
 static const int kDefault4x4Intra[kH264ScalingList4x4Length] = {
     6, 13, 13, 20, 20, 20, 28, 28, 28, 28, 32, 32, 32, 37, 37, 42,
@@ -589,6 +601,8 @@ H264Parser::Result H264Parser::ParseSps(const Nalu& nalu, int* sps_id) {
   H26xBitReader* br = &reader;
 
   *sps_id = -1;
+  if (sps_cache_.Find(nalu, sps_id))
+    return kOk;
 
   std::unique_ptr<H264Sps> sps(new H264Sps());
 
@@ -697,6 +711,9 @@ H264Parser::Result H264Parser::ParseSps(const Nalu& nalu, int* sps_id) {
   // If an SPS with the same id already exists, replace it.
   *sps_id = sps->seq_parameter_set_id;
   active_SPSes_[*sps_id] = std::move(sps);
+  sps_cache_.Add(nalu, *sps_id);
+  // PPSes are parsed using the SPS they refer to, so have to be parsed again.
+  pps_cache_.Clear();
 
   return kOk;
 }
@@ -710,6 +727,8 @@ H264Parser::Result H264Parser::ParsePps(const Nalu& nalu, int* pps_id) {
   H26xBitReader* br = &reader;
 
   *pps_id = -1;
+  if (pps_cache_.Find(nalu, pps_id))
+    return kOk;
 
   std::unique_ptr<H264Pps> pps(new H264Pps());
 
@@ -770,6 +789,7 @@ H264Parser::Result H264Parser::ParsePps(const Nalu& nalu, int* pps_id) {
   // If a PPS with the same id already exists, replace it.
   *pps_id = pps->pic_parameter_set_id;
   active_PPSes_[*pps_id] = std::move(pps);
+  pps_cache_.Add(nalu, *pps_id);
 
   return kOk;
 }
@@ -966,15 +986,21 @@ H264Parser::Result H264Parser::ParseDecRefPicMarking(H26xBitReader* br,
   return kOk;
 }
 
-H264Parser::Result H264Parser::ParseSliceHeader(const Nalu& nalu,
-                                                H264SliceHeader* shdr) {
+H264Parser::Result H264Parser::ParsePartialSliceHeader(
+    const Nalu& nalu,
+    H264SliceHeader* shdr) {
+  H26xBitReader reader;
+  reader.Initialize(nalu.data() + nalu.header_size(), nalu.payload_size());
+  return ParsePartialSliceHeader(nalu, &reader, shdr);
+}
+
+H264Parser::Result H264Parser::ParsePartialSliceHeader(
+    const Nalu& nalu,
+    H26xBitReader* br,
+    H264SliceHeader* shdr) {
   // See 7.4.3.
   const H264Sps* sps;
   const H264Pps* pps;
-  Result res;
-  H26xBitReader reader;
-  reader.Initialize(nalu.data() + nalu.header_size(), nalu.payload_size());
-  H26xBitReader* br = &reader;
 
   *shdr = {};
 
@@ -1009,6 +1035,27 @@ H264Parser::Result H264Parser::ParseSliceHeader(const Nalu& nalu,
     }
   }
 
+  if (pps->num_slice_groups_minus1 > 0) {
+    LOG_ERROR_ONCE("Slice groups not supported");
+    return kUnsupportedStream;
+  }
+
+  return kOk;
+}
+
+H264Parser::Result H264Parser::ParseSliceHeader(const Nalu& nalu,
+                                                H264SliceHeader* shdr) {
+  Result res;
+  H26xBitReader reader;
+  reader.Initialize(nalu.data() + nalu.header_size(), nalu.payload_size());
+  H26xBitReader* br = &reader;
+
+  res = ParsePartialSliceHeader(nalu, br, shdr);
+  if (res != kOk)
+    return res;
+  const H264Pps* pps = GetPps(shdr->pic_parameter_set_id);
+  const H264Sps* sps = GetSps(pps->seq_parameter_set_id);
+
   if (shdr->idr_pic_flag)
     READ_UE_OR_RETURN(&shdr->idr_pic_id);
 
@@ -1106,11 +1153,6 @@ H264Parser::Result H264Parser::ParseSliceHeader(const Nalu& nalu,
     }
   }
 
-  if (pps->num_slice_groups_minus1 > 0) {
-    LOG_ERROR_ONCE("Slice groups not supported");
-    return kUnsupportedStream;
-  }
-
   shdr->header_bit_size = nalu.payload_size() * 8 - br->NumBitsLeft();
   return kOk;
 }
@@ -14,6 +14,7 @@
 
 #include <packager/macros/classes.h>
 #include <packager/media/codecs/h26x_bit_reader.h>
+#include <packager/media/codecs/h26x_parameter_set_cache.h>
 #include <packager/media/codecs/nalu_reader.h>
 
 namespace shaka {
@@ -265,9 +266,15 @@ class H264Parser {
   // of the parsed structure in |*pps_id|/|*sps_id|.
   // To get a pointer to a given SPS/PPS structure, use GetSps()/GetPps(),
   // passing the returned |*sps_id|/|*pps_id| as parameter.
+  // An SPS/PPS with the same bytes as the current one with its id is not
+  // parsed again.
   Result ParseSps(const Nalu& nalu, int* sps_id);
   Result ParsePps(const Nalu& nalu, int* pps_id);
 
+  // Returns true if |nalu| is an SPS/PPS with the same bytes as the current
+  // one with its id, i.e. parsing it would not change anything.
+  bool IsParameterSetUnchanged(const Nalu& nalu) const;
+
   // Return a pointer to SPS/PPS with given |sps_id|/|pps_id| or NULL if not
   // present.
   const H264Sps* GetSps(int sps_id);
@@ -282,6 +289,12 @@ class H264Parser {
   // the NALU returned from AdvanceToNextNALU() and corresponding to |*shdr|.
   Result ParseSliceHeader(const Nalu& nalu, H264SliceHeader* shdr);
 
+  // Same as ParseSliceHeader(), but only parses the slice header up to
+  // |field_pic_flag|, which is enough to detect the first slice of a picture.
+  // The members of |*shdr| after it are left zero, including
+  // |header_bit_size|.
+  Result ParsePartialSliceHeader(const Nalu& nalu, H264SliceHeader* shdr);
+
   // Parse a SEI message, returning it in |*sei_msg|, provided and managed
   // by the caller.
   Result ParseSEI(const Nalu& nalu, H264SEIMessage* sei_msg);
@@ -325,12 +338,22 @@ class H264Parser {
   // Parse decoded reference picture marking information (see spec).
   Result ParseDecRefPicMarking(H26xBitReader* br, H264SliceHeader* shdr);
 
+  // Parse the slice header up to |field_pic_flag|, for ParseSliceHeader() and
+  // ParsePartialSliceHeader().
+  Result ParsePartialSliceHeader(const Nalu& nalu,
+                                 H26xBitReader* br,
+                                 H264SliceHeader* shdr);
+
   // PPSes and SPSes stored for future reference.
   typedef std::map<int, std::unique_ptr<H264Sps>> SpsById;
   typedef std::map<int, std::unique_ptr<H264Pps>> PpsById;
   SpsById active_SPSes_;
   PpsById active_PPSes_;
 
+  // The bytes of the SPSes and PPSes above.
+  H26xParameterSetCache sps_cache_;
+  H26xParameterSetCache pps_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(H264Parser);
 };
 
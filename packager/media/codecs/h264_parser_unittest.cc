@@ -193,6 +193,75 @@ TEST(H264ParserTest, PredWeightTable) {
   EXPECT_EQ(0, pred_weight_table.chroma_offset[3][1]);
 }
 
+TEST(H264ParserTest, ParsePartialSliceHeader) {
+  H264Parser parser;
+  int unused_id;
+  Nalu nalu;
+  ASSERT_TRUE(nalu.Initialize(Nalu::kH264, kSps2, std::size(kSps2)));
+  ASSERT_EQ(H264Parser::kOk, parser.ParseSps(nalu, &unused_id));
+  ASSERT_TRUE(nalu.Initialize(Nalu::kH264, kPps2, std::size(kPps2)));
+  ASSERT_EQ(H264Parser::kOk, parser.ParsePps(nalu, &unused_id));
+  ASSERT_TRUE(
+      nalu.Initialize(Nalu::kH264, kVideoSliceTrimmedMultipleLumaWeights,
+                      std::size(kVideoSliceTrimmedMultipleLumaWeights)));
+
+  H264SliceHeader slice_header;
+  ASSERT_EQ(H264Parser::kOk, parser.ParseSliceHeader(nalu, &slice_header));
+  H264SliceHeader partial_slice_header;
+  ASSERT_EQ(H264Parser::kOk,
+            parser.ParsePartialSliceHeader(nalu, &partial_slice_header));
+
+  EXPECT_EQ(slice_header.first_mb_in_slice,
+            partial_slice_header.first_mb_in_slice);
+  EXPECT_EQ(slice_header.slice_type, partial_slice_header.slice_type);
+  EXPECT_EQ(slice_header.pic_parameter_set_id,
+            partial_slice_header.pic_parameter_set_id);
+  EXPECT_EQ(slice_header.frame_num, partial_slice_header.frame_num);
+  // The rest of the slice header is not parsed.
+  EXPECT_FALSE(partial_slice_header.num_ref_idx_active_override_flag);
+  EXPECT_EQ(0u, partial_slice_header.header_bit_size);
+}
+
+TEST(H264ParserTest, ParseUnchangedParameterSets) {
+  H264Parser parser;
+  int sps_id;
+  int pps_id;
+  Nalu sps_nalu;
+  Nalu pps_nalu;
+  ASSERT_TRUE(sps_nalu.Initialize(Nalu::kH264, kSps2, std::size(kSps2)));
+  ASSERT_TRUE(pps_nalu.Initialize(Nalu::kH264, kPps2, std::size(kPps2)));
+  EXPECT_FALSE(parser.IsParameterSetUnchanged(sps_nalu));
+  ASSERT_EQ(H264Parser::kOk, parser.ParseSps(sps_nalu, &sps_id));
+  EXPECT_TRUE(parser.IsParameterSetUnchanged(sps_nalu));
+  EXPECT_FALSE(parser.IsParameterSetUnchanged(pps_nalu));
+  ASSERT_EQ(H264Parser::kOk, parser.ParsePps(pps_nalu, &pps_id));
+  EXPECT_TRUE(parser.IsParameterSetUnchanged(pps_nalu));
+
+  // Repeated parameter sets are not parsed again.
+  const H264Sps* sps = parser.GetSps(sps_id);
+  const H264Pps* pps = parser.GetPps(pps_id);
+  int id = -1;
+  ASSERT_EQ(H264Parser::kOk, parser.ParseSps(sps_nalu, &id));
+  EXPECT_EQ(sps_id, id);
+  id = -1;
+  ASSERT_EQ(H264Parser::kOk, parser.ParsePps(pps_nalu, &id));
+  EXPECT_EQ(pps_id, id);
+  EXPECT_EQ(sps, parser.GetSps(sps_id));
+  EXPECT_EQ(pps, parser.GetPps(pps_id));
+
+  // A changed SPS is parsed again, and so are the PPSes referring to it.
+  std::vector<uint8_t> changed_sps(std::begin(kSps2), std::end(kSps2));
+  // Changes level_idc.
+  changed_sps[3] = 0x1E;
+  ASSERT_TRUE(
+      sps_nalu.Initialize(Nalu::kH264, changed_sps.data(), changed_sps.size()));
+  EXPECT_FALSE(parser.IsParameterSetUnchanged(sps_nalu));
+  ASSERT_EQ(H264Parser::kOk, parser.ParseSps(sps_nalu, &id));
+  EXPECT_EQ(sps_id, id);
+  EXPECT_EQ(30, parser.GetSps(sps_id)->level_idc);
+  EXPECT_FALSE(parser.IsParameterSetUnchanged(pps_nalu));
+}
+
 TEST(H264ParserTest, ParseSps) {
   const uint8_t kSps[] = {0x67, 0x64, 0x00, 0x1E, 0xAC, 0xD9, 0x40, 0xB4,
                           0x2F, 0xF9, 0x7F, 0xF0, 0x00, 0x80, 0x00, 0x91,
@@ -283,15 +283,20 @@ H265SliceHeader::~H265SliceHeader() {}
 H265Parser::H265Parser() {}
 H265Parser::~H265Parser() {}
 
-H265Parser::Result H265Parser::ParseSliceHeader(const Nalu& nalu,
-                                                H265SliceHeader* slice_header) {
+H265Parser::Result H265Parser::ParsePartialSliceHeader(
+    const Nalu& nalu,
+    H265SliceHeader* slice_header) {
   DCHECK(nalu.is_video_slice());
-  *slice_header = H265SliceHeader();
-
-  // Parses whole element.
   H26xBitReader reader;
   reader.Initialize(nalu.data() + nalu.header_size(), nalu.payload_size());
-  H26xBitReader* br = &reader;
+  return ParsePartialSliceHeader(nalu, &reader, slice_header);
+}
+
+H265Parser::Result H265Parser::ParsePartialSliceHeader(
+    const Nalu& nalu,
+    H26xBitReader* br,
+    H265SliceHeader* slice_header) {
+  *slice_header = H265SliceHeader();
 
   TRUE_OR_RETURN(br->ReadBool(&slice_header->first_slice_segment_in_pic_flag));
   if (nalu.type() >= Nalu::H265_BLA_W_LP &&
@@ -307,11 +312,28 @@ H265Parser::Result H265Parser::ParseSliceHeader(const Nalu& nalu,
   TRUE_OR_RETURN(sps);
 
   const H265Vps* vps = GetVps(sps->video_parameter_set_id);
-  const int nuh_layer_id = nalu.nuh_layer_id();
-  if (nuh_layer_id > 0) {
+  if (nalu.nuh_layer_id() > 0) {
     TRUE_OR_RETURN(vps);
   }
 
+  return kOk;
+}
+
+H265Parser::Result H265Parser::ParseSliceHeader(const Nalu& nalu,
+                                                H265SliceHeader* slice_header) {
+  DCHECK(nalu.is_video_slice());
+
+  // Parses whole element.
+  H26xBitReader reader;
+  reader.Initialize(nalu.data() + nalu.header_size(), nalu.payload_size());
+  H26xBitReader* br = &reader;
+
+  OK_OR_RETURN(ParsePartialSliceHeader(nalu, br, slice_header));
+  const H265Pps* pps = GetPps(slice_header->pic_parameter_set_id);
+  const H265Sps* sps = GetSps(pps->seq_parameter_set_id);
+  const H265Vps* vps = GetVps(sps->video_parameter_set_id);
+  const int nuh_layer_id = nalu.nuh_layer_id();
+
   if (!slice_header->first_slice_segment_in_pic_flag) {
     if (pps->dependent_slice_segments_enabled_flag) {
       TRUE_OR_RETURN(br->ReadBool(&slice_header->dependent_slice_segment_flag));
@@ -529,6 +551,9 @@ H265Parser::Result H265Parser::ParsePps(const Nalu& nalu, int* pps_id) {
   H26xBitReader* br = &reader;
 
   *pps_id = -1;
+  if (pps_cache_.Find(nalu, pps_id))
+    return kOk;
+
   std::unique_ptr<H265Pps> pps(new H265Pps);
 
   TRUE_OR_RETURN(br->ReadUE(&pps->pic_parameter_set_id));
@@ -624,6 +649,7 @@ H265Parser::Result H265Parser::ParsePps(const Nalu& nalu, int* pps_id) {
   // This will replace any existing PPS instance.
   *pps_id = pps->pic_parameter_set_id;
   active_ppses_[*pps_id] = std::move(pps);
+  pps_cache_.Add(nalu, *pps_id);
 
   return kOk;
 }
@@ -637,6 +663,8 @@ H265Parser::Result H265Parser::ParseSps(const Nalu& nalu, int* sps_id) {
   H26xBitReader* br = &reader;
 
   *sps_id = -1;
+  if (sps_cache_.Find(nalu, sps_id))
+    return kOk;
 
   std::unique_ptr<H265Sps> sps(new H265Sps);
 
@@ -800,6 +828,7 @@ H265Parser::Result H265Parser::ParseSps(const Nalu& nalu, int* sps_id) {
   // This will replace any existing SPS instance.
   *sps_id = sps->seq_parameter_set_id;
   active_spses_[*sps_id] = std::move(sps);
+  sps_cache_.Add(nalu, *sps_id);
 
   return kOk;
 }
@@ -807,6 +836,20 @@ H265Parser::Result H265Parser::ParseSps(const Nalu& nalu, int* sps_id) {
 H265Parser::Result H265Parser::ParseVps(const Nalu& nalu, int* vps_id) {
   DCHECK_EQ(Nalu::H265_VPS, nalu.type());
 
+  *vps_id = -1;
+  if (vps_cache_.Find(nalu, vps_id))
+    return kOk;
+
+  OK_OR_RETURN(ParseVpsUncached(nalu, vps_id));
+  vps_cache_.Add(nalu, *vps_id);
+  // SPSes are parsed using the VPS they refer to, so have to be parsed again.
+  sps_cache_.Clear();
+  return kOk;
+}
+
+H265Parser::Result H265Parser::ParseVpsUncached(const Nalu& nalu,
+                                                int* vps_id) {
+
   // Reads only the data needed.
   H26xBitReader reader;
   reader.Initialize(nalu.data() + nalu.header_size(), nalu.payload_size());
@@ -1306,6 +1349,20 @@ const H265Vps* H265Parser::GetVps(int vps_id) {
   return active_vpses_[vps_id].get();
 }
 
+bool H265Parser::IsParameterSetUnchanged(const Nalu& nalu) const {
+  int id;
+  switch (nalu.type()) {
+    case Nalu::H265_VPS:
+      return vps_cache_.Find(nalu, &id);
+    case Nalu::H265_SPS:
+      return sps_cache_.Find(nalu, &id);
+    case Nalu::H265_PPS:
+      return pps_cache_.Find(nalu, &id);
+    default:
+      return false;
+  }
+}
+
 H265Parser::Result H265Parser::ParseVuiParameters(int max_num_sub_layers_minus1,
                                                   H26xBitReader* br,
                                                   H265VuiParameters* vui) {
@@ -14,6 +14,7 @@
 
 #include <packager/macros/classes.h>
 #include <packager/media/codecs/h26x_bit_reader.h>
+#include <packager/media/codecs/h26x_parameter_set_cache.h>
 
 namespace shaka {
 namespace media {
@@ -402,6 +403,13 @@ class H265Parser {
   /// contents of |*slice_header| are undefined.
   Result ParseSliceHeader(const Nalu& nalu, H265SliceHeader* slice_header);
 
+  /// Same as ParseSliceHeader(), but only parses the slice header up to
+  /// |pic_parameter_set_id|, which is enough to find the parameter sets of the
+  /// picture.  The other members of |*slice_header| are left at their
+  /// defaults, including |header_bit_size|.
+  Result ParsePartialSliceHeader(const Nalu& nalu,
+                                 H265SliceHeader* slice_header);
+
   /// Parses a PPS element.  This object is owned and managed by this class.
   /// The unique ID of the parsed PPS is stored in |*pps_id| if kOk is returned.
   Result ParsePps(const Nalu& nalu, int* pps_id);
@@ -411,6 +419,11 @@ class H265Parser {
   /// Parses a VPS element.  This object is owned and managed by this class.
   /// The unique ID of the parsed VPS is stored in |*vps_id| if kOk is returned.
   Result ParseVps(const Nalu& nalu, int* vps_id);
+  /// A PPS/SPS/VPS with the same bytes as the current one with its ID is not
+  /// parsed again by the functions above.
+  /// @return true if @a nalu is a PPS/SPS/VPS with the same bytes as the
+  ///         current one with its ID, i.e. parsing it would change nothing.
+  bool IsParameterSetUnchanged(const Nalu& nalu) const;
 
   /// @return a pointer to the PPS with the given ID, or NULL if none exists.
   const H265Pps* GetPps(int pps_id);
@@ -420,6 +433,12 @@ class H265Parser {
   const H265Vps* GetVps(int vps_id);
 
  private:
+  Result ParsePartialSliceHeader(const Nalu& nalu,
+                                 H26xBitReader* br,
+                                 H265SliceHeader* slice_header);
+
+  Result ParseVpsUncached(const Nalu& nalu, int* vps_id);
+
   Result ParseVuiParameters(int max_num_sub_layers_minus1,
                             H26xBitReader* br,
                             H265VuiParameters* vui);
@@ -472,6 +491,11 @@ class H265Parser {
   SpsById active_spses_;
   PpsById active_ppses_;
 
+  // The bytes of the parameter sets above.
+  H26xParameterSetCache vps_cache_;
+  H26xParameterSetCache sps_cache_;
+  H26xParameterSetCache pps_cache_;
+
   DISALLOW_COPY_AND_ASSIGN(H265Parser);
 };
 
@@ -134,6 +134,55 @@ TEST(H265ParserTest, ParseSliceHeader_NonIDR) {
   EXPECT_EQ(128u, header.header_bit_size);
 }
 
+TEST(H265ParserTest, ParsePartialSliceHeader) {
+  // Parse the SPS and PPS first so the data is available.
+  int id;
+  Nalu nalu;
+  H265Parser parser;
+  ASSERT_TRUE(nalu.Initialize(Nalu::kH265, kSpsData, std::size(kSpsData)));
+  ASSERT_EQ(H265Parser::kOk, parser.ParseSps(nalu, &id));
+  ASSERT_TRUE(nalu.Initialize(Nalu::kH265, kPpsData, std::size(kPpsData)));
+  ASSERT_EQ(H265Parser::kOk, parser.ParsePps(nalu, &id));
+
+  // Parse the slice header.
+  ASSERT_TRUE(nalu.Initialize(Nalu::kH265, kSliceData, std::size(kSliceData)));
+
+  H265SliceHeader header;
+  ASSERT_EQ(H265Parser::kOk, parser.ParsePartialSliceHeader(nalu, &header));
+
+  EXPECT_TRUE(header.first_slice_segment_in_pic_flag);
+  EXPECT_EQ(0, header.pic_parameter_set_id);
+  // The rest of the slice header is not parsed.
+  EXPECT_EQ(0, header.num_entry_point_offsets);
+  EXPECT_EQ(0u, header.header_bit_size);
+}
+
+TEST(H265ParserTest, ParseUnchangedParameterSets) {
+  int vps_id;
+  int sps_id;
+  Nalu vps_nalu;
+  Nalu sps_nalu;
+  H265Parser parser;
+  ASSERT_TRUE(vps_nalu.Initialize(Nalu::kH265, kVpsData, std::size(kVpsData)));
+  ASSERT_TRUE(sps_nalu.Initialize(Nalu::kH265, kSpsDataWithVps,
+                                  std::size(kSpsDataWithVps)));
+  ASSERT_EQ(H265Parser::kOk, parser.ParseSps(sps_nalu, &sps_id));
+  EXPECT_TRUE(parser.IsParameterSetUnchanged(sps_nalu));
+  const H265Sps* sps = parser.GetSps(sps_id);
+  int id = -1;
+  ASSERT_EQ(H265Parser::kOk, parser.ParseSps(sps_nalu, &id));
+  EXPECT_EQ(sps_id, id);
+  EXPECT_EQ(sps, parser.GetSps(sps_id));
+
+  // The SPS is parsed again after a new VPS, which it may refer to.
+  EXPECT_FALSE(parser.IsParameterSetUnchanged(vps_nalu));
+  ASSERT_EQ(H265Parser::kOk, parser.ParseVps(vps_nalu, &vps_id));
+  EXPECT_TRUE(parser.IsParameterSetUnchanged(vps_nalu));
+  EXPECT_FALSE(parser.IsParameterSetUnchanged(sps_nalu));
+  ASSERT_EQ(H265Parser::kOk, parser.ParseSps(sps_nalu, &id));
+  EXPECT_TRUE(parser.IsParameterSetUnchanged(sps_nalu));
+}
+
 TEST(H265ParserTest, ParseSps) {
   Nalu nalu;
   ASSERT_TRUE(nalu.Initialize(Nalu::kH265, kSpsData, std::size(kSpsData)));
@@ -0,0 +1,86 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/codecs/h26x_byte_scanner.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define H26X_BYTE_SCANNER_SSE2
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define H26X_BYTE_SCANNER_NEON
+#include <arm_neon.h>
+#endif
+
+#include <absl/numeric/bits.h>
+
+namespace shaka {
+namespace media {
+
+namespace {
+// Number of sequences checked at once by the SIMD implementations.
+const uint64_t kVectorSize = 16;
+// Each sequence is 3 bytes, so checking kVectorSize of them reads that many
+// more bytes.
+const uint64_t kVectorReadSize = kVectorSize + 2;
+}  // namespace
+
+uint64_t FindZeroZeroSequence(const uint8_t* data,
+                              uint64_t data_size,
+                              uint8_t max_third_byte) {
+  uint64_t pos = 0;
+#if defined(H26X_BYTE_SCANNER_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i max_third = _mm_set1_epi8(static_cast<char>(max_third_byte));
+  for (; pos + kVectorReadSize <= data_size; pos += kVectorSize) {
+    const __m128i first =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    const __m128i second =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 1));
+    const __m128i third =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos + 2));
+    // There is no unsigned comparison in SSE2: third <= max_third if and
+    // only if min(third, max_third) == third.
+    const __m128i match = _mm_and_si128(
+        _mm_and_si128(_mm_cmpeq_epi8(first, zero),
+                      _mm_cmpeq_epi8(second, zero)),
+        _mm_cmpeq_epi8(_mm_min_epu8(third, max_third), third));
+    const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(match));
+    if (mask != 0)
+      return pos + absl::countr_zero(mask);
+  }
+#elif defined(H26X_BYTE_SCANNER_NEON)
+  const uint8x16_t max_third = vdupq_n_u8(max_third_byte);
+  for (; pos + kVectorReadSize <= data_size; pos += kVectorSize) {
+    const uint8x16_t match =
+        vandq_u8(vandq_u8(vceqzq_u8(vld1q_u8(data + pos)),
+                          vceqzq_u8(vld1q_u8(data + pos + 1))),
+                 vcleq_u8(vld1q_u8(data + pos + 2), max_third));
+    // Locating the match is rare enough to be left to the scalar code.
+    if (vmaxvq_u8(match) != 0) {
+      return pos + FindZeroZeroSequenceScalar(data + pos, kVectorReadSize,
+                                              max_third_byte);
+    }
+  }
+#endif
+  return pos + FindZeroZeroSequenceScalar(data + pos, data_size - pos,
+                                          max_third_byte);
+}
+
+uint64_t FindZeroZeroSequenceScalar(const uint8_t* data,
+                                    uint64_t data_size,
+                                    uint8_t max_third_byte) {
+  for (uint64_t pos = 0; pos + 2 < data_size; ++pos) {
+    if (data[pos] == 0x00 && data[pos + 1] == 0x00 &&
+        data[pos + 2] <= max_third_byte) {
+      return pos;
+    }
+  }
+  return data_size;
+}
+
+}  // namespace media
+}  // namespace shaka
@@ -0,0 +1,36 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_CODECS_H26X_BYTE_SCANNER_H_
+#define PACKAGER_MEDIA_CODECS_H26X_BYTE_SCANNER_H_
+
+#include <cstdint>
+
+namespace shaka {
+namespace media {
+
+/// Finds the first 00 00 xx byte sequence with xx <= @a max_third_byte, e.g.
+/// a start code (xx <= 1) or a sequence to escape with an emulation prevention
+/// byte (xx <= 3), in H.26x data. SIMD instructions are used when the target
+/// has them, i.e. SSE2 on x86-64 and NEON on ARM64.
+/// @param data is the data to search.
+/// @param data_size is the size of the data.
+/// @param max_third_byte is the maximum value of the third byte.
+/// @return the offset of the sequence, or @a data_size if there is none.
+uint64_t FindZeroZeroSequence(const uint8_t* data,
+                              uint64_t data_size,
+                              uint8_t max_third_byte);
+
+/// Same as FindZeroZeroSequence() but byte by byte. This is the reference of
+/// the SIMD implementations.
+uint64_t FindZeroZeroSequenceScalar(const uint8_t* data,
+                                    uint64_t data_size,
+                                    uint8_t max_third_byte);
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_CODECS_H26X_BYTE_SCANNER_H_
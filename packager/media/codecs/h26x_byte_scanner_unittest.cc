@@ -0,0 +1,158 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/codecs/h26x_byte_scanner.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <packager/media/base/buffer_writer.h>
+#include <packager/media/codecs/nal_unit_to_byte_stream_converter.h>
+#include <packager/media/codecs/nalu_reader.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const int kNumRandomBuffers = 2000;
+const size_t kMaxRandomBufferSize = 100;
+
+// Returns random data which is mostly made of the bytes of start codes and
+// emulation prevention sequences.
+std::vector<uint8_t> GetRandomData(std::mt19937* generator) {
+  const uint8_t kBytes[] = {0x00, 0x00, 0x00, 0x00, 0x01,
+                            0x02, 0x03, 0x04, 0x80, 0xff};
+  std::uniform_int_distribution<size_t> size_distribution(
+      0, kMaxRandomBufferSize);
+  std::uniform_int_distribution<size_t> byte_distribution(
+      0, std::size(kBytes) - 1);
+  std::vector<uint8_t> data(size_distribution(*generator));
+  for (uint8_t& byte : data)
+    byte = kBytes[byte_distribution(*generator)];
+  return data;
+}
+
+// The byte by byte implementation of NaluReader::FindStartCode().
+bool FindStartCodeByteByByte(const uint8_t* data,
+                             uint64_t data_size,
+                             uint64_t* offset,
+                             uint8_t* start_code_size) {
+  uint64_t pos = 0;
+  for (; pos + 3 <= data_size; ++pos) {
+    if (data[pos] == 0x00 && data[pos + 1] == 0x00 && data[pos + 2] == 0x01) {
+      const bool four_bytes = pos > 0 && data[pos - 1] == 0x00;
+      *offset = four_bytes ? pos - 1 : pos;
+      *start_code_size = four_bytes ? 4 : 3;
+      return true;
+    }
+  }
+  *offset = pos;
+  *start_code_size = 0;
+  return false;
+}
+
+// The byte by byte implementation of EscapeNalByteSequence().
+std::vector<uint8_t> EscapeByteByByte(const std::vector<uint8_t>& input) {
+  std::vector<uint8_t> output;
+  int consecutive_zero_count = 0;
+  for (uint8_t byte : input) {
+    if (consecutive_zero_count == 2) {
+      if (byte <= 0x03)
+        output.push_back(0x03);
+      consecutive_zero_count = 0;
+    }
+    output.push_back(byte);
+    consecutive_zero_count = byte == 0x00 ? consecutive_zero_count + 1 : 0;
+  }
+  if (consecutive_zero_count > 0)
+    output.push_back(0x03);
+  return output;
+}
+
+}  // namespace
+
+TEST(H26xByteScannerTest, FindZeroZeroSequence) {
+  const uint8_t kData[] = {0x01, 0x00, 0x00, 0x04, 0x00, 0x00, 0x02, 0x00,
+                           0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+                           0x03, 0x00, 0x00, 0x00, 0x00, 0x01, 0x05, 0x00};
+  EXPECT_EQ(4u, FindZeroZeroSequence(kData, std::size(kData), 0x03));
+  EXPECT_EQ(7u, FindZeroZeroSequence(kData, std::size(kData), 0x01));
+  EXPECT_EQ(1u, FindZeroZeroSequence(kData, std::size(kData), 0x04));
+  EXPECT_EQ(6u, FindZeroZeroSequence(kData + 1, 9, 0x01));
+  // The sequence is cut off.
+  EXPECT_EQ(8u, FindZeroZeroSequence(kData + 1, 8, 0x01));
+  EXPECT_EQ(0u, FindZeroZeroSequence(kData, 0, 0x01));
+  EXPECT_EQ(2u, FindZeroZeroSequence(kData + 1, 2, 0x04));
+}
+
+TEST(H26xByteScannerTest, FindZeroZeroSequenceInLongData) {
+  // Longer than several SIMD vectors, with the sequence at every position.
+  const size_t kDataSize = 100;
+  for (size_t pos = 0; pos + 3 <= kDataSize; ++pos) {
+    std::vector<uint8_t> data(kDataSize, 0x80);
+    data[pos] = 0x00;
+    data[pos + 1] = 0x00;
+    data[pos + 2] = 0x01;
+    EXPECT_EQ(pos, FindZeroZeroSequence(data.data(), data.size(), 0x01));
+    // The sequence is cut off.
+    EXPECT_EQ(pos + 2, FindZeroZeroSequence(data.data(), pos + 2, 0x01));
+  }
+}
+
+TEST(H26xByteScannerTest, MatchesScalarImplementation) {
+  std::mt19937 generator;
+  for (int i = 0; i < kNumRandomBuffers; ++i) {
+    const std::vector<uint8_t> data = GetRandomData(&generator);
+    for (uint8_t max_third_byte : {0x01, 0x03}) {
+      // Start from every offset, so that the SIMD loads are not aligned.
+      for (size_t offset = 0; offset < std::min<size_t>(data.size(), 17);
+           ++offset) {
+        EXPECT_EQ(
+            FindZeroZeroSequenceScalar(data.data() + offset,
+                                       data.size() - offset, max_third_byte),
+            FindZeroZeroSequence(data.data() + offset, data.size() - offset,
+                                 max_third_byte));
+      }
+    }
+  }
+}
+
+TEST(H26xByteScannerTest, FindStartCodeMatchesByteByByteSearch) {
+  std::mt19937 generator;
+  for (int i = 0; i < kNumRandomBuffers; ++i) {
+    const std::vector<uint8_t> data = GetRandomData(&generator);
+    uint64_t expected_offset = 0;
+    uint8_t expected_start_code_size = 0;
+    const bool expected_found =
+        FindStartCodeByteByByte(data.data(), data.size(), &expected_offset,
+                                &expected_start_code_size);
+    uint64_t offset = 0;
+    uint8_t start_code_size = 0;
+    EXPECT_EQ(expected_found,
+              NaluReader::FindStartCode(data.data(), data.size(), &offset,
+                                        &start_code_size));
+    EXPECT_EQ(expected_offset, offset);
+    EXPECT_EQ(expected_start_code_size, start_code_size);
+  }
+}
+
+TEST(H26xByteScannerTest, EscapeNalByteSequenceMatchesByteByByteEscaping) {
+  std::mt19937 generator;
+  for (int i = 0; i < kNumRandomBuffers; ++i) {
+    const std::vector<uint8_t> data = GetRandomData(&generator);
+    BufferWriter writer;
+    EscapeNalByteSequence(data.data(), data.size(), &writer);
+    EXPECT_EQ(EscapeByteByByte(data),
+              std::vector<uint8_t>(writer.Buffer(),
+                                   writer.Buffer() + writer.Size()));
+  }
+}
+
+}  // namespace media
+}  // namespace shaka
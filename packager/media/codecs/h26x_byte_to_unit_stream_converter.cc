@@ -6,6 +6,7 @@
 
 #include <packager/media/codecs/h26x_byte_to_unit_stream_converter.h>
 
+#include <cstring>
 #include <limits>
 
 #include <absl/flags/flag.h>
@@ -14,7 +15,7 @@
 #include <absl/strings/escaping.h>
 
 #include <packager/macros/logging.h>
-#include <packager/media/base/buffer_writer.h>
+#include <packager/media/base/media_sample.h>
 #include <packager/utils/bytes_to_string_view.h>
 
 // TODO(kqyang): Move byte to unit stream convertion to muxer and make it a
@@ -31,12 +32,6 @@ ABSL_FLAG(bool,
 namespace shaka {
 namespace media {
 
-namespace {
-// Additional space to reserve for output frame. This value ought to be enough
-// to acommodate frames consisting of 100 NAL units with 3-byte start codes.
-const size_t kStreamConversionOverhead = 100;
-}  // namespace
-
 H26xByteToUnitStreamConverter::H26xByteToUnitStreamConverter(
     Nalu::CodecType type)
     : type_(type),
@@ -59,7 +54,33 @@ bool H26xByteToUnitStreamConverter::ConvertByteStreamToNalUnitStream(
   DCHECK(input_frame);
   DCHECK(output_frame);
 
-  BufferWriter output_buffer(input_frame_size + kStreamConversionOverhead);
+  size_t output_frame_size = 0;
+  if (!ScanByteStream(input_frame, input_frame_size, &output_frame_size))
+    return false;
+  output_frame->resize(output_frame_size);
+  WriteNalUnitStream(output_frame->data());
+  return true;
+}
+
+bool H26xByteToUnitStreamConverter::ConvertByteStreamToNalUnitStream(
+    const uint8_t* input_frame,
+    size_t input_frame_size,
+    MediaSample* output_sample) {
+  DCHECK(input_frame);
+  DCHECK(output_sample);
+
+  size_t output_frame_size = 0;
+  if (!ScanByteStream(input_frame, input_frame_size, &output_frame_size))
+    return false;
+  WriteNalUnitStream(output_sample->AllocateData(output_frame_size));
+  return true;
+}
+
+bool H26xByteToUnitStreamConverter::ScanByteStream(const uint8_t* input_frame,
+                                                   size_t input_frame_size,
+                                                   size_t* output_frame_size) {
+  nalus_.clear();
+  *output_frame_size = 0;
 
   Nalu nalu;
   NaluReader reader(type_, kIsAnnexbByteStream, input_frame, input_frame_size);
@@ -75,15 +96,27 @@ bool H26xByteToUnitStreamConverter::ConvertByteStreamToNalUnitStream(
     if (ProcessNalu(nalu))
       continue;
 
-    // Append 4-byte length and NAL unit data to the buffer.
-    output_buffer.AppendInt(static_cast<uint32_t>(nalu_size));
-    output_buffer.AppendArray(nalu.data(), nalu_size);
+    // A 4-byte length followed by the NAL unit data.
+    nalus_.emplace_back(nalu.data(), static_cast<uint32_t>(nalu_size));
+    *output_frame_size += kUnitStreamNaluLengthSize + nalu_size;
   }
-
-  output_buffer.SwapBuffer(output_frame);
   return true;
 }
 
+void H26xByteToUnitStreamConverter::WriteNalUnitStream(
+    uint8_t* output_frame) const {
+  for (const auto& nalu : nalus_) {
+    const uint32_t nalu_size = nalu.second;
+    output_frame[0] = static_cast<uint8_t>(nalu_size >> 24);
+    output_frame[1] = static_cast<uint8_t>(nalu_size >> 16);
+    output_frame[2] = static_cast<uint8_t>(nalu_size >> 8);
+    output_frame[3] = static_cast<uint8_t>(nalu_size);
+    output_frame += kUnitStreamNaluLengthSize;
+    memcpy(output_frame, nalu.first, nalu_size);
+    output_frame += nalu_size;
+  }
+}
+
 void H26xByteToUnitStreamConverter::WarnIfNotMatch(
     int nalu_type,
     const uint8_t* nalu_ptr,
@@ -8,6 +8,7 @@
 #define PACKAGER_MEDIA_CODECS_H26X_BYTE_TO_UNIT_STREAM_CONVERTER_H_
 
 #include <cstdint>
+#include <utility>
 #include <vector>
 
 #include <packager/macros/classes.h>
@@ -18,6 +19,7 @@ namespace shaka {
 namespace media {
 
 class BufferWriter;
+class MediaSample;
 
 /// A base class that is used to convert H.26x byte streams to NAL unit streams.
 class H26xByteToUnitStreamConverter {
@@ -47,6 +49,18 @@ class H26xByteToUnitStreamConverter {
                                         size_t input_frame_size,
                                         std::vector<uint8_t>* output_frame);
 
+  /// Converts a whole byte stream encoded video frame to NAL unit stream
+  /// format, directly into the data of a sample.
+  /// @param input_frame is a buffer containing a whole H.26x frame in byte
+  ///        stream format.
+  /// @param input_frame_size is the size of the H.26x frame, in bytes.
+  /// @param output_sample is the sample which will receive the converted
+  ///        frame as its data.
+  /// @return true if successful, false otherwise.
+  bool ConvertByteStreamToNalUnitStream(const uint8_t* input_frame,
+                                        size_t input_frame_size,
+                                        MediaSample* output_sample);
+
   /// Creates either an AVCDecoderConfigurationRecord or a
   /// HEVCDecoderConfigurationRecord from the units extracted from the byte
   /// stream.
@@ -75,8 +89,20 @@ class H26xByteToUnitStreamConverter {
   // not be copied to the buffer.
   virtual bool ProcessNalu(const Nalu& nalu) = 0;
 
+  // Find the NAL units of |input_frame| to be copied to the converted frame,
+  // so that the converted frame can be written in one go.
+  // @param output_frame_size receives the size of the converted frame.
+  bool ScanByteStream(const uint8_t* input_frame,
+                      size_t input_frame_size,
+                      size_t* output_frame_size);
+  // Write the converted frame of the NAL units found by the last
+  // ScanByteStream() call to |output_frame|.
+  void WriteNalUnitStream(uint8_t* output_frame) const;
+
   Nalu::CodecType type_;
   H26xStreamFormat stream_format_;
+  // The NAL units found by ScanByteStream(), kept to reuse their memory.
+  std::vector<std::pair<const uint8_t*, uint32_t>> nalus_;
 
   DISALLOW_COPY_AND_ASSIGN(H26xByteToUnitStreamConverter);
 };
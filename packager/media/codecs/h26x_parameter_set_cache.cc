@@ -0,0 +1,72 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/codecs/h26x_parameter_set_cache.h>
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+namespace shaka {
+namespace media {
+
+namespace {
+
+const uint8_t* GetData(const Nalu& nalu) {
+  return nalu.data();
+}
+
+size_t GetSize(const Nalu& nalu) {
+  // The header is included, as e.g. the nuh_layer_id of an H.265 SPS
+  // changes how it is parsed.
+  return nalu.header_size() + nalu.payload_size();
+}
+
+size_t GetHash(const Nalu& nalu) {
+  return std::hash<std::string_view>()(std::string_view(
+      reinterpret_cast<const char*>(GetData(nalu)), GetSize(nalu)));
+}
+
+}  // namespace
+
+H26xParameterSetCache::H26xParameterSetCache() {}
+H26xParameterSetCache::~H26xParameterSetCache() {}
+
+bool H26xParameterSetCache::Find(const Nalu& nalu, int* id) const {
+  auto id_iter = ids_by_hash_.find(GetHash(nalu));
+  if (id_iter == ids_by_hash_.end())
+    return false;
+  auto entry_iter = entries_by_id_.find(id_iter->second);
+  if (entry_iter == entries_by_id_.end())
+    return false;
+  // Rule out hash collisions.
+  const std::vector<uint8_t>& data = entry_iter->second.data;
+  if (data.size() != GetSize(nalu) ||
+      !std::equal(data.begin(), data.end(), GetData(nalu))) {
+    return false;
+  }
+  *id = id_iter->second;
+  return true;
+}
+
+void H26xParameterSetCache::Add(const Nalu& nalu, int id) {
+  Entry& entry = entries_by_id_[id];
+  auto id_iter = ids_by_hash_.find(entry.hash);
+  if (id_iter != ids_by_hash_.end() && id_iter->second == id)
+    ids_by_hash_.erase(id_iter);
+
+  entry.hash = GetHash(nalu);
+  entry.data.assign(GetData(nalu), GetData(nalu) + GetSize(nalu));
+  ids_by_hash_[entry.hash] = id;
+}
+
+void H26xParameterSetCache::Clear() {
+  entries_by_id_.clear();
+  ids_by_hash_.clear();
+}
+
+}  // namespace media
+}  // namespace shaka
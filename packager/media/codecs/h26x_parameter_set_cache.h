@@ -0,0 +1,59 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_CODECS_H26X_PARAMETER_SET_CACHE_H_
+#define PACKAGER_MEDIA_CODECS_H26X_PARAMETER_SET_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include <packager/macros/classes.h>
+#include <packager/media/codecs/nalu_reader.h>
+
+namespace shaka {
+namespace media {
+
+/// Remembers the bytes of the parameter sets of one type which have been
+/// parsed, keyed by their hash, so that a parameter set repeated unchanged,
+/// e.g. before every IDR picture in broadcast streams, is not parsed again.
+class H26xParameterSetCache {
+ public:
+  H26xParameterSetCache();
+  ~H26xParameterSetCache();
+
+  /// @param nalu is the parameter set NAL unit to look up.
+  /// @param[out] id receives the id of the parameter set if it is found.
+  /// @return true if @a nalu has the same bytes as the parameter set last
+  ///         added with its id.
+  bool Find(const Nalu& nalu, int* id) const;
+
+  /// Records that @a nalu has been parsed into the parameter set @a id,
+  /// replacing the parameter set previously added with this id.
+  void Add(const Nalu& nalu, int id);
+
+  /// Forgets all the parameter sets, e.g. when a parameter set which they
+  /// refer to has changed and they have to be parsed again.
+  void Clear();
+
+ private:
+  struct Entry {
+    size_t hash = 0;
+    std::vector<uint8_t> data;
+  };
+
+  std::map<int, Entry> entries_by_id_;
+  std::unordered_map<size_t, int> ids_by_hash_;
+
+  DISALLOW_COPY_AND_ASSIGN(H26xParameterSetCache);
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_CODECS_H26X_PARAMETER_SET_CACHE_H_
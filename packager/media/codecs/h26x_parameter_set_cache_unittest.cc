@@ -0,0 +1,85 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/codecs/h26x_parameter_set_cache.h>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace shaka {
+namespace media {
+namespace {
+
+const uint8_t kPps1[] = {0x68, 0xEB, 0xCC, 0xB2, 0x2C};
+const uint8_t kPps2[] = {0x68, 0xEB, 0xCC, 0xB2, 0x2D};
+const uint8_t kPps3[] = {0x68, 0xEB, 0xCC, 0xB2, 0x2C, 0x80};
+
+class H26xParameterSetCacheTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(pps1_.Initialize(Nalu::kH264, kPps1, std::size(kPps1)));
+    ASSERT_TRUE(pps2_.Initialize(Nalu::kH264, kPps2, std::size(kPps2)));
+    ASSERT_TRUE(pps3_.Initialize(Nalu::kH264, kPps3, std::size(kPps3)));
+  }
+
+  H26xParameterSetCache cache_;
+  Nalu pps1_;
+  Nalu pps2_;
+  Nalu pps3_;
+};
+
+}  // namespace
+
+TEST_F(H26xParameterSetCacheTest, Find) {
+  int id = -1;
+  EXPECT_FALSE(cache_.Find(pps1_, &id));
+
+  cache_.Add(pps1_, 1);
+  cache_.Add(pps2_, 2);
+  EXPECT_TRUE(cache_.Find(pps1_, &id));
+  EXPECT_EQ(1, id);
+  EXPECT_TRUE(cache_.Find(pps2_, &id));
+  EXPECT_EQ(2, id);
+  EXPECT_FALSE(cache_.Find(pps3_, &id));
+}
+
+TEST_F(H26xParameterSetCacheTest, FindWithCopiedData) {
+  cache_.Add(pps1_, 1);
+
+  const std::vector<uint8_t> data(std::begin(kPps1), std::end(kPps1));
+  Nalu nalu;
+  ASSERT_TRUE(nalu.Initialize(Nalu::kH264, data.data(), data.size()));
+  int id = -1;
+  EXPECT_TRUE(cache_.Find(nalu, &id));
+  EXPECT_EQ(1, id);
+}
+
+TEST_F(H26xParameterSetCacheTest, Replace) {
+  cache_.Add(pps1_, 1);
+  cache_.Add(pps2_, 1);
+
+  int id = -1;
+  EXPECT_FALSE(cache_.Find(pps1_, &id));
+  EXPECT_TRUE(cache_.Find(pps2_, &id));
+  EXPECT_EQ(1, id);
+
+  // The same parameter set with another id.
+  cache_.Add(pps2_, 2);
+  EXPECT_TRUE(cache_.Find(pps2_, &id));
+  EXPECT_EQ(2, id);
+}
+
+TEST_F(H26xParameterSetCacheTest, Clear) {
+  cache_.Add(pps1_, 1);
+  cache_.Clear();
+
+  int id = -1;
+  EXPECT_FALSE(cache_.Find(pps1_, &id));
+}
+
+}  // namespace media
+}  // namespace shaka
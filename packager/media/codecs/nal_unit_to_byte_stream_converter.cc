@@ -15,6 +15,7 @@
 #include <packager/media/base/bit_reader.h>
 #include <packager/media/base/buffer_reader.h>
 #include <packager/media/base/buffer_writer.h>
+#include <packager/media/codecs/h26x_byte_scanner.h>
 #include <packager/media/codecs/nalu_reader.h>
 
 namespace shaka {
@@ -63,38 +64,29 @@ void AddAccessUnitDelimiter(BufferWriter* buffer_writer) {
 void EscapeNalByteSequence(const uint8_t* input,
                            size_t input_size,
                            BufferWriter* output_writer) {
-  // Keep track of consecutive zeros that it has seen (not including the current
-  // byte), so that the algorithm doesn't need to go back to check the same
-  // bytes.
-  int consecutive_zero_count = 0;
-  for (size_t i = 0; i < input_size; ++i) {
-    if (consecutive_zero_count <= 1) {
-      output_writer->AppendInt(input[i]);
-    } else if (consecutive_zero_count == 2) {
-      if (input[i] == 0 || input[i] == 1 || input[i] == 2 || input[i] == 3) {
-        // Must be escaped.
-        output_writer->AppendInt(kEmulationPreventionByte);
-      }
-
-      output_writer->AppendInt(input[i]);
-      // Note that input[i] can be 0.
-      // 00 00 00 00 00 00 should become
-      // 00 00 03 00 00 03 00 00 03
-      // So consecutive_zero_count is reset here and incremented below if
-      // input[i] is 0.
-      consecutive_zero_count = 0;
-    }
-
-    consecutive_zero_count = input[i] == 0 ? consecutive_zero_count + 1 : 0;
+  // The bytes from |input| are copied in bulk, up to the next 00 00 xx
+  // sequence, with xx <= 3, which must be escaped as 00 00 03 xx.
+  size_t copied_size = 0;
+  size_t pos = 0;
+  while (true) {
+    pos += FindZeroZeroSequence(input + pos, input_size - pos, 0x03);
+    if (pos == input_size)
+      break;
+    output_writer->AppendArray(input + copied_size, pos + 2 - copied_size);
+    output_writer->AppendInt(kEmulationPreventionByte);
+    // Note that input[pos + 2] can be 0.
+    // 00 00 00 00 00 00 should become
+    // 00 00 03 00 00 03 00 00 03
+    // So the search goes on from input[pos + 2].
+    pos += 2;
+    copied_size = pos;
   }
+  output_writer->AppendArray(input + copied_size, input_size - copied_size);
 
   // ISO 14496-10 Section 7.4.1.1 mentions that if the last byte is 0 (which
   // only happens if RBSP has cabac_zero_word), 0x03 must be appended.
-  if (consecutive_zero_count > 0) {
-    DCHECK_GT(input_size, 0u);
-    DCHECK_EQ(input[input_size - 1], 0u);
+  if (input_size > 0 && input[input_size - 1] == 0x00)
     output_writer->AppendInt(kEmulationPreventionByte);
-  }
 }
 
 // This functions creates a new subsample entry (|clear_bytes|, |cipher_bytes|)
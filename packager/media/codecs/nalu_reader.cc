@@ -14,6 +14,7 @@
 #include <packager/macros/logging.h>
 #include <packager/media/base/buffer_reader.h>
 #include <packager/media/codecs/h264_parser.h>
+#include <packager/media/codecs/h26x_byte_scanner.h>
 
 namespace shaka {
 namespace media {
@@ -313,31 +314,32 @@ bool NaluReader::FindStartCode(const uint8_t* data,
                                uint64_t data_size,
                                uint64_t* offset,
                                uint8_t* start_code_size) {
-  uint64_t bytes_left = data_size;
-
-  while (bytes_left >= 3) {
-    if (IsStartCode(data)) {
+  uint64_t pos = 0;
+  while (true) {
+    // Look for 00 00 00 too, which may be followed by a four-byte start code.
+    pos += FindZeroZeroSequence(data + pos, data_size - pos, 0x01);
+    if (pos == data_size)
+      break;
+    if (data[pos + 2] == 0x01) {
       // Found three-byte start code, set pointer at its beginning.
-      *offset = data_size - bytes_left;
+      *offset = pos;
       *start_code_size = 3;
 
       // If there is a zero byte before this start code,
       // then it's actually a four-byte start code, so backtrack one byte.
-      if (*offset > 0 && *(data - 1) == 0x00) {
+      if (*offset > 0 && data[pos - 1] == 0x00) {
         --(*offset);
         ++(*start_code_size);
       }
 
       return true;
     }
-
-    ++data;
-    --bytes_left;
+    ++pos;
   }
 
   // End of data: offset is pointing to the first byte that was not considered
   // as a possible start of a start code.
-  *offset = data_size - bytes_left;
+  *offset = data_size < 3 ? 0 : data_size - 2;
   *start_code_size = 0;
   return false;
 }
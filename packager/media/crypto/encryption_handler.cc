@@ -16,6 +16,7 @@
 #include <packager/macros/status.h>
 #include <packager/media/base/aes_encryptor.h>
 #include <packager/media/base/audio_stream_info.h>
+#include <packager/media/base/buffer_pool.h>
 #include <packager/media/base/common_pssh_generator.h>
 #include <packager/media/base/key_source.h>
 #include <packager/media/base/media_sample.h>
@@ -216,6 +217,11 @@ Status EncryptionHandler::Process(std::unique_ptr<StreamData> stream_data) {
   }
 }
 
+Status EncryptionHandler::ProcessBatch(
+    absl::Span<std::unique_ptr<StreamData>> batch) {
+  return ProcessAndDispatchBatch(batch);
+}
+
 Status EncryptionHandler::ProcessStreamInfo(const StreamInfo& clear_info) {
   if (clear_info.is_encrypted()) {
     return Status(error::INVALID_ARGUMENT,
@@ -304,17 +310,32 @@ Status EncryptionHandler::ProcessMediaSample(
   size_t ciphertext_size =
       encryptor_->RequiredOutputSize(clear_sample->data_size());
 
-  std::shared_ptr<uint8_t> cipher_sample_data(new uint8_t[ciphertext_size],
-                                              std::default_delete<uint8_t[]>());
+  std::shared_ptr<MediaSample> cipher_sample;
+  std::shared_ptr<uint8_t> cipher_sample_data;
+  uint8_t* dest = nullptr;
+  if (clear_sample.use_count() == 1 &&
+      ciphertext_size == clear_sample->data_size()) {
+    // Nothing else refers to the clear sample, so it is encrypted in place if
+    // its data is not shared either.
+    cipher_sample = std::const_pointer_cast<MediaSample>(clear_sample);
+    dest = cipher_sample->GetExclusiveData();
+  }
+  if (!dest) {
+    cipher_sample_data =
+        BufferPool::GetInstance()->AllocateShared(ciphertext_size);
+    dest = cipher_sample_data.get();
+    // The clone shares the clear data until it is replaced below.
+    cipher_sample = clear_sample->Clone();
+  }
 
   const uint8_t* source = clear_sample->data();
-  uint8_t* dest = cipher_sample_data.get();
   if (!subsamples.empty()) {
     size_t total_size = 0;
     for (const SubsampleEntry& subsample : subsamples) {
       if (subsample.clear_bytes > 0) {
         // clear_bytes is the number of bytes to leave in the clear
-        memcpy(dest, source, subsample.clear_bytes);
+        if (dest != source)
+          memcpy(dest, source, subsample.clear_bytes);
         source += subsample.clear_bytes;
         dest += subsample.clear_bytes;
         total_size += subsample.clear_bytes;
@@ -332,9 +353,10 @@ Status EncryptionHandler::ProcessMediaSample(
     EncryptBytes(source, clear_sample->data_size(), dest, ciphertext_size);
   }
 
-  std::shared_ptr<MediaSample> cipher_sample(clear_sample->Clone());
-  cipher_sample->TransferData(std::move(cipher_sample_data),
-                              clear_sample->data_size());
+  if (cipher_sample_data) {
+    cipher_sample->TransferData(std::move(cipher_sample_data),
+                                clear_sample->data_size());
+  }
 
   // Finish initializing the sample before sending it downstream. We must
   // wait until now to finish the initialization as we will lose access to
@@ -33,6 +33,7 @@ class EncryptionHandler : public MediaHandler {
   /// @{
   Status InitializeInternal() override;
   Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status ProcessBatch(absl::Span<std::unique_ptr<StreamData>> batch) override;
   /// @}
 
  private:
@@ -514,33 +514,47 @@ bool MockEncrypt(const uint8_t* text,
 
 class EncryptionHandlerSubsampleTest
     : public EncryptionHandlerTest,
-      public WithParamInterface<SubsampleTestCase> {};
+      public WithParamInterface<SubsampleTestCase> {
+ protected:
+  // Sets up MockEncrypt and the subsamples of the test case, and processes a
+  // video stream info.
+  void SetUpMockEncryption() {
+    std::unique_ptr<MockAesCryptor> mock_encryptor(new MockAesCryptor);
+    EXPECT_CALL(*mock_encryptor, CryptInternal(_, _, _, _))
+        .WillRepeatedly(Invoke(MockEncrypt));
+    ASSERT_TRUE(mock_encryptor->SetIv(
+        std::vector<uint8_t>(std::begin(kIv), std::end(kIv))));
+
+    std::unique_ptr<MockAesEncryptorFactory> mock_encryptor_factory(
+        new MockAesEncryptorFactory);
+    EXPECT_CALL(*mock_encryptor_factory, CreateEncryptor(_, _, _, _, _, _))
+        .WillOnce(Return(ByMove(std::move(mock_encryptor))));
+    InjectEncryptorFactoryForTesting(std::move(mock_encryptor_factory));
+
+    InjectSubsamples(GetParam().subsamples);
+
+    EXPECT_CALL(mock_key_source_, GetKey(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(GetMockEncryptionKey()),
+                        Return(Status::OK)));
+
+    ASSERT_OK(Process(StreamData::FromStreamInfo(
+        kStreamIndex, GetVideoStreamInfo(kTimeScale, kCodecH264))));
+  }
+
+  std::vector<uint8_t> GetOutputSampleData() {
+    const MediaSample& sample =
+        *GetOutputStreamDataVector().back()->media_sample;
+    return std::vector<uint8_t>(sample.data(),
+                                sample.data() + sample.data_size());
+  }
+};
 
 INSTANTIATE_TEST_CASE_P(SubsampleTestCases,
                         EncryptionHandlerSubsampleTest,
                         ValuesIn(kSubsampleTestCases));
 
 TEST_P(EncryptionHandlerSubsampleTest, SubsampleTest) {
-  std::unique_ptr<MockAesCryptor> mock_encryptor(new MockAesCryptor);
-  EXPECT_CALL(*mock_encryptor, CryptInternal(_, _, _, _))
-      .WillRepeatedly(Invoke(MockEncrypt));
-  ASSERT_TRUE(mock_encryptor->SetIv(
-      std::vector<uint8_t>(std::begin(kIv), std::end(kIv))));
-
-  std::unique_ptr<MockAesEncryptorFactory> mock_encryptor_factory(
-      new MockAesEncryptorFactory);
-  EXPECT_CALL(*mock_encryptor_factory, CreateEncryptor(_, _, _, _, _, _))
-      .WillOnce(Return(ByMove(std::move(mock_encryptor))));
-  InjectEncryptorFactoryForTesting(std::move(mock_encryptor_factory));
-
-  InjectSubsamples(GetParam().subsamples);
-
-  EXPECT_CALL(mock_key_source_, GetKey(_, _))
-      .WillOnce(
-          DoAll(SetArgPointee<1>(GetMockEncryptionKey()), Return(Status::OK)));
-
-  ASSERT_OK(Process(StreamData::FromStreamInfo(
-      kStreamIndex, GetVideoStreamInfo(kTimeScale, kCodecH264))));
+  SetUpMockEncryption();
   ASSERT_OK(Process(StreamData::FromMediaSample(
       kStreamIndex,
       GetMediaSample(0, kSampleDuration, kIsKeyFrame, kData, kDataSize))));
@@ -551,15 +565,40 @@ TEST_P(EncryptionHandlerSubsampleTest, SubsampleTest) {
                           IsMediaSample(kStreamIndex, 0, kSampleDuration,
                                         kEncrypted, _)));
 
-  const MediaSample& sample = *output_stream_data.back()->media_sample;
-  EXPECT_EQ(
-      GetParam().expected_output,
-      std::vector<uint8_t>(sample.data(), sample.data() + sample.data_size()));
+  EXPECT_EQ(GetParam().expected_output, GetOutputSampleData());
 
+  const MediaSample& sample = *output_stream_data.back()->media_sample;
   const DecryptConfig& decrypt_config = *sample.decrypt_config();
   EXPECT_EQ(GetParam().subsamples, decrypt_config.subsamples());
 }
 
+TEST_P(EncryptionHandlerSubsampleTest, EncryptsUnsharedSampleInPlace) {
+  SetUpMockEncryption();
+  std::shared_ptr<MediaSample> clear_sample =
+      GetMediaSample(0, kSampleDuration, kIsKeyFrame, kData, kDataSize);
+  const uint8_t* clear_data = clear_sample->data();
+  ASSERT_OK(Process(
+      StreamData::FromMediaSample(kStreamIndex, std::move(clear_sample))));
+
+  EXPECT_EQ(clear_data,
+            GetOutputStreamDataVector().back()->media_sample->data());
+  EXPECT_EQ(GetParam().expected_output, GetOutputSampleData());
+}
+
+TEST_P(EncryptionHandlerSubsampleTest, DoesNotModifySharedSample) {
+  SetUpMockEncryption();
+  std::shared_ptr<MediaSample> clear_sample =
+      GetMediaSample(0, kSampleDuration, kIsKeyFrame, kData, kDataSize);
+  ASSERT_OK(
+      Process(StreamData::FromMediaSample(kStreamIndex, clear_sample)));
+
+  EXPECT_EQ(GetParam().expected_output, GetOutputSampleData());
+  EXPECT_EQ(std::vector<uint8_t>(kData, kData + kDataSize),
+            std::vector<uint8_t>(clear_sample->data(),
+                                 clear_sample->data() + kDataSize));
+  EXPECT_FALSE(clear_sample->is_encrypted());
+}
+
 class EncryptionHandlerTrackTypeTest : public EncryptionHandlerTest {};
 
 TEST_F(EncryptionHandlerTrackTypeTest, AudioTrackType) {
@@ -7,15 +7,20 @@
 #include <packager/media/demuxer/demuxer.h>
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
+#include <set>
 
+#include <absl/flags/flag.h>
 #include <absl/log/check.h>
 #include <absl/log/log.h>
 #include <absl/strings/escaping.h>
 #include <absl/strings/numbers.h>
 #include <absl/strings/str_format.h>
+#include <absl/time/clock.h>
 
 #include <packager/file.h>
+#include <packager/file/local_file.h>
 #include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
 #include <packager/media/base/decryptor_source.h>
@@ -28,14 +33,31 @@
 #include <packager/media/formats/webvtt/webvtt_parser.h>
 #include <packager/media/formats/wvm/wvm_media_parser.h>
 
+ABSL_FLAG(bool,
+          use_mmap_for_inputs,
+          false,
+          "Map local input files into memory instead of reading them. MP4 "
+          "samples then reference the mapped file instead of being copied. "
+          "Only use this with inputs which do not change while they are "
+          "packaged, e.g. VOD inputs.");
+
 namespace {
 // 65KB, sufficient to determine the container and likely all init data.
 const size_t kInitBufSize = 0x10000;
 const size_t kBufSize = 0x200000;  // 2MB
+// Maximum number of reads per RunStep() call.
+const size_t kMaxReadsPerStep = 64;
 // Maximum number of allowed queued samples. If we are receiving a lot of
 // samples before seeing init_event, something is not right. The number
 // set here is arbitrary though.
 const size_t kQueuedSamplesLimit = 10000;
+// Maximum number of samples dispatched downstream at once.
+const size_t kMaxDispatchBatchSize = 64;
+// Reading pauses while the memory budget is exhausted, as long as memory is
+// released at least this often.
+const absl::Duration kMemoryReleaseTimeout = absl::Milliseconds(100);
+// Interval to check for cancellation while reading is paused.
+const absl::Duration kMemoryWaitInterval = absl::Milliseconds(10);
 const size_t kInvalidStreamIndex = static_cast<size_t>(-1);
 const size_t kBaseVideoOutputStreamIndex = 0x100;
 const size_t kBaseAudioOutputStreamIndex = 0x200;
@@ -73,6 +95,25 @@ bool GetStreamIndex(const std::string& stream_label, size_t* stream_index) {
   return true;
 }
 
+// Get the type of the streams selected by |stream_index|. Return false if the
+// stream is selected by its index in the input instead.
+bool GetSelectedStreamType(size_t stream_index,
+                           shaka::media::StreamType* stream_type) {
+  switch (stream_index) {
+    case kBaseVideoOutputStreamIndex:
+      *stream_type = shaka::media::kStreamVideo;
+      return true;
+    case kBaseAudioOutputStreamIndex:
+      *stream_type = shaka::media::kStreamAudio;
+      return true;
+    case kBaseTextOutputStreamIndex:
+      *stream_type = shaka::media::kStreamText;
+      return true;
+    default:
+      return false;
+  }
+}
+
 }  // namespace
 
 namespace shaka {
@@ -91,44 +132,27 @@ void Demuxer::SetKeySource(std::unique_ptr<KeySource> key_source) {
 }
 
 Status Demuxer::Run() {
-  LOG(INFO) << "Demuxer::Run() on file '" << file_name_ << "'.";
-  Status status = InitializeParser();
-  // ParserInitEvent callback is called after a few calls to Parse(), which sets
-  // up the streams. Only after that, we can verify the outputs below.
-  while (!all_streams_ready_ && status.ok())
-    status.Update(Parse());
-  // If no output is defined, then return success after receiving all stream
-  // info.
-  if (all_streams_ready_ && output_handlers().empty())
-    return Status::OK;
-  if (!init_event_status_.ok())
-    return init_event_status_;
-  if (!status.ok())
-    return status;
-  // Check if all specified outputs exists.
-  for (const auto& pair : output_handlers()) {
-    if (std::find(stream_indexes_.begin(), stream_indexes_.end(), pair.first) ==
-        stream_indexes_.end()) {
-      LOG(ERROR) << "Invalid argument, stream=" << GetStreamLabel(pair.first)
-                 << " not available.";
-      return Status(error::INVALID_ARGUMENT, "Stream not available");
-    }
+  Status status;
+  while (Step(false, &status) != StepResult::kDone) {
   }
+  return status;
+}
 
-  while (!cancelled_ && status.ok())
-    status.Update(Parse());
-  if (cancelled_ && status.ok())
-    return Status(error::CANCELLED, "Demuxer run cancelled");
+Demuxer::StepResult Demuxer::RunStep(Status* status) {
+  return Step(true, status);
+}
 
-  if (status.error_code() == error::END_OF_STREAM) {
-    for (size_t stream_index : stream_indexes_) {
-      status = FlushDownstream(stream_index);
-      if (!status.ok())
-        return status;
-    }
-    return Status::OK;
-  }
-  return status;
+int Demuxer::GetInputReadinessFd() {
+  // Waiting for memory rather than input, so retry periodically.
+  if (memory_state_ == MemoryState::kPaused)
+    return -1;
+  return media_file_ ? media_file_->GetReadinessFd() : -1;
+}
+
+absl::Duration Demuxer::GetInputTimeout() {
+  const int64_t timeout_us = media_file_ ? media_file_->GetReadTimeoutUs() : 0;
+  return timeout_us > 0 ? absl::Microseconds(timeout_us)
+                        : absl::InfiniteDuration();
 }
 
 void Demuxer::Cancel() {
@@ -152,33 +176,266 @@ void Demuxer::SetLanguageOverride(const std::string& stream_label,
   language_overrides_[stream_index] = language_override;
 }
 
-Status Demuxer::InitializeParser() {
+Demuxer::StepResult Demuxer::Step(bool poll_input, Status* status) {
+  if (cancelled_) {
+    *status = Status(error::CANCELLED, "Demuxer run cancelled");
+    return StepResult::kDone;
+  }
+
+  switch (run_state_) {
+    case RunState::kNotStarted:
+      LOG(INFO) << "Demuxer::Run() on file '" << file_name_ << "'.";
+      if (memory_budget()) {
+        buffer_reservation_ =
+            MemoryBudget::Reservation(memory_budget(), kBufSize);
+      }
+      *status = OpenInput(poll_input);
+      if (!status->ok())
+        return OnStartupDone(*status, status);
+      run_state_ = RunState::kDetectingContainer;
+      return StepResult::kContinue;
+
+    case RunState::kDetectingContainer:
+      if (!HasInitData()) {
+        if (poll_input && !media_file_->IsReadReady())
+          return StepResult::kWaitForInput;
+        *status = ReadInitData();
+        return status->ok() ? StepResult::kContinue
+                            : OnStartupDone(*status, status);
+      }
+      *status = InitializeParser();
+      if (!status->ok())
+        return OnStartupDone(*status, status);
+      run_state_ = RunState::kWaitingForStreams;
+      return StepResult::kContinue;
+
+    case RunState::kWaitingForStreams:
+      // ParserInitEvent callback is called after a few calls to Parse(), which
+      // sets up the streams. Only after that, we can verify the outputs.
+      if (!all_streams_ready_) {
+        if (poll_input && !IsInputReady())
+          return StepResult::kWaitForInput;
+        *status = Parse();
+        if (status->ok() && !all_streams_ready_)
+          return StepResult::kContinue;
+      }
+      return OnStartupDone(*status, status);
+
+    case RunState::kRunning:
+      return ParseStep(poll_input, status);
+
+    case RunState::kDone:
+      break;
+  }
+  *status = Status(error::INTERNAL_ERROR, "Demuxer has already finished.");
+  return StepResult::kDone;
+}
+
+Demuxer::StepResult Demuxer::OnStartupDone(const Status& startup_status,
+                                           Status* status) {
+  run_state_ = RunState::kDone;
+  // If no output is defined, then return success after receiving all stream
+  // info.
+  if (all_streams_ready_ && output_handlers().empty()) {
+    *status = Status::OK;
+    return StepResult::kDone;
+  }
+  if (!init_event_status_.ok()) {
+    *status = init_event_status_;
+    return StepResult::kDone;
+  }
+  if (!startup_status.ok()) {
+    *status = startup_status;
+    return StepResult::kDone;
+  }
+  // Check if all specified outputs exists.
+  for (const auto& pair : output_handlers()) {
+    if (std::find(stream_indexes_.begin(), stream_indexes_.end(), pair.first) ==
+        stream_indexes_.end()) {
+      LOG(ERROR) << "Invalid argument, stream=" << GetStreamLabel(pair.first)
+                 << " not available.";
+      *status = Status(error::INVALID_ARGUMENT, "Stream not available");
+      return StepResult::kDone;
+    }
+  }
+  run_state_ = RunState::kRunning;
+  *status = Status::OK;
+  return StepResult::kContinue;
+}
+
+Demuxer::StepResult Demuxer::ParseStep(bool poll_input, Status* status) {
+  if (poll_input && ShouldPauseForMemory())
+    return StepResult::kWaitForInput;
+  if (!poll_input) {
+    while (!cancelled_ && ShouldPauseForMemory())
+      memory_budget()->WaitForRoom(kMemoryWaitInterval);
+  }
+  if (poll_input && !IsInputReady())
+    return StepResult::kWaitForInput;
+
+  // Live inputs often return little data per read, so parse whatever is
+  // ready, within limits, before giving other handlers a turn.
+  const uint64_t start_bytes_read = num_bytes_read_;
+  size_t num_reads = 0;
+  do {
+    *status = Parse();
+    ++num_reads;
+  } while (poll_input && status->ok() && !cancelled_ &&
+           num_reads < kMaxReadsPerStep &&
+           num_bytes_read_ - start_bytes_read < kBufSize && IsInputReady() &&
+           !ShouldPauseForMemory());
+  if (status->ok())
+    return StepResult::kContinue;
+
+  run_state_ = RunState::kDone;
+  if (status->error_code() == error::END_OF_STREAM) {
+    for (size_t stream_index : stream_indexes_) {
+      *status = FlushDownstream(stream_index);
+      if (!status->ok())
+        return StepResult::kDone;
+    }
+    *status = Status::OK;
+  }
+  return StepResult::kDone;
+}
+
+bool Demuxer::ShouldPauseForMemory() {
+  MemoryBudget* budget = memory_budget().get();
+  if (!budget || drop_samples_over_memory_budget_ || budget->HasRoom()) {
+    memory_state_ = MemoryState::kNormal;
+    return false;
+  }
+
+  const absl::Time now = absl::Now();
+  const uint64_t usage_bytes = budget->usage_bytes();
+  switch (memory_state_) {
+    case MemoryState::kNormal:
+      VLOG(1) << "Memory budget of " << file_name_
+              << " exhausted, pausing reads.";
+      budget->AddBackpressureWait();
+      memory_state_ = MemoryState::kPaused;
+      memory_pause_usage_bytes_ = usage_bytes;
+      memory_pause_time_ = now;
+      return true;
+    case MemoryState::kPaused:
+      if (usage_bytes < memory_pause_usage_bytes_) {
+        memory_pause_usage_bytes_ = usage_bytes;
+        memory_pause_time_ = now;
+        return true;
+      }
+      if (now - memory_pause_time_ < kMemoryReleaseTimeout)
+        return true;
+      // The memory is held by handlers which only release it when they get
+      // more data, e.g. muxers buffering a segment, or by other inputs.
+      LOG(WARNING) << "Memory budget of " << file_name_
+                   << " exhausted but memory is not being released, reading "
+                      "on.";
+      memory_state_ = MemoryState::kOverridden;
+      return false;
+    case MemoryState::kOverridden:
+      return false;
+  }
+  return false;
+}
+
+bool Demuxer::ShouldDropSample(size_t stream_index, const MediaSample& sample) {
+  MemoryBudget* budget = memory_budget().get();
+  if (!budget || !drop_samples_over_memory_budget_)
+    return false;
+
+  auto iter = num_dropped_samples_.find(stream_index);
+  if (!budget->HasRoom()) {
+    if (iter == num_dropped_samples_.end()) {
+      LOG(WARNING) << "Memory budget of " << file_name_
+                   << " exhausted, dropping samples of stream "
+                   << GetStreamLabel(stream_index) << ".";
+      iter = num_dropped_samples_.emplace(stream_index, 0).first;
+    }
+  } else if (iter != num_dropped_samples_.end() && sample.is_key_frame()) {
+    // Resume on a key frame, so that the stream is decodable.
+    LOG(WARNING) << "Dropped " << iter->second << " samples of stream "
+                 << GetStreamLabel(stream_index) << " of " << file_name_
+                 << " to stay within the memory budget.";
+    num_dropped_samples_.erase(iter);
+    return false;
+  }
+  if (iter == num_dropped_samples_.end())
+    return false;
+  ++iter->second;
+  budget->AddDroppedSamples(1);
+  return true;
+}
+
+bool Demuxer::IsInputReady() {
+  return mapped_data_ || media_file_->IsReadReady();
+}
+
+Status Demuxer::OpenInput(bool poll_input) {
   DCHECK(!media_file_);
   DCHECK(!all_streams_ready_);
 
   LOG(INFO) << "Initialize Demuxer for file '" << file_name_ << "'.";
 
-  media_file_ = File::Open(file_name_.c_str(), "r");
-  if (!media_file_) {
-    return Status(error::FILE_FAILURE,
-                  "Cannot open file for reading " + file_name_);
-  }
-
-  int64_t bytes_read = 0;
-  bool eof = false;
-  if (input_format_.empty()) {
-    // Read enough bytes before detecting the container.
-    while (static_cast<size_t>(bytes_read) < kInitBufSize) {
-      int64_t read_result =
-          media_file_->Read(buffer_.get() + bytes_read, kInitBufSize);
-      if (read_result < 0)
-        return Status(error::FILE_FAILURE, "Cannot read file " + file_name_);
-      if (read_result == 0) {
-        eof = true;
-        break;
-      }
-      bytes_read += read_result;
+  if (absl::GetFlag(FLAGS_use_mmap_for_inputs) &&
+      File::IsLocalRegularFile(file_name_.c_str())) {
+    const char* local_file_name = file_name_.c_str();
+    if (strncmp(local_file_name, kLocalFilePrefix, strlen(kLocalFilePrefix)) ==
+        0) {
+      local_file_name += strlen(kLocalFilePrefix);
+    }
+    mapped_data_ = LocalFile::Map(local_file_name, &mapped_size_);
+    if (!mapped_data_)
+      LOG(WARNING) << "Cannot map '" << file_name_ << "'. Reading it instead.";
+  }
+  if (!mapped_data_) {
+    // When taking turns with other handlers, read UDP inputs straight from
+    // the socket, so that waiting for them does not take a thread.  The
+    // socket buffer absorbs bursts instead of the I/O cache.
+    const bool read_directly =
+        poll_input && strncmp(file_name_.c_str(), kUdpFilePrefix,
+                              strlen(kUdpFilePrefix)) == 0;
+    media_file_ = read_directly
+                      ? File::OpenWithNoBuffering(file_name_.c_str(), "r")
+                      : File::Open(file_name_.c_str(), "r");
+    if (!media_file_) {
+      return Status(error::FILE_FAILURE,
+                    "Cannot open file for reading " + file_name_);
     }
+  }
+  return Status::OK;
+}
+
+bool Demuxer::HasInitData() const {
+  return !input_format_.empty() || mapped_data_ || init_data_eof_ ||
+         static_cast<size_t>(init_data_size_) >= kInitBufSize;
+}
+
+Status Demuxer::ReadInitData() {
+  DCHECK(media_file_);
+  // Read enough bytes before detecting the container.
+  int64_t read_result =
+      media_file_->Read(buffer_.get() + init_data_size_, kInitBufSize);
+  if (read_result < 0)
+    return Status(error::FILE_FAILURE, "Cannot read file " + file_name_);
+  if (read_result == 0)
+    init_data_eof_ = true;
+  init_data_size_ += read_result;
+  num_bytes_read_ += read_result;
+  last_read_time_us_ = absl::ToUnixMicros(absl::Now());
+  return Status::OK;
+}
+
+Status Demuxer::InitializeParser() {
+  DCHECK(HasInitData());
+
+  // In mapped mode, the init data is parsed in place.
+  const uint8_t* data = mapped_data_ ? mapped_data_.get() : buffer_.get();
+  int64_t bytes_read = init_data_size_;
+  const bool eof = init_data_eof_;
+  if (input_format_.empty() && mapped_data_) {
+    bytes_read = std::min<uint64_t>(mapped_size_, kInitBufSize);
+    container_name_ = DetermineContainer(data, bytes_read);
+  } else if (input_format_.empty()) {
     container_name_ = DetermineContainer(buffer_.get(), bytes_read);
   } else {
     container_name_ = DetermineContainerFromFormatName(input_format_);
@@ -189,9 +446,26 @@ Status Demuxer::InitializeParser() {
     case CONTAINER_MOV:
       parser_.reset(new mp4::MP4MediaParser());
       break;
-    case CONTAINER_MPEG2TS:
-      parser_.reset(new mp2t::Mp2tMediaParser());
+    case CONTAINER_MPEG2TS: {
+      std::unique_ptr<mp2t::Mp2tMediaParser> mp2t_parser(
+          new mp2t::Mp2tMediaParser());
+      // Only parse the elementary streams of the selected types. The indexes
+      // of the streams, and the dumped stream info, depend on all of them
+      // though.
+      std::set<StreamType> stream_types;
+      for (const auto& pair : output_handlers()) {
+        StreamType stream_type = kStreamUnknown;
+        if (dump_stream_info_ ||
+            !GetSelectedStreamType(pair.first, &stream_type)) {
+          stream_types.clear();
+          break;
+        }
+        stream_types.insert(stream_type);
+      }
+      mp2t_parser->set_selected_stream_types(stream_types);
+      parser_ = std::move(mp2t_parser);
       break;
+    }
       // Widevine classic (WVM) is derived from MPEG2PS. We do not support
       // non-WVM MPEG2PS file, thus we do not differentiate between the two.
       // Every MPEG2PS file is assumed to be WVM file. If it turns out not the
@@ -212,7 +486,7 @@ Status Demuxer::InitializeParser() {
       const int64_t kDumpSizeLimit = 512;
       LOG(ERROR) << "Failed to detect the container type from the buffer: "
                  << absl::BytesToHexString(absl::string_view(
-                        reinterpret_cast<const char*>(buffer_.get()),
+                        reinterpret_cast<const char*>(data),
                         std::min(bytes_read, kDumpSizeLimit)));
       return Status(error::INVALID_ARGUMENT,
                     "Failed to detect the container type.");
@@ -238,8 +512,7 @@ Status Demuxer::InitializeParser() {
     // descriptor |media_file_| instead of opening the same file again.
     static_cast<mp4::MP4MediaParser*>(parser_.get())->LoadMoov(file_name_);
   }
-  if (!parser_->Parse(buffer_.get(), bytes_read) ||
-      (eof && !parser_->Flush())) {
+  if (!ParseData(data, bytes_read) || (eof && !FlushParser())) {
     return Status(error::PARSER_FAILURE,
                   "Cannot parse media file " + file_name_);
   }
@@ -264,6 +537,11 @@ void Demuxer::ParserInitEvent(
       output_handlers().end();
   bool text_handler_set = output_handlers().find(kBaseTextOutputStreamIndex) !=
                           output_handlers().end();
+  // Keep the samples of earlier streams ahead of the new stream info.
+  if (!DispatchPendingSamples()) {
+    init_event_status_.Update(
+        Status(error::PARSER_FAILURE, "Failed to dispatch samples."));
+  }
   for (const std::shared_ptr<StreamInfo>& stream_info : stream_infos) {
     size_t stream_index = base_stream_index;
     if (video_handler_set && stream_info->stream_type() == kStreamVideo) {
@@ -310,6 +588,9 @@ void Demuxer::ParserInitEvent(
 
 bool Demuxer::NewMediaSampleEvent(uint32_t track_id,
                                   std::shared_ptr<MediaSample> sample) {
+  // The sample arrived with the read which completed it.
+  if (sample->arrival_time_us() == 0)
+    sample->set_arrival_time_us(last_read_time_us_);
   if (!all_streams_ready_) {
     if (queued_media_samples_.size() >= kQueuedSamplesLimit) {
       LOG(ERROR) << "Queued samples limit reached: " << kQueuedSamplesLimit;
@@ -365,13 +646,12 @@ bool Demuxer::PushMediaSample(uint32_t track_id,
   }
   if (stream_index_iter->second == kInvalidStreamIndex)
     return true;
-  Status status = DispatchMediaSample(stream_index_iter->second, sample);
-  if (!status.ok()) {
-    LOG(ERROR) << "Failed to process sample " << stream_index_iter->second
-               << " " << status;
-    return false;
-  }
-  return true;
+  if (ShouldDropSample(stream_index_iter->second, *sample))
+    return true;
+  pending_samples_.push_back(StreamData::FromMediaSample(
+      stream_index_iter->second, std::move(sample)));
+  return pending_samples_.size() < kMaxDispatchBatchSize ||
+         DispatchPendingSamples();
 }
 
 bool Demuxer::PushTextSample(uint32_t track_id,
@@ -383,34 +663,80 @@ bool Demuxer::PushTextSample(uint32_t track_id,
   }
   if (stream_index_iter->second == kInvalidStreamIndex)
     return true;
-  Status status = DispatchTextSample(stream_index_iter->second, sample);
+  pending_samples_.push_back(
+      StreamData::FromTextSample(stream_index_iter->second, std::move(sample)));
+  return pending_samples_.size() < kMaxDispatchBatchSize ||
+         DispatchPendingSamples();
+}
+
+bool Demuxer::DispatchPendingSamples() {
+  if (pending_samples_.empty())
+    return true;
+  if (metrics()) {
+    for (const auto& stream_data : pending_samples_)
+      metrics()->AddStreamData(*stream_data);
+  }
+  Status status = DispatchBatch(absl::MakeSpan(pending_samples_));
+  pending_samples_.clear();
   if (!status.ok()) {
-    LOG(ERROR) << "Failed to process sample " << stream_index_iter->second
-               << " " << status;
+    LOG(ERROR) << "Failed to process samples " << status;
     return false;
   }
   return true;
 }
 
 Status Demuxer::Parse() {
-  DCHECK(media_file_);
+  DCHECK(media_file_ || mapped_data_);
   DCHECK(parser_);
   DCHECK(buffer_);
 
-  int64_t bytes_read = media_file_->Read(buffer_.get(), kBufSize);
+  const uint8_t* data = buffer_.get();
+  int64_t bytes_read;
+  if (mapped_data_) {
+    data = mapped_data_.get() + mapped_position_;
+    bytes_read = std::min<uint64_t>(mapped_size_ - mapped_position_, kBufSize);
+  } else {
+    bytes_read = media_file_->Read(buffer_.get(), kBufSize);
+  }
+  // Time spent waiting for input, e.g. from a live source, is not processing.
+  HandlerMetrics::ScopedTimer timer(metrics());
   if (bytes_read == 0) {
-    if (!parser_->Flush())
+    if (!FlushParser())
       return Status(error::PARSER_FAILURE, "Failed to flush.");
     return Status(error::END_OF_STREAM, "");
   } else if (bytes_read < 0) {
     return Status(error::FILE_FAILURE, "Cannot read file " + file_name_);
   }
+  num_bytes_read_ += bytes_read;
+  last_read_time_us_ = absl::ToUnixMicros(absl::Now());
 
-  return parser_->Parse(buffer_.get(), bytes_read)
+  return ParseData(data, bytes_read)
              ? Status::OK
              : Status(error::PARSER_FAILURE,
                       "Cannot parse media file " + file_name_);
 }
 
+bool Demuxer::ParseData(const uint8_t* data, int64_t size) {
+  bool parsed;
+  if (!mapped_data_) {
+    parsed = parser_->Parse(data, size);
+  } else {
+    DCHECK_EQ(data, mapped_data_.get() + mapped_position_);
+    mapped_position_ += size;
+    // Share ownership of the mapping, so that samples referencing it keep it
+    // alive.
+    parsed = parser_->ParseShared(
+        std::shared_ptr<const uint8_t>(mapped_data_, data), size);
+  }
+  // The samples parsed so far are dispatched even if parsing failed, as they
+  // would have been without batching.
+  return DispatchPendingSamples() && parsed;
+}
+
+bool Demuxer::FlushParser() {
+  const bool flushed = parser_->Flush();
+  return DispatchPendingSamples() && flushed;
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -9,13 +9,18 @@
 
 #include <cstdint>
 #include <deque>
+#include <map>
 #include <memory>
 #include <vector>
 
+#include <absl/time/time.h>
+
 #include <packager/macros/classes.h>
 #include <packager/media/base/container_names.h>
 #include <packager/media/origin/origin_handler.h>
+#include <packager/memory_params.h>
 #include <packager/status.h>
+#include <packager/utils/memory_budget.h>
 
 namespace shaka {
 
@@ -49,6 +54,13 @@ class Demuxer : public OriginHandler {
   /// the Data to Muxer until Eof.
   Status Run() override;
 
+  /// Same as Run, a step at a time, without waiting for input.  UDP inputs
+  /// are read directly from the socket in this mode, without an I/O cache.
+  StepResult RunStep(Status* status) override;
+
+  int GetInputReadinessFd() override;
+  absl::Duration GetInputTimeout() override;
+
   /// Cancel a demuxing job in progress. Will cause @a Run to exit with an error
   /// status of type CANCELLED.
   void Cancel() override;
@@ -80,6 +92,13 @@ class Demuxer : public OriginHandler {
     input_format_ = input_format;
   }
 
+  /// Set what to do while the memory budget, see set_memory_budget(), is
+  /// exhausted.
+  void set_memory_overflow_action(MemoryParams::OverflowAction action) {
+    drop_samples_over_memory_budget_ =
+        action == MemoryParams::OverflowAction::kDrop;
+  }
+
  protected:
   /// @name MediaHandler implementation overrides.
   /// @{
@@ -110,6 +129,37 @@ class Demuxer : public OriginHandler {
     std::shared_ptr<T> sample;
   };
 
+  enum class RunState {
+    kNotStarted,
+    kDetectingContainer,
+    kWaitingForStreams,
+    kRunning,
+    kDone,
+  };
+
+  // Advance Run by one step. If |poll_input| is true, return kWaitForInput
+  // instead of waiting for input.
+  StepResult Step(bool poll_input, Status* status);
+  // Validate the outputs once the stream info is known, or stop on
+  // |startup_status| error.
+  StepResult OnStartupDone(const Status& startup_status, Status* status);
+  StepResult ParseStep(bool poll_input, Status* status);
+  bool IsInputReady();
+  // Whether reading has to pause until memory is released. Memory held
+  // downstream, e.g. by muxers buffering a segment, may only be released once
+  // more data is read, so reading only pauses while memory is released.
+  bool ShouldPauseForMemory();
+  // Whether |sample| has to be dropped to stay within the memory budget.
+  // Samples are dropped while the budget is exhausted, up to the next key
+  // frame.
+  bool ShouldDropSample(size_t stream_index, const MediaSample& sample);
+
+  // Map or open the input.
+  Status OpenInput(bool poll_input);
+  // Whether enough data has been read to detect the container.
+  bool HasInitData() const;
+  // Read more data to detect the container from.
+  Status ReadInitData();
   // Initialize the parser. This method primes the demuxer by parsing portions
   // of the media file to extract stream information.
   // @return OK on success.
@@ -124,12 +174,20 @@ class Demuxer : public OriginHandler {
                            std::shared_ptr<MediaSample> sample);
   bool NewTextSampleEvent(uint32_t track_id,
                           std::shared_ptr<TextSample> sample);
-  // Helper function to push the sample to corresponding stream.
+  // Helper function to push the sample to corresponding stream. Samples are
+  // dispatched in batches, see DispatchPendingSamples().
   bool PushMediaSample(uint32_t track_id, std::shared_ptr<MediaSample> sample);
   bool PushTextSample(uint32_t track_id, std::shared_ptr<TextSample> sample);
+  // Dispatch the pushed samples downstream, in order.
+  bool DispatchPendingSamples();
 
   // Read from the source and send it to the parser.
   Status Parse();
+  // Send |size| bytes at |data| to the parser.  In mapped mode, |data| must be
+  // the next unparsed part of the mapped file.
+  bool ParseData(const uint8_t* data, int64_t size);
+  // Flush the parser, dispatching the samples it flushes.
+  bool FlushParser();
 
   std::string file_name_;
   File* media_file_ = nullptr;
@@ -138,6 +196,8 @@ class Demuxer : public OriginHandler {
   // Queued samples received in NewSampleEvent() before ParserInitEvent().
   std::deque<QueuedSample<MediaSample>> queued_media_samples_;
   std::deque<QueuedSample<TextSample>> queued_text_samples_;
+  // Samples pushed but not dispatched yet.
+  std::vector<std::unique_ptr<StreamData>> pending_samples_;
   std::unique_ptr<MediaParser> parser_;
   // TrackId -> StreamIndex map.
   std::map<uint32_t, size_t> track_id_to_stream_index_map_;
@@ -148,6 +208,19 @@ class Demuxer : public OriginHandler {
   std::map<size_t, std::string> language_overrides_;
   MediaContainerName container_name_ = CONTAINER_UNKNOWN;
   std::unique_ptr<uint8_t[]> buffer_;
+  // Data read into |buffer_| to detect the container from.
+  int64_t init_data_size_ = 0;
+  bool init_data_eof_ = false;
+  uint64_t num_bytes_read_ = 0;
+  // Wall-clock time of the last read, in microseconds since the Unix epoch.
+  // Samples parsed from the data read are stamped with it.
+  int64_t last_read_time_us_ = 0;
+  RunState run_state_ = RunState::kNotStarted;
+  // The mapped input file, which is parsed in place instead of being read
+  // through |media_file_|.
+  std::shared_ptr<const uint8_t> mapped_data_;
+  uint64_t mapped_size_ = 0;
+  uint64_t mapped_position_ = 0;
   std::unique_ptr<KeySource> key_source_;
   bool cancelled_ = false;
   // Whether to dump stream info when it is received.
@@ -155,6 +228,23 @@ class Demuxer : public OriginHandler {
   Status init_event_status_;
   // Explicitly defined input format, for avoiding autodetection.
   std::string input_format_;
+
+  enum class MemoryState {
+    kNormal,
+    // Reads are paused until memory is released.
+    kPaused,
+    // Memory was not released while paused, so reading goes on until the
+    // budget has room again.
+    kOverridden,
+  };
+  MemoryBudget::Reservation buffer_reservation_;
+  bool drop_samples_over_memory_budget_ = false;
+  MemoryState memory_state_ = MemoryState::kNormal;
+  uint64_t memory_pause_usage_bytes_ = 0;
+  absl::Time memory_pause_time_;
+  // Stream index -> number of samples dropped since the budget was exhausted,
+  // for the streams currently dropping samples.
+  std::map<size_t, uint64_t> num_dropped_samples_;
 };
 
 }  // namespace media
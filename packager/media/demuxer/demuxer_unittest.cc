@@ -6,14 +6,22 @@
 
 #include <packager/media/demuxer/demuxer.h>
 
+#include <chrono>
+#include <thread>
+
+#include <absl/flags/declare.h>
+#include <absl/flags/flag.h>
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <packager/flag_saver.h>
 #include <packager/media/base/media_handler_test_base.h>
 #include <packager/media/base/raw_key_source.h>
 #include <packager/media/test/test_data_util.h>
 #include <packager/status/status_test_util.h>
 
+ABSL_DECLARE_FLAG(bool, use_mmap_for_inputs);
+
 namespace shaka {
 namespace media {
 namespace {
@@ -73,6 +81,78 @@ TEST_F(DemuxerTest, EncryptedContentWithKeySource) {
   EXPECT_OK(demuxer.Run());
 }
 
+TEST_F(DemuxerTest, MappedInput) {
+  FlagSaver<bool> saver(&FLAGS_use_mmap_for_inputs);
+  absl::SetFlag(&FLAGS_use_mmap_for_inputs, true);
+
+  std::unique_ptr<MockKeySource> mock_key_source(new MockKeySource);
+  EXPECT_CALL(*mock_key_source, GetKey(_, _))
+      .WillOnce(
+          DoAll(SetArgPointee<1>(GetMockEncryptionKey()), Return(Status::OK)));
+
+  Demuxer demuxer(
+      GetAppTestDataFilePath("encryption/bear-640x360-video.mp4").string());
+  demuxer.SetKeySource(std::move(mock_key_source));
+  ASSERT_OK(demuxer.SetHandler("video", some_handler()));
+  EXPECT_OK(demuxer.Run());
+}
+
+TEST_F(DemuxerTest, RunStep) {
+  std::unique_ptr<MockKeySource> mock_key_source(new MockKeySource);
+  EXPECT_CALL(*mock_key_source, GetKey(_, _))
+      .WillOnce(
+          DoAll(SetArgPointee<1>(GetMockEncryptionKey()), Return(Status::OK)));
+
+  Demuxer demuxer(
+      GetAppTestDataFilePath("encryption/bear-640x360-video.mp4").string());
+  demuxer.SetKeySource(std::move(mock_key_source));
+  ASSERT_OK(demuxer.SetHandler("video", some_handler()));
+
+  // Local files are always ready.
+  Status status;
+  OriginHandler::StepResult result;
+  do {
+    result = demuxer.RunStep(&status);
+    ASSERT_NE(OriginHandler::StepResult::kWaitForInput, result);
+  } while (result == OriginHandler::StepResult::kContinue);
+  EXPECT_OK(status);
+}
+
+TEST_F(DemuxerTest, RunStepWaitsForLiveInput) {
+  // Port 0 lets the system assign a free port, as nothing is sent to it.
+  Demuxer demuxer("udp://127.0.0.1:0");
+  ASSERT_OK(demuxer.SetHandler("video", some_handler()));
+
+  Status status;
+  ASSERT_EQ(OriginHandler::StepResult::kContinue, demuxer.RunStep(&status));
+  // Nothing has been sent yet.
+  EXPECT_EQ(OriginHandler::StepResult::kWaitForInput,
+            demuxer.RunStep(&status));
+#if defined(__linux__)
+  EXPECT_GE(demuxer.GetInputReadinessFd(), 0);
+#endif  // defined(__linux__)
+
+  demuxer.Cancel();
+  EXPECT_EQ(OriginHandler::StepResult::kDone, demuxer.RunStep(&status));
+  EXPECT_EQ(error::CANCELLED, status.error_code());
+}
+
+TEST_F(DemuxerTest, RunStepTimesOutLiveInput) {
+  Demuxer demuxer("udp://127.0.0.1:0?timeout=50000");
+  ASSERT_OK(demuxer.SetHandler("video", some_handler()));
+
+  Status status;
+  ASSERT_EQ(OriginHandler::StepResult::kContinue, demuxer.RunStep(&status));
+  EXPECT_EQ(absl::Milliseconds(50), demuxer.GetInputTimeout());
+  EXPECT_EQ(OriginHandler::StepResult::kWaitForInput,
+            demuxer.RunStep(&status));
+
+  // Fails as a blocking read would, once nothing arrived for the timeout.
+  std::this_thread::sleep_for(std::chrono::milliseconds(60));
+  EXPECT_EQ(OriginHandler::StepResult::kDone, demuxer.RunStep(&status));
+  EXPECT_EQ(error::FILE_FAILURE, status.error_code());
+}
+
 // TODO(kqyang): Add more tests.
 
 }  // namespace media
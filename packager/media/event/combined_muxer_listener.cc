@@ -86,6 +86,12 @@ void CombinedMuxerListener::OnCompletedSegment(int64_t duration,
   }
 }
 
+void CombinedMuxerListener::OnSegmentLatency(const SegmentLatency& latency) {
+  for (auto& listener : muxer_listeners_) {
+    listener->OnSegmentLatency(latency);
+  }
+}
+
 void CombinedMuxerListener::OnKeyFrame(int64_t timestamp,
                                        uint64_t start_byte_offset,
                                        uint64_t size) {
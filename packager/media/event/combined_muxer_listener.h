@@ -49,6 +49,7 @@ class CombinedMuxerListener : public MuxerListener {
                     int64_t segment_number) override;
   void OnCompletedSegment(int64_t duration,
                           uint64_t segment_file_size) override;
+  void OnSegmentLatency(const SegmentLatency& latency) override;
   void OnKeyFrame(int64_t timestamp,
                   uint64_t start_byte_offset,
                   uint64_t size) override;
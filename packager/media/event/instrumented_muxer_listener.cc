@@ -0,0 +1,106 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/media/event/instrumented_muxer_listener.h>
+
+#include <absl/log/check.h>
+
+namespace shaka {
+namespace media {
+
+InstrumentedMuxerListener::InstrumentedMuxerListener(
+    std::unique_ptr<MuxerListener> listener,
+    std::shared_ptr<HandlerMetrics> metrics)
+    : listener_(std::move(listener)), metrics_(std::move(metrics)) {
+  DCHECK(listener_);
+}
+
+void InstrumentedMuxerListener::OnEncryptionInfoReady(
+    bool is_initial_encryption_info,
+    FourCC protection_scheme,
+    const std::vector<uint8_t>& key_id,
+    const std::vector<uint8_t>& iv,
+    const std::vector<ProtectionSystemSpecificInfo>& key_system_info) {
+  HandlerMetrics::ScopedTimer timer(metrics_.get());
+  listener_->OnEncryptionInfoReady(is_initial_encryption_info,
+                                   protection_scheme, key_id, iv,
+                                   key_system_info);
+}
+
+void InstrumentedMuxerListener::OnEncryptionStart() {
+  HandlerMetrics::ScopedTimer timer(metrics_.get());
+  listener_->OnEncryptionStart();
+}
+
+void InstrumentedMuxerListener::OnMediaStart(const MuxerOptions& muxer_options,
+                                             const StreamInfo& stream_info,
+                                             int32_t time_scale,
+                                             ContainerType container_type) {
+  HandlerMetrics::ScopedTimer timer(metrics_.get());
+  listener_->OnMediaStart(muxer_options, stream_info, time_scale,
+                          container_type);
+}
+
+void InstrumentedMuxerListener::OnAvailabilityOffsetReady() {
+  HandlerMetrics::ScopedTimer timer(metrics_.get());
+  listener_->OnAvailabilityOffsetReady();
+}
+
+void InstrumentedMuxerListener::OnSampleDurationReady(
+    int32_t sample_duration) {
+  HandlerMetrics::ScopedTimer timer(metrics_.get());
+  listener_->OnSampleDurationReady(sample_duration);
+}
+
+void InstrumentedMuxerListener::OnSegmentDurationReady() {
+  HandlerMetrics::ScopedTimer timer(metrics_.get());
+  listener_->OnSegmentDurationReady();
+}
+
+void InstrumentedMuxerListener::OnMediaEnd(const MediaRanges& media_ranges,
+                                           float duration_seconds) {
+  HandlerMetrics::ScopedTimer timer(metrics_.get());
+  listener_->OnMediaEnd(media_ranges, duration_seconds);
+}
+
+void InstrumentedMuxerListener::OnNewSegment(const std::string& file_name,
+                                             int64_t start_time,
+                                             int64_t duration,
+                                             uint64_t segment_file_size,
+                                             int64_t segment_number) {
+  HandlerMetrics::ScopedTimer timer(metrics_.get());
+  listener_->OnNewSegment(file_name, start_time, duration, segment_file_size,
+                          segment_number);
+}
+
+void InstrumentedMuxerListener::OnCompletedSegment(
+    int64_t duration,
+    uint64_t segment_file_size) {
+  HandlerMetrics::ScopedTimer timer(metrics_.get());
+  listener_->OnCompletedSegment(duration, segment_file_size);
+}
+
+void InstrumentedMuxerListener::OnSegmentLatency(
+    const SegmentLatency& latency) {
+  HandlerMetrics::ScopedTimer timer(metrics_.get());
+  listener_->OnSegmentLatency(latency);
+}
+
+void InstrumentedMuxerListener::OnKeyFrame(int64_t timestamp,
+                                           uint64_t start_byte_offset,
+                                           uint64_t size) {
+  HandlerMetrics::ScopedTimer timer(metrics_.get());
+  listener_->OnKeyFrame(timestamp, start_byte_offset, size);
+}
+
+void InstrumentedMuxerListener::OnCueEvent(int64_t timestamp,
+                                           const std::string& cue_data) {
+  HandlerMetrics::ScopedTimer timer(metrics_.get());
+  listener_->OnCueEvent(timestamp, cue_data);
+}
+
+}  // namespace media
+}  // namespace shaka
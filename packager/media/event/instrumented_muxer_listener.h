@@ -0,0 +1,71 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_MEDIA_EVENT_INSTRUMENTED_MUXER_LISTENER_H_
+#define PACKAGER_MEDIA_EVENT_INSTRUMENTED_MUXER_LISTENER_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <packager/media/base/handler_metrics.h>
+#include <packager/media/event/muxer_listener.h>
+
+namespace shaka {
+namespace media {
+
+/// Forwards all events to another MuxerListener, timing them, so that the
+/// time spent e.g. updating manifests shows up apart from the muxer's.
+class InstrumentedMuxerListener : public MuxerListener {
+ public:
+  InstrumentedMuxerListener(std::unique_ptr<MuxerListener> listener,
+                            std::shared_ptr<HandlerMetrics> metrics);
+
+  /// @name MuxerListener implementation overrides.
+  /// @{
+  void OnEncryptionInfoReady(bool is_initial_encryption_info,
+                             FourCC protection_scheme,
+                             const std::vector<uint8_t>& key_id,
+                             const std::vector<uint8_t>& iv,
+                             const std::vector<ProtectionSystemSpecificInfo>&
+                                 key_system_info) override;
+  void OnEncryptionStart() override;
+  void OnMediaStart(const MuxerOptions& muxer_options,
+                    const StreamInfo& stream_info,
+                    int32_t time_scale,
+                    ContainerType container_type) override;
+  void OnAvailabilityOffsetReady() override;
+  void OnSampleDurationReady(int32_t sample_duration) override;
+  void OnSegmentDurationReady() override;
+  void OnMediaEnd(const MediaRanges& media_ranges,
+                  float duration_seconds) override;
+  void OnNewSegment(const std::string& file_name,
+                    int64_t start_time,
+                    int64_t duration,
+                    uint64_t segment_file_size,
+                    int64_t segment_number) override;
+  void OnCompletedSegment(int64_t duration,
+                          uint64_t segment_file_size) override;
+  void OnSegmentLatency(const SegmentLatency& latency) override;
+  void OnKeyFrame(int64_t timestamp,
+                  uint64_t start_byte_offset,
+                  uint64_t size) override;
+  void OnCueEvent(int64_t timestamp, const std::string& cue_data) override;
+  /// @}
+
+ private:
+  InstrumentedMuxerListener(const InstrumentedMuxerListener&) = delete;
+  InstrumentedMuxerListener& operator=(const InstrumentedMuxerListener&) =
+      delete;
+
+  std::unique_ptr<MuxerListener> listener_;
+  std::shared_ptr<HandlerMetrics> metrics_;
+};
+
+}  // namespace media
+}  // namespace shaka
+
+#endif  // PACKAGER_MEDIA_EVENT_INSTRUMENTED_MUXER_LISTENER_H_
@@ -55,6 +55,22 @@ class MuxerListener {
     std::vector<Range> subsegment_ranges;
   };
 
+  /// Ingest-to-publish latency of a segment, see OnSegmentLatency().
+  struct SegmentLatency {
+    /// Start time of the segment, relative to the timescale specified by
+    /// MediaInfo passed to OnMediaStart().
+    int64_t start_time = 0;
+    bool is_subsegment = false;
+    /// Whether this is a low latency chunk.
+    bool is_chunk = false;
+    /// Time from the ingestion of the first sample of the segment to the
+    /// segment being written, in microseconds.
+    int64_t first_sample_latency_us = 0;
+    /// Time from the ingestion of the last sample of the segment to the
+    /// segment being written, in microseconds.
+    int64_t last_sample_latency_us = 0;
+  };
+
   virtual ~MuxerListener() = default;
 
   /// Called when the media's encryption information is ready.
@@ -152,6 +168,15 @@ class MuxerListener {
     UNUSED(segment_file_size);
   }
 
+  /// Called when a segment, subsegment or low latency chunk has been written,
+  /// i.e. after the OnNewSegment() or OnCompletedSegment() call for it if
+  /// any, when the ingest time of its samples is known, e.g. for live inputs.
+  /// Note that subsegments of single segment outputs are only written out
+  /// when the media ends.
+  virtual void OnSegmentLatency(const SegmentLatency& latency) {
+    UNUSED(latency);
+  }
+
   /// Called when there is a new key frame. For Video only. Note that it should
   /// be called before OnNewSegment is called on the containing segment.
   /// @param timestamp is in terms of the timescale of the media.
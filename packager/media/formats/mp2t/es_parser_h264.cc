@@ -53,6 +53,10 @@ bool EsParserH264::ProcessNalu(const Nalu& nalu,
     }
     case Nalu::H264_SPS: {
       DVLOG(LOG_LEVEL_ES) << "Nalu: SPS";
+      // Parameter sets are typically repeated unchanged before every key
+      // frame, which changes neither them nor the decoder configuration.
+      if (h264_parser_->IsParameterSetUnchanged(nalu))
+        break;
       int sps_id;
       auto status = h264_parser_->ParseSps(nalu, &sps_id);
       if (status == H264Parser::kOk)
@@ -66,6 +70,8 @@ bool EsParserH264::ProcessNalu(const Nalu& nalu,
     }
     case Nalu::H264_PPS: {
       DVLOG(LOG_LEVEL_ES) << "Nalu: PPS";
+      if (h264_parser_->IsParameterSetUnchanged(nalu))
+        break;
       int pps_id;
       auto status = h264_parser_->ParsePps(nalu, &pps_id);
       if (status == H264Parser::kOk) {
@@ -85,7 +91,7 @@ bool EsParserH264::ProcessNalu(const Nalu& nalu,
       const bool is_key_frame = (nalu.type() == Nalu::H264_IDRSlice);
       DVLOG(LOG_LEVEL_ES) << "Nalu: slice IDR=" << is_key_frame;
       H264SliceHeader shdr;
-      auto status = h264_parser_->ParseSliceHeader(nalu, &shdr);
+      auto status = h264_parser_->ParsePartialSliceHeader(nalu, &shdr);
       if (status == H264Parser::kOk) {
         video_slice_info->valid = true;
         video_slice_info->is_key_frame = is_key_frame;
@@ -56,6 +56,10 @@ bool EsParserH265::ProcessNalu(const Nalu& nalu,
     }
     case Nalu::H265_SPS: {
       DVLOG(LOG_LEVEL_ES) << "Nalu: SPS";
+      // Parameter sets are typically repeated unchanged before every key
+      // frame, which changes neither them nor the decoder configuration.
+      if (h265_parser_->IsParameterSetUnchanged(nalu))
+        break;
       int sps_id;
       auto status = h265_parser_->ParseSps(nalu, &sps_id);
       if (status == H265Parser::kOk)
@@ -69,6 +73,8 @@ bool EsParserH265::ProcessNalu(const Nalu& nalu,
     }
     case Nalu::H265_PPS: {
       DVLOG(LOG_LEVEL_ES) << "Nalu: PPS";
+      if (h265_parser_->IsParameterSetUnchanged(nalu))
+        break;
       int pps_id;
       auto status = h265_parser_->ParsePps(nalu, &pps_id);
       if (status == H265Parser::kOk) {
@@ -89,7 +95,7 @@ bool EsParserH265::ProcessNalu(const Nalu& nalu,
                                   nalu.type() == Nalu::H265_IDR_N_LP;
         DVLOG(LOG_LEVEL_ES) << "Nalu: slice KeyFrame=" << is_key_frame;
         H265SliceHeader shdr;
-        auto status = h265_parser_->ParseSliceHeader(nalu, &shdr);
+        auto status = h265_parser_->ParsePartialSliceHeader(nalu, &shdr);
         if (status == H265Parser::kOk) {
           video_slice_info->valid = true;
           video_slice_info->is_key_frame = is_key_frame;
@@ -304,10 +304,11 @@ bool EsParserH26x::EmitFrame(int64_t access_unit_pos,
   const uint8_t* es;
   es_queue_->PeekAt(access_unit_pos, &es, &es_size);
 
-  // Convert frame to unit stream format.
-  std::vector<uint8_t> converted_frame;
-  if (!stream_converter_->ConvertByteStreamToNalUnitStream(es, access_unit_size,
-                                                           &converted_frame)) {
+  // Convert frame to unit stream format, directly into the media sample.
+  std::shared_ptr<MediaSample> media_sample =
+      MediaSample::CreateEmptyMediaSample();
+  if (!stream_converter_->ConvertByteStreamToNalUnitStream(
+          es, access_unit_size, media_sample.get())) {
     DLOG(ERROR) << "Failure to convert video frame to unit stream format.";
     return false;
   }
@@ -315,10 +316,8 @@ bool EsParserH26x::EmitFrame(int64_t access_unit_pos,
   // Update the video decoder configuration if needed.
   RCHECK(UpdateVideoDecoderConfig(pps_id));
 
-  // Create the media sample, emitting always the previous sample after
-  // calculating its duration.
-  std::shared_ptr<MediaSample> media_sample = MediaSample::CopyFrom(
-      converted_frame.data(), converted_frame.size(), is_key_frame);
+  // Emit always the previous sample after calculating its duration.
+  media_sample->set_is_key_frame(is_key_frame);
   media_sample->set_dts(current_timing_desc.dts);
   media_sample->set_pts(current_timing_desc.pts);
   if (pending_sample_) {
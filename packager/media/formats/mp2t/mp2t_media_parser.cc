@@ -4,6 +4,7 @@
 
 #include <packager/media/formats/mp2t/mp2t_media_parser.h>
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 
@@ -13,6 +14,7 @@
 #include <packager/media/base/media_sample.h>
 #include <packager/media/base/stream_info.h>
 #include <packager/media/base/text_sample.h>
+#include <packager/media/base/timestamp.h>
 #include <packager/media/formats/mp2t/es_parser.h>
 #include <packager/media/formats/mp2t/es_parser_audio.h>
 #include <packager/media/formats/mp2t/es_parser_dvb.h>
@@ -32,6 +34,52 @@ namespace shaka {
 namespace media {
 namespace mp2t {
 
+namespace {
+
+// Return the type of the streams carried by elementary streams of
+// |stream_type|, or kStreamUnknown if the type is not supported.
+StreamType GetStreamType(TsStreamType stream_type) {
+  switch (stream_type) {
+    case TsStreamType::kAvc:
+    case TsStreamType::kHevc:
+      return kStreamVideo;
+    case TsStreamType::kAdtsAac:
+    case TsStreamType::kMpeg1Audio:
+    case TsStreamType::kAc3:
+      return kStreamAudio;
+    case TsStreamType::kDvbSubtitles:
+    case TsStreamType::kTeletextSubtitles:
+      return kStreamText;
+    default:
+      return kStreamUnknown;
+  }
+}
+
+// Reports the timestamps in the PES headers of an elementary stream without
+// parsing its payload.
+class EsParserTimestamps : public EsParser {
+ public:
+  typedef std::function<void(int64_t timestamp)> EmitTimestampCB;
+
+  EsParserTimestamps(uint32_t pid, const EmitTimestampCB& emit_timestamp_cb)
+      : EsParser(pid), emit_timestamp_cb_(emit_timestamp_cb) {}
+
+  bool Parse(const uint8_t* buf, int size, int64_t pts, int64_t dts) override {
+    // DTS is not present if it is the same as PTS.
+    const int64_t timestamp = dts != kNoTimestamp ? dts : pts;
+    if (timestamp != kNoTimestamp)
+      emit_timestamp_cb_(timestamp);
+    return true;
+  }
+  bool Flush() override { return true; }
+  void Reset() override {}
+
+ private:
+  EmitTimestampCB emit_timestamp_cb_;
+};
+
+}  // namespace
+
 class PidState {
  public:
   enum PidType {
@@ -40,6 +88,9 @@ class PidState {
     kPidAudioPes,
     kPidVideoPes,
     kPidTextPes,
+    // An unselected audio or video PES, parsed for the heartbeats of the
+    // selected text streams.
+    kPidTimingPes,
   };
 
   PidState(int pid,
@@ -153,7 +204,9 @@ void PidState::ResetState() {
 }
 
 Mp2tMediaParser::Mp2tMediaParser()
-    : sbr_in_mimetype_(false), is_initialized_(false) {}
+    : sbr_in_mimetype_(false),
+      pid_table_(TsSection::kPidMax + 1, nullptr),
+      is_initialized_(false) {}
 
 Mp2tMediaParser::~Mp2tMediaParser() {}
 
@@ -183,6 +236,9 @@ bool Mp2tMediaParser::Flush() {
   }
   bool result = EmitRemainingSamples();
   pids_.clear();
+  std::fill(pid_table_.begin(), pid_table_.end(), nullptr);
+  has_unselected_pes_ = false;
+  has_timing_pes_ = false;
 
   // Remove any bytes left in the TS buffer.
   // (i.e. any partial TS packet => less than 188 bytes).
@@ -193,63 +249,107 @@ bool Mp2tMediaParser::Flush() {
 bool Mp2tMediaParser::Parse(const uint8_t* buf, int size) {
   DVLOG(2) << "Mp2tMediaParser::Parse size=" << size;
 
-  // Add the data to the parser state.
-  ts_byte_queue_.Push(buf, size);
+  // TS packets are parsed from |buf| directly. Only the bytes of a partial TS
+  // packet are copied to |ts_byte_queue_|, which is completed first the next
+  // time.
+  const uint8_t* queued_data;
+  int queued_size;
+  ts_byte_queue_.Peek(&queued_data, &queued_size);
+  while (queued_size > 0 && size > 0) {
+    const int bytes_to_push =
+        std::min(size, TsPacket::kPacketSize - queued_size);
+    ts_byte_queue_.Push(buf, bytes_to_push);
+    buf += bytes_to_push;
+    size -= bytes_to_push;
+
+    ts_byte_queue_.Peek(&queued_data, &queued_size);
+    int bytes_parsed = 0;
+    RCHECK(ParseTsPackets(queued_data, queued_size, &bytes_parsed));
+    ts_byte_queue_.Pop(bytes_parsed);
+    ts_byte_queue_.Peek(&queued_data, &queued_size);
+  }
+  if (size > 0) {
+    int bytes_parsed = 0;
+    RCHECK(ParseTsPackets(buf, size, &bytes_parsed));
+    ts_byte_queue_.Push(buf + bytes_parsed, size - bytes_parsed);
+  }
 
-  while (true) {
-    const uint8_t* ts_buffer;
-    int ts_buffer_size;
-    ts_byte_queue_.Peek(&ts_buffer, &ts_buffer_size);
-    if (ts_buffer_size < TsPacket::kPacketSize)
-      break;
+  // The streams may all have been skipped, in which case no stream info is
+  // ever received.
+  if (has_unselected_pes_)
+    FinishInitializationIfNeeded();
+
+  // Emit the A/V buffers that kept accumulating during TS parsing.
+  return EmitRemainingSamples();
+}
+
+bool Mp2tMediaParser::ParseTsPackets(const uint8_t* buf,
+                                     int size,
+                                     int* bytes_parsed) {
+  *bytes_parsed = 0;
+  while (size - *bytes_parsed >= TsPacket::kPacketSize) {
+    const uint8_t* ts_buffer = buf + *bytes_parsed;
+    const int ts_buffer_size = size - *bytes_parsed;
 
     // Synchronization.
     int skipped_bytes = TsPacket::Sync(ts_buffer, ts_buffer_size);
     if (skipped_bytes > 0) {
       DVLOG(1) << "Packet not aligned on a TS syncword:"
                << " skipped_bytes=" << skipped_bytes;
-      ts_byte_queue_.Pop(skipped_bytes);
+      *bytes_parsed += skipped_bytes;
       continue;
     }
 
     // Parse the TS header, skipping 1 byte if the header is invalid.
-    std::unique_ptr<TsPacket> ts_packet(
-        TsPacket::Parse(ts_buffer, ts_buffer_size));
-    if (!ts_packet) {
+    TsPacket ts_packet;
+    if (!TsPacket::Parse(ts_buffer, ts_buffer_size, &ts_packet)) {
       DVLOG(1) << "Error: invalid TS packet";
-      ts_byte_queue_.Pop(1);
+      *bytes_parsed += 1;
       continue;
     }
-    DVLOG(LOG_LEVEL_TS) << "Processing PID=" << ts_packet->pid()
+    DVLOG(LOG_LEVEL_TS) << "Processing PID=" << ts_packet.pid()
                         << " start_unit="
-                        << ts_packet->payload_unit_start_indicator()
+                        << ts_packet.payload_unit_start_indicator()
                         << " continuity_counter="
-                        << ts_packet->continuity_counter();
+                        << ts_packet.continuity_counter();
     // Parse the section.
-    auto it = pids_.find(ts_packet->pid());
-    if (it == pids_.end() && ts_packet->pid() == TsSection::kPidPat) {
+    PidState* pid_state = GetPidState(ts_packet.pid());
+    if (!pid_state && ts_packet.pid() == TsSection::kPidPat) {
       // Create the PAT state here if needed.
       std::unique_ptr<TsSection> pat_section_parser(new TsSectionPat(
           std::bind(&Mp2tMediaParser::RegisterPmt, this, std::placeholders::_1,
                     std::placeholders::_2)));
       std::unique_ptr<PidState> pat_pid_state(new PidState(
-          ts_packet->pid(), PidState::kPidPat, std::move(pat_section_parser)));
+          ts_packet.pid(), PidState::kPidPat, std::move(pat_section_parser)));
       pat_pid_state->Enable();
-      it = pids_.emplace(ts_packet->pid(), std::move(pat_pid_state)).first;
+      pid_state = pat_pid_state.get();
+      AddPidState(ts_packet.pid(), std::move(pat_pid_state));
     }
 
-    if (it != pids_.end()) {
-      RCHECK(it->second->PushTsPacket(*ts_packet));
+    if (pid_state) {
+      RCHECK(pid_state->PushTsPacket(ts_packet));
     } else {
-      DVLOG(LOG_LEVEL_TS) << "Ignoring TS packet for pid: " << ts_packet->pid();
+      DVLOG(LOG_LEVEL_TS) << "Ignoring TS packet for pid: " << ts_packet.pid();
     }
 
     // Go to the next packet.
-    ts_byte_queue_.Pop(TsPacket::kPacketSize);
+    *bytes_parsed += TsPacket::kPacketSize;
   }
 
-  // Emit the A/V buffers that kept accumulating during TS parsing.
-  return EmitRemainingSamples();
+  return true;
+}
+
+PidState* Mp2tMediaParser::GetPidState(int pid) const {
+  DCHECK_GE(pid, 0);
+  DCHECK_LE(pid, TsSection::kPidMax);
+  return pid_table_[pid];
+}
+
+void Mp2tMediaParser::AddPidState(int pid,
+                                  std::unique_ptr<PidState> pid_state) {
+  DCHECK(!pid_table_[pid]);
+  pid_table_[pid] = pid_state.get();
+  pids_.emplace(pid, std::move(pid_state));
 }
 
 void Mp2tMediaParser::RegisterPmt(int program_number, int pmt_pid) {
@@ -276,7 +376,7 @@ void Mp2tMediaParser::RegisterPmt(int program_number, int pmt_pid) {
   std::unique_ptr<PidState> pmt_pid_state(
       new PidState(pmt_pid, PidState::kPidPmt, std::move(pmt_section_parser)));
   pmt_pid_state->Enable();
-  pids_.emplace(pmt_pid, std::move(pmt_pid_state));
+  AddPidState(pmt_pid, std::move(pmt_pid_state));
 }
 
 void Mp2tMediaParser::RegisterPes(int pmt_pid,
@@ -287,8 +387,21 @@ void Mp2tMediaParser::RegisterPes(int pmt_pid,
                                   TsAudioType audio_type,
                                   const uint8_t* descriptor,
                                   size_t descriptor_length) {
-  if (pids_.count(pes_pid) != 0)
+  if (GetPidState(pes_pid))
     return;
+  const StreamType pes_stream_type = GetStreamType(stream_type);
+  if (!selected_stream_types_.empty() && pes_stream_type != kStreamUnknown &&
+      selected_stream_types_.count(pes_stream_type) == 0) {
+    DVLOG(1) << "Skipping unselected PES: pes_pid=" << pes_pid
+             << " stream_type=" << std::hex << static_cast<int>(stream_type)
+             << std::dec;
+    has_unselected_pes_ = true;
+    // Text streams are segmented on heartbeats from the audio or video
+    // timestamps, so the PES headers of one of them are still parsed.
+    if (!has_timing_pes_ && selected_stream_types_.count(kStreamText) > 0)
+      RegisterTimingPes(pes_pid);
+    return;
+  }
   DVLOG(1) << "RegisterPes:"
            << " pes_pid=" << pes_pid << " stream_type=" << std::hex
            << static_cast<int>(stream_type) << std::dec
@@ -349,7 +462,7 @@ void Mp2tMediaParser::RegisterPes(int pmt_pid,
   std::unique_ptr<PidState> pes_pid_state(
       new PidState(pes_pid, pid_type, std::move(pes_section_parser)));
   pes_pid_state->Enable();
-  pids_.emplace(pes_pid, std::move(pes_pid_state));
+  AddPidState(pes_pid, std::move(pes_pid_state));
 
   // Store PES metadata.
   pes_metadata_.insert(
@@ -361,6 +474,20 @@ void Mp2tMediaParser::RegisterPes(int pmt_pid,
   }
 }
 
+void Mp2tMediaParser::RegisterTimingPes(int pes_pid) {
+  DVLOG(1) << "RegisterTimingPes: pes_pid=" << pes_pid;
+  std::unique_ptr<EsParser> es_parser(new EsParserTimestamps(
+      pes_pid, std::bind(&Mp2tMediaParser::update_biggest_pts, this,
+                         std::placeholders::_1)));
+  std::unique_ptr<TsSection> pes_section_parser(
+      new TsSectionPes(std::move(es_parser)));
+  std::unique_ptr<PidState> pes_pid_state(new PidState(
+      pes_pid, PidState::kPidTimingPes, std::move(pes_section_parser)));
+  pes_pid_state->Enable();
+  AddPidState(pes_pid, std::move(pes_pid_state));
+  has_timing_pes_ = true;
+}
+
 void Mp2tMediaParser::OnNewStreamInfo(
     uint32_t pes_pid,
     std::shared_ptr<StreamInfo> new_stream_info) {
@@ -368,8 +495,8 @@ void Mp2tMediaParser::OnNewStreamInfo(
   DVLOG(1) << "OnVideoConfigChanged for pid=" << pes_pid
            << ", has_info=" << (new_stream_info ? "true" : "false");
 
-  auto pid_state = pids_.find(pes_pid);
-  if (pid_state == pids_.end()) {
+  PidState* pid_state = GetPidState(pes_pid);
+  if (!pid_state) {
     LOG(ERROR) << "PID State for new stream not found (pid = "
                << new_stream_info->track_id() << ").";
     return;
@@ -388,10 +515,10 @@ void Mp2tMediaParser::OnNewStreamInfo(
       // and set here from audio_type
     }
 
-    pid_state->second->set_config(new_stream_info);
+    pid_state->set_config(new_stream_info);
   } else {
     LOG(WARNING) << "Ignoring unsupported stream with pid=" << pes_pid;
-    pid_state->second->Disable();
+    pid_state->Disable();
   }
 
   // Finish initialization if all streams have configs.
@@ -408,18 +535,24 @@ bool Mp2tMediaParser::FinishInitializationIfNeeded() {
     return true;
 
   std::vector<std::shared_ptr<StreamInfo>> all_stream_info;
+  uint32_t num_pes(0);
   uint32_t num_es(0);
   for (const auto& pair : pids_) {
-    if ((pair.second->pid_type() == PidState::kPidAudioPes ||
-         pair.second->pid_type() == PidState::kPidVideoPes ||
-         pair.second->pid_type() == PidState::kPidTextPes) &&
-        pair.second->IsEnabled()) {
+    if (pair.second->pid_type() == PidState::kPidAudioPes ||
+        pair.second->pid_type() == PidState::kPidVideoPes ||
+        pair.second->pid_type() == PidState::kPidTextPes) {
+      ++num_pes;
+      if (!pair.second->IsEnabled())
+        continue;
       ++num_es;
       if (pair.second->config())
         all_stream_info.push_back(pair.second->config());
     }
   }
-  if (num_es && (all_stream_info.size() == num_es)) {
+  // Report no streams if all of them were skipped as unselected, so that the
+  // missing streams are reported without waiting for the end of the input.
+  const bool all_pes_unselected = has_unselected_pes_ && num_pes == 0;
+  if ((num_es && (all_stream_info.size() == num_es)) || all_pes_unselected) {
     // All stream configurations have been received. Initialization can
     // be completed.
     init_cb_(all_stream_info);
@@ -440,8 +573,8 @@ void Mp2tMediaParser::OnEmitMediaSample(
                       << " pts=" << new_sample->pts();
 
   // Add the sample to the appropriate PID sample queue.
-  auto pid_state = pids_.find(pes_pid);
-  if (pid_state == pids_.end()) {
+  PidState* pid_state = GetPidState(pes_pid);
+  if (!pid_state) {
     LOG(ERROR) << "PID State for new sample not found (pid = " << pes_pid
                << ").";
     return;
@@ -450,7 +583,7 @@ void Mp2tMediaParser::OnEmitMediaSample(
   // Use video DTS (or PTS if DTS not available) for video streams
   // Use audio PTS for audio streams
   int64_t timestamp_for_heartbeat = new_sample->pts();
-  if (pid_state->second->pid_type() == PidState::kPidVideoPes) {
+  if (pid_state->pid_type() == PidState::kPidVideoPes) {
     // For video, prefer DTS if available, otherwise use PTS
     // DTS is <= PTS and typically not present if DTS == PTS.
     timestamp_for_heartbeat = new_sample->dts();
@@ -461,7 +594,7 @@ void Mp2tMediaParser::OnEmitMediaSample(
   // For audio and other streams, use PTS (default already set above)
 
   update_biggest_pts(timestamp_for_heartbeat);
-  pid_state->second->media_sample_queue_.push_back(std::move(new_sample));
+  pid_state->media_sample_queue_.push_back(std::move(new_sample));
 }
 
 void Mp2tMediaParser::OnEmitTextSample(uint32_t pes_pid,
@@ -472,8 +605,8 @@ void Mp2tMediaParser::OnEmitTextSample(uint32_t pes_pid,
                       << " start=" << new_sample->start_time();
 
   // Add the sample to the appropriate PID sample queue.
-  auto pid_state = pids_.find(pes_pid);
-  if (pid_state == pids_.end()) {
+  PidState* pid_state = GetPidState(pes_pid);
+  if (!pid_state) {
     LOG(ERROR) << "PID State for new sample not found (pid = " << pes_pid
                << ").";
     return;
@@ -483,7 +616,7 @@ void Mp2tMediaParser::OnEmitTextSample(uint32_t pes_pid,
   // generation Even when real text cues arrive, heartbeats provide timing
   // information for proper segment boundaries, especially for sparse teletext
   // streams
-  pid_state->second->text_sample_queue_.push_back(std::move(new_sample));
+  pid_state->text_sample_queue_.push_back(std::move(new_sample));
 }
 
 bool Mp2tMediaParser::EmitRemainingSamples() {
@@ -521,8 +654,7 @@ void Mp2tMediaParser::update_biggest_pts(int64_t pts) {
   if (pts >= biggest_pts_ + 9000) {  // 100ms larger than last biggest
     biggest_pts_ = pts;
     for (auto pid : text_pids_) {
-      auto pid_state = pids_.find(pid);
-      if (pid_state == pids_.end()) {
+      if (!GetPidState(pid)) {
         LOG(ERROR) << "PID State for new sample not found (text pid = " << pid
                    << " )";
         continue;
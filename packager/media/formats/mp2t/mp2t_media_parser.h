@@ -10,8 +10,10 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #include <packager/macros/classes.h>
 #include <packager/media/base/byte_queue.h>
@@ -52,7 +54,28 @@ class Mp2tMediaParser : public MediaParser {
   [[nodiscard]] bool Parse(const uint8_t* buf, int size) override;
   /// @}
 
+  /// Only parse the elementary streams of the given types, e.g. when only the
+  /// video stream is used. The TS packets of the other elementary streams are
+  /// dropped without being reassembled into PES packets, and the streams are
+  /// not reported in the stream info. If text is selected, the PES headers of
+  /// one audio or video stream are still parsed, for the timestamps of the
+  /// text heartbeats. Must be called before Parse(). All the elementary
+  /// streams are parsed if @a stream_types is empty, the default.
+  void set_selected_stream_types(const std::set<StreamType>& stream_types) {
+    selected_stream_types_ = stream_types;
+  }
+
  private:
+  // Return the state of |pid|, or nullptr if the PID is not registered.
+  PidState* GetPidState(int pid) const;
+
+  // Add a registered PID to |pids_| and |pid_table_|.
+  void AddPidState(int pid, std::unique_ptr<PidState> pid_state);
+
+  // Parse the TS packets in |buf|, until less than a TS packet is left.
+  // |*bytes_parsed| is set to the number of bytes parsed or skipped.
+  bool ParseTsPackets(const uint8_t* buf, int size, int* bytes_parsed);
+
   // Callback invoked to register a Program Map Table.
   // Note: Does nothing if the PID is already registered.
   void RegisterPmt(int program_number, int pmt_pid);
@@ -72,6 +95,10 @@ class Mp2tMediaParser : public MediaParser {
                    const uint8_t* descriptor,
                    size_t descriptor_length);
 
+  // Parse the PES headers of the unselected audio or video |pes_pid|, only for
+  // the timestamps of the text heartbeats.
+  void RegisterTimingPes(int pes_pid);
+
   // Callback invoked each time the audio/video decoder configuration is
   // changed.
   void OnNewStreamInfo(uint32_t pes_pid,
@@ -105,12 +132,23 @@ class Mp2tMediaParser : public MediaParser {
 
   bool sbr_in_mimetype_;
 
-  // Bytes of the TS media.
+  // Bytes of the TS media which could not be parsed from the buffer given to
+  // Parse() directly, i.e. a partial TS packet.
   ByteQueue ts_byte_queue_;
 
   // Map of PIDs and their states.  Use an ordered map so manifest generation
   // has a deterministic order.
   std::map<int, std::unique_ptr<PidState>> pids_;
+  // The states in |pids_| indexed by PID, for the lookup of every TS packet.
+  std::vector<PidState*> pid_table_;
+
+  // Types of the elementary streams to parse. Empty to parse all of them.
+  std::set<StreamType> selected_stream_types_;
+  // Whether an elementary stream was skipped as it is not selected.
+  bool has_unselected_pes_ = false;
+  // Whether an unselected PES is parsed for its timestamps, see
+  // RegisterTimingPes().
+  bool has_timing_pes_ = false;
 
   // Map of PIDs and their metadata.
   std::map<int, PesMetadata> pes_metadata_;
@@ -49,6 +49,7 @@ class Mp2tMediaParserTest : public testing::Test {
 
   std::unique_ptr<Mp2tMediaParser> parser_;
   StreamMap stream_map_;
+  bool init_received_ = false;
   int audio_frame_count_;
   int video_frame_count_;
   int64_t video_min_dts_;
@@ -78,6 +79,7 @@ class Mp2tMediaParserTest : public testing::Test {
 
   void OnInit(const std::vector<std::shared_ptr<StreamInfo>>& stream_infos) {
     DVLOG(1) << "OnInit: " << stream_infos.size() << " streams.";
+    init_received_ = true;
     for (const auto& stream_info : stream_infos) {
       DVLOG(1) << stream_info->ToString();
       stream_map_[stream_info->track_id()] = stream_info;
@@ -159,6 +161,50 @@ TEST_F(Mp2tMediaParserTest, UnalignedAppend512_H264) {
   EXPECT_EQ(82, video_frame_count_);
 }
 
+TEST_F(Mp2tMediaParserTest, AppendWholeFile_H264) {
+  std::vector<uint8_t> buffer = ReadTestDataFile("bear-640x360.ts");
+  ASSERT_TRUE(ParseMpeg2TsFile("bear-640x360.ts", buffer.size()));
+  EXPECT_EQ(79, video_frame_count_);
+  EXPECT_TRUE(parser_->Flush());
+  EXPECT_EQ(82, video_frame_count_);
+}
+
+TEST_F(Mp2tMediaParserTest, UnalignedAppendAfterGarbage_H264) {
+  // The garbage is skipped although it is split across appends.
+  InitializeParser();
+  std::vector<uint8_t> buffer(100, 0x00);
+  const std::vector<uint8_t> ts = ReadTestDataFile("bear-640x360.ts");
+  buffer.insert(buffer.end(), ts.begin(), ts.end());
+  ASSERT_TRUE(AppendDataInPieces(buffer.data(), buffer.size(), 17));
+  EXPECT_EQ(79, video_frame_count_);
+  EXPECT_TRUE(parser_->Flush());
+  EXPECT_EQ(82, video_frame_count_);
+}
+
+TEST_F(Mp2tMediaParserTest, SelectedStreamTypes) {
+  parser_->set_selected_stream_types({kStreamVideo});
+  ASSERT_TRUE(ParseMpeg2TsFile("bear-640x360.ts", 512));
+  EXPECT_TRUE(parser_->Flush());
+  ASSERT_EQ(1u, stream_map_.size());
+  EXPECT_EQ(kStreamVideo, stream_map_.begin()->second->stream_type());
+  EXPECT_EQ(82, video_frame_count_);
+  EXPECT_EQ(0, audio_frame_count_);
+}
+
+TEST_F(Mp2tMediaParserTest, NoSelectedStreams) {
+  // The parser is initialized without streams as soon as the PMT shows that
+  // none of them is selected.
+  parser_->set_selected_stream_types({kStreamText});
+  InitializeParser();
+  std::vector<uint8_t> buffer = ReadTestDataFile("bear-640x360.ts");
+  ASSERT_FALSE(buffer.empty());
+  // The PAT and the PMT are in the first few TS packets.
+  const size_t kHeadSize = 10 * 188;
+  ASSERT_TRUE(AppendData(buffer.data(), kHeadSize));
+  EXPECT_TRUE(init_received_);
+  EXPECT_TRUE(stream_map_.empty());
+}
+
 TEST_F(Mp2tMediaParserTest, UnalignedAppend17_H265) {
   // Test small, non-segment-aligned appends.
   ASSERT_TRUE(ParseMpeg2TsFile("bear-640x360-hevc.ts", 17));
@@ -311,6 +357,26 @@ TEST_F(Mp2tMediaParserTest, TeletextHeartbeatGeneration) {
   LOG(INFO) << "  TextHeartBeat: " << text_heartbeat_count;
 }
 
+TEST_F(Mp2tMediaParserTest, TeletextHeartbeatsWithOnlyTextSelected) {
+  // The audio and video streams are not reported, but their timestamps still
+  // drive the heartbeats of the text stream.
+  parser_->set_selected_stream_types({kStreamText});
+  ASSERT_TRUE(ParseMpeg2TsFile("test_teletext_live.ts", 188));
+  EXPECT_TRUE(parser_->Flush());
+  ASSERT_EQ(1u, stream_map_.size());
+  EXPECT_EQ(kStreamText, stream_map_.begin()->second->stream_type());
+  EXPECT_EQ(0, video_frame_count_);
+  EXPECT_EQ(0, audio_frame_count_);
+
+  int heartbeat_count = 0;
+  for (const auto& sample : text_samples_) {
+    if (sample.role == TextSampleRole::kMediaHeartBeat)
+      ++heartbeat_count;
+  }
+  EXPECT_GT(heartbeat_count, 200);
+  EXPECT_LT(heartbeat_count, 300);
+}
+
 TEST_F(Mp2tMediaParserTest, TeletextPtsWrapAround) {
   // Test that the parser correctly handles PTS values near the 33-bit
   // wrap-around point (2^33 = 8589934592 ticks, ~26.5 hours at 90kHz).
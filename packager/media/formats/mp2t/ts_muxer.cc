@@ -86,17 +86,24 @@ Status TsMuxer::FinalizeSegment(size_t stream_id,
 
   const int64_t file_size = segmenter_->segment_buffer()->Size();
 
-  RETURN_IF_ERROR(WriteSegment(segment_path, segmenter_->segment_buffer()));
+  OutputInfo output_info;
+  output_info.is_segment = true;
+  output_info.segment_number = segment_info.segment_number;
+  output_info.start_time =
+      segment_info.start_timestamp * segmenter_->timescale() +
+      segmenter_->transport_stream_timestamp_offset();
+  output_info.duration = segment_info.duration * segmenter_->timescale();
+  output_info.timescale = kTsTimescale;
+
+  RETURN_IF_ERROR(
+      WriteSegment(segment_path, output_info, segmenter_->segment_buffer()));
 
   total_duration_ += segment_info.duration;
 
   if (muxer_listener()) {
-    muxer_listener()->OnNewSegment(
-        segment_path,
-        segment_info.start_timestamp * segmenter_->timescale() +
-            segmenter_->transport_stream_timestamp_offset(),
-        segment_info.duration * segmenter_->timescale(), file_size,
-        segment_info.segment_number);
+    muxer_listener()->OnNewSegment(segment_path, output_info.start_time,
+                                   output_info.duration, file_size,
+                                   segment_info.segment_number);
   }
 
   segmenter_->set_segment_started(false);
@@ -105,6 +112,7 @@ Status TsMuxer::FinalizeSegment(size_t stream_id,
 }
 
 Status TsMuxer::WriteSegment(const std::string& segment_path,
+                             const OutputInfo& output_info,
                              BufferWriter* segment_buffer) {
   std::unique_ptr<File, FileCloser> file;
 
@@ -122,6 +130,7 @@ Status TsMuxer::WriteSegment(const std::string& segment_path,
       return Status(error::FILE_FAILURE,
                     "Cannot open file for write " + segment_path);
     }
+    SetOutputInfo(options(), output_info, file.get());
   }
 
   RETURN_IF_ERROR(segment_buffer->WriteToFile(output_file_ ? output_file_.get()
@@ -9,6 +9,7 @@
 
 #include <cstdint>
 
+#include <packager/buffer_callback_params.h>
 #include <packager/macros/classes.h>
 #include <packager/media/base/muxer.h>
 #include <packager/media/formats/mp2t/ts_segmenter.h>
@@ -32,6 +33,7 @@ class TsMuxer : public Muxer {
   Status FinalizeSegment(size_t stream_id, const SegmentInfo& sample) override;
 
   Status WriteSegment(const std::string& segment_path,
+                      const OutputInfo& output_info,
                       BufferWriter* segment_buffer);
   Status CloseFile(std::unique_ptr<File, FileCloser> file);
 
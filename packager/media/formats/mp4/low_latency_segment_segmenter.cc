@@ -79,7 +79,7 @@ Status LowLatencySegmentSegmenter::DoFinalizeChunk(int64_t segment_number) {
   if (is_initial_chunk_in_seg_) {
     return WriteInitialChunk(segment_number);
   }
-  return WriteChunk();
+  return WriteChunk(segment_number);
 }
 
 Status LowLatencySegmentSegmenter::WriteInitSegment() {
@@ -92,6 +92,7 @@ Status LowLatencySegmentSegmenter::WriteInitSegment() {
     return Status(error::FILE_FAILURE,
                   "Cannot open file for write " + options().output_file_name);
   }
+  SetOutputInfo(options(), OutputInfo(), file.get());
   std::unique_ptr<BufferWriter> buffer(new BufferWriter);
   ftyp()->Write(buffer.get());
   moov()->Write(buffer.get());
@@ -146,6 +147,7 @@ Status LowLatencySegmentSegmenter::WriteInitialChunk(int64_t segment_number) {
 
   // Write the chunk data to the file
   RETURN_IF_ERROR(fragment_buffer()->WriteToFile(segment_file_.get()));
+  RETURN_IF_ERROR(DeliverChunk(segment_number));
 
   uint64_t segment_duration = GetSegmentDuration();
   UpdateProgress(segment_duration);
@@ -170,11 +172,12 @@ Status LowLatencySegmentSegmenter::WriteInitialChunk(int64_t segment_number) {
   return Status::OK;
 }
 
-Status LowLatencySegmentSegmenter::WriteChunk() {
+Status LowLatencySegmentSegmenter::WriteChunk(int64_t segment_number) {
   DCHECK(fragment_buffer());
 
   // Write the chunk data to the file
   RETURN_IF_ERROR(fragment_buffer()->WriteToFile(segment_file_.get()));
+  RETURN_IF_ERROR(DeliverChunk(segment_number));
 
   UpdateProgress(GetSegmentDuration());
 
@@ -202,6 +205,16 @@ Status LowLatencySegmentSegmenter::FinalizeSegment() {
   return Status::OK;
 }
 
+Status LowLatencySegmentSegmenter::DeliverChunk(int64_t segment_number) {
+  OutputInfo output_info;
+  output_info.is_segment = true;
+  output_info.segment_number = segment_number;
+  output_info.start_time = sidx()->earliest_presentation_time;
+  output_info.duration = GetSegmentDuration();
+  output_info.timescale = sidx()->timescale;
+  return DeliverOutputChunk(options(), output_info, segment_file_.get());
+}
+
 uint64_t LowLatencySegmentSegmenter::GetSegmentDuration() {
   DCHECK(sidx());
 
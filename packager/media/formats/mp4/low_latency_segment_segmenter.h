@@ -51,9 +51,12 @@ class LowLatencySegmentSegmenter : public Segmenter {
 
   // Write segment to file.
   Status WriteInitSegment();
-  Status WriteChunk();
+  Status WriteChunk(int64_t segment_number);
   Status WriteInitialChunk(int64_t segment_number);
   Status FinalizeSegment();
+  // Delivers the chunk just written, if the segment is delivered through
+  // BufferCallbackParams::output_func.
+  Status DeliverChunk(int64_t segment_number);
 
   uint64_t GetSegmentDuration();
 
@@ -17,6 +17,7 @@
 #include <packager/macros/compiler.h>
 #include <packager/macros/logging.h>
 #include <packager/media/base/audio_stream_info.h>
+#include <packager/media/base/buffer_pool.h>
 #include <packager/media/base/buffer_reader.h>
 #include <packager/media/base/decrypt_config.h>
 #include <packager/media/base/key_source.h>
@@ -308,7 +309,21 @@ bool MP4MediaParser::Parse(const uint8_t* buf, int size) {
     return false;
 
   queue_.Push(buf, size);
+  return ParseQueuedData();
+}
+
+bool MP4MediaParser::ParseShared(std::shared_ptr<const uint8_t> buf,
+                                 int size) {
+  DCHECK_NE(state_, kWaitingForInit);
+
+  if (state_ == kError)
+    return false;
 
+  queue_.PushShared(std::move(buf), size);
+  return ParseQueuedData();
+}
+
+bool MP4MediaParser::ParseQueuedData() {
   bool result, err = false;
 
   do {
@@ -1017,8 +1032,8 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
       MediaSample::CopyFrom(media_data, kDummyDataSize, runs_->is_keyframe()));
 
   if (runs_->is_encrypted()) {
-    std::shared_ptr<uint8_t> decrypted_media_data(
-        new uint8_t[media_data_size], std::default_delete<uint8_t[]>());
+    std::shared_ptr<uint8_t> decrypted_media_data =
+        BufferPool::GetInstance()->AllocateShared(media_data_size);
     std::unique_ptr<DecryptConfig> decrypt_config = runs_->GetDecryptConfig();
     if (!decrypt_config) {
       *err = true;
@@ -1027,7 +1042,8 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
     }
 
     if (!decryptor_source_) {
-      stream_sample->SetData(media_data, media_data_size);
+      SetSampleData(sample_offset, media_data, media_data_size,
+                    stream_sample.get());
       // If the demuxer does not have the decryptor_source_, store
       // decrypt_config so that the demuxed sample can be decrypted later.
       stream_sample->set_decrypt_config(std::move(decrypt_config));
@@ -1044,7 +1060,8 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
                                   media_data_size);
     }
   } else {
-    stream_sample->SetData(media_data, media_data_size);
+    SetSampleData(sample_offset, media_data, media_data_size,
+                  stream_sample.get());
   }
 
   stream_sample->set_dts(runs_->dts());
@@ -1066,6 +1083,21 @@ bool MP4MediaParser::EnqueueSample(bool* err) {
   return true;
 }
 
+void MP4MediaParser::SetSampleData(int64_t sample_offset,
+                                   const uint8_t* media_data,
+                                   size_t media_data_size,
+                                   MediaSample* sample) {
+  // Reference the sample data directly if it is in a shared input buffer.
+  std::shared_ptr<const uint8_t> shared_data =
+      queue_.GetSharedAt(sample_offset);
+  if (shared_data) {
+    DCHECK_EQ(shared_data.get(), media_data);
+    sample->TransferData(std::move(shared_data), media_data_size);
+  } else {
+    sample->SetData(media_data, media_data_size);
+  }
+}
+
 bool MP4MediaParser::ReadAndDiscardMDATsUntil(const int64_t offset) {
   bool err = false;
   while (mdat_tail_ < offset) {
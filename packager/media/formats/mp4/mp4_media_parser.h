@@ -44,6 +44,8 @@ class MP4MediaParser : public MediaParser {
             KeySource* decryption_key_source) override;
   [[nodiscard]] bool Flush() override;
   [[nodiscard]] bool Parse(const uint8_t* buf, int size) override;
+  [[nodiscard]] bool ParseShared(std::shared_ptr<const uint8_t> buf,
+                                 int size) override;
   /// @}
 
   /// Handles ISO-BMFF containers which have the 'moov' box trailing the
@@ -57,6 +59,8 @@ class MP4MediaParser : public MediaParser {
  private:
   enum State { kWaitingForInit, kParsingBoxes, kEmittingSamples, kError };
 
+  // Parses the data in |queue_| as far as possible.
+  bool ParseQueuedData();
   bool ParseBox(bool* err);
   bool ParseMoov(mp4::BoxReader* reader);
   bool ParseMoof(mp4::BoxReader* reader);
@@ -64,6 +68,13 @@ class MP4MediaParser : public MediaParser {
   bool FetchKeysIfNecessary(
       const std::vector<ProtectionSystemSpecificHeader>& headers);
 
+  // Sets the data of |sample|, at |sample_offset| in the input, without copying
+  // if possible.
+  void SetSampleData(int64_t sample_offset,
+                     const uint8_t* media_data,
+                     size_t media_data_size,
+                     MediaSample* sample);
+
   // To retain proper framing, each 'mdat' box must be read; to limit memory
   // usage, the box's data needs to be discarded incrementally as frames are
   // extracted from the stream. This function discards data from the stream up
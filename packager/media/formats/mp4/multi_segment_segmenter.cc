@@ -83,6 +83,7 @@ Status MultiSegmentSegmenter::WriteInitSegment() {
     return Status(error::FILE_FAILURE,
                   "Cannot open file for write " + options().output_file_name);
   }
+  SetOutputInfo(options(), OutputInfo(), file.get());
   std::unique_ptr<BufferWriter> buffer(new BufferWriter);
   ftyp()->Write(buffer.get());
   moov()->Write(buffer.get());
@@ -141,6 +142,20 @@ Status MultiSegmentSegmenter::WriteSegment(int64_t segment_number) {
   }
   RETURN_IF_ERROR(fragment_buffer()->WriteToFile(file.get()));
 
+  int64_t segment_duration = 0;
+  // ISO/IEC 23009-1:2012: the value shall be identical to sum of the the
+  // values of all Subsegment_duration fields in the first ‘sidx’ box.
+  for (size_t i = 0; i < sidx()->references.size(); ++i)
+    segment_duration += sidx()->references[i].subsegment_duration;
+
+  OutputInfo output_info;
+  output_info.is_segment = true;
+  output_info.segment_number = segment_number;
+  output_info.start_time = sidx()->earliest_presentation_time;
+  output_info.duration = segment_duration;
+  output_info.timescale = sidx()->timescale;
+  SetOutputInfo(options(), output_info, file.get());
+
   // Close the file, which also does flushing, to make sure the file is written
   // before manifest is updated.
   if (!file.release()->Close()) {
@@ -150,12 +165,6 @@ Status MultiSegmentSegmenter::WriteSegment(int64_t segment_number) {
             ", possibly file permission issue or running out of disk space.");
   }
 
-  int64_t segment_duration = 0;
-  // ISO/IEC 23009-1:2012: the value shall be identical to sum of the the
-  // values of all Subsegment_duration fields in the first ‘sidx’ box.
-  for (size_t i = 0; i < sidx()->references.size(); ++i)
-    segment_duration += sidx()->references[i].subsegment_duration;
-
   UpdateProgress(segment_duration);
   if (muxer_listener()) {
     muxer_listener()->OnSampleDurationReady(sample_duration());
@@ -223,7 +223,9 @@ Status Segmenter::FinalizeSegment(size_t stream_id,
           {key_frame_info.timestamp, moof_start_offset,
            fragment_buffer_->Size() - moof_start_offset + key_frame_info.size});
     }
-    fragment_buffer_->AppendBuffer(*fragmenter->data());
+    // The fragment data is not needed once the fragment is finalized, so it
+    // is moved rather than copied.
+    fragment_buffer_->AppendBufferWithoutCopy(fragmenter->data());
   }
 
   // Increase sequence_number for next fragment.
@@ -86,19 +86,28 @@ Status PackedAudioWriter::FinalizeSegment(size_t stream_id,
   // Save |segment_size| as it will be cleared after writing.
   const size_t segment_size = segmenter_->segment_buffer()->Size();
 
-  RETURN_IF_ERROR(WriteSegment(segment_path, segmenter_->segment_buffer()));
+  OutputInfo output_info;
+  output_info.is_segment = true;
+  output_info.segment_number = segment_info.segment_number;
+  output_info.start_time =
+      segment_timestamp + transport_stream_timestamp_offset_;
+  output_info.duration = segment_info.duration * segmenter_->TimescaleScale();
+  output_info.timescale = static_cast<int32_t>(kPackedAudioTimescale);
+
+  RETURN_IF_ERROR(
+      WriteSegment(segment_path, output_info, segmenter_->segment_buffer()));
   total_duration_ += segment_info.duration;
 
   if (muxer_listener()) {
-    muxer_listener()->OnNewSegment(
-        segment_path, segment_timestamp + transport_stream_timestamp_offset_,
-        segment_info.duration * segmenter_->TimescaleScale(), segment_size,
-        segment_info.segment_number);
+    muxer_listener()->OnNewSegment(segment_path, output_info.start_time,
+                                   output_info.duration, segment_size,
+                                   segment_info.segment_number);
   }
   return Status::OK;
 }
 
 Status PackedAudioWriter::WriteSegment(const std::string& segment_path,
+                                       const OutputInfo& output_info,
                                        BufferWriter* segment_buffer) {
   std::unique_ptr<File, FileCloser> file;
   if (output_file_) {
@@ -115,6 +124,7 @@ Status PackedAudioWriter::WriteSegment(const std::string& segment_path,
       return Status(error::FILE_FAILURE,
                     "Cannot open file for write " + segment_path);
     }
+    SetOutputInfo(options(), output_info, file.get());
   }
 
   RETURN_IF_ERROR(segment_buffer->WriteToFile(output_file_ ? output_file_.get()
@@ -9,6 +9,7 @@
 
 #include <cstdint>
 
+#include <packager/buffer_callback_params.h>
 #include <packager/file/file_closer.h>
 #include <packager/media/base/muxer.h>
 
@@ -41,6 +42,7 @@ class PackedAudioWriter : public Muxer {
   Status FinalizeSegment(size_t stream_id, const SegmentInfo& sample) override;
 
   Status WriteSegment(const std::string& segment_path,
+                      const OutputInfo& output_info,
                       BufferWriter* segment_buffer);
 
   Status CloseFile(std::unique_ptr<File, FileCloser> file);
@@ -8,6 +8,7 @@
 
 #include <absl/log/check.h>
 
+#include <packager/media/base/buffer_pool.h>
 #include <packager/media/base/buffer_writer.h>
 #include <packager/media/base/media_sample.h>
 #include <packager/media/formats/webm/webm_constants.h>
@@ -104,8 +105,8 @@ void UpdateFrameForEncryption(MediaSample* sample) {
   WriteEncryptedFrameHeader(sample->decrypt_config(), &header_buffer);
 
   const size_t sample_size = header_buffer.Size() + sample->data_size();
-  std::shared_ptr<uint8_t> new_sample_data(new uint8_t[sample_size],
-                                           std::default_delete<uint8_t[]>());
+  std::shared_ptr<uint8_t> new_sample_data =
+      BufferPool::GetInstance()->AllocateShared(sample_size);
   memcpy(new_sample_data.get(), header_buffer.Buffer(), header_buffer.Size());
   memcpy(&new_sample_data.get()[header_buffer.Size()], sample->data(),
          sample->data_size());
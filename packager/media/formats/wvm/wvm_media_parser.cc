@@ -820,13 +820,11 @@ bool WvmMediaParser::Output(bool output_encrypted_sample) {
   } else {
     if ((prev_pes_stream_id_ & kPesStreamIdVideoMask) == kPesStreamIdVideo) {
       // Convert video stream to unit stream and get config.
-      std::vector<uint8_t> nal_unit_stream;
       if (!byte_to_unit_stream_converter_.ConvertByteStreamToNalUnitStream(
-              sample_data_.data(), sample_data_.size(), &nal_unit_stream)) {
+              sample_data_.data(), sample_data_.size(), media_sample_.get())) {
         LOG(ERROR) << "Could not convert h.264 byte stream sample";
         return false;
       }
-      media_sample_->SetData(nal_unit_stream.data(), nal_unit_stream.size());
       if (!is_initialized_) {
         // Set extra data for video stream from AVC Decoder Config Record.
         // Also, set codec string from the AVC Decoder Config Record.
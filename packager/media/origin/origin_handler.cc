@@ -18,5 +18,10 @@ Status OriginHandler::Process(std::unique_ptr<StreamData> /* ignored */) {
                 "An origin handlers should never be a downstream handler.");
 }
 
+OriginHandler::StepResult OriginHandler::RunStep(Status* status) {
+  *status = Run();
+  return StepResult::kDone;
+}
+
 }  // namespace media
 }  // namespace shaka
@@ -7,6 +7,8 @@
 #ifndef PACKAGER_MEDIA_ORIGIN_ORIGIN_HANDLER_H_
 #define PACKAGER_MEDIA_ORIGIN_ORIGIN_HANDLER_H_
 
+#include <absl/time/time.h>
+
 #include <packager/media/base/media_handler.h>
 
 namespace shaka {
@@ -19,6 +21,15 @@ class OriginHandler : public MediaHandler {
  public:
   OriginHandler() = default;
 
+  enum class StepResult {
+    // Some work was done and more is left.
+    kContinue,
+    // No work can be done until more input arrives.
+    kWaitForInput,
+    // The handler finished, successfully or not.
+    kDone,
+  };
+
   // Process all data and send messages down stream. This is the main
   // method of the handler. Since origin handlers do not take input via
   // |Process|, run will take input from an alternative source. This call
@@ -31,6 +42,22 @@ class OriginHandler : public MediaHandler {
   // as soon is convenient.
   virtual void Cancel() = 0;
 
+  // Cooperative alternative to |Run|, so that many origin handlers can take
+  // turns on a few threads: do a bounded amount of work, without waiting for
+  // input, and return. When this returns kDone, |status| is set to what |Run|
+  // would have returned. The default implementation calls |Run|.
+  // Use either Run() or RunStep(), not both.
+  virtual StepResult RunStep(Status* status);
+
+  // Returns a file descriptor which polls readable when input may have
+  // arrived after |RunStep| returned kWaitForInput, or -1 if the handler
+  // should simply be stepped again later.
+  virtual int GetInputReadinessFd() { return -1; }
+
+  // Returns how long |RunStep| may keep returning kWaitForInput before the
+  // handler fails, i.e. when it should be stepped again even without input.
+  virtual absl::Duration GetInputTimeout() { return absl::InfiniteDuration(); }
+
  private:
   OriginHandler(const OriginHandler&) = delete;
   OriginHandler& operator=(const OriginHandler&) = delete;
@@ -29,6 +29,23 @@ Status Replicator::Process(std::unique_ptr<StreamData> stream_data) {
   return status;
 }
 
+Status Replicator::ProcessBatch(
+    absl::Span<std::unique_ptr<StreamData>> batch) {
+  Status status;
+
+  std::vector<std::unique_ptr<StreamData>> copies(batch.size());
+  for (auto& out : output_handlers()) {
+    for (size_t i = 0; i < batch.size(); ++i) {
+      copies[i].reset(new StreamData(*batch[i]));
+      copies[i]->stream_index = out.first;
+    }
+
+    status.Update(DispatchBatch(absl::MakeSpan(copies)));
+  }
+
+  return status;
+}
+
 bool Replicator::ValidateOutputStreamIndex(size_t /* ignored */) const {
   return true;
 }
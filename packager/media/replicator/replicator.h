@@ -20,6 +20,7 @@ class Replicator : public MediaHandler {
  private:
   Status InitializeInternal() override;
   Status Process(std::unique_ptr<StreamData> stream_data) override;
+  Status ProcessBatch(absl::Span<std::unique_ptr<StreamData>> batch) override;
   bool ValidateOutputStreamIndex(size_t stream_index) const override;
   Status OnFlushRequest(size_t input_stream_index) override;
 };
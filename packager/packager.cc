@@ -8,6 +8,7 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <optional>
 
 #include <absl/log/check.h>
@@ -16,15 +17,23 @@
 #include <absl/strings/str_format.h>
 
 #include <packager/app/job_manager.h>
+#include <packager/app/job_pool.h>
+#include <packager/app/key_source_cache.h>
 #include <packager/app/muxer_factory.h>
 #include <packager/app/packager_util.h>
 #include <packager/app/single_thread_job_manager.h>
+#include <packager/app/stats_dumper.h>
+#include <packager/app/work_stealing_job_manager.h>
 #include <packager/file.h>
+#include <packager/file/http_origin.h>
 #include <packager/hls/base/hls_notifier.h>
 #include <packager/hls/base/simple_hls_notifier.h>
 #include <packager/macros/logging.h>
 #include <packager/macros/status.h>
+#include <packager/media/async_queue/async_queue_handler.h>
+#include <packager/media/base/buffer_pool.h>
 #include <packager/media/base/cc_stream_filter.h>
+#include <packager/media/base/handler_metrics.h>
 #include <packager/media/base/language_utils.h>
 #include <packager/media/base/muxer.h>
 #include <packager/media/base/muxer_util.h>
@@ -34,6 +43,7 @@
 #include <packager/media/chunking/text_chunker.h>
 #include <packager/media/crypto/encryption_handler.h>
 #include <packager/media/demuxer/demuxer.h>
+#include <packager/media/event/instrumented_muxer_listener.h>
 #include <packager/media/event/muxer_listener_factory.h>
 #include <packager/media/event/vod_media_info_dump_muxer_listener.h>
 #include <packager/media/formats/ttml/ttml_to_mp4_handler.h>
@@ -43,6 +53,7 @@
 #include <packager/media/trick_play/trick_play_handler.h>
 #include <packager/mpd/base/media_info.pb.h>
 #include <packager/mpd/base/simple_mpd_notifier.h>
+#include <packager/utils/memory_budget.h>
 #include <packager/version/version.h>
 
 namespace shaka {
@@ -54,6 +65,7 @@ using media::KeySource;
 using media::MuxerOptions;
 using media::SingleThreadJobManager;
 using media::SyncPointQueue;
+using media::WorkStealingJobManager;
 
 namespace media {
 namespace {
@@ -460,6 +472,8 @@ Status CreateDemuxer(const StreamDescriptor& stream,
   std::shared_ptr<Demuxer> demuxer = std::make_shared<Demuxer>(stream.input);
   demuxer->set_dump_stream_info(packaging_params.test_params.dump_stream_info);
   demuxer->set_input_format(stream.input_format);
+  demuxer->set_memory_overflow_action(
+      packaging_params.memory_params.overflow_action);
 
   if (packaging_params.decryption_params.key_provider != KeyProvider::kNone) {
     std::unique_ptr<KeySource> decryption_key_source(
@@ -593,6 +607,15 @@ Status CreateTtmlJobs(
   return Status::OK;
 }
 
+// Collect the statistics of |handler|, if any, as |type|[|label|].
+void InstrumentHandler(PipelineMetrics* metrics,
+                       const std::string& type,
+                       const std::string& label,
+                       MediaHandler* handler) {
+  if (handler)
+    handler->set_metrics(metrics->Create(type + "[" + label + "]"));
+}
+
 Status CreateAudioVideoJobs(
     const std::vector<std::reference_wrapper<const StreamDescriptor>>& streams,
     const PackagingParams& packaging_params,
@@ -600,9 +623,13 @@ Status CreateAudioVideoJobs(
     SyncPointQueue* sync_points,
     MuxerListenerFactory* muxer_listener_factory,
     MuxerFactory* muxer_factory,
+    PipelineMetrics* metrics,
+    std::shared_ptr<MemoryBudget> memory_budget,
     JobManager* job_manager) {
   DCHECK(muxer_listener_factory);
   DCHECK(muxer_factory);
+  DCHECK(metrics);
+  DCHECK(memory_budget);
   DCHECK(job_manager);
   // Store all the demuxers in a map so that we can look up a stream's demuxer.
   // This is step one in making this part of the pipeline less dependant on
@@ -624,6 +651,14 @@ Status CreateAudioVideoJobs(
         sync_points ? std::make_shared<CueAlignmentHandler>(sync_points)
                     : nullptr;
     segment_coordinators[stream.input] = std::make_shared<SegmentCoordinator>();
+
+    sources[stream.input]->set_memory_budget(memory_budget);
+    InstrumentHandler(metrics, "Demuxer", stream.input,
+                      sources[stream.input].get());
+    InstrumentHandler(metrics, "CueAlignmentHandler", stream.input,
+                      cue_aligners[stream.input].get());
+    InstrumentHandler(metrics, "SegmentCoordinator", stream.input,
+                      segment_coordinators[stream.input].get());
   }
 
   for (auto& source : sources) {
@@ -655,6 +690,12 @@ Status CreateAudioVideoJobs(
     previous_input = stream.input;
     previous_selector = stream.stream_selector;
 
+    const std::string stream_label =
+        stream.input + ":" + stream.stream_selector;
+    const std::string output_label = stream.segment_template.empty()
+                                         ? stream.output
+                                         : stream.segment_template;
+
     // If the stream has no output, then there is no reason setting-up the rest
     // of the pipeline.
     if (stream.output.empty() && stream.segment_template.empty()) {
@@ -678,6 +719,8 @@ Status CreateAudioVideoJobs(
       if (is_text && stream.cc_index < 0) {
         handlers.emplace_back(std::make_shared<TextPadder>(
             packaging_params.default_text_zero_bias_ms));
+        InstrumentHandler(metrics, "TextPadder", stream_label,
+                          handlers.back().get());
       }
       if (sync_points) {
         handlers.emplace_back(cue_aligner);
@@ -694,9 +737,13 @@ Status CreateAudioVideoJobs(
         // SegmentInfo from ChunkingHandler will reach the coordinator
         handlers.emplace_back(std::make_shared<ChunkingHandler>(
             packaging_params.chunking_params));
+        InstrumentHandler(metrics, "ChunkingHandler", stream_label,
+                          handlers.back().get());
         handlers.emplace_back(segment_coordinator);
         handlers.emplace_back(CreateEncryptionHandler(packaging_params, stream,
                                                       encryption_key_source));
+        InstrumentHandler(metrics, "EncryptionHandler", stream_label,
+                          handlers.back().get());
       } else {
         // For text: SegmentCoordinator before TextChunker
         // So it can forward SegmentInfo from video/audio to TextChunker
@@ -704,6 +751,7 @@ Status CreateAudioVideoJobs(
       }
 
       replicator = std::make_shared<Replicator>();
+      InstrumentHandler(metrics, "Replicator", stream_label, replicator.get());
       handlers.emplace_back(replicator);
 
       RETURN_IF_ERROR(MediaHandler::Chain(handlers));
@@ -720,22 +768,47 @@ Status CreateAudioVideoJobs(
                                                  stream.stream_selector);
     }
 
+    muxer->set_memory_budget(memory_budget);
+    InstrumentHandler(metrics, "Muxer", output_label, muxer.get());
+
     std::unique_ptr<MuxerListener> muxer_listener =
         muxer_listener_factory->CreateListener(ToMuxerListenerData(stream));
+    if (muxer_listener) {
+      muxer_listener.reset(new InstrumentedMuxerListener(
+          std::move(muxer_listener),
+          metrics->Create("MuxerListener[" + output_label + "]")));
+    }
     muxer->SetMuxerListener(std::move(muxer_listener));
 
     std::vector<std::shared_ptr<MediaHandler>> handlers;
     handlers.emplace_back(replicator);
 
+    // Run the output on a thread of its own, so that outputs sharing an input
+    // are muxed and written in parallel.
+    if (packaging_params.output_queue_size > 0 &&
+        !packaging_params.single_threaded) {
+      auto async_queue = std::make_shared<AsyncQueueHandler>(
+          packaging_params.output_queue_size);
+      async_queue->set_memory_budget(memory_budget);
+      InstrumentHandler(metrics, "AsyncQueueHandler", output_label,
+                        async_queue.get());
+      job_manager->AddAsyncQueue(async_queue);
+      handlers.emplace_back(std::move(async_queue));
+    }
+
     // Trick play is optional.
     if (stream.trick_play_factor) {
       handlers.emplace_back(
           std::make_shared<TrickPlayHandler>(stream.trick_play_factor));
+      InstrumentHandler(metrics, "TrickPlayHandler", output_label,
+                        handlers.back().get());
     }
 
     if (stream.cc_index >= 0) {
       handlers.emplace_back(
           std::make_shared<CcStreamFilter>(stream.language, stream.cc_index));
+      InstrumentHandler(metrics, "CcStreamFilter", output_label,
+                        handlers.back().get());
     }
 
     if (is_text &&
@@ -744,14 +817,20 @@ Status CreateAudioVideoJobs(
       bool use_coordinator = is_teletext;
       handlers.emplace_back(
           CreateTextChunker(packaging_params.chunking_params, use_coordinator));
+      InstrumentHandler(metrics, "TextChunker", output_label,
+                        handlers.back().get());
     }
 
     if (is_text && output_format == CONTAINER_MOV) {
       const auto output_codec = GetTextOutputCodec(stream);
       if (output_codec == CONTAINER_WEBVTT) {
         handlers.emplace_back(std::make_shared<WebVttToMp4Handler>());
+        InstrumentHandler(metrics, "WebVttToMp4Handler", output_label,
+                          handlers.back().get());
       } else if (output_codec == CONTAINER_TTML) {
         handlers.emplace_back(std::make_shared<ttml::TtmlToMp4Handler>());
+        InstrumentHandler(metrics, "TtmlToMp4Handler", output_label,
+                          handlers.back().get());
       }
     }
 
@@ -769,6 +848,8 @@ Status CreateAllJobs(const std::vector<StreamDescriptor>& stream_descriptors,
                      SyncPointQueue* sync_points,
                      MuxerListenerFactory* muxer_listener_factory,
                      MuxerFactory* muxer_factory,
+                     PipelineMetrics* metrics,
+                     std::shared_ptr<MemoryBudget> memory_budget,
                      JobManager* job_manager) {
   DCHECK(muxer_factory);
   DCHECK(muxer_listener_factory);
@@ -829,24 +910,104 @@ Status CreateAllJobs(const std::vector<StreamDescriptor>& stream_descriptors,
                                  muxer_factory, mpd_notifier, job_manager));
   RETURN_IF_ERROR(CreateAudioVideoJobs(
       audio_video_streams, packaging_params, encryption_key_source, sync_points,
-      muxer_listener_factory, muxer_factory, job_manager));
+      muxer_listener_factory, muxer_factory, metrics, std::move(memory_budget),
+      job_manager));
 
   // Initialize processing graph.
   return job_manager->InitializeJobs();
 }
 
+// Returns the segment templates of the outputs served by the HTTP origin,
+// without the origin:// prefix.
+std::vector<std::string> GetHttpOriginSegmentTemplates(
+    const std::vector<StreamDescriptor>& stream_descriptors) {
+  std::vector<std::string> segment_templates;
+  for (const StreamDescriptor& descriptor : stream_descriptors) {
+    if (absl::StartsWith(descriptor.segment_template, kOriginFilePrefix)) {
+      segment_templates.push_back(
+          descriptor.segment_template.substr(strlen(kOriginFilePrefix)));
+    }
+  }
+  return segment_templates;
+}
+
+// Segments must stay available while they are referenced by a live manifest,
+// i.e. for the time shift buffer depth after they are published, plus the
+// segments preserved outside of the live window.  Returns zero, i.e. no
+// eviction, if there is no live window.
+absl::Duration GetHttpOriginRetention(const PackagingParams& packaging_params) {
+  const double segment_duration =
+      packaging_params.chunking_params.segment_duration_in_seconds;
+  auto get_retention = [segment_duration](double time_shift_buffer_depth,
+                                          size_t preserved_segments) {
+    if (time_shift_buffer_depth <= 0)
+      return absl::InfiniteDuration();
+    return absl::Seconds(time_shift_buffer_depth +
+                         (preserved_segments + 1) * segment_duration);
+  };
+
+  absl::Duration retention = absl::ZeroDuration();
+  const MpdParams& mpd_params = packaging_params.mpd_params;
+  if (!mpd_params.mpd_output.empty()) {
+    retention = std::max(
+        retention,
+        get_retention(mpd_params.time_shift_buffer_depth,
+                      mpd_params.preserved_segments_outside_live_window));
+  }
+  const HlsParams& hls_params = packaging_params.hls_params;
+  if (!hls_params.master_playlist_output.empty()) {
+    retention = std::max(
+        retention,
+        get_retention(hls_params.time_shift_buffer_depth,
+                      hls_params.preserved_segments_outside_live_window));
+  }
+  return retention == absl::InfiniteDuration() ? absl::ZeroDuration()
+                                               : retention;
+}
+
 }  // namespace
 }  // namespace media
 
 struct Packager::PackagerInternal {
+  ~PackagerInternal();
+
+  // Flush the manifests once the jobs are done.
+  Status FlushNotifiers();
+
   std::shared_ptr<media::FakeClock> fake_clock;
-  std::unique_ptr<KeySource> encryption_key_source;
+  std::shared_ptr<KeySource> encryption_key_source;
   std::unique_ptr<MpdNotifier> mpd_notifier;
   std::unique_ptr<hls::HlsNotifier> hls_notifier;
   BufferCallbackParams buffer_callback_params;
   std::unique_ptr<media::JobManager> job_manager;
+  // Set if |job_manager| runs the jobs on a job pool.
+  media::WorkStealingJobManager* pooled_job_manager = nullptr;
+  // Memory used by the pipeline, within the budget of its PackagerHost if any.
+  std::shared_ptr<MemoryBudget> memory_budget;
+  media::PipelineMetrics metrics;
+  // Declared after |metrics|, which it reads from.
+  std::unique_ptr<media::StatsDumper> stats_dumper;
+  // Set if the HTTP origin evicts the segments of this channel.
+  std::optional<int> origin_retention_id;
 };
 
+Packager::PackagerInternal::~PackagerInternal() {
+  if (origin_retention_id)
+    HttpOrigin::GetInstance()->RemoveRetention(*origin_retention_id);
+}
+
+Status Packager::PackagerInternal::FlushNotifiers() {
+  if (hls_notifier) {
+    if (!hls_notifier->Flush())
+      return Status(error::INVALID_ARGUMENT, "Failed to flush Hls.");
+  }
+  if (mpd_notifier) {
+    if (!mpd_notifier->Flush())
+      return Status(error::INVALID_ARGUMENT, "Failed to flush Mpd.");
+  }
+  return Status::OK;
+}
+
 Packager::Packager() {}
 
 Packager::~Packager() {}
@@ -854,6 +1015,21 @@ Packager::~Packager() {}
 Status Packager::Initialize(
     const PackagingParams& packaging_params,
     const std::vector<StreamDescriptor>& stream_descriptors) {
+  std::shared_ptr<media::JobPool> job_pool;
+  if (packaging_params.job_pool_size > 0) {
+    job_pool =
+        std::make_shared<media::JobPool>(packaging_params.job_pool_size);
+  }
+  return Initialize(packaging_params, stream_descriptors, std::move(job_pool),
+                    nullptr, MemoryBudget::GetGlobal());
+}
+
+Status Packager::Initialize(
+    const PackagingParams& packaging_params,
+    const std::vector<StreamDescriptor>& stream_descriptors,
+    std::shared_ptr<media::JobPool> job_pool,
+    media::KeySourceCache* key_sources,
+    std::shared_ptr<MemoryBudget> parent_memory_budget) {
   if (internal_)
     return Status(error::INVALID_ARGUMENT, "Already initialized.");
 
@@ -865,13 +1041,22 @@ Status Packager::Initialize(
   }
 
   std::unique_ptr<PackagerInternal> internal(new PackagerInternal);
+  internal->memory_budget = std::make_shared<MemoryBudget>(
+      "packager", packaging_params.memory_params.max_memory_bytes,
+      std::move(parent_memory_budget));
+  internal->metrics.set_memory_budget(internal->memory_budget);
 
   // Create encryption key source if needed.
   if (packaging_params.encryption_params.key_provider != KeyProvider::kNone) {
-    internal->encryption_key_source = CreateEncryptionKeySource(
-        static_cast<media::FourCC>(
-            packaging_params.encryption_params.protection_scheme),
-        packaging_params.encryption_params);
+    const media::FourCC protection_scheme = static_cast<media::FourCC>(
+        packaging_params.encryption_params.protection_scheme);
+    if (key_sources) {
+      internal->encryption_key_source = key_sources->GetEncryptionKeySource(
+          protection_scheme, packaging_params.encryption_params);
+    } else {
+      internal->encryption_key_source = CreateEncryptionKeySource(
+          protection_scheme, packaging_params.encryption_params);
+    }
     if (!internal->encryption_key_source)
       return Status(error::INVALID_ARGUMENT, "Failed to create key source.");
   }
@@ -889,7 +1074,10 @@ Status Packager::Initialize(
 
   // Store callback params to make it available during packaging.
   internal->buffer_callback_params = packaging_params.buffer_callback_params;
-  if (internal->buffer_callback_params.write_func) {
+  const bool has_write_callback =
+      internal->buffer_callback_params.write_func ||
+      internal->buffer_callback_params.output_func;
+  if (has_write_callback) {
     mpd_params.mpd_output = File::MakeCallbackFileName(
         internal->buffer_callback_params, mpd_params.mpd_output);
     hls_params.master_playlist_output = File::MakeCallbackFileName(
@@ -910,6 +1098,18 @@ Status Packager::Initialize(
   hls_params.is_independent_segments =
       packaging_params.chunking_params.segment_sap_aligned;
 
+  // Each channel evicts its own segments from the HTTP origin, once they have
+  // left its live window.
+  const std::vector<std::string> origin_segment_templates =
+      media::GetHttpOriginSegmentTemplates(stream_descriptors);
+  const absl::Duration origin_retention =
+      media::GetHttpOriginRetention(packaging_params);
+  if (!origin_segment_templates.empty() &&
+      origin_retention > absl::ZeroDuration()) {
+    internal->origin_retention_id = HttpOrigin::GetInstance()->AddRetention(
+        origin_segment_templates, origin_retention);
+  }
+
   for (const auto& caption : packaging_params.closed_captions) {
     CeaCaption dash_caption = caption;
     dash_caption.language = LanguageToISO_639_2(caption.language);
@@ -945,7 +1145,15 @@ Status Packager::Initialize(
   if (packaging_params.single_threaded) {
     internal->job_manager.reset(
         new SingleThreadJobManager(std::move(sync_points)));
+  } else if (job_pool && !sync_points) {
+    internal->pooled_job_manager =
+        new WorkStealingJobManager(std::move(sync_points), std::move(job_pool));
+    internal->job_manager.reset(internal->pooled_job_manager);
   } else {
+    // Cue alignment makes inputs wait for each other, which requires a thread
+    // per input.
+    LOG_IF(WARNING, job_pool != nullptr)
+        << "The job pool is not used with ad cues.";
     internal->job_manager.reset(new JobManager(std::move(sync_points)));
   }
 
@@ -960,7 +1168,7 @@ Status Packager::Initialize(
                                               descriptor.input);
     }
 
-    if (internal->buffer_callback_params.write_func) {
+    if (has_write_callback) {
       copy.output = File::MakeCallbackFileName(internal->buffer_callback_params,
                                                descriptor.output);
       copy.segment_template = File::MakeCallbackFileName(
@@ -995,7 +1203,13 @@ Status Packager::Initialize(
       streams_for_jobs, packaging_params, internal->mpd_notifier.get(),
       internal->encryption_key_source.get(),
       internal->job_manager->sync_points(), &muxer_listener_factory,
-      &muxer_factory, internal->job_manager.get()));
+      &muxer_factory, &internal->metrics, internal->memory_budget,
+      internal->job_manager.get()));
+
+  if (!packaging_params.stats_params.stats_output.empty()) {
+    internal->stats_dumper.reset(new media::StatsDumper(
+        packaging_params.stats_params, &internal->metrics));
+  }
 
   internal_ = std::move(internal);
   return Status::OK;
@@ -1005,17 +1219,38 @@ Status Packager::Run() {
   if (!internal_)
     return Status(error::INVALID_ARGUMENT, "Not yet initialized.");
 
-  RETURN_IF_ERROR(internal_->job_manager->RunJobs());
+  const Status status = internal_->job_manager->RunJobs();
+  if (internal_->stats_dumper)
+    internal_->stats_dumper->Stop();
+  RETURN_IF_ERROR(status);
+
+  const media::BufferPool::Stats pool_stats =
+      media::BufferPool::GetInstance()->GetStats();
+  VLOG(1) << "Sample buffers: " << pool_stats.num_allocations
+          << " allocations, " << pool_stats.num_reused << " reused, peak "
+          << pool_stats.peak_bytes_in_use << " bytes in use.";
+  return internal_->FlushNotifiers();
+}
 
-  if (internal_->hls_notifier) {
-    if (!internal_->hls_notifier->Flush())
-      return Status(error::INVALID_ARGUMENT, "Failed to flush Hls.");
-  }
-  if (internal_->mpd_notifier) {
-    if (!internal_->mpd_notifier->Flush())
-      return Status(error::INVALID_ARGUMENT, "Failed to flush Mpd.");
-  }
-  return Status::OK;
+bool Packager::Start(std::function<void(const Status&)> on_complete) {
+  DCHECK(internal_);
+  if (!internal_->pooled_job_manager)
+    return false;
+
+  PackagerInternal* internal = internal_.get();
+  internal->pooled_job_manager->StartJobs(
+      [internal, on_complete](const Status& status) {
+        if (internal->stats_dumper)
+          internal->stats_dumper->Stop();
+        on_complete(status.ok() ? internal->FlushNotifiers() : status);
+      });
+  return true;
+}
+
+PackagerStats Packager::GetStats() const {
+  if (!internal_)
+    return PackagerStats();
+  return internal_->metrics.GetStats();
 }
 
 void Packager::Cancel() {
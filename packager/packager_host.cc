@@ -0,0 +1,206 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/packager_host.h>
+
+#include <algorithm>
+#include <map>
+#include <thread>
+
+#include <absl/log/log.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/synchronization/notification.h>
+
+#include <packager/app/job_pool.h>
+#include <packager/app/key_source_cache.h>
+#include <packager/utils/memory_budget.h>
+
+namespace shaka {
+
+struct PackagerHost::Channel {
+  ~Channel() {
+    if (thread.joinable())
+      thread.join();
+  }
+
+  Packager packager;
+  // Notified once the channel completes, with |status| set.
+  absl::Notification done;
+  Status status;
+  // Only used by channels which cannot run on the job pool.
+  std::thread thread;
+
+  // Guarded by PackagerHostInternal::mutex.
+  bool started = false;
+  bool cancelled = false;
+};
+
+struct PackagerHost::PackagerHostInternal {
+  std::shared_ptr<media::JobPool> job_pool;
+  media::KeySourceCache key_sources;
+  std::shared_ptr<MemoryBudget> memory_budget;
+
+  mutable absl::Mutex mutex;
+  std::map<std::string, std::shared_ptr<Channel>> channels
+      ABSL_GUARDED_BY(mutex);
+};
+
+PackagerHost::PackagerHost() {}
+
+PackagerHost::~PackagerHost() {
+  if (!internal_)
+    return;
+  for (const std::string& channel_id : GetChannelIds())
+    RemoveChannel(channel_id);
+}
+
+Status PackagerHost::Initialize(const PackagerHostParams& params) {
+  if (internal_)
+    return Status(error::INVALID_ARGUMENT, "Already initialized.");
+
+  size_t num_worker_threads = params.num_worker_threads;
+  if (num_worker_threads == 0)
+    num_worker_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::unique_ptr<PackagerHostInternal> internal(new PackagerHostInternal);
+  internal->job_pool = std::make_shared<media::JobPool>(num_worker_threads);
+  internal->memory_budget = std::make_shared<MemoryBudget>(
+      "host", params.max_memory_bytes, MemoryBudget::GetGlobal());
+  internal_ = std::move(internal);
+  return Status::OK;
+}
+
+Status PackagerHost::AddChannel(
+    const std::string& channel_id,
+    const PackagingParams& packaging_params,
+    const std::vector<StreamDescriptor>& stream_descriptors) {
+  if (!internal_)
+    return Status(error::INVALID_ARGUMENT, "Not yet initialized.");
+
+  std::shared_ptr<Channel> channel = std::make_shared<Channel>();
+  {
+    absl::MutexLock lock(internal_->mutex);
+    if (internal_->channels.count(channel_id) > 0) {
+      return Status(error::ALREADY_EXISTS,
+                    "Channel already exists: " + channel_id);
+    }
+    internal_->channels[channel_id] = channel;
+  }
+
+  // Initializing may fetch keys, so it is done without holding the lock.
+  Status status = channel->packager.Initialize(
+      packaging_params, stream_descriptors, internal_->job_pool,
+      &internal_->key_sources, internal_->memory_budget);
+
+  absl::MutexLock lock(internal_->mutex);
+  if (!status.ok() || channel->cancelled) {
+    channel->status =
+        status.ok() ? Status(error::CANCELLED, "Channel removed.") : status;
+    channel->done.Notify();
+    internal_->channels.erase(channel_id);
+    return channel->status;
+  }
+
+  Channel* channel_ptr = channel.get();
+  const bool on_job_pool =
+      channel->packager.Start([channel_ptr](const Status& status) {
+        channel_ptr->status = status;
+        channel_ptr->done.Notify();
+      });
+  if (!on_job_pool) {
+    channel->thread = std::thread([channel_ptr]() {
+      channel_ptr->status = channel_ptr->packager.Run();
+      channel_ptr->done.Notify();
+    });
+  }
+  channel->started = true;
+  return Status::OK;
+}
+
+Status PackagerHost::WaitForChannel(const std::string& channel_id) {
+  if (!internal_)
+    return Status(error::INVALID_ARGUMENT, "Not yet initialized.");
+
+  std::shared_ptr<Channel> channel;
+  {
+    absl::MutexLock lock(internal_->mutex);
+    auto iter = internal_->channels.find(channel_id);
+    if (iter == internal_->channels.end())
+      return Status(error::NOT_FOUND, "Channel not found: " + channel_id);
+    channel = iter->second;
+  }
+  return WaitAndRemoveChannel(channel_id, std::move(channel));
+}
+
+Status PackagerHost::RemoveChannel(const std::string& channel_id) {
+  if (!internal_)
+    return Status(error::INVALID_ARGUMENT, "Not yet initialized.");
+
+  std::shared_ptr<Channel> channel;
+  {
+    absl::MutexLock lock(internal_->mutex);
+    auto iter = internal_->channels.find(channel_id);
+    if (iter == internal_->channels.end())
+      return Status(error::NOT_FOUND, "Channel not found: " + channel_id);
+    channel = iter->second;
+    // A channel which is still initializing is not started, see AddChannel.
+    channel->cancelled = true;
+    if (channel->started)
+      channel->packager.Cancel();
+  }
+  return WaitAndRemoveChannel(channel_id, std::move(channel));
+}
+
+Status PackagerHost::WaitAndRemoveChannel(const std::string& channel_id,
+                                          std::shared_ptr<Channel> channel) {
+  channel->done.WaitForNotification();
+  {
+    absl::MutexLock lock(internal_->mutex);
+    auto iter = internal_->channels.find(channel_id);
+    if (iter != internal_->channels.end() && iter->second == channel)
+      internal_->channels.erase(iter);
+  }
+  // The channel is destroyed with its last reference, which releases its
+  // jobs from the pool.
+  return channel->status;
+}
+
+std::vector<std::string> PackagerHost::GetChannelIds() const {
+  std::vector<std::string> channel_ids;
+  if (!internal_)
+    return channel_ids;
+
+  absl::MutexLock lock(internal_->mutex);
+  for (const auto& entry : internal_->channels)
+    channel_ids.push_back(entry.first);
+  return channel_ids;
+}
+
+Status PackagerHost::GetChannelStats(const std::string& channel_id,
+                                     PackagerStats* stats) const {
+  if (!internal_)
+    return Status(error::INVALID_ARGUMENT, "Not yet initialized.");
+
+  std::shared_ptr<Channel> channel;
+  {
+    absl::MutexLock lock(internal_->mutex);
+    auto iter = internal_->channels.find(channel_id);
+    // The packager is initialized without the lock, see AddChannel.
+    if (iter == internal_->channels.end() || !iter->second->started)
+      return Status(error::NOT_FOUND, "Channel not found: " + channel_id);
+    channel = iter->second;
+  }
+  *stats = channel->packager.GetStats();
+  return Status::OK;
+}
+
+MemoryStats PackagerHost::GetMemoryStats() const {
+  if (!internal_)
+    return MemoryStats();
+  return internal_->memory_budget->GetStats();
+}
+
+}  // namespace shaka
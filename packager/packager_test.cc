@@ -12,6 +12,7 @@
 #include <absl/log/log.h>
 #include <packager/file.h>
 #include <packager/packager.h>
+#include <packager/packager_host.h>
 
 using testing::_;
 using testing::HasSubstr;
@@ -117,6 +118,102 @@ TEST_F(PackagerTest, Success) {
   ASSERT_EQ(Status::OK, packager.Run());
 }
 
+TEST_F(PackagerTest, SuccessWithJobPool) {
+  PackagingParams packaging_params = SetupPackagingParams();
+  packaging_params.job_pool_size = 2;
+
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(packaging_params, SetupStreamDescriptors()));
+  ASSERT_EQ(Status::OK, packager.Run());
+
+  std::string mpd;
+  ASSERT_TRUE(File::ReadFileToString(GetFullPath(kOutputMpd).c_str(), &mpd));
+  EXPECT_NE(std::string::npos, mpd.find(kOutputVideo));
+  EXPECT_NE(std::string::npos, mpd.find(kOutputAudio));
+}
+
+TEST_F(PackagerTest, CollectsStats) {
+  PackagingParams packaging_params = SetupPackagingParams();
+  packaging_params.stats_params.stats_output = GetFullPath("stats.json");
+
+  Packager packager;
+  EXPECT_TRUE(packager.GetStats().handlers.empty());
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(packaging_params, SetupStreamDescriptors()));
+  ASSERT_EQ(Status::OK, packager.Run());
+
+  const PackagerStats stats = packager.GetStats();
+  auto find_handler = [&stats](const std::string& name) -> const HandlerStats* {
+    for (const HandlerStats& handler : stats.handlers) {
+      if (handler.name == name)
+        return &handler;
+    }
+    return nullptr;
+  };
+  const HandlerStats* demuxer =
+      find_handler(std::string("Demuxer[") + kTestFile + "]");
+  ASSERT_TRUE(demuxer);
+  EXPECT_GT(demuxer->num_samples, 0u);
+  EXPECT_GT(demuxer->num_calls, 0u);
+  const HandlerStats* muxer =
+      find_handler("Muxer[" + GetFullPath(kOutputVideo) + "]");
+  ASSERT_TRUE(muxer);
+  EXPECT_GT(muxer->num_samples, 0u);
+  EXPECT_GT(muxer->num_bytes, 0u);
+  ASSERT_TRUE(find_handler("MuxerListener[" + GetFullPath(kOutputVideo) + "]"));
+
+  std::string stats_json;
+  ASSERT_TRUE(File::ReadFileToString(GetFullPath("stats.json").c_str(),
+                                     &stats_json));
+  EXPECT_NE(std::string::npos, stats_json.find("\"Demuxer["));
+}
+
+TEST_F(PackagerTest, HostRunsChannels) {
+  PackagerHostParams host_params;
+  host_params.num_worker_threads = 2;
+  PackagerHost host;
+  ASSERT_EQ(Status::OK, host.Initialize(host_params));
+
+  const std::vector<std::string> kChannelIds = {"channel_1", "channel_2"};
+  for (const std::string& channel_id : kChannelIds) {
+    PackagingParams packaging_params = SetupPackagingParams();
+    packaging_params.mpd_params.mpd_output =
+        GetFullPath(channel_id + "/" + kOutputMpd);
+    std::vector<StreamDescriptor> stream_descriptors = SetupStreamDescriptors();
+    stream_descriptors[0].output = GetFullPath(channel_id + "/" + kOutputVideo);
+    stream_descriptors[1].output = GetFullPath(channel_id + "/" + kOutputAudio);
+    ASSERT_EQ(Status::OK, host.AddChannel(channel_id, packaging_params,
+                                          stream_descriptors));
+  }
+  EXPECT_EQ(kChannelIds, host.GetChannelIds());
+
+  for (const std::string& channel_id : kChannelIds) {
+    ASSERT_EQ(Status::OK, host.WaitForChannel(channel_id));
+    std::string mpd;
+    ASSERT_TRUE(File::ReadFileToString(
+        GetFullPath(channel_id + "/" + kOutputMpd).c_str(), &mpd));
+    EXPECT_NE(std::string::npos, mpd.find(kOutputVideo));
+  }
+  EXPECT_TRUE(host.GetChannelIds().empty());
+}
+
+TEST_F(PackagerTest, HostRejectsDuplicatedChannels) {
+  PackagerHost host;
+  ASSERT_EQ(Status::OK, host.Initialize(PackagerHostParams()));
+  ASSERT_EQ(Status::OK, host.AddChannel("channel", SetupPackagingParams(),
+                                        SetupStreamDescriptors()));
+  EXPECT_EQ(error::ALREADY_EXISTS,
+            host.AddChannel("channel", SetupPackagingParams(),
+                            SetupStreamDescriptors())
+                .error_code());
+  // The channel may complete before it is cancelled.
+  const Status status = host.RemoveChannel("channel");
+  EXPECT_TRUE(status.ok() || status.error_code() == error::CANCELLED)
+      << status;
+  EXPECT_EQ(error::NOT_FOUND, host.RemoveChannel("channel").error_code());
+}
+
 TEST_F(PackagerTest, MissingStreamDescriptors) {
   std::vector<StreamDescriptor> stream_descriptors;
   Packager packager;
@@ -230,6 +327,51 @@ TEST_F(PackagerTest, WriteOutputToBuffer) {
   ASSERT_EQ(Status::OK, packager.Run());
 }
 
+TEST_F(PackagerTest, WriteWholeSegmentsToBuffer) {
+  auto packaging_params = SetupPackagingParams();
+
+  std::vector<OutputInfo> outputs;
+  packaging_params.buffer_callback_params.output_func =
+      [&outputs](const OutputInfo& info, const void* buffer, uint64_t size) {
+        EXPECT_TRUE(buffer);
+        EXPECT_GT(size, 0u);
+        outputs.push_back(info);
+        return true;
+      };
+
+  auto stream_descriptors = SetupStreamDescriptors();
+  stream_descriptors[0].segment_template = GetFullPath(kOutputVideoTemplate);
+  stream_descriptors[1].segment_template = GetFullPath(kOutputAudioTemplate);
+
+  Packager packager;
+  ASSERT_EQ(Status::OK,
+            packager.Initialize(packaging_params, stream_descriptors));
+  ASSERT_EQ(Status::OK, packager.Run());
+
+  int64_t num_video_segments = 0;
+  bool has_video_init_segment = false;
+  bool has_manifest = false;
+  for (const OutputInfo& info : outputs) {
+    if (info.name == GetFullPath(kOutputMpd)) {
+      EXPECT_TRUE(info.stream.empty());
+      has_manifest = true;
+    } else if (info.name == GetFullPath(kOutputVideo)) {
+      EXPECT_EQ(GetFullPath(kOutputVideoTemplate), info.stream);
+      EXPECT_FALSE(info.is_segment);
+      has_video_init_segment = true;
+    } else if (info.stream == GetFullPath(kOutputVideoTemplate)) {
+      EXPECT_TRUE(info.is_segment);
+      EXPECT_FALSE(info.is_chunk);
+      EXPECT_EQ(++num_video_segments, info.segment_number);
+      EXPECT_GT(info.duration, 0);
+      EXPECT_GT(info.timescale, 0);
+    }
+  }
+  EXPECT_TRUE(has_video_init_segment);
+  EXPECT_TRUE(has_manifest);
+  EXPECT_GT(num_video_segments, 1);
+}
+
 TEST_F(PackagerTest, ReadFromBuffer) {
   auto packaging_params = SetupPackagingParams();
 
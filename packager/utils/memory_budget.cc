@@ -0,0 +1,148 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/memory_budget.h>
+
+#include <absl/log/check.h>
+#include <absl/synchronization/mutex.h>
+#include <absl/time/clock.h>
+
+namespace shaka {
+
+namespace {
+
+// Waiting for room is rare, so all budgets share one condition variable,
+// which is only signalled while someone waits.
+absl::Mutex g_wait_mutex;
+absl::CondVar g_room_available;
+std::atomic<int> g_num_waiters{0};
+
+}  // namespace
+
+MemoryBudget::MemoryBudget(const std::string& name,
+                           uint64_t limit_bytes,
+                           std::shared_ptr<MemoryBudget> parent)
+    : name_(name), limit_bytes_(limit_bytes), parent_(std::move(parent)) {}
+
+std::shared_ptr<MemoryBudget> MemoryBudget::GetGlobal() {
+  // Never destroyed, as buffers may be released during static destruction.
+  static auto* global =
+      new std::shared_ptr<MemoryBudget>(new MemoryBudget("global", 0, nullptr));
+  return *global;
+}
+
+MemoryBudget::Reservation::Reservation(std::shared_ptr<MemoryBudget> budget,
+                                       uint64_t bytes)
+    : budget_(std::move(budget)), bytes_(bytes) {
+  if (budget_)
+    budget_->Reserve(bytes_);
+}
+
+MemoryBudget::Reservation::Reservation(Reservation&& other)
+    : budget_(std::move(other.budget_)), bytes_(other.bytes_) {
+  other.budget_ = nullptr;
+  other.bytes_ = 0;
+}
+
+MemoryBudget::Reservation& MemoryBudget::Reservation::operator=(
+    Reservation&& other) {
+  if (this != &other) {
+    Reset();
+    budget_ = std::move(other.budget_);
+    bytes_ = other.bytes_;
+    other.budget_ = nullptr;
+    other.bytes_ = 0;
+  }
+  return *this;
+}
+
+MemoryBudget::Reservation::~Reservation() {
+  Reset();
+}
+
+void MemoryBudget::Reservation::Reset() {
+  if (budget_)
+    budget_->Release(bytes_);
+  budget_ = nullptr;
+  bytes_ = 0;
+}
+
+void MemoryBudget::Reserve(uint64_t bytes) {
+  for (MemoryBudget* budget = this; budget; budget = budget->parent_.get()) {
+    const uint64_t usage =
+        budget->usage_bytes_.fetch_add(bytes, std::memory_order_relaxed) +
+        bytes;
+    uint64_t max_usage =
+        budget->max_usage_bytes_.load(std::memory_order_relaxed);
+    while (max_usage < usage &&
+           !budget->max_usage_bytes_.compare_exchange_weak(
+               max_usage, usage, std::memory_order_relaxed)) {
+    }
+  }
+}
+
+void MemoryBudget::Release(uint64_t bytes) {
+  for (MemoryBudget* budget = this; budget; budget = budget->parent_.get()) {
+    const uint64_t usage = budget->usage_bytes_.fetch_sub(bytes);
+    DCHECK_GE(usage, bytes) << "More memory released than reserved in "
+                            << budget->name_;
+  }
+  // Sequentially consistent with WaitForRoom(), so that either the waiter sees
+  // the new usage or this sees the waiter.
+  if (g_num_waiters.load() > 0) {
+    absl::MutexLock lock(g_wait_mutex);
+    g_room_available.SignalAll();
+  }
+}
+
+bool MemoryBudget::HasRoom() const {
+  for (const MemoryBudget* budget = this; budget;
+       budget = budget->parent_.get()) {
+    if (budget->limit_bytes_ > 0 &&
+        budget->usage_bytes_.load() >= budget->limit_bytes_) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool MemoryBudget::WaitForRoom(absl::Duration timeout) {
+  if (HasRoom())
+    return true;
+
+  const absl::Time deadline = absl::Now() + timeout;
+  absl::MutexLock lock(g_wait_mutex);
+  g_num_waiters.fetch_add(1);
+  while (!HasRoom()) {
+    if (g_room_available.WaitWithDeadline(&g_wait_mutex, deadline))
+      break;
+  }
+  g_num_waiters.fetch_sub(1);
+  return HasRoom();
+}
+
+void MemoryBudget::AddBackpressureWait() {
+  num_backpressure_waits_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemoryBudget::AddDroppedSamples(uint64_t num_samples) {
+  num_dropped_samples_.fetch_add(num_samples, std::memory_order_relaxed);
+}
+
+MemoryStats MemoryBudget::GetStats() const {
+  MemoryStats stats;
+  stats.name = name_;
+  stats.usage_bytes = usage_bytes_.load(std::memory_order_relaxed);
+  stats.max_usage_bytes = max_usage_bytes_.load(std::memory_order_relaxed);
+  stats.limit_bytes = limit_bytes_;
+  stats.num_backpressure_waits =
+      num_backpressure_waits_.load(std::memory_order_relaxed);
+  stats.num_dropped_samples =
+      num_dropped_samples_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+}  // namespace shaka
@@ -0,0 +1,103 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#ifndef PACKAGER_UTILS_MEMORY_BUDGET_H_
+#define PACKAGER_UTILS_MEMORY_BUDGET_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <absl/time/time.h>
+
+#include <packager/packager_stats.h>
+
+namespace shaka {
+
+/// Accounts for the memory held by buffers, e.g. queued samples or I/O
+/// caches, against an optional limit. Budgets form a tree: memory reserved in
+/// a budget is also reserved in its ancestors, e.g. the budget of a channel
+/// belongs to the budget of its PackagerHost, which belongs to the
+/// process-wide budget. Going over a limit is allowed; it is up to the
+/// producers of data to check HasRoom() and slow down or drop data.
+/// All methods are thread safe.
+class MemoryBudget {
+ public:
+  /// @param name identifies the budget in MemoryStats.
+  /// @param limit_bytes is the limit of the budget, 0 for unlimited.
+  /// @param parent is the budget the memory is also reserved in. Null for a
+  ///        root budget.
+  MemoryBudget(const std::string& name,
+               uint64_t limit_bytes,
+               std::shared_ptr<MemoryBudget> parent);
+
+  /// @return the process-wide budget, which is unlimited. All the other
+  ///         budgets should belong to it.
+  static std::shared_ptr<MemoryBudget> GetGlobal();
+
+  /// Memory reserved in a budget, which is released on destruction.
+  class Reservation {
+   public:
+    Reservation() = default;
+    Reservation(std::shared_ptr<MemoryBudget> budget, uint64_t bytes);
+    Reservation(Reservation&& other);
+    Reservation& operator=(Reservation&& other);
+    ~Reservation();
+
+    /// Release the memory now.
+    void Reset();
+
+   private:
+    Reservation(const Reservation&) = delete;
+    Reservation& operator=(const Reservation&) = delete;
+
+    std::shared_ptr<MemoryBudget> budget_;
+    uint64_t bytes_ = 0;
+  };
+
+  /// Account for @a bytes more memory, even if it goes over the limit.
+  void Reserve(uint64_t bytes);
+  /// Account for @a bytes less memory.
+  void Release(uint64_t bytes);
+
+  /// @return whether both this budget and its ancestors are under their
+  ///         limits.
+  bool HasRoom() const;
+  /// Wait until HasRoom(), for at most @a timeout.
+  /// @return HasRoom().
+  bool WaitForRoom(absl::Duration timeout);
+
+  /// Count an input pausing until memory is released.
+  void AddBackpressureWait();
+  /// Count @a num_samples samples dropped to stay within the budget.
+  void AddDroppedSamples(uint64_t num_samples);
+
+  MemoryStats GetStats() const;
+
+  const std::string& name() const { return name_; }
+  uint64_t limit_bytes() const { return limit_bytes_; }
+  uint64_t usage_bytes() const {
+    return usage_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  MemoryBudget(const MemoryBudget&) = delete;
+  MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+  const std::string name_;
+  const uint64_t limit_bytes_;
+  const std::shared_ptr<MemoryBudget> parent_;
+
+  std::atomic<uint64_t> usage_bytes_{0};
+  std::atomic<uint64_t> max_usage_bytes_{0};
+  std::atomic<uint64_t> num_backpressure_waits_{0};
+  std::atomic<uint64_t> num_dropped_samples_{0};
+};
+
+}  // namespace shaka
+
+#endif  // PACKAGER_UTILS_MEMORY_BUDGET_H_
@@ -0,0 +1,94 @@
+// Copyright 2025 Google LLC. All rights reserved.
+//
+// Use of this source code is governed by a BSD-style
+// license that can be found in the LICENSE file or at
+// https://developers.google.com/open-source/licenses/bsd
+
+#include <packager/utils/memory_budget.h>
+
+#include <thread>
+
+#include <absl/time/clock.h>
+#include <gtest/gtest.h>
+
+namespace shaka {
+
+TEST(MemoryBudgetTest, ReservesInAncestors) {
+  auto host = std::make_shared<MemoryBudget>("host", 0, nullptr);
+  auto channel1 = std::make_shared<MemoryBudget>("channel1", 0, host);
+  auto channel2 = std::make_shared<MemoryBudget>("channel2", 0, host);
+
+  channel1->Reserve(100);
+  channel2->Reserve(50);
+  EXPECT_EQ(100u, channel1->usage_bytes());
+  EXPECT_EQ(50u, channel2->usage_bytes());
+  EXPECT_EQ(150u, host->usage_bytes());
+
+  channel1->Release(100);
+  EXPECT_EQ(0u, channel1->usage_bytes());
+  EXPECT_EQ(50u, host->usage_bytes());
+  EXPECT_EQ(150u, host->GetStats().max_usage_bytes);
+  EXPECT_EQ(100u, channel1->GetStats().max_usage_bytes);
+}
+
+TEST(MemoryBudgetTest, HasRoomChecksAncestors) {
+  auto host = std::make_shared<MemoryBudget>("host", 100, nullptr);
+  auto channel1 = std::make_shared<MemoryBudget>("channel1", 80, host);
+  auto channel2 = std::make_shared<MemoryBudget>("channel2", 0, host);
+
+  channel1->Reserve(80);
+  EXPECT_FALSE(channel1->HasRoom());
+  EXPECT_TRUE(channel2->HasRoom());
+
+  // Going over the limit is allowed.
+  channel2->Reserve(30);
+  EXPECT_EQ(110u, host->usage_bytes());
+  EXPECT_FALSE(channel2->HasRoom());
+
+  channel1->Release(80);
+  EXPECT_TRUE(channel1->HasRoom());
+  EXPECT_TRUE(channel2->HasRoom());
+}
+
+TEST(MemoryBudgetTest, ReservationReleasesOnDestruction) {
+  auto budget = std::make_shared<MemoryBudget>("budget", 0, nullptr);
+  {
+    MemoryBudget::Reservation reservation(budget, 10);
+    EXPECT_EQ(10u, budget->usage_bytes());
+
+    MemoryBudget::Reservation moved;
+    moved = std::move(reservation);
+    EXPECT_EQ(10u, budget->usage_bytes());
+  }
+  EXPECT_EQ(0u, budget->usage_bytes());
+}
+
+TEST(MemoryBudgetTest, WaitForRoom) {
+  auto budget = std::make_shared<MemoryBudget>("budget", 100, nullptr);
+  EXPECT_TRUE(budget->WaitForRoom(absl::ZeroDuration()));
+
+  budget->Reserve(100);
+  EXPECT_FALSE(budget->WaitForRoom(absl::Milliseconds(1)));
+
+  std::thread releaser([budget]() {
+    absl::SleepFor(absl::Milliseconds(10));
+    budget->Release(50);
+  });
+  EXPECT_TRUE(budget->WaitForRoom(absl::InfiniteDuration()));
+  releaser.join();
+}
+
+TEST(MemoryBudgetTest, CountsThrottling) {
+  MemoryBudget budget("budget", 100, nullptr);
+  budget.AddBackpressureWait();
+  budget.AddDroppedSamples(3);
+  budget.AddDroppedSamples(1);
+
+  const MemoryStats stats = budget.GetStats();
+  EXPECT_EQ("budget", stats.name);
+  EXPECT_EQ(100u, stats.limit_bytes);
+  EXPECT_EQ(1u, stats.num_backpressure_waits);
+  EXPECT_EQ(4u, stats.num_dropped_samples);
+}
+
+}  // namespace shaka